@@ -0,0 +1,191 @@
+#include "AllocationTracker.h"
+
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+namespace
+{
+	thread_local unsigned long long thread_allocation_count = 0;
+	thread_local unsigned long long thread_allocated_bytes = 0;
+
+	//	Returns nullptr if the memory couldn't be found, for the caller to throw or not.
+	void* TrackedAllocate(std::size_t size)
+	{
+		if (size == 0)
+		{
+			size = 1;
+		}
+
+		void* ptr = std::malloc(size);
+		if (ptr)
+		{
+			thread_allocation_count++;
+			thread_allocated_bytes += size;
+		}
+
+		return ptr;
+	}
+
+	void* TrackedAllocateAligned(std::size_t size, std::align_val_t alignment)
+	{
+		if (size == 0)
+		{
+			size = 1;
+		}
+
+		void* ptr = _aligned_malloc(size, static_cast<std::size_t>(alignment));
+		if (ptr)
+		{
+			thread_allocation_count++;
+			thread_allocated_bytes += size;
+		}
+
+		return ptr;
+	}
+
+	void* ThrowIfNull(void* ptr)
+	{
+		if (!ptr)
+		{
+			throw std::bad_alloc();
+		}
+
+		return ptr;
+	}
+}
+
+//	Replace the global allocation functions so every new/delete in the application is counted.
+//		That includes the nothrow forms and the forms for over-aligned types, or allocations made through them would be missed.
+//		Over-aligned memory has to be given back with _aligned_free, so each form has its own delete.
+void* operator new(std::size_t size)
+{
+	return ThrowIfNull(TrackedAllocate(size));
+}
+
+void* operator new[](std::size_t size)
+{
+	return ThrowIfNull(TrackedAllocate(size));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return ThrowIfNull(TrackedAllocateAligned(size, alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return ThrowIfNull(TrackedAllocateAligned(size, alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	_aligned_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+	_aligned_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+	_aligned_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+	_aligned_free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	_aligned_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	_aligned_free(ptr);
+}
+
+AllocationTracker::AllocationTracker()
+{
+	frame_start_count_ = 0;
+	frame_start_bytes_ = 0;
+	frame_allocations_ = 0;
+	frame_bytes_ = 0;
+}
+
+//	Take a snapshot of the counters for the calling thread.
+void AllocationTracker::BeginFrame()
+{
+	frame_start_count_ = thread_allocation_count;
+	frame_start_bytes_ = thread_allocated_bytes;
+}
+
+//	Store the number of allocations made since BeginFrame was called.
+void AllocationTracker::EndFrame()
+{
+	frame_allocations_ = (unsigned int)(thread_allocation_count - frame_start_count_);
+	frame_bytes_ = (unsigned int)(thread_allocated_bytes - frame_start_bytes_);
+}
+
+unsigned long long AllocationTracker::GetThreadAllocationCount()
+{
+	return thread_allocation_count;
+}
+
+unsigned long long AllocationTracker::GetThreadAllocatedBytes()
+{
+	return thread_allocated_bytes;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+//	Counts heap allocations made through any form of operator new.
+//	Counters are kept per thread so a frame only sees the allocations made by the thread running it.
+class AllocationTracker
+{
+public:
+	AllocationTracker();
+	void BeginFrame();
+	void EndFrame();
+	inline unsigned int GetFrameAllocations() { return frame_allocations_; }
+	inline unsigned int GetFrameAllocatedBytes() { return frame_bytes_; }
+	static unsigned long long GetThreadAllocationCount();
+	static unsigned long long GetThreadAllocatedBytes();
+
+private:
+	unsigned long long frame_start_count_;
+	unsigned long long frame_start_bytes_;
+	unsigned int frame_allocations_;
+	unsigned int frame_bytes_;
+};
@@ -10,6 +10,10 @@ App1::App1()
 	track_mesh_ = nullptr;
 	plane_mesh_ = nullptr;
 	plane_ = nullptr;
+	render_backend_ = nullptr;
+	buffer_backend_ = nullptr;
+	endless_ride_ = nullptr;
+	endless_mesh_ = nullptr;
 }
 
 void App1::init(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeight, Input *in)
@@ -29,6 +33,15 @@ void App1::init(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeigh
 	shaders_.push_back(colour_shader);
 	DefaultShader* default_shader = new DefaultShader(renderer->getDevice(), hwnd);
 	shaders_.push_back(default_shader);
+	InstancedShader* instanced_shader = new InstancedShader(renderer->getDevice(), hwnd);
+	shaders_.push_back(instanced_shader);
+	InstancedShader* cross_tie_shader = new InstancedShader(renderer->getDevice(), hwnd, InstancedShader::Placement::POSE);
+	shaders_.push_back(cross_tie_shader);
+	PackedShader* packed_shader = new PackedShader(renderer->getDevice(), hwnd);
+	shaders_.push_back(packed_shader);
+
+	render_backend_ = new D3D11RenderBackend(renderer->getDevice(), renderer->getDeviceContext());
+	buffer_backend_ = new D3D11BufferBackend(renderer->getDevice(), renderer->getDeviceContext());
 
 	//	Create Mesh instances and assign shaders.
 	plane_ = new MeshInstance(textureMgr->getTexture("default"), colour_shader , plane_mesh_);
@@ -38,10 +51,10 @@ void App1::init(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeigh
 		scale_matrix = XMMatrixScaling(50.0f, 1.0f, 50.0f);
 		translation_matrix = XMMatrixTranslation(-150.0f, -3.0f, -70.0f);
 		plane_->SetWorldMatrix(scale_matrix * translation_matrix * renderer->getWorldMatrix());
-		objects_.push_back(plane_);
+		scene_.Add(plane_);
 	}
 
-	track_mesh_ = new TrackMesh(renderer->getDevice(), renderer->getDeviceContext(), colour_shader, 40);
+	track_mesh_ = new TrackMesh(renderer->getDevice(), renderer->getDeviceContext(), colour_shader, instanced_shader, cross_tie_shader, packed_shader);
 	track_mesh_->SetLargeRailTexture(textureMgr->getTexture("metal"));
 	track_mesh_->SetSmallRailTexture(textureMgr->getTexture("metal3"));
 	track_mesh_->SetCrossTieTexture(textureMgr->getTexture("metal4"));
@@ -49,24 +62,42 @@ void App1::init(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeigh
 	std::vector<MeshInstance*> track_instances = track_mesh_->GetTrackMeshInstances();
 	for (int i = 0; i < track_instances.size(); i++)
 	{
-		objects_.push_back(track_instances[i]);
+		scene_.Add(track_instances[i]);
+	}
+
+	//	The endless ride has its own mesh, which is only shown while riding it.
+	endless_ride_ = new EndlessRide(24);
+	endless_mesh_ = new EndlessMesh(renderer->getDevice(), renderer->getDeviceContext(), colour_shader, cross_tie_shader, endless_ride_->GetSlotCount());
+	endless_mesh_->SetTextures(textureMgr->getTexture("metal3"), textureMgr->getTexture("metal"), textureMgr->getTexture("metal4"));
+	endless_mesh_->SetVisible(false);
+
+	std::vector<MeshInstance*> endless_instances = endless_mesh_->GetMeshInstances();
+	for (int i = 0; i < endless_instances.size(); i++)
+	{
+		scene_.Add(endless_instances[i]);
 	}
 
-	line_controller_ = new LineController(renderer->getDevice(), renderer->getDeviceContext(), default_shader, 6);
+	line_controller_ = new LineController(buffer_backend_, default_shader, 6);
+	scene_.SetLineController(line_controller_);
 
 	camera = &default_camera_;
 	camera->setPosition(0.0f, 1.0f, -10.0f);
 	camera->update();
 
-	track_ = new Track(1000, track_mesh_);
+	track_ = new Track(100, track_mesh_);
 	
 	//Initialise Application States:
+	building_state_.SetTrackMesh(track_mesh_);
 	building_state_.Init(track_);
 	building_state_.SetScreenWidth(screenWidth);
 	simulating_state_.Init(track_);
 	simulating_state_.SetScreenWidth(screenWidth);
 	simulating_state_.SetLineController(line_controller_);
 	building_state_.SetLineController(line_controller_);
+	endless_state_.Init(endless_ride_);
+	endless_state_.SetEndlessMesh(endless_mesh_);
+	endless_state_.SetScreenWidth(screenWidth);
+	endless_state_.SetLineController(line_controller_);
 	application_state_ = &building_state_;
 }
 
@@ -74,8 +105,6 @@ App1::~App1()
 {
 	BaseApplication::~BaseApplication();
 
-	objects_.clear();
-
 	if (line_controller_)
 	{
 		delete line_controller_;
@@ -94,6 +123,18 @@ App1::~App1()
 		track_mesh_ = 0;
 	}
 
+	if (endless_mesh_)
+	{
+		delete endless_mesh_;
+		endless_mesh_ = 0;
+	}
+
+	if (endless_ride_)
+	{
+		delete endless_ride_;
+		endless_ride_ = 0;
+	}
+
 	if (plane_mesh_)
 	{
 		delete plane_mesh_;
@@ -115,12 +156,26 @@ App1::~App1()
 		}
 	}
 	shaders_.clear();
+
+	if (render_backend_)
+	{
+		delete render_backend_;
+		render_backend_ = 0;
+	}
+
+	if (buffer_backend_)
+	{
+		delete buffer_backend_;
+		buffer_backend_ = 0;
+	}
 }
 
 bool App1::frame()
 {
 	bool result;
 
+	allocation_tracker_.BeginFrame();
+
 	result = BaseApplication::frame();
 	if (!result)
 	{
@@ -142,7 +197,15 @@ bool App1::frame()
 		//	Update the coaster camera.
 		if (application_state_ == &simulating_state_)
 		{
-			coaster_camera_.CalculateMatrix(track_->GetCameraEye(), track_->GetCameraLookAt(), track_->GetCameraUp(), track_->GetTrackMesh()->GetWorldMatrix());
+			XMVECTOR eye, look_at, up;
+			simulating_state_.GetCamera(eye, look_at, up);
+			coaster_camera_.CalculateMatrix(eye, look_at, up, track_mesh_->GetWorldMatrix());
+		}
+		else if (application_state_ == &endless_state_)
+		{
+			XMVECTOR eye, look_at, up;
+			endless_state_.GetCamera(eye, look_at, up);
+			coaster_camera_.CalculateMatrix(eye, look_at, up, endless_mesh_->GetWorldMatrix());
 		}
 
 		if (!application_state_->ApplicationRunning())
@@ -157,6 +220,8 @@ bool App1::frame()
 	{
 		return false;
 	}
+
+	allocation_tracker_.EndFrame();
 	
 	return true;
 }
@@ -164,37 +229,19 @@ bool App1::frame()
 bool App1::render()
 {
 	//	Add new mesh instances that have been created.
-	if (track_->GetTrackMesh()->HasNewInstances())
+	if (track_mesh_->HasNewInstances())
 	{
-		std::vector<MeshInstance*> new_instances = track_->GetTrackMesh()->GetNewInstances();
+		const std::vector<MeshInstance*>& new_instances = track_mesh_->GetNewInstances();
 
 		for (int i = 0; i < new_instances.size(); i++)
 		{
-			objects_.push_back(new_instances.at(i));
-		}
-	}
-
-	//	Remove mesh instances that are no longer used.
-	if (track_->GetTrackMesh()->InstancesPendingRemoval())
-	{
-		//	Remove any of the instances pending removal from the container of objects.
-		std::vector<MeshInstance*> pending_removal = track_->GetTrackMesh()->GetInstancesForRemoval();
-		for (int i = 0; i < pending_removal.size(); i++)
-		{
-			//	Loop in reverse order so that addresses are still valid after erasure.
-			for (int j = objects_.size() - 1; j >= 0; j--)
-			{
-				if (pending_removal[i] == objects_[j])
-				{
-					objects_.erase(objects_.begin() + j);
-				}
-			}
+			scene_.Add(new_instances.at(i));
 		}
 
-		track_->GetTrackMesh()->RemoveUnusedInstances();
+		track_mesh_->ClearNewInstances();
 	}
 
-	XMMATRIX worldMatrix, viewMatrix, projectionMatrix;
+	XMMATRIX viewMatrix, projectionMatrix;
 
 	renderer->setWireframeMode(application_state_->GetWireframeState());
 
@@ -203,18 +250,14 @@ bool App1::render()
 	// Generate the view matrix based on the camera's position.
 	camera->update();
 
-	// Get the world, view, projection matrices from the camera and Direct3D objects.
-	worldMatrix = renderer->getWorldMatrix();
+	// Get the view and projection matrices from the camera and Direct3D objects.
 	viewMatrix = camera->getViewMatrix();
 	projectionMatrix = renderer->getProjectionMatrix();
 
-	//	Render all mesh instances.
-	for (int i = 0; i < objects_.size(); i++)
-	{
-		objects_.at(i)->Render(renderer->getDeviceContext(), viewMatrix, projectionMatrix);
-	}
+	//	Choose the track's level of detail from the camera's position, which is the last row of the inverse view matrix.
+	track_mesh_->UpdateLod(XMMatrixInverse(nullptr, viewMatrix).r[3]);
 
-	line_controller_->Render(renderer->getDeviceContext(), worldMatrix, viewMatrix, projectionMatrix);
+	scene_.Render(viewMatrix, projectionMatrix, render_backend_);
 
 	// Render GUI
 	gui();
@@ -235,11 +278,23 @@ void App1::SwitchApplicationState(ApplicationState::APPLICATIONSTATE state)
 		break;
 
 	case ApplicationState::APPLICATIONSTATE::SIMULATING_STATE:
+		//	The track can't be moved while it is ridden, so its placement is only passed on when the ride starts.
+		simulating_state_.SetTrackWorldMatrix(track_mesh_->GetWorldMatrix());
 		application_state_ = &simulating_state_;
 		camera = &coaster_camera_;
 		break;
+
+	case ApplicationState::APPLICATIONSTATE::ENDLESS_STATE:
+		application_state_ = &endless_state_;
+		camera = &coaster_camera_;
+		break;
 	}
 
+	//	Only one of the two tracks is on screen at a time.
+	bool endless = (application_state_ == &endless_state_);
+	track_mesh_->SetVisible(!endless);
+	endless_mesh_->SetVisible(endless);
+
 	application_state_->OnEnter();
 }
 
@@ -306,6 +361,11 @@ void App1::gui()
 	if (application_state_->ShowFPS())
 	{
 		ImGui::Text("FPS: %.f", timer->getFPS());
+		ImGui::Text("Allocations: %u", allocation_tracker_.GetFrameAllocations());
+
+		TrackMesh::MemoryStats memory = track_mesh_->GetMemoryStats();
+		ImGui::Text("Track buffers: %u KB (%u chunks, %u pooled)", 
+			(memory.chunk_bytes + memory.preview_bytes + memory.support_bytes) / 1024, memory.chunk_count, memory.pooled_chunk_count);
 	}
 
 	application_state_->RenderUI();
@@ -6,14 +6,22 @@
 #include "ColourShader.h"
 #include "../DXFramework/Geometry.h"
 #include "DefaultShader.h"
+#include "InstancedShader.h"
+#include "PackedShader.h"
 #include "MeshInstance.h"
+#include "Scene.h"
+#include "D3D11RenderBackend.h"
+#include "D3D11BufferBackend.h"
 #include <vector>
 #include "CoasterCamera.h"
 #include "Track.h"
 #include "BuildingState.h"
 #include "SimulatingState.h"
+#include "EndlessState.h"
+#include "EndlessMesh.h"
 #include "LineController.h"
 #include "TrackMesh.h"
+#include "AllocationTracker.h"
 
 class App1 : public BaseApplication
 {
@@ -34,7 +42,7 @@ private:
 
 private:
 	LineController* line_controller_;
-	std::vector<MeshInstance*> objects_;
+	Scene scene_;
 	Track* track_;
 	TrackMesh* track_mesh_;
 	Camera default_camera_;
@@ -42,10 +50,16 @@ private:
 	ApplicationState* application_state_;
 	BuildingState building_state_;
 	SimulatingState simulating_state_;
+	EndlessState endless_state_;
+	EndlessRide* endless_ride_;
+	EndlessMesh* endless_mesh_;
 	PlaneMesh* plane_mesh_;
 	MeshInstance* plane_;
 	bool wireframe_;
 	std::vector<BaseShader*> shaders_;
+	D3D11RenderBackend* render_backend_;
+	D3D11BufferBackend* buffer_backend_;
+	AllocationTracker allocation_tracker_;
 };
 
 #endif
\ No newline at end of file
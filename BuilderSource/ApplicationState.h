@@ -11,7 +11,8 @@ public:
 	enum class APPLICATIONSTATE
 	{
 		BUILDING_STATE = 0,
-		SIMULATING_STATE
+		SIMULATING_STATE,
+		ENDLESS_STATE
 	};
 
 	ApplicationState();
@@ -0,0 +1,126 @@
+#include "BankingSolver.h"
+
+#include "Track.h"
+#include "../Spline-Library/matrix3x3.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+
+BankingSolver::BankingSolver() : min_speed_(default_min_speed), samples_per_piece_(30), smoothing_radius_(0)
+{
+}
+
+//	Sample the track once, then find the bank angle at every sample and store it on the track.
+bool BankingSolver::Solve(Track* track)
+{
+	if (!track || track->GetTrackPieceCount() < 1)
+	{
+		return false;
+	}
+
+	const float gravity = 9.81f;
+	const int sample_count = track->GetTrackPieceCount() * samples_per_piece_ + 1;
+	const float step = track->GetTrackLength() / (float)(sample_count - 1);
+	if (step <= 0.0f)
+	{
+		return false;
+	}
+
+	tangents_.resize(sample_count);
+	heights_.resize(sample_count);
+
+	track->Reset();
+	DirectX::XMFLOAT3 start_up = track->GetUp();
+
+	float max_height = -FLT_MAX;
+	for (int i = 0; i < sample_count; i++)
+	{
+		float d = (float)i / (float)(sample_count - 1);
+		track->UpdateSimulation(d);
+
+		tangents_[i] = track->GetTangent();
+		heights_[i] = track->GetPointAtDistance(d).y;
+
+		if (heights_[i] > max_height)
+		{
+			max_height = heights_[i];
+		}
+	}
+	track->Reset();
+
+	std::shared_ptr<std::vector<float>> channel = std::make_shared<std::vector<float>>(sample_count);
+	std::vector<float>& roll = *channel;
+
+	//	Carry the frame along the track the same way the simulation does, rolling it as it goes,
+	//		so that the simulation reproduces the same frames at the samples.
+	SL::Vector up(start_up.x, start_up.y, start_up.z);
+	float current_roll = 0.0f;
+
+	SL::Vector world_up(0.0f, 1.0f, 0.0f);
+	for (int i = 0; i < sample_count; i++)
+	{
+		//	Central difference of the unit tangent over distance, pointing towards the centre of the turn.
+		int previous = (i > 0) ? i - 1 : i;
+		int next = (i < sample_count - 1) ? i + 1 : i;
+		SL::Vector curvature = tangents_[next].Subtract(tangents_[previous]).Scaled(1.0f / ((next - previous) * step));
+
+		float speed_squared = min_speed_ * min_speed_ + 2.0f * gravity * (max_height - heights_[i]);
+
+		//	The force felt by the rider, which the track's up should follow, without its part along the track.
+		SL::Vector felt = curvature.Scaled(speed_squared).Add(world_up.Scaled(gravity));
+		SL::Vector forward = tangents_[i];
+		felt = felt.Subtract(forward.Scaled(felt.Dot(forward)));
+
+		SL::Vector right = up.Cross(forward).Normalised();
+		up = forward.Cross(right).Normalised();
+
+		//	A positive roll turns up towards forward x up. Taking the shortest way round keeps the channel continuous.
+		SL::Vector side = forward.Cross(up);
+		float angle_needed = atan2f(felt.Dot(side), felt.Dot(up));
+		if (angle_needed != 0.0f)
+		{
+			SL::Matrix3x3 roll_matrix;
+			roll_matrix.RotationAxisAngle(forward, angle_needed);
+			up = roll_matrix.TransformVector(up);
+		}
+
+		current_roll += angle_needed;
+		roll[i] = current_roll;
+	}
+
+	//	Curvature jumps where pieces meet, which snaps the bank angle unless the joints have been smoothed.
+	//		Filtering the channel softens the snap, at the cost of some sideways force either side of it.
+	Smooth(roll);
+
+	track->SetRollChannel(channel);
+
+	return true;
+}
+
+//	Box filter, with the window shrinking at the ends so the first and last samples are kept.
+void BankingSolver::Smooth(std::vector<float>& channel)
+{
+	const int count = channel.size();
+	if (smoothing_radius_ <= 0 || count < 3)
+	{
+		return;
+	}
+
+	scratch_.resize(count + 1);
+	scratch_[0] = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		scratch_[i + 1] = scratch_[i] + channel[i];
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		int radius = std::min(smoothing_radius_, std::min(i, count - 1 - i));
+		channel[i] = (scratch_[i + radius + 1] - scratch_[i - radius]) / (float)(2 * radius + 1);
+	}
+}
+
+BankingSolver::~BankingSolver()
+{
+}
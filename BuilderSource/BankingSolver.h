@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../Spline-Library/vector.h"
+#include <vector>
+
+class Track;
+
+//	Works out how far the track has to bank so that riders feel no sideways force.
+//	The speed along the track comes from energy: the train is assumed to crest the highest point at the
+//		minimum speed and lose no energy to friction. The force felt by a rider is then the centripetal
+//		acceleration plus gravity, and the bank angle is whatever lines the track's up with that force.
+//	The result is a roll for every sample along the track, which replaces the roll targets of the pieces.
+class BankingSolver
+{
+public:
+	//	In metres per second.
+	static constexpr float default_min_speed = 8.0f;
+
+	BankingSolver();
+	bool Solve(Track* track);
+	inline void SetMinSpeed(float min_speed) { min_speed_ = min_speed; }
+	inline float GetMinSpeed() { return min_speed_; }
+	inline void SetSamplesPerPiece(int samples_per_piece) { samples_per_piece_ = samples_per_piece; }
+	inline void SetSmoothingRadius(int smoothing_radius) { smoothing_radius_ = smoothing_radius; }
+	~BankingSolver();
+
+private:
+	void Smooth(std::vector<float>& channel);
+
+private:
+	//	In metres per second.
+	float min_speed_;
+	int samples_per_piece_;
+	int smoothing_radius_;
+
+	std::vector<SL::Vector> tangents_;
+	std::vector<float> heights_;
+	std::vector<float> scratch_;
+};
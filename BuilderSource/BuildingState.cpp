@@ -5,23 +5,31 @@
 BuildingState::BuildingState()
 {
 	track_ = nullptr;
+	track_mesh_ = nullptr;
 	track_builder_ = nullptr;
 	track_loader_ = nullptr;
 	delta_time_ = 0.0f;
 	move_speed_ = 5.0f;
+	endless_ = false;
 }
 
 void BuildingState::Init(void* ptr)
 {
 	track_ = static_cast<Track*>(ptr);
 	
-	track_builder_ = new TrackBuilder(track_);
+	track_builder_ = new TrackBuilder(track_, track_mesh_);
 
 	track_loader_ = new TrackLoader();
 	track_loader_->LoadTrack("Example1.txt", track_);
 	track_builder_->SetTrackLoadToggle();
 }
 
+//	The mesh the track is drawn with. Must be set before Init, which hands it to the track builder.
+void BuildingState::SetTrackMesh(TrackMesh* track_mesh)
+{
+	track_mesh_ = track_mesh;
+}
+
 void BuildingState::Update(float delta_time)
 {
 	delta_time_ = delta_time;
@@ -132,6 +140,7 @@ void BuildingState::RenderUI()
 			ImGui::BulletText("Once the track piece has been placed you can edit it with SHIFT + W,A,S,D,Q,E");
 			ImGui::BulletText("You can make further changes in the 'New Track Piece' pop-up menu");
 			ImGui::BulletText("Pressing 'Finish Track' will connect the first and last pieces");
+			ImGui::BulletText("'Smooth Loop Closure' reshapes the last few pieces so the join is seamless");
 			ImGui::BulletText("Select 'Build Support Structures' to add the track supports");
 			ImGui::BulletText("Once finished you may ride your newly created roller coaster");
 			ImGui::Separator();
@@ -172,28 +181,63 @@ void BuildingState::RenderUI()
 	}
 
 	ImGui::Checkbox("Ride Coaster", &exit_);
-	ImGui::Separator();
-	if (track_->GetTrackPieceCount() >= track_->GetMaxTrackPieceCount())
+	ImGui::Checkbox("Endless Ride", &endless_);
+	if (endless_)
 	{
-		ImGui::Text("Track has reached max length!");
-		ImGui::Text("Remove track pieces to continue.");
+		exit_ = true;
 	}
-	else
+	ImGui::Separator();
+	ImGui::Text("Track Piece Type");
+	ImGui::Checkbox("Add Straight", track_builder_->SetTrackPieceType(TrackPiece::Tag::STRAIGHT));
+	ImGui::Checkbox("Add Right Turn", track_builder_->SetTrackPieceType(TrackPiece::Tag::RIGHT_TURN));
+	ImGui::Checkbox("Add Left Turn", track_builder_->SetTrackPieceType(TrackPiece::Tag::LEFT_TURN));
+	ImGui::Checkbox("Add Climb Up", track_builder_->SetTrackPieceType(TrackPiece::Tag::CLIMB_UP));
+	ImGui::Checkbox("Add Climb Down", track_builder_->SetTrackPieceType(TrackPiece::Tag::CLIMB_DOWN));
+	ImGui::Separator();
+	ImGui::Checkbox("Finish Track", track_builder_->SetTrackPieceType(TrackPiece::Tag::COMPLETE_TRACK));
+
+	if (track_->IsComplete())
 	{
-		ImGui::Text("Track Piece Type");
-		ImGui::Checkbox("Add Straight", track_builder_->SetTrackPieceType(TrackPiece::Tag::STRAIGHT));
-		ImGui::Checkbox("Add Right Turn", track_builder_->SetTrackPieceType(TrackPiece::Tag::RIGHT_TURN));
-		ImGui::Checkbox("Add Left Turn", track_builder_->SetTrackPieceType(TrackPiece::Tag::LEFT_TURN));
-		ImGui::Checkbox("Add Climb Up", track_builder_->SetTrackPieceType(TrackPiece::Tag::CLIMB_UP));
-		ImGui::Checkbox("Add Climb Down", track_builder_->SetTrackPieceType(TrackPiece::Tag::CLIMB_DOWN));
-		ImGui::Separator();
-		ImGui::Checkbox("Finish Track", track_builder_->SetTrackPieceType(TrackPiece::Tag::COMPLETE_TRACK));
+		ImGui::Checkbox("Smooth Loop Closure", track_builder_->SetCloseLoop());
 	}
 
-	ImGui::Checkbox("Remove Last Piece", track_builder_->SetUndo());
+	ImGui::Checkbox("Remove Last Piece", track_builder_->SetRemoveLastPiece());
 	ImGui::Checkbox("Build Support Structures", track_builder_->SetBuildSupports());
+	ImGui::Checkbox("Smooth Joints On Commit", track_builder_->SetSmoothJoints());
+	ImGui::Checkbox("Automatic Banking", track_builder_->SetAutoBank());
+	if (*track_builder_->SetAutoBank())
+	{
+		ImGui::SliderFloat("Banking Speed (m/s)", track_builder_->SetBankSpeed(), 2.0f, 30.0f);
+	}
+	if (track_builder_->IsBaking())
+	{
+		ImGui::Text("Baking...");
+	}
 	ImGui::Separator();
 
+	TrackHistory* history = track_builder_->GetHistory();
+	ImGui::Text("History (%u/%u)", history->GetUndoCount(), history->GetUndoCount() + history->GetRedoCount());
+	if (history->CanUndo())
+	{
+		ImGui::Checkbox("Undo", track_builder_->SetUndo());
+	}
+	if (history->CanRedo())
+	{
+		ImGui::Checkbox("Redo", track_builder_->SetRedo());
+	}
+	ImGui::Separator();
+
+	if (track_->GetTrackPieceCount() > 0)
+	{
+		ImGui::Text("Edit Track");
+		ImGui::SliderInt("Selected Piece", track_builder_->SetSelectedPiece(), 0, track_->GetTrackPieceCount() - 1);
+		ImGui::Combo("Piece Type", track_builder_->SetEditPieceType(), "Straight\0Right Turn\0Left Turn\0Climb Up\0Climb Down\0\0");
+		ImGui::Checkbox("Insert After Selected", track_builder_->SetInsertPiece());
+		ImGui::Checkbox("Replace Selected", track_builder_->SetReplacePiece());
+		ImGui::Checkbox("Remove Selected", track_builder_->SetRemovePiece());
+		ImGui::Separator();
+	}
+
 	if (track_builder_->GetPreviewActive())
 	{
 		ImGui::Begin("New Track Piece");
@@ -220,6 +264,7 @@ void BuildingState::RenderUI()
 		}
 
 		ImGui::SliderInt("Roll Target:", track_builder_->SetRollTarget(), -720, 720);
+		ImGui::SliderFloat("Tension:", track_builder_->SetTension(), 0.5f, 4.0f);
 
 		ImGui::Checkbox("Finish Track Piece", track_builder_->SetPreviewFinished());
 		ImGui::Separator();
@@ -236,12 +281,20 @@ void BuildingState::OnEnter()
 ApplicationState::APPLICATIONSTATE BuildingState::OnExit()
 {
 	exit_ = false;
+
+	//	The endless ride generates its own track, so the one being built is left as it is.
+	if (endless_)
+	{
+		endless_ = false;
+		return APPLICATIONSTATE::ENDLESS_STATE;
+	}
 	
 	//	The track preview is still active, add it to the track so that the camera movement matches the spline during simulation.
 	if (track_builder_->GetPreviewActive())
 	{
 		track_builder_->FinishPreview();
 	}
+	track_builder_->FinishBaking();
 
 	return APPLICATIONSTATE::SIMULATING_STATE;
 }
@@ -5,12 +5,14 @@
 #include "Track.h"
 
 class TrackLoader;
+class TrackMesh;
 
 class BuildingState : public ApplicationState
 {
 public:
 	BuildingState();
 	void Init(void* ptr);
+	void SetTrackMesh(TrackMesh* track_mesh);
 	void Update(float delta_time);
 	void OnEnter();
 	APPLICATIONSTATE OnExit();
@@ -28,8 +30,10 @@ public:
 private:
 	TrackBuilder* track_builder_;
 	Track* track_;
+	TrackMesh* track_mesh_;
 	float delta_time_;
 	float move_speed_;
+	bool endless_;
 	TrackLoader* track_loader_;
 	char save_buffer_[64];
 	char load_buffer_[64];
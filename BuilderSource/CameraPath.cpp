@@ -0,0 +1,332 @@
+#include "CameraPath.h"
+
+#include "Track.h"
+
+#include <cmath>
+#include <cfloat>
+
+using namespace DirectX;
+
+CameraPath::CameraPath()
+{
+	sample_count_ = 0;
+	closed_ = false;
+}
+
+//	Run the simulation once over the whole track and bake a table for every camera rig.
+void CameraPath::Bake(Track* track, int samples_per_piece, int smoothing_radius)
+{
+	Clear();
+
+	if (!track || track->GetTrackPieceCount() < 1)
+	{
+		return;
+	}
+
+	closed_ = track->GetBack()->GetTag() == TrackPiece::Tag::COMPLETE_TRACK;
+	sample_count_ = track->GetTrackPieceCount() * samples_per_piece + 1;
+
+	//	Sample the frame at a fixed distance step.
+	//	The simulation propagates the frame from the previous update so it must run in order.
+	std::vector<RideFrame> frames(sample_count_);
+	float min_height = FLT_MAX;
+	track->Reset();
+	for (int i = 0; i < sample_count_; i++)
+	{
+		float d = (float)i / (float)(sample_count_ - 1);
+		track->UpdateSimulation(d);
+
+		frames[i].point = track->GetPoint();
+		frames[i].forward = track->GetForward();
+		frames[i].up = track->GetUp();
+		frames[i].right = track->GetRight();
+
+		if (frames[i].point.y < min_height)
+		{
+			min_height = frames[i].point.y;
+		}
+	}
+	track->Reset();
+
+	//	Convert the rig offsets from world units into table samples.
+	float step = track->GetTrackLength() / (float)(sample_count_ - 1);
+	if (step <= 0.0f)
+	{
+		step = 1.0f;
+	}
+	int back_seat_offset = (int)(1.5f / step + 0.5f);
+	int chase_offset = (int)(3.0f / step + 0.5f);
+
+	BakeFrontSeat(frames);
+	BakeBackSeat(frames, back_seat_offset);
+	BakeChase(frames, chase_offset);
+	BakeFlyBy(frames, samples_per_piece * 2, min_height);
+
+	//	Filter each rig to remove the jolts between track pieces.
+	//	The fly-by eye is left alone, its cuts between stations are intentional.
+	std::vector<XMFLOAT3> channel(sample_count_);
+	for (int rig = 0; rig < (int)Rig::RIG_COUNT; rig++)
+	{
+		std::vector<CameraSample>& samples = samples_[rig];
+
+		if (rig != (int)Rig::FLY_BY)
+		{
+			for (int i = 0; i < sample_count_; i++) channel[i] = samples[i].eye;
+			Smooth(channel, smoothing_radius, false);
+			for (int i = 0; i < sample_count_; i++) samples[i].eye = channel[i];
+		}
+
+		for (int i = 0; i < sample_count_; i++) channel[i] = samples[i].look_at;
+		Smooth(channel, smoothing_radius, false);
+		for (int i = 0; i < sample_count_; i++) samples[i].look_at = channel[i];
+
+		for (int i = 0; i < sample_count_; i++) channel[i] = samples[i].up;
+		Smooth(channel, smoothing_radius, true);
+		for (int i = 0; i < sample_count_; i++) samples[i].up = channel[i];
+	}
+}
+
+//	The original seat position, slightly above and behind the current point.
+void CameraPath::BakeFrontSeat(const std::vector<RideFrame>& frames)
+{
+	std::vector<CameraSample>& samples = samples_[(int)Rig::FRONT_SEAT];
+	samples.resize(sample_count_);
+
+	for (int i = 0; i < sample_count_; i++)
+	{
+		XMVECTOR point = XMLoadFloat3(&frames[i].point);
+		XMVECTOR forward = XMLoadFloat3(&frames[i].forward);
+		XMVECTOR up = XMLoadFloat3(&frames[i].up);
+
+		XMVECTOR eye = point + XMVectorScale(up, 0.15f) - XMVectorScale(forward, 0.5f);
+		XMStoreFloat3(&samples[i].eye, eye);
+		XMStoreFloat3(&samples[i].look_at, eye + forward);
+		samples[i].up = frames[i].up;
+	}
+}
+
+//	Same as the front seat but using the frame of a car further back along the track.
+void CameraPath::BakeBackSeat(const std::vector<RideFrame>& frames, int offset)
+{
+	std::vector<CameraSample>& samples = samples_[(int)Rig::BACK_SEAT];
+	samples.resize(sample_count_);
+
+	for (int i = 0; i < sample_count_; i++)
+	{
+		const RideFrame& frame = frames[OffsetIndex(i, -offset)];
+		XMVECTOR point = XMLoadFloat3(&frame.point);
+		XMVECTOR forward = XMLoadFloat3(&frame.forward);
+		XMVECTOR up = XMLoadFloat3(&frame.up);
+
+		XMVECTOR eye = point + XMVectorScale(up, 0.15f) - XMVectorScale(forward, 0.5f);
+		XMStoreFloat3(&samples[i].eye, eye);
+		XMStoreFloat3(&samples[i].look_at, eye + forward);
+		samples[i].up = frame.up;
+	}
+}
+
+//	Follow behind and above the train, looking at the front car.
+//	The up vector is blended towards world up so the chase camera does not roll as hard as the track.
+void CameraPath::BakeChase(const std::vector<RideFrame>& frames, int offset)
+{
+	std::vector<CameraSample>& samples = samples_[(int)Rig::CHASE];
+	samples.resize(sample_count_);
+
+	XMVECTOR world_up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+	for (int i = 0; i < sample_count_; i++)
+	{
+		const RideFrame& frame = frames[OffsetIndex(i, -offset)];
+		XMVECTOR point = XMLoadFloat3(&frame.point);
+		XMVECTOR forward = XMLoadFloat3(&frame.forward);
+		XMVECTOR up = XMLoadFloat3(&frame.up);
+
+		XMVECTOR eye = point + XMVectorScale(up, 1.2f) - XMVectorScale(forward, 1.0f);
+		XMVECTOR look_at = XMLoadFloat3(&frames[i].point) + XMVectorScale(XMLoadFloat3(&frames[i].up), 0.3f);
+		XMStoreFloat3(&samples[i].eye, eye);
+		XMStoreFloat3(&samples[i].look_at, look_at);
+		XMStoreFloat3(&samples[i].up, XMVector3Normalize(XMVectorLerp(up, world_up, 0.5f)));
+	}
+}
+
+//	Fixed cameras placed beside the track. The camera cuts to the next station as the train passes.
+void CameraPath::BakeFlyBy(const std::vector<RideFrame>& frames, int station_spacing, float min_height)
+{
+	std::vector<CameraSample>& samples = samples_[(int)Rig::FLY_BY];
+	samples.resize(sample_count_);
+
+	if (station_spacing < 1)
+	{
+		station_spacing = 1;
+	}
+
+	XMFLOAT3 station;
+	for (int i = 0; i < sample_count_; i++)
+	{
+		//	Place a new station level with the middle of the section it covers.
+		if (i % station_spacing == 0)
+		{
+			int centre = i + station_spacing / 2;
+			if (centre >= sample_count_)
+			{
+				centre = sample_count_ - 1;
+			}
+
+			const RideFrame& frame = frames[centre];
+			XMVECTOR right = XMLoadFloat3(&frame.right);
+			right = XMVector3Normalize(XMVectorSetY(right, 0.0f));
+			XMStoreFloat3(&station, XMLoadFloat3(&frame.point) + XMVectorScale(right, 6.0f));
+			station.y += 2.0f;
+
+			//	Keep the station above the lowest part of the track.
+			if (station.y < min_height + 1.0f)
+			{
+				station.y = min_height + 1.0f;
+			}
+		}
+
+		samples[i].eye = station;
+		samples[i].look_at = frames[i].point;
+		samples[i].up = XMFLOAT3(0.0f, 1.0f, 0.0f);
+	}
+}
+
+//	Step along the table, wrapping around a complete circuit and clamping an open one.
+int CameraPath::OffsetIndex(int index, int offset) const
+{
+	int result = index + offset;
+
+	if (closed_)
+	{
+		//	The first and last samples are the same point on a closed track.
+		int period = sample_count_ - 1;
+		result %= period;
+		if (result < 0)
+		{
+			result += period;
+		}
+	}
+	else if (result < 0)
+	{
+		result = 0;
+	}
+	else if (result >= sample_count_)
+	{
+		result = sample_count_ - 1;
+	}
+
+	return result;
+}
+
+//	Gaussian weighted moving average over a single channel.
+void CameraPath::Smooth(std::vector<XMFLOAT3>& channel, int radius, bool normalise)
+{
+	if (radius < 1)
+	{
+		return;
+	}
+
+	std::vector<float> weights(radius + 1);
+	float sigma = radius * 0.5f;
+	for (int k = 0; k <= radius; k++)
+	{
+		weights[k] = expf(-(float)(k * k) / (2.0f * sigma * sigma));
+	}
+
+	std::vector<XMFLOAT3> source = channel;
+	for (int i = 0; i < sample_count_; i++)
+	{
+		XMVECTOR sum = XMVectorZero();
+		float total = 0.0f;
+
+		for (int k = -radius; k <= radius; k++)
+		{
+			float weight = weights[k < 0 ? -k : k];
+			sum += XMVectorScale(XMLoadFloat3(&source[OffsetIndex(i, k)]), weight);
+			total += weight;
+		}
+
+		sum = XMVectorScale(sum, 1.0f / total);
+		if (normalise)
+		{
+			sum = XMVector3Normalize(sum);
+		}
+		XMStoreFloat3(&channel[i], sum);
+	}
+}
+
+//	Look up the camera for distance d along the track, blending the two nearest table entries.
+void CameraPath::Sample(Rig rig, float d, XMVECTOR& eye, XMVECTOR& look_at, XMVECTOR& up) const
+{
+	if (!IsBaked())
+	{
+		eye = XMVectorZero();
+		look_at = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
+		up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+		return;
+	}
+
+	const std::vector<CameraSample>& samples = samples_[(int)rig];
+
+	if (d < 0.0f)
+	{
+		d = 0.0f;
+	}
+	else if (d > 1.0f)
+	{
+		d = 1.0f;
+	}
+
+	float position = d * (float)(sample_count_ - 1);
+	int index = (int)position;
+	if (index >= sample_count_ - 1)
+	{
+		index = sample_count_ - 2;
+	}
+	float blend = position - (float)index;
+
+	const CameraSample& a = samples[index];
+	const CameraSample& b = samples[index + 1];
+
+	//	Fly-by stations cut rather than pan between each other.
+	if (rig == Rig::FLY_BY)
+	{
+		eye = XMLoadFloat3(blend < 0.5f ? &a.eye : &b.eye);
+	}
+	else
+	{
+		eye = XMVectorLerp(XMLoadFloat3(&a.eye), XMLoadFloat3(&b.eye), blend);
+	}
+	look_at = XMVectorLerp(XMLoadFloat3(&a.look_at), XMLoadFloat3(&b.look_at), blend);
+	up = XMVector3Normalize(XMVectorLerp(XMLoadFloat3(&a.up), XMLoadFloat3(&b.up), blend));
+}
+
+void CameraPath::Clear()
+{
+	for (int rig = 0; rig < (int)Rig::RIG_COUNT; rig++)
+	{
+		samples_[rig].clear();
+	}
+	sample_count_ = 0;
+	closed_ = false;
+}
+
+const char* CameraPath::GetRigName(Rig rig)
+{
+	switch (rig)
+	{
+	case Rig::FRONT_SEAT:
+		return "Front Seat";
+	case Rig::BACK_SEAT:
+		return "Back Seat";
+	case Rig::CHASE:
+		return "Chase";
+	case Rig::FLY_BY:
+		return "Fly-by";
+	default:
+		return "";
+	}
+}
+
+CameraPath::~CameraPath()
+{
+}
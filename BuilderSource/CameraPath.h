@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <directxmath.h>
+
+class Track;
+
+//	Baked camera paths for riding the coaster.
+//	Every rig is sampled once per track at a fixed distance step and smoothed, so the camera
+//		only has to look up and interpolate two table entries each frame.
+class CameraPath
+{
+public:
+	enum class Rig
+	{
+		FRONT_SEAT = 0,
+		BACK_SEAT,
+		CHASE,
+		FLY_BY,
+		RIG_COUNT
+	};
+
+	CameraPath();
+	void Bake(Track* track, int samples_per_piece = 60, int smoothing_radius = 6);
+	void Clear();
+	void Sample(Rig rig, float d, DirectX::XMVECTOR& eye, DirectX::XMVECTOR& look_at, DirectX::XMVECTOR& up) const;
+	inline bool IsBaked() const { return sample_count_ > 1; }
+	static const char* GetRigName(Rig rig);
+	~CameraPath();
+
+private:
+	struct CameraSample
+	{
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 look_at;
+		DirectX::XMFLOAT3 up;
+	};
+
+	struct RideFrame
+	{
+		DirectX::XMFLOAT3 point;
+		DirectX::XMFLOAT3 forward;
+		DirectX::XMFLOAT3 up;
+		DirectX::XMFLOAT3 right;
+	};
+
+	void BakeFrontSeat(const std::vector<RideFrame>& frames);
+	void BakeBackSeat(const std::vector<RideFrame>& frames, int offset);
+	void BakeChase(const std::vector<RideFrame>& frames, int offset);
+	void BakeFlyBy(const std::vector<RideFrame>& frames, int station_spacing, float min_height);
+	int OffsetIndex(int index, int offset) const;
+	void Smooth(std::vector<DirectX::XMFLOAT3>& channel, int radius, bool normalise);
+
+private:
+	std::vector<CameraSample> samples_[(int)Rig::RIG_COUNT];
+	int sample_count_;
+	bool closed_;
+};
@@ -2,7 +2,7 @@
 #include "colourshader.h"
 
 
-ColourShader::ColourShader(ID3D11Device* device, HWND hwnd) : BaseShader(device, hwnd)
+ColourShader::ColourShader(ID3D11Device* device, HWND hwnd) : SceneShader(device, hwnd)
 {
 	initShader(L"colour_vs.cso", L"colour_ps.cso");
 	//SHADER_TYPE = SHADERTYPE::COLOUR;
@@ -56,7 +56,7 @@ void ColourShader::initShader(WCHAR* vsFilename, WCHAR* psFilename)
 
 	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
 	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
+	matrixBufferDesc.ByteWidth = sizeof(ObjectBufferType);
 	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
 	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	matrixBufferDesc.MiscFlags = 0;
@@ -95,33 +95,21 @@ void ColourShader::initShader(WCHAR* vsFilename, WCHAR* psFilename)
 }
 
 
-void ColourShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix, const XMMATRIX &projectionMatrix)
+//	Set what changes with each draw. The texture is bound by the render backend, only when it changes.
+void ColourShader::SetObjectParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX &worldMatrix)
 {
-	HRESULT result;
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	MatrixBufferType* dataPtr;
+	ObjectBufferType* dataPtr;
 	ColourBufferType* colour_ptr;
-	unsigned int bufferNumber;
-	XMMATRIX tworld, tview, tproj;
-
-	// Transpose the matrices to prepare them for the shader.
-	tworld = XMMatrixTranspose(worldMatrix);
-	tview = XMMatrixTranspose(viewMatrix);
-	tproj = XMMatrixTranspose(projectionMatrix);
-
-	// Lock the constant buffer so it can be written to.
-	result = deviceContext->Map(matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	dataPtr = (MatrixBufferType*)mappedResource.pData;
-	dataPtr->world = tworld;// worldMatrix;
-	dataPtr->view = tview;
-	dataPtr->projection = tproj;
-	// Unlock the constant buffer.
+
+	// Lock the constant buffer so it can be written to. The view and projection are already in the frame buffer.
+	deviceContext->Map(matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	dataPtr = (ObjectBufferType*)mappedResource.pData;
+	dataPtr->world = XMMatrixTranspose(worldMatrix);
 	deviceContext->Unmap(matrixBuffer, 0);
-	bufferNumber = 0;
-	// Now set the constant buffer in the vertex shader with the updated values.
-	deviceContext->VSSetConstantBuffers(bufferNumber, 1, &matrixBuffer);
+	deviceContext->VSSetConstantBuffers(0, 1, &matrixBuffer);
 
-	result = deviceContext->Map(colour_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);	
+	deviceContext->Map(colour_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 	colour_ptr = (ColourBufferType*)mappedResource.pData;
 	colour_ptr->colour = colour_;
 	colour_ptr->light_ambient = XMFLOAT4(0.3f, 0.3f, 0.3f, 1.0f);
@@ -129,12 +117,6 @@ void ColourShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, const
 	colour_ptr->light_direction = XMFLOAT4(2.0f, -2.0f, 1.0f, 0.0f);
 	deviceContext->Unmap(colour_buffer_, 0);
 	deviceContext->PSSetConstantBuffers(0, 1, &colour_buffer_);
-
-	if (texture_)
-	{
-		deviceContext->PSSetShaderResources(0, 1, &texture_);
-		deviceContext->PSSetSamplers(0, 1, &sampleState);
-	}
 }
 
 void ColourShader::SetTexture(ID3D11ShaderResourceView* texture)
@@ -3,7 +3,7 @@
 #ifndef _COLOURSHADER_H_
 #define _COLOURSHADER_H_
 
-#include "../DXFramework/BaseShader.h"
+#include "SceneShader.h"
 
 using namespace std;
 using namespace DirectX;
@@ -16,12 +16,12 @@ struct ColourBufferType
 	XMFLOAT4 light_direction;
 };
 
-class ColourShader : public BaseShader
+class ColourShader : public SceneShader
 {
 public:
 	ColourShader(ID3D11Device* device, HWND hwnd);
 	~ColourShader();
-	virtual void SetShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX &world, const XMMATRIX &view, const XMMATRIX &projection);
+	void SetObjectParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX &world);
 	void SetTexture(ID3D11ShaderResourceView* texture);
 	void SetColour(float r, float g, float b);
 
@@ -1,18 +1,10 @@
-
 #include "CrossTieMesh.h"
+#include <cmath>
 
-// Initialise vertex data, buffers and load texture.
-CrossTieMesh::CrossTieMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, unsigned int max_segments)
+// Initialise vertex data and buffers.
+CrossTieMesh::CrossTieMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
 {
-	cross_tie_count_ = 0;
-	max_segments_ = max_segments;
-	
 	initBuffers(device);
-
-	device_context_ = deviceContext;
-
-	prev_index_count_ = 0;
-
 }
 
 
@@ -24,17 +16,19 @@ CrossTieMesh::~CrossTieMesh()
 
 //	Each cross tie has faces consisting of:
 //		2 triangles and a rectangle to connect them.
-void CrossTieMesh::AddCrossTie(XMVECTOR centre, XMVECTOR left, XMVECTOR right, XMVECTOR up, XMVECTOR forward)
+void CrossTieMesh::AddCrossTie(std::vector<VertexType>& vertices, std::vector<unsigned long>& indices,
+	XMVECTOR left, XMVECTOR right, XMVECTOR up, XMVECTOR forward)
 {
+	unsigned long base = vertices.size();
 	VertexType vertex0, vertex1, vertex2, vertex3;
 	XMVECTOR btl, btr, bd;
-	btl = centre - forward + left;
-	btr = centre - forward + right;
-	bd = centre - up;
+	btl = left - forward;
+	btr = right - forward;
+	bd = -up;
 	XMVECTOR ftl, ftr, fd;
-	ftl = centre + forward + left;
-	ftr = centre + forward + right;
-	fd = centre - up;
+	ftl = left + forward;
+	ftr = right + forward;
+	fd = -up;
 
 	//	Back face.
 	vertex0.position = XMFLOAT3(XMVectorGetX(btr), XMVectorGetY(btr), XMVectorGetZ(btr));
@@ -49,15 +43,13 @@ void CrossTieMesh::AddCrossTie(XMVECTOR centre, XMVECTOR left, XMVECTOR right, X
 	vertex1.texture = XMFLOAT2(1.0f, 0.0f);
 	vertex2.texture = XMFLOAT2(0.5f, 0.25f);
 	
-	vertices_.push_back(vertex0);
-	vertices_.push_back(vertex1);
-	vertices_.push_back(vertex2);
-	
-	indices_.push_back(0 + (cross_tie_count_ * 3));
-	indices_.push_back(1 + (cross_tie_count_ * 3));
-	indices_.push_back(2 + (cross_tie_count_ * 3));
+	vertices.push_back(vertex0);
+	vertices.push_back(vertex1);
+	vertices.push_back(vertex2);
 	
-	cross_tie_count_++;
+	indices.push_back(base + 0);
+	indices.push_back(base + 1);
+	indices.push_back(base + 2);
 
 
 	//	front face.
@@ -73,15 +65,13 @@ void CrossTieMesh::AddCrossTie(XMVECTOR centre, XMVECTOR left, XMVECTOR right, X
 	vertex1.texture = XMFLOAT2(1.0f, 0.0f);
 	vertex2.texture = XMFLOAT2(0.5f, 0.25f);
 
-	vertices_.push_back(vertex0);
-	vertices_.push_back(vertex1);
-	vertices_.push_back(vertex2);
+	vertices.push_back(vertex0);
+	vertices.push_back(vertex1);
+	vertices.push_back(vertex2);
 
-	indices_.push_back(0 + (cross_tie_count_ * 3));
-	indices_.push_back(1 + (cross_tie_count_ * 3));
-	indices_.push_back(2 + (cross_tie_count_ * 3));
-
-	cross_tie_count_++;
+	indices.push_back(base + 3);
+	indices.push_back(base + 4);
+	indices.push_back(base + 5);
 
 
 
@@ -101,136 +91,64 @@ void CrossTieMesh::AddCrossTie(XMVECTOR centre, XMVECTOR left, XMVECTOR right, X
 	vertex2.texture = XMFLOAT2(0.0f, 0.0f);
 	vertex3.texture = XMFLOAT2(1.0f, 0.0f);
 
-	vertices_.push_back(vertex0);
-	vertices_.push_back(vertex1);
-	vertices_.push_back(vertex2);
-	//vertices_.push_back(vertex3);
+	vertices.push_back(vertex0);
+	vertices.push_back(vertex1);
+	vertices.push_back(vertex2);
+	//vertices.push_back(vertex3);
 
-	indices_.push_back(2 + (cross_tie_count_ * 3));
-	indices_.push_back(1 + (cross_tie_count_ * 3));
-	indices_.push_back(0 + (cross_tie_count_ * 3));
-	cross_tie_count_++;
+	indices.push_back(base + 8);
+	indices.push_back(base + 7);
+	indices.push_back(base + 6);
 	
-	vertices_.push_back(vertex1);
-	vertices_.push_back(vertex2);
-	vertices_.push_back(vertex3);
+	vertices.push_back(vertex1);
+	vertices.push_back(vertex2);
+	vertices.push_back(vertex3);
 
-	indices_.push_back(1 + (cross_tie_count_ * 3));
-	indices_.push_back(2 + (cross_tie_count_ * 3));
-	indices_.push_back(0 + (cross_tie_count_ * 3));
+	indices.push_back(base + 10);
+	indices.push_back(base + 11);
+	indices.push_back(base + 9);
 
-	
-	cross_tie_count_++;
 }
 
+//	Build the one tie and put it in static buffers, as it never changes.
 void CrossTieMesh::initBuffers(ID3D11Device* device)
 {
-	VertexType* vertices;
-	unsigned long* indices;
+	std::vector<VertexType> tie_vertices;
+	std::vector<unsigned long> tie_indices;
+	AddCrossTie(tie_vertices, tie_indices, XMVectorSet(-tie_half_width, 0.0f, 0.0f, 0.0f), XMVectorSet(tie_half_width, 0.0f, 0.0f, 0.0f),
+		XMVectorSet(0.0f, tie_depth, 0.0f, 0.0f), XMVectorSet(0.0f, 0.0f, tie_half_thickness, 0.0f));
+
 	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
 	D3D11_SUBRESOURCE_DATA vertexData, indexData;
 
-	
-	//	12 vertices/indices per cross tie, 15 cross ties per segment.
-	vertexCount = 15 * 12 * max_segments_;
-	indexCount = vertexCount;
-
-	// Create the vertex and index array.
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
+	vertexCount = tie_vertices.size();
+	indexCount = tie_indices.size();
 
 	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
 	vertexBufferDesc.ByteWidth = sizeof(VertexType) * vertexCount;
 	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	vertexBufferDesc.CPUAccessFlags = 0;
 	vertexBufferDesc.MiscFlags = 0;
 	vertexBufferDesc.StructureByteStride = 0;
 	// Give the subresource structure a pointer to the vertex data.
-	vertexData.pSysMem = vertices;
+	vertexData.pSysMem = &tie_vertices[0];
 	vertexData.SysMemPitch = 0;
 	vertexData.SysMemSlicePitch = 0;
 	// Now create the vertex buffer.
 	device->CreateBuffer(&vertexBufferDesc, &vertexData, &vertexBuffer);
 
 	// Set up the description of the static index buffer.
-	indexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
 	indexBufferDesc.ByteWidth = sizeof(unsigned long) * indexCount;
 	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	indexBufferDesc.CPUAccessFlags = 0;
 	indexBufferDesc.MiscFlags = 0;
 	indexBufferDesc.StructureByteStride = 0;
 	// Give the subresource structure a pointer to the index data.
-	indexData.pSysMem = indices;
+	indexData.pSysMem = &tie_indices[0];
 	indexData.SysMemPitch = 0;
 	indexData.SysMemSlicePitch = 0;
 	// Create the index buffer.
 	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-
-	delete[] indices;
-	indices = 0;
-}
-
-void CrossTieMesh::Update()
-{
-	if (vertices_.empty())
-	{
-		return;
-	}
-
-	//	Update the vertex buffer.
-	D3D11_MAPPED_SUBRESOURCE vertex_mapped_resource;
-	ZeroMemory(&vertex_mapped_resource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-	device_context_->Map(vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &vertex_mapped_resource);
-	memcpy(vertex_mapped_resource.pData, &vertices_[0], sizeof(VertexType) * vertices_.size());
-	device_context_->Unmap(vertexBuffer, 0);
-
-	//	Update the index buffer.
-	if (indices_.size() < prev_index_count_)
-	{
-		//	The number of vertices has been reduced since the last update. 
-		//		So write over the indices for the vertices 'ahead'.
-		for (int k = indices_.size(); k < prev_index_count_; k++)
-		{
-			indices_.push_back(-1);
-		}
-	}
-
-	prev_index_count_ = indices_.size();
-
-	D3D11_MAPPED_SUBRESOURCE index_mapped_resource;
-	ZeroMemory(&index_mapped_resource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-	device_context_->Map(indexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &index_mapped_resource);
-	memcpy(index_mapped_resource.pData, &indices_[0], sizeof(unsigned long int) * indices_.size());
-	device_context_->Unmap(indexBuffer, 0);
-
-	vertices_.clear();
-	indices_.clear();
-	cross_tie_count_ = 0;
-}
-
-void CrossTieMesh::Clear()
-{
-	//	Update the index buffer.
-	D3D11_MAPPED_SUBRESOURCE index_mapped_resource;
-	ZeroMemory(&index_mapped_resource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-	
-	std::vector<unsigned long> indices;
-	for (int i = 0; i < indexCount; i++)
-	{
-		indices.push_back(-1);
-	}
-
-	device_context_->Map(indexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &index_mapped_resource);
-	memcpy(index_mapped_resource.pData, &indices[0], sizeof(unsigned long) * indexCount);
-	device_context_->Unmap(indexBuffer, 0);
-
-	prev_index_count_ = 0;
-
 }
@@ -2,28 +2,36 @@
 
 #include "../DXFramework/BaseMesh.h"
 #include <vector>
+#include <cmath>
 
 using namespace DirectX;
 
+//	A single cross tie, shared by every tie along the track.
+//		The tie is built in its own space, with x to the right, y up and z along the track, and is put in place
+//			by each instance, see TrackGeometry::CrossTie.
 class CrossTieMesh : public BaseMesh
 {
 
 public:
-	CrossTieMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, unsigned int max_segments);
-	void Update();
-	void AddCrossTie(XMVECTOR centre, XMVECTOR left, XMVECTOR right, XMVECTOR up, XMVECTOR forward);
-	void Clear();
+	using BaseMesh::VertexType;
+
+	CrossTieMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext);
 	~CrossTieMesh();
 
+	//	How far any corner of the tie is from its centre, for bounding ties without building them.
+	//		Defined here so the track can be baked without the mesh.
+	static inline float GetReach() { return sqrtf(tie_half_width * tie_half_width + tie_depth * tie_depth + tie_half_thickness * tie_half_thickness); }
+
 protected:
 	void initBuffers(ID3D11Device* device);
 	int resolution;
 
 private:
-	std::vector<VertexType> vertices_;
-	std::vector<unsigned long int> indices_;
-	unsigned int cross_tie_count_;
-	unsigned int prev_index_count_;
-	ID3D11DeviceContext* device_context_;
-	unsigned int max_segments_;
+	//	Half the width, the depth and half the thickness of a tie.
+	static constexpr float tie_half_width = 0.35f;
+	static constexpr float tie_depth = 0.25f;
+	static constexpr float tie_half_thickness = 0.05f;
+
+	static void AddCrossTie(std::vector<VertexType>& vertices, std::vector<unsigned long>& indices,
+		XMVECTOR left, XMVECTOR right, XMVECTOR up, XMVECTOR forward);
 };
@@ -0,0 +1,72 @@
+#include "D3D11BufferBackend.h"
+
+#include <cstring>
+
+D3D11BufferBackend::D3D11BufferBackend(ID3D11Device* device, ID3D11DeviceContext* device_context) :
+	device_(device), device_context_(device_context)
+{
+}
+
+void* D3D11BufferBackend::CreateBuffer(unsigned int byte_width, bool index_buffer)
+{
+	D3D11_BUFFER_DESC buffer_desc;
+	buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+	buffer_desc.ByteWidth = byte_width;
+	buffer_desc.BindFlags = index_buffer ? D3D11_BIND_INDEX_BUFFER : D3D11_BIND_VERTEX_BUFFER;
+	buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	buffer_desc.MiscFlags = 0;
+	buffer_desc.StructureByteStride = 0;
+
+	ID3D11Buffer* buffer = nullptr;
+	if (FAILED(device_->CreateBuffer(&buffer_desc, nullptr, &buffer)))
+	{
+		return nullptr;
+	}
+
+	return buffer;
+}
+
+//	Discarding hands back fresh memory, so the whole of the data that is needed has to be written.
+//		Writing without discarding doesn't wait for the GPU, so is only safe for regions it has finished with
+//		or where drawing the old contents for one more frame doesn't matter.
+void D3D11BufferBackend::WriteBuffer(void* buffer, unsigned int byte_offset, const void* data, unsigned int byte_count, bool discard)
+{
+	void* mapped = MapBuffer(buffer, discard);
+	if (!mapped)
+	{
+		return;
+	}
+
+	memcpy(static_cast<char*>(mapped) + byte_offset, data, byte_count);
+	UnmapBuffer(buffer);
+}
+
+//	The same rules as writing apply to whatever is written through the mapping.
+void* D3D11BufferBackend::MapBuffer(void* buffer, bool discard)
+{
+	ID3D11Buffer* d3d_buffer = static_cast<ID3D11Buffer*>(buffer);
+
+	D3D11_MAPPED_SUBRESOURCE mapped_resource;
+	ZeroMemory(&mapped_resource, sizeof(D3D11_MAPPED_SUBRESOURCE));
+
+	if (FAILED(device_context_->Map(d3d_buffer, 0, discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped_resource)))
+	{
+		return nullptr;
+	}
+
+	return mapped_resource.pData;
+}
+
+void D3D11BufferBackend::UnmapBuffer(void* buffer)
+{
+	device_context_->Unmap(static_cast<ID3D11Buffer*>(buffer), 0);
+}
+
+void D3D11BufferBackend::ReleaseBuffer(void* buffer)
+{
+	static_cast<ID3D11Buffer*>(buffer)->Release();
+}
+
+D3D11BufferBackend::~D3D11BufferBackend()
+{
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "PagedBuffer.h"
+#include <d3d11.h>
+
+//	Dynamic D3D11 vertex and index buffers, written by mapping them from the CPU.
+class D3D11BufferBackend : public BufferBackend
+{
+public:
+	D3D11BufferBackend(ID3D11Device* device, ID3D11DeviceContext* device_context);
+	void* CreateBuffer(unsigned int byte_width, bool index_buffer);
+	void WriteBuffer(void* buffer, unsigned int byte_offset, const void* data, unsigned int byte_count, bool discard);
+	void* MapBuffer(void* buffer, bool discard);
+	void UnmapBuffer(void* buffer);
+	void ReleaseBuffer(void* buffer);
+	~D3D11BufferBackend();
+
+private:
+	ID3D11Device* device_;
+	ID3D11DeviceContext* device_context_;
+};
@@ -0,0 +1,78 @@
+#include "D3D11RenderBackend.h"
+#include "SceneShader.h"
+#include "../DXFramework/BaseMesh.h"
+
+D3D11RenderBackend::D3D11RenderBackend(ID3D11Device* device, ID3D11DeviceContext* device_context) :
+	device_context_(device_context), frame_buffer_(nullptr), shader_(nullptr)
+{
+	D3D11_BUFFER_DESC frame_buffer_desc;
+	frame_buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+	frame_buffer_desc.ByteWidth = sizeof(SceneShader::FrameBufferType);
+	frame_buffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	frame_buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	frame_buffer_desc.MiscFlags = 0;
+	frame_buffer_desc.StructureByteStride = 0;
+	device->CreateBuffer(&frame_buffer_desc, NULL, &frame_buffer_);
+}
+
+//	Write the view and projection once, for every draw of the frame.
+void D3D11RenderBackend::SetFrame(const XMMATRIX& view, const XMMATRIX& projection)
+{
+	D3D11_MAPPED_SUBRESOURCE mapped_resource;
+	if (FAILED(device_context_->Map(frame_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource)))
+	{
+		return;
+	}
+
+	SceneShader::FrameBufferType* frame = static_cast<SceneShader::FrameBufferType*>(mapped_resource.pData);
+	frame->view = XMMatrixTranspose(view);
+	frame->projection = XMMatrixTranspose(projection);
+	device_context_->Unmap(frame_buffer_, 0);
+
+	device_context_->VSSetConstantBuffers(1, 1, &frame_buffer_);
+	shader_ = nullptr;
+}
+
+void D3D11RenderBackend::SetShader(SceneShader* shader)
+{
+	shader->Bind(device_context_);
+	shader_ = shader;
+}
+
+void D3D11RenderBackend::SetTexture(ID3D11ShaderResourceView* texture)
+{
+	device_context_->PSSetShaderResources(0, 1, &texture);
+}
+
+void D3D11RenderBackend::SetMesh(BaseMesh* mesh, const PackedVertex::Quantisation* quantisation)
+{
+	mesh->sendData(device_context_);
+	shader_->SetMeshParameters(device_context_, quantisation);
+}
+
+//	Set the world matrix and colour of the draw, then draw the mesh once, or once for every instance.
+void D3D11RenderBackend::Draw(const DrawItem& item)
+{
+	shader_->SetColour(item.colour.x, item.colour.y, item.colour.z);
+	shader_->SetObjectParameters(device_context_, XMLoadFloat4x4(&item.world));
+
+	if (item.instance_buffer)
+	{
+		unsigned int offset = 0;
+		device_context_->IASetVertexBuffers(1, 1, &item.instance_buffer, &item.instance_stride, &offset);
+		device_context_->DrawIndexedInstanced(item.index_count, item.instance_count, 0, 0, 0);
+	}
+	else
+	{
+		device_context_->DrawIndexed(item.index_count, 0, 0);
+	}
+}
+
+D3D11RenderBackend::~D3D11RenderBackend()
+{
+	if (frame_buffer_)
+	{
+		frame_buffer_->Release();
+		frame_buffer_ = nullptr;
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "RenderQueue.h"
+#include <d3d11.h>
+
+//	Draws the RenderQueue's draws with D3D11. Owns the constant buffer holding the frame's view and projection,
+//		which every SceneShader reads from slot b1.
+class D3D11RenderBackend : public RenderBackend
+{
+public:
+	D3D11RenderBackend(ID3D11Device* device, ID3D11DeviceContext* device_context);
+	void SetFrame(const XMMATRIX& view, const XMMATRIX& projection);
+	void SetShader(SceneShader* shader);
+	void SetTexture(ID3D11ShaderResourceView* texture);
+	void SetMesh(BaseMesh* mesh, const PackedVertex::Quantisation* quantisation);
+	void Draw(const DrawItem& item);
+	~D3D11RenderBackend();
+
+private:
+	ID3D11DeviceContext* device_context_;
+	ID3D11Buffer* frame_buffer_;
+	SceneShader* shader_;
+};
@@ -2,8 +2,9 @@
 #include "defaultshader.h"
 
 
-DefaultShader::DefaultShader(ID3D11Device* device, HWND hwnd) : BaseShader(device, hwnd)
+DefaultShader::DefaultShader(ID3D11Device* device, HWND hwnd) : SceneShader(device, hwnd)
 {
+	texture_ = nullptr;
 	initShader(L"default_vs.cso", L"default_ps.cso");
 }
 
@@ -24,10 +25,10 @@ DefaultShader::~DefaultShader()
 		layout = 0;
 	}
 
-	if (sample_state_)
+	if (sampleState)
 	{
-		sample_state_->Release();
-		sample_state_ = 0;
+		sampleState->Release();
+		sampleState = 0;
 	}
 
 	//Release base shader components
@@ -54,7 +55,7 @@ void DefaultShader::initShader(WCHAR* vsFilename, WCHAR* psFilename)
 
 	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
 	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
+	matrixBufferDesc.ByteWidth = sizeof(ObjectBufferType);
 	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
 	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	matrixBufferDesc.MiscFlags = 0;
@@ -79,45 +80,19 @@ void DefaultShader::initShader(WCHAR* vsFilename, WCHAR* psFilename)
 	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
 
 	// Create the texture sampler state.
-	renderer->CreateSamplerState(&samplerDesc, &sample_state_);
+	renderer->CreateSamplerState(&samplerDesc, &sampleState);
 }
 
-void DefaultShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix)
+//	Set what changes with each draw. The view and projection are already in the frame buffer.
+void DefaultShader::SetObjectParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& worldMatrix)
 {
-	HRESULT result;
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	MatrixBufferType* dataPtr;
-	unsigned int bufferNumber;
-	XMMATRIX tworld, tview, tproj;
-
-	// Transpose the matrices to prepare them for the shader.
-	tworld = XMMatrixTranspose(worldMatrix);
-	tview = XMMatrixTranspose(viewMatrix);
-	tproj = XMMatrixTranspose(projectionMatrix);
+	ObjectBufferType* dataPtr;
 
 	// Lock the constant buffer so it can be written to.
-	result = deviceContext->Map(matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-
-	// Get a pointer to the data in the constant buffer.
-	dataPtr = (MatrixBufferType*)mappedResource.pData;
-
-	// Copy the matrices into the constant buffer.
-	dataPtr->world = tworld;// worldMatrix;
-	dataPtr->view = tview;
-	dataPtr->projection = tproj;
-
-	// Unlock the constant buffer.
+	deviceContext->Map(matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	dataPtr = (ObjectBufferType*)mappedResource.pData;
+	dataPtr->world = XMMatrixTranspose(worldMatrix);
 	deviceContext->Unmap(matrixBuffer, 0);
-
-	// Set the position of the constant buffer in the vertex shader.
-	bufferNumber = 0;
-
-	// Now set the constant buffer in the vertex shader with the updated values.
-	deviceContext->VSSetConstantBuffers(bufferNumber, 1, &matrixBuffer);
-
-	deviceContext->PSSetShaderResources(0, 1, &texture_);
+	deviceContext->VSSetConstantBuffers(0, 1, &matrixBuffer);
 }
-
-
-
-
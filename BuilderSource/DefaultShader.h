@@ -1,13 +1,14 @@
 #ifndef _DEFAULTSHADER_H_
 #define _DEFAULTSHADER_H_
 
-#include "../DXFramework/BaseShader.h"
+#include "SceneShader.h"
 
 using namespace std;
 using namespace DirectX;
 
 
-class DefaultShader : public BaseShader
+//	Draws each vertex in the colour kept in its normal, unlit. Used for the lines of the reference frame.
+class DefaultShader : public SceneShader
 {
 
 public:
@@ -15,14 +16,13 @@ public:
 	~DefaultShader();
 	void SetTexture(ID3D11ShaderResourceView* texture);
 	void SetColour(float r, float g, float b);
-	virtual void SetShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& world, const XMMATRIX& view, const XMMATRIX& projection);
+	void SetObjectParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& world);
 
 private:
 	void initShader(WCHAR*, WCHAR*);
 
 private:
 	ID3D11Buffer* matrixBuffer;
-	ID3D11SamplerState* sample_state_;
 	ID3D11ShaderResourceView* texture_;
 
 };
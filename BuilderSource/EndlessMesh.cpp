@@ -0,0 +1,151 @@
+#include "EndlessMesh.h"
+#include "EndlessRide.h"
+#include <cassert>
+
+namespace
+{
+	//	Must match the rails built by the TrackGeometry.
+	const float rail_radius[3] = { 0.06f, 0.06f, 0.26f };
+	const unsigned int rail_slices[3] = { 10, 10, 6 };
+}
+
+EndlessMesh::EndlessMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, SceneShader* shader, InstancedShader* cross_tie_shader, int slot_count)
+	: slot_count_(slot_count)
+{
+	const unsigned int circle_count = TrackGeometry::GetFramesPerPiece() + 1;
+	slot_cross_ties_ = TrackGeometry::GetFramesPerPiece() / TrackGeometry::GetCrossTieFrequency();
+
+	std::vector<unsigned long> slot_indices;
+	std::vector<unsigned long> indices;
+
+	//	Every slot has a fixed region of the buffers, so every piece needs the same rings.
+	geometry_.SetAdaptive(false);
+
+	//	Every slot's rails are joined up the same way, just offset to the slot's own vertices.
+	for (int i = 0; i < 3; i++)
+	{
+		PipeMesh* rail_mesh = new PipeMesh(device, deviceContext, rail_radius[i], rail_slices[i]);
+		rail_meshes_.push_back(rail_mesh);
+
+		slot_indices.clear();
+		ProfileExtruder::CalculateIndices(circle_count, rail_slices[i], slot_indices);
+
+		unsigned long slot_vertices = circle_count * (rail_slices[i] + 1);
+		rail_mesh->Reserve(slot_count_ * slot_vertices);
+		indices.clear();
+		for (int slot = 0; slot < slot_count_; slot++)
+		{
+			for (int j = 0; j < slot_indices.size(); j++)
+			{
+				indices.push_back(slot_indices[j] + slot * slot_vertices);
+			}
+		}
+		rail_mesh->SetIndices(indices);
+	}
+
+	//	Every slot places the same number of cross ties.
+	cross_tie_mesh_ = new CrossTieMesh(device, deviceContext);
+	cross_ties_ = new InstancedMeshInstance(device, deviceContext, cross_tie_shader, cross_tie_mesh_, sizeof(TrackGeometry::CrossTie), slot_cross_ties_);
+	cross_ties_->Reserve(slot_count_ * slot_cross_ties_);
+
+	MeshInstance* rail = new MeshInstance(nullptr, shader, rail_meshes_[0]);
+	rail->SetColour(XMFLOAT4(0.46f, 0.62f, 0.8f, 0.0f));
+	instances_.push_back(rail);
+	rail = new MeshInstance(nullptr, shader, rail_meshes_[1]);
+	rail->SetColour(XMFLOAT4(0.46f, 0.62f, 0.8f, 0.0f));
+	instances_.push_back(rail);
+	rail = new MeshInstance(nullptr, shader, rail_meshes_[2]);
+	rail->SetColour(XMFLOAT4(0.3f, 0.3f, 0.3f, 0.0f));
+	instances_.push_back(rail);
+
+	cross_ties_->SetColour(XMFLOAT4(0.2f, 0.2f, 0.2f, 0.0f));
+	instances_.push_back(cross_ties_);
+}
+
+//	Rewrite the slots that have been given new pieces since the last upload.
+void EndlessMesh::Upload(EndlessRide* ride)
+{
+	const std::vector<int>& changed_slots = ride->GetChangedSlots();
+
+	for (int i = 0; i < changed_slots.size(); i++)
+	{
+		int slot = changed_slots[i];
+		if (slot >= slot_count_)
+		{
+			continue;
+		}
+
+		ride->BakeSlot(slot, &geometry_);
+
+		for (int j = 0; j < 3; j++)
+		{
+			const TrackGeometry::MeshData& rail = geometry_.GetPart(static_cast<TrackGeometry::Part>(j));
+			rail_meshes_[j]->UploadRegion(slot * rail.vertices.size(), rail.vertices);
+		}
+
+		//	Every slot is baked with the same frames, so a different number of ties would overrun its neighbours.
+		const std::vector<TrackGeometry::CrossTie>& cross_ties = geometry_.GetCrossTies();
+		assert(cross_ties.size() == slot_cross_ties_);
+		cross_ties_->UploadRegion(slot * slot_cross_ties_, &cross_ties[0], slot_cross_ties_);
+	}
+
+	ride->ClearChangedSlots();
+}
+
+std::vector<MeshInstance*> EndlessMesh::GetMeshInstances()
+{
+	return instances_;
+}
+
+void EndlessMesh::SetVisible(bool visible)
+{
+	for (int i = 0; i < instances_.size(); i++)
+	{
+		instances_[i]->SetRender(visible);
+	}
+}
+
+void EndlessMesh::SetTextures(ID3D11ShaderResourceView* small_rail, ID3D11ShaderResourceView* large_rail, ID3D11ShaderResourceView* cross_tie)
+{
+	instances_[0]->SetTexture(small_rail);
+	instances_[1]->SetTexture(small_rail);
+	instances_[2]->SetTexture(large_rail);
+	instances_[3]->SetTexture(cross_tie);
+}
+
+XMMATRIX EndlessMesh::GetWorldMatrix()
+{
+	return instances_[0]->GetWorldMatrix();
+}
+
+EndlessMesh::~EndlessMesh()
+{
+	for (int i = 0; i < instances_.size(); i++)
+	{
+		if (instances_[i])
+		{
+			delete instances_[i];
+			instances_[i] = 0;
+		}
+	}
+	instances_.clear();
+
+	for (int i = 0; i < rail_meshes_.size(); i++)
+	{
+		if (rail_meshes_[i])
+		{
+			delete rail_meshes_[i];
+			rail_meshes_[i] = 0;
+		}
+	}
+	rail_meshes_.clear();
+
+	//	The cross ties were deleted with the rest of the instances.
+	cross_ties_ = 0;
+
+	if (cross_tie_mesh_)
+	{
+		delete cross_tie_mesh_;
+		cross_tie_mesh_ = 0;
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "PipeMesh.h"
+#include "CrossTieMesh.h"
+#include "MeshInstance.h"
+#include "InstancedMeshInstance.h"
+#include "TrackGeometry.h"
+#include <vector>
+
+class EndlessRide;
+
+//	Mesh for the endless ride. Each slot of the ride owns a fixed region of every buffer, and the indices
+//		never change, so a new piece only rewrites the vertices and cross ties of its own slot.
+class EndlessMesh
+{
+public:
+	EndlessMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, SceneShader* shader, InstancedShader* cross_tie_shader, int slot_count);
+	void Upload(EndlessRide* ride);
+	std::vector<MeshInstance*> GetMeshInstances();
+	void SetVisible(bool visible);
+	void SetTextures(ID3D11ShaderResourceView* small_rail, ID3D11ShaderResourceView* large_rail, ID3D11ShaderResourceView* cross_tie);
+	XMMATRIX GetWorldMatrix();
+	~EndlessMesh();
+
+private:
+	std::vector<PipeMesh*> rail_meshes_;
+	CrossTieMesh* cross_tie_mesh_;
+	InstancedMeshInstance* cross_ties_;
+	unsigned int slot_cross_ties_;
+	std::vector<MeshInstance*> instances_;
+	TrackGeometry geometry_;
+	int slot_count_;
+};
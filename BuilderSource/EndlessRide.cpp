@@ -0,0 +1,378 @@
+#include "EndlessRide.h"
+
+#include "TrackGeometry.h"
+#include "../Spline-Library/matrix3x3.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	//	Half the width of the grid the ride stays inside, and the highest level it climbs to, in 10 metre cells.
+	const int footprint = 8;
+	const int max_height = 3;
+
+	//	Pieces kept behind the train, so the retired piece is always well out of sight of the front seat.
+	const int pieces_behind = 2;
+
+	//	Speed at the highest point of the ride, in metres per second. It speeds up as it drops from there.
+	const float min_speed = 6.0f;
+
+	//	Pieces the ride looks ahead when choosing the next one.
+	const int lookahead = 4;
+}
+
+EndlessRide::EndlessRide(int slot_count, int resolution) : resolution_(resolution), scratch_(1 << 14)
+{
+	const int frame_count = TrackGeometry::GetFramesPerPiece() + 1;
+
+	slots_.resize(std::max(slot_count, pieces_behind + 4));
+	for (int i = 0; i < slots_.size(); i++)
+	{
+		slots_[i].arc_table.resize(resolution_ + 1);
+		slots_[i].frames.resize(frame_count);
+		slots_[i].length = 0.0f;
+		slots_[i].piece_number = 0;
+	}
+	changed_slots_.reserve(slots_.size());
+
+	grid_.Resize(footprint, max_height);
+
+	//	Copy the shape of each stock piece, so new pieces can be placed without creating any track pieces.
+	for (int i = 0; i < TrackGrid::stock_count; i++)
+	{
+		TrackPiece* track_piece = TrackPiece::CreateStockPiece(TrackGrid::stock_tags[i]);
+
+		for (int j = 0; j < 4; j++)
+		{
+			stock_points_[i][j] = track_piece->GetControlPoint(j);
+		}
+		stock_tensions_[i] = track_piece->GetTension();
+
+		delete track_piece->GetSpline();
+		delete track_piece;
+	}
+
+	head_ = 0;
+	count_ = 0;
+	current_ = 0;
+	distance_ = 0.0f;
+	speed_ = min_speed;
+	pieces_travelled_ = 0;
+	pieces_laid_ = 0;
+	roll_ = 0.0f;
+	roll_target_ = 0.0f;
+	up_ = DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f);
+}
+
+//	Start a new ride from the origin, filling the whole ring with track.
+void EndlessRide::Reset(unsigned int seed)
+{
+	random_.seed(seed);
+	grid_.Clear();
+
+	end_.x = 0;
+	end_.y = 0;
+	end_.z = 0;
+	end_.heading = 0;
+	tail_ = end_;
+	grid_.Occupy(end_);
+
+	head_ = 0;
+	count_ = 0;
+	current_ = 0;
+	distance_ = 0.0f;
+	speed_ = min_speed;
+	pieces_travelled_ = 0;
+	pieces_laid_ = 0;
+	roll_ = 0.0f;
+	roll_target_ = 0.0f;
+	up_ = DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f);
+
+	changed_slots_.clear();
+	while (count_ < slots_.size())
+	{
+		AddPiece();
+	}
+}
+
+//	Move the train along, then swap pieces it has left behind for new ones in front.
+void EndlessRide::Update(float delta_time)
+{
+	if (count_ == 0)
+	{
+		return;
+	}
+
+	//	A stalled frame would otherwise lay a whole ring of track at once.
+	delta_time = std::min(delta_time, 0.25f);
+
+	DirectX::XMVECTOR position, forward, up;
+	GetFrame(position, forward, up);
+
+	float drop = (max_height * 10.0f) - DirectX::XMVectorGetY(position);
+	speed_ = sqrtf(min_speed * min_speed + 2.0f * 9.81f * std::max(0.0f, drop));
+	distance_ += speed_ * delta_time;
+
+	while ((distance_ >= slots_[GetSlot(current_)].length) && (current_ < count_ - 1))
+	{
+		distance_ -= slots_[GetSlot(current_)].length;
+		current_++;
+		pieces_travelled_++;
+	}
+
+	while (current_ > pieces_behind)
+	{
+		//	The oldest slot is reused for the new piece at the front. Where it ends is where the ring now starts, so stays marked.
+		Cell corner;
+		if (grid_.GetCorner(tail_, slots_[head_].tag, corner))
+		{
+			grid_.Vacate(corner);
+		}
+		grid_.Vacate(tail_);
+		tail_ = slots_[head_].end;
+		head_ = (head_ + 1) % slots_.size();
+		count_--;
+		current_--;
+
+		AddPiece();
+	}
+}
+
+//	Frame of the train, found between the two nearest stored frames of the piece it is on.
+void EndlessRide::GetFrame(DirectX::XMVECTOR& position, DirectX::XMVECTOR& forward, DirectX::XMVECTOR& up)
+{
+	const Slot& slot = slots_[GetSlot(current_)];
+	const int frame_count = TrackGeometry::GetFramesPerPiece();
+
+	float f = (slot.length > 0.0f) ? (distance_ / slot.length) * frame_count : 0.0f;
+	f = std::max(0.0f, std::min(f, (float)frame_count));
+
+	int k = std::min((int)f, frame_count - 1);
+	float s = f - k;
+
+	const Frame& a = slot.frames[k];
+	const Frame& b = slot.frames[k + 1];
+
+	position = DirectX::XMVectorLerp(DirectX::XMLoadFloat3(&a.point), DirectX::XMLoadFloat3(&b.point), s);
+	forward = DirectX::XMVector3Normalize(DirectX::XMVectorLerp(DirectX::XMLoadFloat3(&a.forward), DirectX::XMLoadFloat3(&b.forward), s));
+	up = DirectX::XMVector3Normalize(DirectX::XMVectorLerp(DirectX::XMLoadFloat3(&a.up), DirectX::XMLoadFloat3(&b.up), s));
+}
+
+//	Build the rails and cross ties of one slot from its stored frames.
+//		Every slot has the same number of frames and cross ties, so it always fills the same region of the mesh.
+void EndlessRide::BakeSlot(int slot_index, TrackGeometry* geometry)
+{
+	const Slot& slot = slots_[slot_index];
+	const int frame_count = TrackGeometry::GetFramesPerPiece();
+
+	geometry->Clear();
+	geometry->SetTextureFrame((slot.piece_number * frame_count) % 8);
+	geometry->BeginPiece(frame_count);
+
+	for (int k = 0; k <= frame_count; k++)
+	{
+		const Frame& frame = slot.frames[k];
+		DirectX::XMVECTOR centre = DirectX::XMLoadFloat3(&frame.point);
+		DirectX::XMVECTOR x = DirectX::XMLoadFloat3(&frame.right);
+		DirectX::XMVECTOR y = DirectX::XMLoadFloat3(&frame.up);
+		DirectX::XMVECTOR z = DirectX::XMLoadFloat3(&frame.forward);
+
+		geometry->AddFrame(centre, x, y, z);
+		if ((k < frame_count) && (k % TrackGeometry::GetCrossTieFrequency() == 0))
+		{
+			geometry->AddCrossTie(centre, x, y, z);
+		}
+	}
+
+	scratch_.Reset();
+	geometry->Finalise(scratch_);
+}
+
+//	Lay a new piece at the front of the track, in the slot after the newest.
+void EndlessRide::AddPiece()
+{
+	Slot& slot = slots_[GetSlot(count_)];
+	Cell start = end_;
+
+	slot.tag = ChoosePiece(slot.end);
+	slot.piece_number = pieces_laid_++;
+	grid_.Occupy(start, slot.tag, slot.end);
+	end_ = slot.end;
+
+	//	Bank into the turns and level out everywhere else.
+	float start_roll = roll_target_;
+	roll_target_ = 0.0f;
+	if (slot.tag == TrackPiece::Tag::RIGHT_TURN)
+	{
+		roll_target_ = -45.0f;
+	}
+	else if (slot.tag == TrackPiece::Tag::LEFT_TURN)
+	{
+		roll_target_ = 45.0f;
+	}
+
+	BuildSpline(slot, start);
+	SimulateSlot(slot, start_roll, roll_target_);
+
+	if (std::find(changed_slots_.begin(), changed_slots_.end(), GetSlot(count_)) == changed_slots_.end())
+	{
+		changed_slots_.push_back(GetSlot(count_));
+	}
+	count_++;
+}
+
+//	Pick a piece that stays inside the footprint and leaves somewhere to go next, in proportion to the weights.
+//		Only the pieces still in the ring count as track, so the ride is free to cross where it has been before.
+TrackPiece::Tag EndlessRide::ChoosePiece(Cell& end)
+{
+	Cell moves[TrackGrid::stock_count];
+	int weights[TrackGrid::stock_count];
+	int total_weight = 0;
+
+	//	Looking a few pieces ahead keeps the ride out of dead ends. If it does box itself in, it has to cross its own track.
+	for (int pass = 0; (pass < 2) && (total_weight == 0); pass++)
+	{
+		bool ignore_track = (pass == 1);
+		for (int k = 0; k < TrackGrid::stock_count; k++)
+		{
+			bool valid = false;
+			if (!ignore_track)
+			{
+				valid = grid_.CanMove(end_, TrackGrid::stock_tags[k], moves[k]) && grid_.HasMove(moves[k], lookahead, false);
+			}
+			else
+			{
+				valid = grid_.Move(end_, TrackGrid::stock_tags[k], moves[k]) && grid_.HasMove(moves[k], 1, true);
+			}
+
+			weights[k] = valid ? TrackGrid::stock_weights[k] : 0;
+			total_weight += weights[k];
+		}
+	}
+
+	//	Every piece the ride has chosen can be followed by one inside the footprint, so there is always a move.
+	int value = std::uniform_int_distribution<int>(0, std::max(0, total_weight - 1))(random_);
+	int choice = 0;
+	while ((choice < TrackGrid::stock_count - 1) && (value >= weights[choice]))
+	{
+		value -= weights[choice];
+		choice++;
+	}
+
+	end = moves[choice];
+	return TrackGrid::stock_tags[choice];
+}
+
+//	Turn the stock piece to face the heading it starts on and move it to the start cell.
+void EndlessRide::BuildSpline(Slot& slot, const Cell& start)
+{
+	const float heading_cos[4] = { 1.0f, 0.0f, -1.0f, 0.0f };
+	const float heading_sin[4] = { 0.0f, 1.0f, 0.0f, -1.0f };
+
+	int tag_index = static_cast<int>(slot.tag);
+	float c = heading_cos[start.heading];
+	float s = heading_sin[start.heading];
+
+	SL::Vector points[4];
+	for (int i = 0; i < 4; i++)
+	{
+		SL::Vector local = stock_points_[tag_index][i];
+		points[i].Set((local.X() * c) + (local.Z() * s) + (start.x * 10.0f),
+			local.Y() + (start.y * 10.0f),
+			(local.Z() * c) - (local.X() * s) + (start.z * 10.0f));
+	}
+
+	slot.spline.SetControlPoints(points[0], points[1], points[2], points[3]);
+	slot.spline.CalculateCoefficients(stock_tensions_[tag_index]);
+
+	//	Measure the piece, so the frames can be spaced evenly along it.
+	const float increment = 1.0f / resolution_;
+	SL::Vector previous_point = slot.spline.GetPoint(0.0f);
+	float length = 0.0f;
+	slot.arc_table[0] = 0.0f;
+
+	for (int i = 1; i <= resolution_; i++)
+	{
+		SL::Vector point = slot.spline.GetPoint(i * increment);
+		length += point.Subtract(previous_point).GetLength();
+		slot.arc_table[i] = length;
+		previous_point = point;
+	}
+
+	slot.length = length;
+}
+
+//	Carry the frame along the new piece the same way the Track simulates it, storing a frame at each even step.
+//		The last frame is where the next piece starts.
+void EndlessRide::SimulateSlot(Slot& slot, float start_roll, float roll_target)
+{
+	const int frame_count = TrackGeometry::GetFramesPerPiece();
+
+	SL::Vector up(up_.x, up_.y, up_.z);
+
+	for (int k = 0; k <= frame_count; k++)
+	{
+		float t = FindLocalTime(slot, slot.length * k / frame_count);
+
+		SL::Vector forward = slot.spline.GetTangent(t);
+		SL::Vector right = up.Cross(forward).Normalised();
+		up = forward.Cross(right).Normalised();
+
+		float target_roll = ((1.0f - t) * start_roll + t * roll_target) * 0.0174533f;
+		float angle_needed = target_roll - roll_;
+		if (angle_needed != 0.0f)
+		{
+			SL::Matrix3x3 roll_matrix;
+			roll_matrix.RotationAxisAngle(forward, angle_needed);
+			up = roll_matrix.TransformVector(up);
+			right = up.Cross(forward);
+			roll_ = target_roll;
+		}
+
+		SL::Vector point = slot.spline.GetPoint(t);
+
+		Frame& frame = slot.frames[k];
+		frame.point = DirectX::XMFLOAT3(point.X(), point.Y(), point.Z());
+		frame.forward = DirectX::XMFLOAT3(forward.X(), forward.Y(), forward.Z());
+		frame.up = DirectX::XMFLOAT3(up.X(), up.Y(), up.Z());
+		frame.right = DirectX::XMFLOAT3(right.X(), right.Y(), right.Z());
+	}
+
+	up_ = DirectX::XMFLOAT3(up.X(), up.Y(), up.Z());
+}
+
+//	Local t at which the piece has covered 'length'. Binary search of the slot's table.
+float EndlessRide::FindLocalTime(const Slot& slot, float length)
+{
+	const std::vector<float>& table = slot.arc_table;
+
+	int left = 0;
+	int right = resolution_;
+
+	while (right - left > 1)
+	{
+		int mid = (left + right) / 2;
+
+		if (table[mid] <= length)
+		{
+			left = mid;
+		}
+		else
+		{
+			right = mid;
+		}
+	}
+
+	float span = table[right] - table[left];
+	float s = 0.0f;
+	if (span > 0.0f)
+	{
+		s = std::min(1.0f, (length - table[left]) / span);
+	}
+
+	return (left + s) / resolution_;
+}
+
+EndlessRide::~EndlessRide()
+{
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "TrackGrid.h"
+#include "ScratchArena.h"
+#include <vector>
+#include <random>
+#include <directxmath.h>
+
+class TrackGeometry;
+
+//	A ride that never ends, for attract mode. Track is laid out just ahead of the train and taken away behind it.
+//	The pieces live in a ring of fixed size. Once the train has moved far enough along, the oldest piece is retired
+//		and its slot is reused for a new piece at the front, so the memory used and the work done each frame stay
+//		the same however long the ride goes on.
+//	New pieces are planned on the same 10 metre grid as the TrackGenerator, inside a fixed footprint, so the ride
+//		never wanders far enough from the origin to lose floating point precision.
+class EndlessRide
+{
+public:
+	EndlessRide(int slot_count = 24, int resolution = 100);
+	void Reset(unsigned int seed);
+	void Update(float delta_time);
+	void GetFrame(DirectX::XMVECTOR& position, DirectX::XMVECTOR& forward, DirectX::XMVECTOR& up);
+	void BakeSlot(int slot, TrackGeometry* geometry);
+	inline int GetSlotCount() { return slots_.size(); }
+	inline const std::vector<int>& GetChangedSlots() { return changed_slots_; }
+	inline void ClearChangedSlots() { changed_slots_.clear(); }
+	inline float GetSpeed() { return speed_; }
+	inline unsigned int GetPiecesTravelled() { return pieces_travelled_; }
+	~EndlessRide();
+
+private:
+	typedef TrackGrid::Cell Cell;
+
+	struct Frame
+	{
+		DirectX::XMFLOAT3 point;
+		DirectX::XMFLOAT3 forward;
+		DirectX::XMFLOAT3 up;
+		DirectX::XMFLOAT3 right;
+	};
+
+	//	One piece of track. Everything is sized up front, so reusing a slot never touches the heap.
+	struct Slot
+	{
+		TrackPiece::Tag tag;
+		SL::CRSpline spline;
+		std::vector<float> arc_table;
+		std::vector<Frame> frames;
+		float length;
+		Cell end;
+
+		//	How many pieces were laid before this one. Keeps the rail texture running on across slots.
+		unsigned int piece_number;
+	};
+
+	void AddPiece();
+	TrackPiece::Tag ChoosePiece(Cell& end);
+	void BuildSpline(Slot& slot, const Cell& start);
+	void SimulateSlot(Slot& slot, float start_roll, float roll_target);
+	float FindLocalTime(const Slot& slot, float length);
+	inline int GetSlot(int piece) { return (head_ + piece) % slots_.size(); }
+
+private:
+	std::vector<Slot> slots_;
+	int resolution_;
+
+	//	Slot holding the oldest piece, and the number of pieces in the ring.
+	int head_;
+	int count_;
+
+	//	Piece the train is on, counted from the oldest, and how far along it the train is in metres.
+	int current_;
+	float distance_;
+	float speed_;
+	unsigned int pieces_travelled_;
+	unsigned int pieces_laid_;
+
+	//	Grid state at the front of the track, and the cell the oldest piece starts from.
+	Cell end_;
+	Cell tail_;
+
+	//	Number of pieces in the ring that pass through each grid cell.
+	TrackGrid grid_;
+	std::mt19937 random_;
+
+	//	Frame and roll carried from the end of the newest piece onto the next.
+	DirectX::XMFLOAT3 up_;
+	float roll_;
+	float roll_target_;
+
+	//	Working space for baking a slot, only ever a single chunk's worth.
+	ScratchArena scratch_;
+
+	//	Control points and tensions of the stock pieces, in their own space.
+	SL::Vector stock_points_[TrackGrid::stock_count][4];
+	float stock_tensions_[TrackGrid::stock_count];
+
+	//	Slots that have been given a new piece since the mesh last caught up.
+	std::vector<int> changed_slots_;
+};
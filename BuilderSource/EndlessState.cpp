@@ -0,0 +1,110 @@
+#include "EndlessState.h"
+
+#include "EndlessMesh.h"
+
+EndlessState::EndlessState()
+{
+	endless_ride_ = nullptr;
+	endless_mesh_ = nullptr;
+	seed_ = 1;
+}
+
+void EndlessState::Init(void* ptr)
+{
+	endless_ride_ = static_cast<EndlessRide*>(ptr);
+}
+
+void EndlessState::SetEndlessMesh(EndlessMesh* endless_mesh)
+{
+	endless_mesh_ = endless_mesh;
+}
+
+void EndlessState::Update(float delta_time)
+{
+	endless_ride_->Update(delta_time);
+
+	//	At most one or two slots change in a frame, and only their vertices are sent to the GPU.
+	if (endless_mesh_)
+	{
+		endless_mesh_->Upload(endless_ride_);
+	}
+}
+
+void EndlessState::RenderUI()
+{
+	if (ImGui::BeginMainMenuBar())
+	{
+		ImGui::Indent(43.0f);
+		if (ImGui::BeginMenu("Settings"))
+		{
+			if (ImGui::Button("Toggle Wireframe"))
+			{
+				SetWireframeState(!wireframe_state_);
+			}
+
+			if (ImGui::Button("Toggle FPS"))
+			{
+				ToggleFPS();
+			}
+
+			ImGui::EndMenu();
+		}
+
+		ImGui::Indent(screen_width_ - 86.0f);
+		if (ImGui::Button("Exit"))
+		{
+			application_running_ = false;
+		}
+
+		ImGui::EndMainMenuBar();
+	}
+
+	ImGui::Text("Endless Ride");
+	ImGui::Spacing();
+	ImGui::Separator();
+	ImGui::Spacing();
+	ImGui::Checkbox("Back to Editing", &exit_);
+	ImGui::Spacing();
+	ImGui::Separator();
+	ImGui::Spacing();
+	ImGui::Text("Speed: %.1f m/s", endless_ride_->GetSpeed());
+	ImGui::Text("Pieces Travelled: %u", endless_ride_->GetPiecesTravelled());
+}
+
+//	Front seat view, taken straight from the frame of the train.
+void EndlessState::GetCamera(DirectX::XMVECTOR& eye, DirectX::XMVECTOR& look_at, DirectX::XMVECTOR& up)
+{
+	DirectX::XMVECTOR position, forward;
+	endless_ride_->GetFrame(position, forward, up);
+
+	eye = position + DirectX::XMVectorScale(up, 0.15f) - DirectX::XMVectorScale(forward, 0.5f);
+	look_at = eye + forward;
+}
+
+void EndlessState::OnEnter()
+{
+	if (line_controller_)
+	{
+		line_controller_->Clear();
+	}
+
+	//	A different ride every time.
+	endless_ride_->Reset(seed_++);
+
+	if (endless_mesh_)
+	{
+		endless_mesh_->Upload(endless_ride_);
+	}
+}
+
+ApplicationState::APPLICATIONSTATE EndlessState::OnExit()
+{
+	exit_ = false;
+
+	return APPLICATIONSTATE::BUILDING_STATE;
+}
+
+EndlessState::~EndlessState()
+{
+
+}
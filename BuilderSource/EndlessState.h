@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ApplicationState.h"
+#include "EndlessRide.h"
+
+class EndlessMesh;
+
+//	Rides a track that is generated as it goes, for leaving running as an attract mode.
+class EndlessState : public ApplicationState
+{
+public:
+	EndlessState();
+	void Init(void* ptr);
+	void SetEndlessMesh(EndlessMesh* endless_mesh);
+	void Update(float delta_time);
+	void RenderUI();
+	void OnEnter();
+	APPLICATIONSTATE OnExit();
+	void GetCamera(DirectX::XMVECTOR& eye, DirectX::XMVECTOR& look_at, DirectX::XMVECTOR& up);
+
+	~EndlessState();
+
+private:
+	EndlessRide* endless_ride_;
+	EndlessMesh* endless_mesh_;
+	unsigned int seed_;
+};
@@ -0,0 +1,58 @@
+#include "Frustum.h"
+
+Frustum::Frustum()
+{
+	//	Until it is built, the frustum contains everything.
+	for (int i = 0; i < 6; i++)
+	{
+		planes_[i] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+}
+
+//	Pull the planes out of the combined view and projection matrix (Gribb and Hartmann).
+//		Points are row vectors, so each plane is a sum or difference of the matrix's columns, which are the
+//		rows of its transpose. The near plane is the third column on its own, as D3D clip space depth runs from 0 to w.
+void Frustum::Build(const XMMATRIX& view, const XMMATRIX& projection)
+{
+	XMMATRIX transpose = XMMatrixTranspose(XMMatrixMultiply(view, projection));
+
+	XMVECTOR column_x = transpose.r[0];
+	XMVECTOR column_y = transpose.r[1];
+	XMVECTOR column_z = transpose.r[2];
+	XMVECTOR column_w = transpose.r[3];
+
+	XMVECTOR planes[6];
+	planes[0] = column_w + column_x;	//	Left.
+	planes[1] = column_w - column_x;	//	Right.
+	planes[2] = column_w + column_y;	//	Bottom.
+	planes[3] = column_w - column_y;	//	Top.
+	planes[4] = column_z;				//	Near.
+	planes[5] = column_w - column_z;	//	Far.
+
+	for (int i = 0; i < 6; i++)
+	{
+		XMStoreFloat4(&planes_[i], XMPlaneNormalize(planes[i]));
+	}
+}
+
+//	Conservative test of an axis aligned box against the frustum. Only returns false when the box is
+//		entirely behind one of the planes, so a few boxes near the corners are drawn when they needn't be.
+bool Frustum::IntersectsBox(const XMFLOAT3& min, const XMFLOAT3& max) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		const XMFLOAT4& plane = planes_[i];
+
+		//	The corner of the box furthest along the plane's normal.
+		float x = (plane.x >= 0.0f) ? max.x : min.x;
+		float y = (plane.y >= 0.0f) ? max.y : min.y;
+		float z = (plane.z >= 0.0f) ? max.z : min.z;
+
+		if ((plane.x * x) + (plane.y * y) + (plane.z * z) + plane.w < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+//	The six planes bounding what the camera can see, used to skip meshes that are entirely off screen.
+class Frustum
+{
+public:
+	Frustum();
+	void Build(const XMMATRIX& view, const XMMATRIX& projection);
+	bool IntersectsBox(const XMFLOAT3& min, const XMFLOAT3& max) const;
+
+private:
+	//	Planes point inwards, stored as (a, b, c, d) where a point p is inside when a*p.x + b*p.y + c*p.z + d >= 0.
+	XMFLOAT4 planes_[6];
+};
@@ -0,0 +1,87 @@
+#include "InstancedMeshInstance.h"
+
+//	The default pages of 256 instances are enough for the supports of a small track.
+InstancedMeshInstance::InstancedMeshInstance(ID3D11Device* device, ID3D11DeviceContext* device_context, InstancedShader* shader, BaseMesh* mesh,
+	unsigned int instance_size, unsigned int page_size) :
+	MeshInstance(shader, mesh), buffer_backend_(device, device_context), instance_size_(instance_size)
+{
+	instance_buffer_ = new PagedBuffer(&buffer_backend_, instance_size, page_size, false);
+	instance_buffer_->Reserve(0);
+	instance_count_ = 0;
+}
+
+InstancedMeshInstance::~InstancedMeshInstance()
+{
+	delete instance_buffer_;
+	instance_buffer_ = nullptr;
+}
+
+//	Add a draw of every copy to the queue, in one call.
+bool InstancedMeshInstance::Submit(RenderQueue& queue)
+{
+	if (!render_ || (instance_count_ == 0))
+	{
+		return false;
+	}
+
+	DrawItem item = CreateDrawItem();
+	item.instance_buffer = static_cast<ID3D11Buffer*>(instance_buffer_->GetBuffer());
+	item.instance_stride = instance_size_;
+	item.instance_count = instance_count_;
+	queue.Submit(item);
+
+	return true;
+}
+
+//	Replace every copy's world matrix.
+void InstancedMeshInstance::SetInstances(const std::vector<XMFLOAT4X4>& instances)
+{
+	if (instances.empty())
+	{
+		Clear();
+		return;
+	}
+
+	SetInstances(&instances[0], instances.size());
+}
+
+//	Replace every copy's placement, each instance_size bytes.
+void InstancedMeshInstance::SetInstances(const void* instances, unsigned int instance_count)
+{
+	if ((instance_count == 0) || !instance_buffer_->Write(instances, instance_count))
+	{
+		Clear();
+		return;
+	}
+
+	instance_count_ = instance_count;
+}
+
+//	Make room for instance_count copies and draw all of them, to be filled in a region at a time, see PipeMesh::Reserve.
+void InstancedMeshInstance::Reserve(unsigned int instance_count)
+{
+	if (!instance_buffer_->Reserve(instance_count))
+	{
+		Clear();
+		return;
+	}
+
+	instance_count_ = instance_count;
+}
+
+//	Overwrite the placements of a run of copies without waiting for the GPU, see PipeMesh::UploadRegion.
+void InstancedMeshInstance::UploadRegion(unsigned int first_instance, const void* instances, unsigned int instance_count)
+{
+	if (instance_count > 0)
+	{
+		instance_buffer_->WriteRegion(first_instance, instances, instance_count);
+	}
+}
+
+//	Stop drawing any copies, and shrink the instance buffer to a single page if it has more than two.
+//		A buffer of one or two pages is kept as it is, like any buffer within a page of its size, see PagedBuffer::Reserve.
+void InstancedMeshInstance::Clear()
+{
+	instance_buffer_->Reserve(0);
+	instance_count_ = 0;
+}
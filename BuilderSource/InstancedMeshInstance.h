@@ -0,0 +1,32 @@
+#pragma once
+
+#include "MeshInstance.h"
+#include "InstancedShader.h"
+#include "D3D11BufferBackend.h"
+#include <vector>
+
+//	Draws one mesh many times in a single call, each copy placed by its own world matrix, or by whatever placement
+//		the shader reads for each copy, see InstancedShader::Placement.
+//		The world matrix of the instance itself is placed on top of every copy's.
+//		The placements live in a paged buffer, so replacing them all is a single upload.
+class InstancedMeshInstance : public MeshInstance
+{
+public:
+	InstancedMeshInstance(ID3D11Device* device, ID3D11DeviceContext* device_context, InstancedShader* shader, BaseMesh* mesh,
+		unsigned int instance_size = sizeof(XMFLOAT4X4), unsigned int page_size = 256);
+	~InstancedMeshInstance();
+	bool Submit(RenderQueue& queue);
+	void SetInstances(const std::vector<XMFLOAT4X4>& instances);
+	void SetInstances(const void* instances, unsigned int instance_count);
+	void Reserve(unsigned int instance_count);
+	void UploadRegion(unsigned int first_instance, const void* instances, unsigned int instance_count);
+	void Clear();
+	inline unsigned int GetInstanceCount() { return instance_count_; }
+	inline unsigned int GetBufferBytes() const { return instance_buffer_->GetByteSize(); }
+
+private:
+	D3D11BufferBackend buffer_backend_;
+	PagedBuffer* instance_buffer_;
+	unsigned int instance_size_;
+	unsigned int instance_count_;
+};
@@ -0,0 +1,214 @@
+#include "InstancedShader.h"
+
+InstancedShader::InstancedShader(ID3D11Device* device, HWND hwnd, Placement placement) : SceneShader(device, hwnd), placement_(placement)
+{
+	if (placement == Placement::POSE)
+	{
+		initShader(L"instanced_pose_vs.cso", L"colour_ps.cso");
+	}
+	else
+	{
+		initShader(L"instanced_vs.cso", L"colour_ps.cso");
+	}
+
+	colour_ = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+	texture_ = nullptr;
+}
+
+InstancedShader::~InstancedShader()
+{
+	// Release the matrix constant buffer.
+	if (matrixBuffer)
+	{
+		matrixBuffer->Release();
+		matrixBuffer = 0;
+	}
+
+	if (colour_buffer_)
+	{
+		colour_buffer_->Release();
+		colour_buffer_ = 0;
+	}
+
+	//	Release the sampler state.
+	if (sampleState)
+	{
+		sampleState->Release();
+		sampleState = 0;
+	}
+
+	// Release the layout.
+	if (layout)
+	{
+		layout->Release();
+		layout = 0;
+	}
+
+	//Release base shader components
+	BaseShader::~BaseShader();
+}
+
+void InstancedShader::initShader(WCHAR* vsFilename, WCHAR* psFilename)
+{
+	D3D11_BUFFER_DESC matrixBufferDesc;
+	D3D11_BUFFER_DESC colour_buffer_desc;
+	D3D11_SAMPLER_DESC sampler_desc;
+
+	// Load (+ compile) shader files
+	loadInstancedVertexShader(vsFilename, placement_);
+	loadPixelShader(psFilename);
+
+	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
+	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	matrixBufferDesc.ByteWidth = sizeof(ObjectBufferType);
+	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	matrixBufferDesc.MiscFlags = 0;
+	matrixBufferDesc.StructureByteStride = 0;
+	renderer->CreateBuffer(&matrixBufferDesc, NULL, &matrixBuffer);
+
+	// Create a texture sampler state description.
+	sampler_desc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	sampler_desc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+	sampler_desc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+	sampler_desc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+	sampler_desc.MipLODBias = 0.0f;
+	sampler_desc.MaxAnisotropy = 1;
+	sampler_desc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+	sampler_desc.BorderColor[0] = 0;
+	sampler_desc.BorderColor[1] = 0;
+	sampler_desc.BorderColor[2] = 0;
+	sampler_desc.BorderColor[3] = 0;
+	sampler_desc.MinLOD = 0;
+	sampler_desc.MaxLOD = D3D11_FLOAT32_MAX;
+	renderer->CreateSamplerState(&sampler_desc, &sampleState);
+
+	// The pixel shader is the ColourShader's, so takes the same lighting buffer.
+	colour_buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+	colour_buffer_desc.ByteWidth = sizeof(ColourBufferType);
+	colour_buffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	colour_buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	colour_buffer_desc.MiscFlags = 0;
+	colour_buffer_desc.StructureByteStride = 0;
+	renderer->CreateBuffer(&colour_buffer_desc, NULL, &colour_buffer_);
+}
+
+//	Same as BaseShader::loadVertexShader, but the layout also reads the placement of each instance from slot 1.
+void InstancedShader::loadInstancedVertexShader(WCHAR* filename, Placement placement)
+{
+	ID3DBlob* vertexShaderBuffer = 0;
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[7];
+	unsigned int element_count = 3;
+
+	// Reads compiled shader into buffer (bytecode).
+	HRESULT result = D3DReadFileToBlob(filename, &vertexShaderBuffer);
+	if (result != S_OK)
+	{
+		MessageBox(NULL, filename, L"File ERROR", MB_OK);
+		exit(0);
+	}
+
+	renderer->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader);
+
+	// Per vertex, matching the VertexType of the BaseMesh.
+	polygonLayout[0].SemanticName = "POSITION";
+	polygonLayout[0].SemanticIndex = 0;
+	polygonLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[0].InputSlot = 0;
+	polygonLayout[0].AlignedByteOffset = 0;
+	polygonLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[0].InstanceDataStepRate = 0;
+
+	polygonLayout[1].SemanticName = "TEXCOORD";
+	polygonLayout[1].SemanticIndex = 0;
+	polygonLayout[1].Format = DXGI_FORMAT_R32G32_FLOAT;
+	polygonLayout[1].InputSlot = 0;
+	polygonLayout[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[1].InstanceDataStepRate = 0;
+
+	polygonLayout[2].SemanticName = "NORMAL";
+	polygonLayout[2].SemanticIndex = 0;
+	polygonLayout[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[2].InputSlot = 0;
+	polygonLayout[2].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[2].InstanceDataStepRate = 0;
+
+	if (placement == Placement::POSE)
+	{
+		// Per instance, a position then a rotation.
+		polygonLayout[3].SemanticName = "INSTANCEPOSITION";
+		polygonLayout[3].SemanticIndex = 0;
+		polygonLayout[3].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+		polygonLayout[3].InputSlot = 1;
+		polygonLayout[3].AlignedByteOffset = 0;
+		polygonLayout[3].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+		polygonLayout[3].InstanceDataStepRate = 1;
+
+		polygonLayout[4].SemanticName = "INSTANCEROTATION";
+		polygonLayout[4].SemanticIndex = 0;
+		polygonLayout[4].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		polygonLayout[4].InputSlot = 1;
+		polygonLayout[4].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+		polygonLayout[4].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+		polygonLayout[4].InstanceDataStepRate = 1;
+
+		element_count = 5;
+	}
+	else
+	{
+		// Per instance, one row of the world matrix each.
+		for (int i = 0; i < 4; i++)
+		{
+			polygonLayout[3 + i].SemanticName = "WORLD";
+			polygonLayout[3 + i].SemanticIndex = i;
+			polygonLayout[3 + i].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+			polygonLayout[3 + i].InputSlot = 1;
+			polygonLayout[3 + i].AlignedByteOffset = (i == 0) ? 0 : D3D11_APPEND_ALIGNED_ELEMENT;
+			polygonLayout[3 + i].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+			polygonLayout[3 + i].InstanceDataStepRate = 1;
+		}
+
+		element_count = 7;
+	}
+
+	renderer->CreateInputLayout(polygonLayout, element_count, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &layout);
+
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+}
+
+//	Set the world matrix placed on top of every copy's placement, and the colour.
+void InstancedShader::SetObjectParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX &worldMatrix)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	ObjectBufferType* dataPtr;
+	ColourBufferType* colour_ptr;
+
+	// Lock the constant buffer so it can be written to. The view and projection are already in the frame buffer.
+	deviceContext->Map(matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	dataPtr = (ObjectBufferType*)mappedResource.pData;
+	dataPtr->world = XMMatrixTranspose(worldMatrix);
+	deviceContext->Unmap(matrixBuffer, 0);
+	deviceContext->VSSetConstantBuffers(0, 1, &matrixBuffer);
+
+	deviceContext->Map(colour_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	colour_ptr = (ColourBufferType*)mappedResource.pData;
+	colour_ptr->colour = colour_;
+	colour_ptr->light_ambient = XMFLOAT4(0.3f, 0.3f, 0.3f, 1.0f);
+	colour_ptr->light_diffuse = XMFLOAT4(0.8f, 0.8f, 0.8f, 1.0f);
+	colour_ptr->light_direction = XMFLOAT4(2.0f, -2.0f, 1.0f, 0.0f);
+	deviceContext->Unmap(colour_buffer_, 0);
+	deviceContext->PSSetConstantBuffers(0, 1, &colour_buffer_);
+}
+
+void InstancedShader::SetTexture(ID3D11ShaderResourceView* texture)
+{
+	texture_ = texture;
+}
+
+void InstancedShader::SetColour(float r, float g, float b)
+{
+	colour_ = XMFLOAT4(r, g, b, 0.0f);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "SceneShader.h"
+#include "ColourShader.h"
+
+using namespace std;
+using namespace DirectX;
+
+//	Lit like the ColourShader, but draws many copies of a mesh in one call.
+//		Each copy has its own placement, read from a second vertex buffer, which is placed on top of
+//		the world matrix shared by every copy.
+class InstancedShader : public SceneShader
+{
+public:
+	//	What is read for each copy. MATRIX is a whole world matrix, for copies that are stretched like the support pillars.
+	//		POSE is just a position followed by a rotation quaternion, for copies that are only moved and turned,
+	//		like the cross ties, see TrackGeometry::CrossTie.
+	enum class Placement
+	{
+		MATRIX = 0,
+		POSE
+	};
+
+	InstancedShader(ID3D11Device* device, HWND hwnd, Placement placement = Placement::MATRIX);
+	~InstancedShader();
+	void SetObjectParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX &world);
+	void SetTexture(ID3D11ShaderResourceView* texture);
+	void SetColour(float r, float g, float b);
+
+private:
+	void initShader(WCHAR*, WCHAR*);
+	void loadInstancedVertexShader(WCHAR* filename, Placement placement);
+
+private:
+	ID3D11Buffer* matrixBuffer;
+	ID3D11Buffer* colour_buffer_;
+	ID3D11ShaderResourceView* texture_;
+	XMFLOAT4 colour_;
+	Placement placement_;
+};
@@ -0,0 +1,225 @@
+#include "JobSystem.h"
+
+JobSystem::JobSystem(unsigned int worker_count) : queued_(0)
+{
+	running_ = true;
+	next_queue_ = 0;
+
+	//	Room for a ParallelFor's share of the tasks, with plenty to spare.
+	for (unsigned int i = 0; i < worker_count; i++)
+	{
+		Queue* queue = new Queue;
+		queue->tasks.resize(16);
+		queue->first = 0;
+		queue->count = 0;
+		queues_.push_back(queue);
+	}
+
+	for (unsigned int i = 0; i < worker_count; i++)
+	{
+		workers_.push_back(std::thread(&JobSystem::Run, this, i));
+	}
+}
+
+//	Leave a core for the render thread and one for the thread asking for the work, which joins in anyway.
+unsigned int JobSystem::GetDefaultWorkerCount()
+{
+	unsigned int cores = std::thread::hardware_concurrency();
+	return (cores > 2) ? cores - 2 : 1;
+}
+
+//	Call job once for every index from 0 to count, spread over the workers, and return once every call has finished.
+//		The calls may run in any order and at the same time, so each should only write to what belongs to its index.
+void JobSystem::ParallelFor(unsigned int count, const Job& job)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (queues_.empty() || (count == 1))
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			job(i);
+		}
+		return;
+	}
+
+	//	A few tasks for each thread, so there is something left to steal when some finish early.
+	unsigned int task_count = (workers_.size() + 1) * 4;
+	if (task_count > count)
+	{
+		task_count = count;
+	}
+
+	std::atomic<unsigned int> remaining(task_count);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		for (unsigned int i = 0; i < task_count; i++)
+		{
+			Task task;
+			task.job = &job;
+			task.first = (unsigned long long)count * i / task_count;
+			task.last = (unsigned long long)count * (i + 1) / task_count;
+			task.remaining = &remaining;
+
+			Queue* queue = queues_[next_queue_];
+			next_queue_ = (next_queue_ + 1) % queues_.size();
+
+			//	Counted before it is queued, as a worker that is already awake can take it straight away.
+			queued_++;
+			Push(queue, task);
+		}
+	}
+	condition_.notify_all();
+
+	//	Help until every task has finished, taking from the queues as if this were the first worker.
+	//		While the last tasks run on the workers, sleep until one of them finishes or more work is queued,
+	//		such as a job running a ParallelFor of its own, and help with that too.
+	Task task;
+	while (remaining > 0)
+	{
+		if (TakeTask(0, task))
+		{
+			Execute(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		condition_.wait(lock, [this, &remaining] { return (remaining == 0) || (queued_ > 0); });
+	}
+}
+
+//	Run on the job system if there is one, or on this thread if not.
+void JobSystem::ParallelFor(JobSystem* jobs, unsigned int count, const Job& job)
+{
+	if (jobs)
+	{
+		jobs->ParallelFor(count, job);
+		return;
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		job(i);
+	}
+}
+
+void JobSystem::Run(unsigned int worker)
+{
+	Task task;
+
+	while (true)
+	{
+		if (TakeTask(worker, task))
+		{
+			Execute(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		condition_.wait(lock, [this] { return (queued_ > 0) || !running_; });
+		if (!running_)
+		{
+			break;
+		}
+	}
+}
+
+//	The newest task from the worker's own queue, or else the oldest from the first other queue that has one.
+bool JobSystem::TakeTask(unsigned int worker, Task& task)
+{
+	for (unsigned int i = 0; i < queues_.size(); i++)
+	{
+		Queue* queue = queues_[(worker + i) % queues_.size()];
+
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->count == 0)
+		{
+			continue;
+		}
+
+		const unsigned int capacity = queue->tasks.size();
+		if (i == 0)
+		{
+			task = queue->tasks[(queue->first + queue->count - 1) % capacity];
+		}
+		else
+		{
+			task = queue->tasks[queue->first];
+			queue->first = (queue->first + 1) % capacity;
+		}
+		queue->count--;
+
+		queued_--;
+		return true;
+	}
+
+	return false;
+}
+
+//	Add a task to the newest end of a queue, doubling the ring if it is full.
+void JobSystem::Push(Queue* queue, const Task& task)
+{
+	std::lock_guard<std::mutex> lock(queue->mutex);
+
+	unsigned int capacity = queue->tasks.size();
+	if (queue->count == capacity)
+	{
+		std::vector<Task> tasks(capacity * 2);
+		for (unsigned int i = 0; i < queue->count; i++)
+		{
+			tasks[i] = queue->tasks[(queue->first + i) % capacity];
+		}
+		queue->tasks.swap(tasks);
+		queue->first = 0;
+		capacity = queue->tasks.size();
+	}
+
+	queue->tasks[(queue->first + queue->count) % capacity] = task;
+	queue->count++;
+}
+
+void JobSystem::Execute(const Task& task)
+{
+	for (unsigned int i = task.first; i < task.last; i++)
+	{
+		(*task.job)(i);
+	}
+
+	if (--(*task.remaining) > 0)
+	{
+		return;
+	}
+
+	//	The thread waiting for the last task checks under the lock, so the lock is taken before waking it.
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+	}
+	condition_.notify_all();
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		running_ = false;
+	}
+	condition_.notify_all();
+
+	for (int i = 0; i < workers_.size(); i++)
+	{
+		if (workers_[i].joinable())
+		{
+			workers_[i].join();
+		}
+	}
+
+	for (int i = 0; i < queues_.size(); i++)
+	{
+		delete queues_[i];
+	}
+}
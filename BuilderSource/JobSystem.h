@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+//	A small pool of worker threads, for splitting the stages of a bake into jobs that can run side by side.
+//	Each worker has its own queue. It takes the newest task from its own queue, and once that is empty takes the
+//		oldest task from another worker's, so a worker that finishes early helps with whatever is left.
+//	The thread asking for the work joins in until all of it is done, and sleeps rather than spins while the workers
+//		finish off, so a job system with no workers, or no job system at all, just runs everything on the thread that asked.
+//	Handing out work never allocates, so a bake that uses the job system costs no more allocations than one that doesn't.
+class JobSystem
+{
+public:
+	//	What to call for each index. It only points at the function object it was made from, rather than copying it,
+	//		which is safe as ParallelFor doesn't return until every call has been made.
+	class Job
+	{
+	public:
+		template<class Function> Job(const Function& function) :
+			function_(&function), call_(&Call<Function>)
+		{
+		}
+
+		inline void operator()(unsigned int index) const { call_(function_, index); }
+
+	private:
+		template<class Function> static void Call(const void* function, unsigned int index)
+		{
+			(*static_cast<const Function*>(function))(index);
+		}
+
+		const void* function_;
+		void (*call_)(const void*, unsigned int);
+	};
+
+	JobSystem(unsigned int worker_count);
+	void ParallelFor(unsigned int count, const Job& job);
+	static void ParallelFor(JobSystem* jobs, unsigned int count, const Job& job);
+	inline unsigned int GetWorkerCount() const { return workers_.size(); }
+	static unsigned int GetDefaultWorkerCount();
+	~JobSystem();
+
+private:
+	//	A run of one ParallelFor's indices, from first up to but not including last.
+	struct Task
+	{
+		const Job* job;
+		unsigned int first;
+		unsigned int last;
+		std::atomic<unsigned int>* remaining;
+	};
+
+	//	A ring of tasks, taken from either end. It only grows if a ParallelFor is started while another is still queued.
+	struct Queue
+	{
+		std::mutex mutex;
+		std::vector<Task> tasks;
+		unsigned int first;
+		unsigned int count;
+	};
+
+	void Run(unsigned int worker);
+	void Push(Queue* queue, const Task& task);
+	bool TakeTask(unsigned int worker, Task& task);
+	void Execute(const Task& task);
+
+private:
+	std::vector<std::thread> workers_;
+	std::vector<Queue*> queues_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::atomic<unsigned int> queued_;
+	unsigned int next_queue_;
+	bool running_;
+};
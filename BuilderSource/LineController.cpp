@@ -1,9 +1,9 @@
 #include "LineController.h"
 
-LineController::LineController(ID3D11Device* device, ID3D11DeviceContext* device_context, BaseShader* colour_shader, const unsigned int max_vertices ) :
-	colour_shader_(colour_shader)
+LineController::LineController(BufferBackend* buffer_backend, SceneShader* shader, const unsigned int max_vertices)
 {
-	line_mesh_ = new LineMesh(device, device_context, max_vertices);
+	line_mesh_ = new LineMesh(buffer_backend, max_vertices);
+	line_instance_ = new MeshInstance(shader, line_mesh_);
 	should_render_ = false;
 }
 
@@ -32,18 +32,27 @@ bool LineController::GetRenderFlag()
 	return should_render_;
 }
 
-void LineController::Render(ID3D11DeviceContext* device_context, XMMATRIX& world, XMMATRIX& view, XMMATRIX& projection)
+//	Write any lines that have changed, and add a draw of them to the queue. The lines are already in world space.
+bool LineController::Submit(RenderQueue& queue)
 {
-	if (colour_shader_ && line_mesh_ && should_render_)
+	if (!should_render_)
 	{
-		colour_shader_->SetShaderParameters(device_context, world, view, projection);
-		line_mesh_->sendData(device_context);
-		colour_shader_->render(device_context, line_mesh_->getIndexCount());
+		return false;
 	}
+
+	line_mesh_->Upload();
+
+	return line_instance_->Submit(queue);
 }
 
 LineController::~LineController()
 {
+	if (line_instance_)
+	{
+		delete line_instance_;
+		line_instance_ = 0;
+	}
+
 	if (line_mesh_)
 	{
 		delete line_mesh_;
@@ -1,23 +1,27 @@
 #pragma once
 
 #include <DirectXMath.h>
-#include "ColourShader.h"
+#include "SceneShader.h"
 #include "LineMesh.h"
+#include "MeshInstance.h"
 
+//	Lines drawn over the scene, such as the reference frame of the train.
+//	They are drawn with the rest of the scene, through the RenderQueue, in the buffers of the backend they are given.
 class LineController
 {
 public:
-	LineController(ID3D11Device* device, ID3D11DeviceContext* device_context, BaseShader* colour_shader_, const unsigned int max_vertices);
+	LineController(BufferBackend* buffer_backend, SceneShader* shader, const unsigned int max_vertices);
 	void AddLine(XMFLOAT3 start, XMFLOAT3 end, XMFLOAT3 colour);
 	void Clear();
-	void Render(ID3D11DeviceContext* device_context, XMMATRIX& world, XMMATRIX& view, XMMATRIX& projection);
+	bool Submit(RenderQueue& queue);
 	void SetRenderFlag(bool render);
 	bool GetRenderFlag();
+	inline LineMesh* GetMesh() { return line_mesh_; }
 
 	~LineController();
 private:
 	LineMesh* line_mesh_;
-	BaseShader* colour_shader_;
+	MeshInstance* line_instance_;
 	bool should_render_;
 	
-};
\ No newline at end of file
+};
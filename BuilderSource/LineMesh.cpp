@@ -1,121 +1,103 @@
 #include "LineMesh.h"
 
-LineMesh::LineMesh(ID3D11Device* device, ID3D11DeviceContext* device_context, unsigned int max_vertices) : device_(device), device_context_(device_context), max_vertices_(max_vertices)
+LineMesh::LineMesh(BufferBackend* buffer_backend, unsigned int max_vertices) : max_vertices_(max_vertices)
 {
-	initBuffers(device_);
+	//	Reserve space for every line up front so that refilling the mesh each frame does not allocate.
+	lines_.reserve(max_vertices_ / 2);
+	buffer_dirty_ = false;
+
+	//	One page each, holding every vertex there can be.
+	vertex_buffer_ = new PagedBuffer(buffer_backend, sizeof(VertexType), max_vertices_, false);
+	index_buffer_ = new PagedBuffer(buffer_backend, sizeof(unsigned long), max_vertices_, true);
+
+	initBuffers(nullptr);
 }
 
 LineMesh::~LineMesh()
 {
-	BaseMesh::~BaseMesh();
+	//	The paged buffers own the buffers, so they must not be released again by the base mesh.
+	delete vertex_buffer_;
+	delete index_buffer_;
+	vertexBuffer = nullptr;
+	indexBuffer = nullptr;
 }
 
-void LineMesh::AddLine(Line& line)
+void LineMesh::AddLine(const Line& line)
 {
+	if ((lines_.size() + 1) * 2 > max_vertices_)
+	{
+		return;
+	}
+
 	lines_.push_back(line);
-	UpdateVertexBuffer();
+	buffer_dirty_ = true;
 }
 
 void LineMesh::Clear()
 {
 	lines_.clear();
-	UpdateVertexBuffer();
+	buffer_dirty_ = true;
 }
 
+//	Each line is its own pair of vertices, so the indices just count up, and never change.
 void LineMesh::initBuffers(ID3D11Device* device)
 {
-	//	Create vertices for mesh here. TEMP: Triangle mesh.
-	VertexType* vertices;
-	unsigned long* indices;
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData, indexData;
-	HRESULT result;
-
-	vertexCount = max_vertices_;
-	indexCount = vertexCount;
-
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
+	vertex_buffer_->Reserve(max_vertices_);
 
-	int index = 0;
-	for (int i = 0; i < lines_.size(); i++)
+	unsigned long* indices = static_cast<unsigned long*>(index_buffer_->Map(max_vertices_));
+	if (indices)
 	{
-		vertices[index].position = lines_[i].start;
-		vertices[index].normal = lines_[i].colour;
-
-		vertices[index + 1].position = lines_[i].end;
-		vertices[index + 1].normal = lines_[i].colour;
-
-		index += 2;
+		for (unsigned int i = 0; i < max_vertices_; i++)
+		{
+			indices[i] = i;
+		}
+		index_buffer_->Unmap();
 	}
 
-	for (int j = 0; j < max_vertices_; j++)
-	{
-		indices[j] = j;
-	}
-
-	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType) * vertexCount;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-	// Give the subresource structure a pointer to the vertex data.
-	vertexData.pSysMem = vertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
-	// Now create the vertex buffer.
-	result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &vertexBuffer);
-
-	// Set up the description of the static index buffer.
-	indexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	indexBufferDesc.ByteWidth = sizeof(unsigned long) * indexCount;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.StructureByteStride = 0;
-	// Give the subresource structure a pointer to the index data.
-	indexData.pSysMem = indices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
-	
-	// Create the index buffer.
-	result = device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-	
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-	delete[] indices;
-	indices = 0;
-
-	
+	vertexBuffer = static_cast<ID3D11Buffer*>(vertex_buffer_->GetBuffer());
+	indexBuffer = static_cast<ID3D11Buffer*>(index_buffer_->GetBuffer());
+	vertexCount = max_vertices_;
+	indexCount = 0;
 }
 
-void LineMesh::UpdateVertexBuffer()
+//	Write the lines to the vertex buffer if they have changed since they were last written.
+//		Called once a frame, when the lines are drawn, rather than every time a line is added.
+void LineMesh::Upload()
 {
-	D3D11_MAPPED_SUBRESOURCE vertex_mapped_resource;
+	if (!buffer_dirty_)
+	{
+		return;
+	}
 
-	VertexType* vertices;// = new VertexType[max_vertices_];
+	buffer_dirty_ = false;
+	indexCount = 0;
+	if (lines_.empty())
+	{
+		return;
+	}
 
-	device_context_->Map(vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &vertex_mapped_resource);
-	
-	//	Update vertex and index data.
-	vertices = (VertexType*)vertex_mapped_resource.pData;
+	VertexType* vertices = static_cast<VertexType*>(vertex_buffer_->Map(lines_.size() * 2));
+	if (!vertices)
+	{
+		return;
+	}
 
 	int index = 0;
 	for (int i = 0; i < lines_.size(); i++)
 	{
 		vertices[index].position = lines_[i].start;
+		vertices[index].texture = XMFLOAT2(0.0f, 0.0f);
 		vertices[index].normal = lines_[i].colour;
 
 		vertices[index + 1].position = lines_[i].end;
+		vertices[index + 1].texture = XMFLOAT2(1.0f, 0.0f);
 		vertices[index + 1].normal = lines_[i].colour;
 
 		index += 2;
 	}
-	
-	device_context_->Unmap(vertexBuffer, 0);
+
+	vertex_buffer_->Unmap();
+	indexCount = index;
 }
 
 void LineMesh::sendData(ID3D11DeviceContext* deviceContext)
@@ -129,6 +111,5 @@ void LineMesh::sendData(ID3D11DeviceContext* deviceContext)
 
 	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
 	deviceContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
-	deviceContext->IASetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY_LINELIST);
-
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
 }
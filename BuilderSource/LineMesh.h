@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../DXFramework/BaseMesh.h"
+#include "PagedBuffer.h"
 #include <vector>
 
 struct Line
@@ -11,23 +12,27 @@ struct Line
 };
 
 //	For straight line lists.
+//	The buffers are made once, big enough for every line, by the backend they are given, so the lines can be
+//		written without a device. The lines are only written when they have changed, and only those there are drawn.
 class LineMesh : public BaseMesh
 {
 public:
-	LineMesh(ID3D11Device* device, ID3D11DeviceContext* device_context, unsigned int max_vertices);
+	LineMesh(BufferBackend* buffer_backend, unsigned int max_vertices);
 	void sendData(ID3D11DeviceContext* deviceContext);
-	void AddLine(Line& line);
+	void AddLine(const Line& line);
 	void Clear();
+	void Upload();
+	inline unsigned int GetLineCount() const { return lines_.size(); }
 	~LineMesh();
 
 protected:
 	void initBuffers(ID3D11Device* device);
-	void UpdateVertexBuffer();
 
 private:
 	std::vector<Line> lines_;
-	ID3D11Device* device_;
-	ID3D11DeviceContext* device_context_;
+	PagedBuffer* vertex_buffer_;
+	PagedBuffer* index_buffer_;
 	unsigned int max_vertices_;
+	bool buffer_dirty_;
 
-};
\ No newline at end of file
+};
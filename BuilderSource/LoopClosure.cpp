@@ -0,0 +1,376 @@
+#include "LoopClosure.h"
+
+#include "Track.h"
+#include <algorithm>
+#include <cmath>
+
+LoopClosure::LoopClosure(int piece_count) : piece_count_(piece_count), first_index_(-1)
+{
+}
+
+//	Reshape the last pieces of a complete track and set the closing roll. Returns false if the track
+//		is not complete, or is too short to leave the first piece and the pieces being reshaped untouched.
+bool LoopClosure::Solve(Track* track)
+{
+	first_index_ = -1;
+
+	if (!track || !track->IsComplete())
+	{
+		return false;
+	}
+
+	//	The piece before the first reshaped piece is kept, as the reshaped pieces have to join onto it.
+	int open_count = track->GetTrackPieceCount() - 1;
+	int piece_count = std::min(piece_count_, open_count - 1);
+
+	//	With fewer than two pieces there are more constraints than unknowns.
+	if (piece_count < 2)
+	{
+		return false;
+	}
+
+	if (!SolveShape(track, piece_count))
+	{
+		return false;
+	}
+
+	return SolveRoll(track);
+}
+
+//	Joints 0 to piece_count + 1 run from the start of the first reshaped piece to the start of the track.
+//	The first and last joints are fixed, and every joint in between can move and change its tangent.
+//	The constraints are that the second derivative matches on both sides of every joint, including the fixed ones.
+bool LoopClosure::SolveShape(Track* track, int piece_count)
+{
+	const int closing_index = track->GetTrackPieceCount() - 1;
+	first_index_ = closing_index - piece_count;
+
+	TrackPiece* closing_piece = track->GetTrackPiece(closing_index);
+	TrackPiece* first_piece = track->GetTrackPiece(0);
+
+	Hermite incoming = GetHermite(track->GetTrackPiece(first_index_ - 1));
+	Hermite first = GetHermite(first_piece);
+
+	//	The closing piece is built with its own tension from the first piece's control points,
+	//		so its tangent is a scaled copy of the first piece's. Scaling the curvature target by the square
+	//		of that keeps the curvature itself continuous.
+	float scale = closing_piece->GetTension() / first_piece->GetTension();
+
+	const int joint_count = piece_count + 2;
+	std::vector<SL::Vector> positions(joint_count);
+	std::vector<SL::Vector> tangents(joint_count);
+
+	positions[0] = incoming.end;
+	tangents[0] = incoming.end_tangent;
+
+	for (int i = 1; i <= piece_count; i++)
+	{
+		Hermite before = GetHermite(track->GetTrackPiece(first_index_ + i - 1));
+		Hermite after = GetHermite(track->GetTrackPiece(first_index_ + i));
+
+		positions[i] = after.start;
+		tangents[i] = before.end_tangent.Add(after.start_tangent).Scaled(0.5f);
+	}
+
+	positions[joint_count - 1] = first.start;
+	tangents[joint_count - 1] = first.start_tangent.Scaled(scale);
+
+	SL::Vector start_target = GetSecondDerivative(incoming, true);
+	SL::Vector end_target = GetSecondDerivative(first, false).Scaled(scale * scale);
+
+	//	Unknowns are the positions of the free joints followed by their tangents.
+	const int unknown_count = piece_count * 2;
+	const int constraint_count = piece_count + 2;
+
+	std::vector<float> constraints(constraint_count * unknown_count, 0.0f);
+	std::vector<SL::Vector> targets(constraint_count);
+
+	//	Add a term to a constraint, moving it to the other side if the joint is fixed.
+	auto add_term = [&](int row, int joint, bool tangent, float coefficient)
+	{
+		if (joint == 0 || joint == joint_count - 1)
+		{
+			SL::Vector value = tangent ? tangents[joint] : positions[joint];
+			targets[row] = targets[row].Subtract(value.Scaled(coefficient));
+			return;
+		}
+
+		int column = (joint - 1) + (tangent ? piece_count : 0);
+		constraints[row * unknown_count + column] += coefficient;
+	};
+
+	//	Start of the first reshaped piece matches the end of the piece before it.
+	targets[0] = start_target;
+	add_term(0, 0, false, -6.0f);
+	add_term(0, 1, false, 6.0f);
+	add_term(0, 0, true, -4.0f);
+	add_term(0, 1, true, -2.0f);
+
+	//	Interior joints, where the position of the joint itself cancels out.
+	for (int i = 1; i <= piece_count; i++)
+	{
+		add_term(i, i - 1, false, 6.0f);
+		add_term(i, i + 1, false, -6.0f);
+		add_term(i, i - 1, true, 2.0f);
+		add_term(i, i, true, 8.0f);
+		add_term(i, i + 1, true, 2.0f);
+	}
+
+	//	End of the closing piece matches the start of the track.
+	const int last_row = constraint_count - 1;
+	targets[last_row] = end_target;
+	add_term(last_row, joint_count - 2, false, 6.0f);
+	add_term(last_row, joint_count - 1, false, -6.0f);
+	add_term(last_row, joint_count - 2, true, 2.0f);
+	add_term(last_row, joint_count - 1, true, 4.0f);
+
+	//	Moving a joint costs more than turning its tangent, so the layout of the track is kept where possible.
+	std::vector<float> inverse_weights(unknown_count);
+	for (int i = 0; i < unknown_count; i++)
+	{
+		inverse_weights[i] = (i < piece_count) ? 0.25f : 1.0f;
+	}
+
+	std::vector<float> current(unknown_count * 3);
+	for (int i = 0; i < piece_count; i++)
+	{
+		SL::Vector position = positions[i + 1];
+		SL::Vector tangent = tangents[i + 1];
+
+		current[i * 3 + 0] = position.X();
+		current[i * 3 + 1] = position.Y();
+		current[i * 3 + 2] = position.Z();
+		current[(piece_count + i) * 3 + 0] = tangent.X();
+		current[(piece_count + i) * 3 + 1] = tangent.Y();
+		current[(piece_count + i) * 3 + 2] = tangent.Z();
+	}
+
+	//	Smallest weighted change that satisfies the constraints: x = x0 + W A^T y, where (A W A^T) y = b - A x0.
+	std::vector<float> system(constraint_count * constraint_count, 0.0f);
+	std::vector<float> residuals(constraint_count * 3, 0.0f);
+
+	for (int row = 0; row < constraint_count; row++)
+	{
+		for (int other = 0; other < constraint_count; other++)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < unknown_count; k++)
+			{
+				sum += constraints[row * unknown_count + k] * inverse_weights[k] * constraints[other * unknown_count + k];
+			}
+			system[row * constraint_count + other] = sum;
+		}
+
+		SL::Vector target = targets[row];
+		float target_values[3] = { target.X(), target.Y(), target.Z() };
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float sum = target_values[axis];
+			for (int k = 0; k < unknown_count; k++)
+			{
+				sum -= constraints[row * unknown_count + k] * current[k * 3 + axis];
+			}
+			residuals[row * 3 + axis] = sum;
+		}
+	}
+
+	if (!SolveLinearSystem(system, residuals, constraint_count, 3))
+	{
+		return false;
+	}
+
+	for (int k = 0; k < unknown_count; k++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float sum = 0.0f;
+			for (int row = 0; row < constraint_count; row++)
+			{
+				sum += constraints[row * unknown_count + k] * residuals[row * 3 + axis];
+			}
+			current[k * 3 + axis] += inverse_weights[k] * sum;
+		}
+	}
+
+	for (int i = 0; i < piece_count; i++)
+	{
+		positions[i + 1].Set(current[i * 3 + 0], current[i * 3 + 1], current[i * 3 + 2]);
+		tangents[i + 1].Set(current[(piece_count + i) * 3 + 0], current[(piece_count + i) * 3 + 1], current[(piece_count + i) * 3 + 2]);
+	}
+
+	//	Write each reshaped piece back as Catmull-Rom control points. The last piece takes the closing piece's
+	//		tension, so that the closing piece built from it has the same tangent at the joint.
+	for (int i = 0; i < piece_count; i++)
+	{
+		int index = first_index_ + i;
+		TrackPiece::StatePtr current_state = track->CaptureTrackPiece(index);
+
+		std::shared_ptr<TrackPiece::State> state = std::make_shared<TrackPiece::State>(*current_state);
+		if (i == piece_count - 1)
+		{
+			state->tension = closing_piece->GetTension();
+		}
+
+		float inverse_tension = 1.0f / state->tension;
+		state->control_points[1] = positions[i];
+		state->control_points[2] = positions[i + 1];
+		state->control_points[0] = positions[i + 1].Subtract(tangents[i].Scaled(inverse_tension));
+		state->control_points[3] = positions[i].Add(tangents[i + 1].Scaled(inverse_tension));
+
+		//	The shape has changed, so the piece has to be measured again.
+		state->arc_table.reset();
+
+		if (!track->RestoreTrackPiece(index, state, false))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	Find the closing roll that brings the frame at the end of the track back to the frame it started with.
+//	The twist at the end is close to linear in the closing roll, so a few secant steps are enough.
+//	The twist is measured in the range -180 to 180 degrees, so the closing piece takes the shortest way round.
+bool LoopClosure::SolveRoll(Track* track)
+{
+	const int closing_index = track->GetTrackPieceCount() - 1;
+
+	track->Reset();
+	track->UpdateSimulation(0.0f);
+	DirectX::XMFLOAT3 up = track->GetUp();
+	SL::Vector start_up(up.x, up.y, up.z);
+	track->Reset();
+
+	float previous_roll = 0.0f;
+	float previous_twist = 0.0f;
+
+	for (int i = 0; i < 6; i++)
+	{
+		track->CalculateEndOfSimulation();
+
+		SL::Vector end_up = track->GetUpStore();
+		SL::Vector forward = track->GetForwardStore();
+
+		float twist = atan2f(end_up.Cross(start_up).Dot(forward), end_up.Dot(start_up)) * 57.2958f;
+		if (fabsf(twist) < 0.01f)
+		{
+			return true;
+		}
+
+		float roll = track->GetTrackPiece(closing_index)->GetRollTarget();
+		//	Rolling the closing piece further turns the end frame back the other way, so start with a step of one to one.
+		float next_roll = roll + twist;
+		if (i > 0 && twist != previous_twist)
+		{
+			next_roll = roll - twist * (roll - previous_roll) / (twist - previous_twist);
+		}
+
+		previous_roll = roll;
+		previous_twist = twist;
+
+		std::shared_ptr<TrackPiece::State> state = std::make_shared<TrackPiece::State>(*track->CaptureTrackPiece(closing_index));
+		state->roll_target = next_roll;
+		if (!track->RestoreTrackPiece(closing_index, state, false))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	A Catmull-Rom segment runs from its second control point to its third, with tangents scaled by its tension.
+LoopClosure::Hermite LoopClosure::GetHermite(TrackPiece* track_piece)
+{
+	float tension = track_piece->GetTension();
+
+	Hermite segment;
+	segment.start = track_piece->GetControlPoint(1);
+	segment.end = track_piece->GetControlPoint(2);
+	segment.start_tangent = track_piece->GetControlPoint(2).Subtract(track_piece->GetControlPoint(0)).Scaled(tension);
+	segment.end_tangent = track_piece->GetControlPoint(3).Subtract(track_piece->GetControlPoint(1)).Scaled(tension);
+
+	return segment;
+}
+
+SL::Vector LoopClosure::GetSecondDerivative(const Hermite& segment, bool at_end)
+{
+	SL::Vector chord = segment.end.Subtract(segment.start);
+	SL::Vector start_tangent = segment.start_tangent;
+	SL::Vector end_tangent = segment.end_tangent;
+
+	if (at_end)
+	{
+		//	-6(p1 - p0) + 2m0 + 4m1
+		return chord.Scaled(-6.0f).Add(start_tangent.Scaled(2.0f)).Add(end_tangent.Scaled(4.0f));
+	}
+
+	//	6(p1 - p0) - 4m0 - 2m1
+	return chord.Scaled(6.0f).Subtract(start_tangent.Scaled(4.0f)).Subtract(end_tangent.Scaled(2.0f));
+}
+
+//	Gaussian elimination with partial pivoting. The solution replaces rhs.
+bool LoopClosure::SolveLinearSystem(std::vector<float>& matrix, std::vector<float>& rhs, int size, int rhs_count)
+{
+	for (int column = 0; column < size; column++)
+	{
+		int pivot = column;
+		for (int row = column + 1; row < size; row++)
+		{
+			if (fabsf(matrix[row * size + column]) > fabsf(matrix[pivot * size + column]))
+			{
+				pivot = row;
+			}
+		}
+
+		if (fabsf(matrix[pivot * size + column]) < 1e-8f)
+		{
+			return false;
+		}
+
+		if (pivot != column)
+		{
+			for (int k = 0; k < size; k++)
+			{
+				std::swap(matrix[pivot * size + k], matrix[column * size + k]);
+			}
+			for (int k = 0; k < rhs_count; k++)
+			{
+				std::swap(rhs[pivot * rhs_count + k], rhs[column * rhs_count + k]);
+			}
+		}
+
+		for (int row = column + 1; row < size; row++)
+		{
+			float factor = matrix[row * size + column] / matrix[column * size + column];
+			for (int k = column; k < size; k++)
+			{
+				matrix[row * size + k] -= factor * matrix[column * size + k];
+			}
+			for (int k = 0; k < rhs_count; k++)
+			{
+				rhs[row * rhs_count + k] -= factor * rhs[column * rhs_count + k];
+			}
+		}
+	}
+
+	for (int row = size - 1; row >= 0; row--)
+	{
+		for (int k = 0; k < rhs_count; k++)
+		{
+			float sum = rhs[row * rhs_count + k];
+			for (int column = row + 1; column < size; column++)
+			{
+				sum -= matrix[row * size + column] * rhs[column * rhs_count + k];
+			}
+			rhs[row * rhs_count + k] = sum / matrix[row * size + row];
+		}
+	}
+
+	return true;
+}
+
+LoopClosure::~LoopClosure()
+{
+}
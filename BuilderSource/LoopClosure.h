@@ -0,0 +1,44 @@
+#pragma once
+
+#include "TrackPiece.h"
+#include <vector>
+
+class Track;
+
+//	Smooths the seam where a complete track joins back onto its first piece.
+//	The closing piece is rebuilt from the ends of the track, so instead of editing it directly the last few
+//		pieces are reshaped so that the closing piece it produces has matching curvature at both ends.
+//	Each piece is a cubic Hermite curve, so matching second derivatives at every joint is a small linear system
+//		in the joint positions and tangents. The system has more unknowns than constraints, and the solution
+//		that moves the track the least is picked. The closing roll is then found by simulating the track,
+//		so the frame at the end of the ride lines up with the frame it started with.
+class LoopClosure
+{
+public:
+	LoopClosure(int piece_count = 3);
+	bool Solve(Track* track);
+	inline void SetPieceCount(int piece_count) { piece_count_ = piece_count; }
+	inline int GetPieceCount() { return piece_count_; }
+	inline int GetFirstIndex() { return first_index_; }
+	~LoopClosure();
+
+private:
+	//	A single cubic segment between two joints, with the tangents given per unit of t.
+	struct Hermite
+	{
+		SL::Vector start;
+		SL::Vector end;
+		SL::Vector start_tangent;
+		SL::Vector end_tangent;
+	};
+
+	bool SolveShape(Track* track, int piece_count);
+	bool SolveRoll(Track* track);
+	static Hermite GetHermite(TrackPiece* track_piece);
+	static SL::Vector GetSecondDerivative(const Hermite& segment, bool at_end);
+	static bool SolveLinearSystem(std::vector<float>& matrix, std::vector<float>& rhs, int size, int rhs_count);
+
+private:
+	int piece_count_;
+	int first_index_;
+};
@@ -0,0 +1,73 @@
+#include "MemoryBufferBackend.h"
+
+#include <cstring>
+
+MemoryBufferBackend::MemoryBufferBackend()
+{
+	live_buffers_ = 0;
+	live_bytes_ = 0;
+	create_count_ = 0;
+}
+
+void* MemoryBufferBackend::CreateBuffer(unsigned int byte_width, bool index_buffer)
+{
+	std::vector<unsigned char>* buffer = new std::vector<unsigned char>(byte_width);
+
+	live_buffers_++;
+	live_bytes_ += byte_width;
+	create_count_++;
+
+	return buffer;
+}
+
+//	Discarding leaves the rest of the buffer undefined on the GPU, which is marked here by filling it.
+void MemoryBufferBackend::WriteBuffer(void* buffer, unsigned int byte_offset, const void* data, unsigned int byte_count, bool discard)
+{
+	std::vector<unsigned char>& contents = *static_cast<std::vector<unsigned char>*>(buffer);
+	if (byte_offset + byte_count > contents.size())
+	{
+		return;
+	}
+
+	if (discard)
+	{
+		memset(&contents[0], 0xCD, contents.size());
+	}
+
+	memcpy(&contents[byte_offset], data, byte_count);
+}
+
+void* MemoryBufferBackend::MapBuffer(void* buffer, bool discard)
+{
+	std::vector<unsigned char>& contents = *static_cast<std::vector<unsigned char>*>(buffer);
+
+	if (discard)
+	{
+		memset(&contents[0], 0xCD, contents.size());
+	}
+
+	return &contents[0];
+}
+
+void MemoryBufferBackend::UnmapBuffer(void* buffer)
+{
+}
+
+void MemoryBufferBackend::ReleaseBuffer(void* buffer)
+{
+	std::vector<unsigned char>* contents = static_cast<std::vector<unsigned char>*>(buffer);
+
+	live_buffers_--;
+	live_bytes_ -= contents->size();
+
+	delete contents;
+}
+
+const std::vector<unsigned char>& MemoryBufferBackend::GetContents(void* buffer) const
+{
+	return *static_cast<std::vector<unsigned char>*>(buffer);
+}
+
+MemoryBufferBackend::~MemoryBufferBackend()
+{
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "PagedBuffer.h"
+#include <vector>
+
+//	Keeps buffers in system memory and counts what is allocated, standing in for the GPU so the
+//		paging of the track buffers can be checked without a device.
+class MemoryBufferBackend : public BufferBackend
+{
+public:
+	MemoryBufferBackend();
+	void* CreateBuffer(unsigned int byte_width, bool index_buffer);
+	void WriteBuffer(void* buffer, unsigned int byte_offset, const void* data, unsigned int byte_count, bool discard);
+	void* MapBuffer(void* buffer, bool discard);
+	void UnmapBuffer(void* buffer);
+	void ReleaseBuffer(void* buffer);
+	const std::vector<unsigned char>& GetContents(void* buffer) const;
+	inline unsigned int GetLiveBuffers() const { return live_buffers_; }
+	inline unsigned int GetLiveBytes() const { return live_bytes_; }
+	inline unsigned int GetCreateCount() const { return create_count_; }
+	~MemoryBufferBackend();
+
+private:
+	unsigned int live_buffers_;
+	unsigned int live_bytes_;
+	unsigned int create_count_;
+};
@@ -1,18 +1,20 @@
 #include "MeshInstance.h"
 
-MeshInstance::MeshInstance(ID3D11ShaderResourceView* texture, BaseShader* shader, BaseMesh* mesh) : 
+MeshInstance::MeshInstance(ID3D11ShaderResourceView* texture, SceneShader* shader, BaseMesh* mesh) : 
 	world_matrix_(DirectX::XMMatrixIdentity()), texture_(texture), shader_(shader), mesh_(mesh)
 {
-	shader_->SetTexture(texture_);
 	render_ = true;
+	bounded_ = false;
+	quantisation_ = nullptr;
 	SetColour(XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f));
 }
 
-MeshInstance::MeshInstance(BaseShader* shader, BaseMesh* mesh) :
+MeshInstance::MeshInstance(SceneShader* shader, BaseMesh* mesh) :
 	world_matrix_(DirectX::XMMatrixIdentity()), texture_(nullptr), shader_(shader), mesh_(mesh)
 {
-	shader_->SetTexture(texture_);
 	render_ = true;
+	bounded_ = false;
+	quantisation_ = nullptr;
 	SetColour(XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f));
 }
 
@@ -20,22 +22,35 @@ MeshInstance::~MeshInstance()
 {
 }
 
-bool MeshInstance::Render(ID3D11DeviceContext* device_context, XMMATRIX& view, XMMATRIX& projection)
+//	Add a draw of the mesh to the queue, unless it is hidden or has nothing in it.
+bool MeshInstance::Submit(RenderQueue& queue)
 {
-	if (!render_)
+	if (!render_ || (mesh_->getIndexCount() == 0))
 	{
 		return false;
 	}
 
-	shader_->SetTexture(texture_);
-	shader_->SetColour(colour_.x, colour_.y, colour_.z);
-	shader_->SetShaderParameters(device_context, world_matrix_, view, projection);
+	queue.Submit(CreateDrawItem());
 
-	mesh_->sendData(device_context);
+	return true;
+}
 
-	shader_->render(device_context, mesh_->getIndexCount());
+//	A draw of the whole mesh, once, as this instance is now.
+DrawItem MeshInstance::CreateDrawItem()
+{
+	DrawItem item;
+	item.shader = shader_;
+	item.texture = texture_;
+	item.mesh = mesh_;
+	item.quantisation = quantisation_;
+	item.index_count = mesh_->getIndexCount();
+	XMStoreFloat4x4(&item.world, world_matrix_);
+	item.colour = colour_;
+	item.instance_buffer = nullptr;
+	item.instance_stride = 0;
+	item.instance_count = 0;
 
-	return true;
+	return item;
 }
 
 void MeshInstance::SetTexture(ID3D11ShaderResourceView* texture)
@@ -58,3 +73,35 @@ void MeshInstance::SetColour(XMFLOAT4 colour)
 {
 	colour_ = colour;
 }
+
+void MeshInstance::SetBounds(const XMFLOAT3& min, const XMFLOAT3& max)
+{
+	bounded_ = true;
+	bounds_min_ = min;
+	bounds_max_ = max;
+}
+
+//	Move the bounding box into world space and test it against the frustum.
+//		The box is kept axis aligned by growing it to fit the rotated box, which is cheap and never too small.
+bool MeshInstance::InFrustum(const Frustum& frustum)
+{
+	if (!bounded_)
+	{
+		return true;
+	}
+
+	XMVECTOR min = XMLoadFloat3(&bounds_min_);
+	XMVECTOR max = XMLoadFloat3(&bounds_max_);
+	XMVECTOR centre = XMVector3TransformCoord((min + max) * 0.5f, world_matrix_);
+	XMVECTOR extent = (max - min) * 0.5f;
+
+	extent = (XMVectorAbs(world_matrix_.r[0]) * XMVectorGetX(extent))
+		+ (XMVectorAbs(world_matrix_.r[1]) * XMVectorGetY(extent))
+		+ (XMVectorAbs(world_matrix_.r[2]) * XMVectorGetZ(extent));
+
+	XMFLOAT3 world_min, world_max;
+	XMStoreFloat3(&world_min, centre - extent);
+	XMStoreFloat3(&world_max, centre + extent);
+
+	return frustum.IntersectsBox(world_min, world_max);
+}
@@ -2,28 +2,40 @@
 
 #include "../DXFramework/Geometry.h"
 #include <DirectXMath.h>
-#include "ColourShader.h"
-#include "DefaultShader.h"
+#include "SceneShader.h"
+#include "RenderQueue.h"
+#include "Frustum.h"
 
 class MeshInstance
 {
 public:
-	MeshInstance(ID3D11ShaderResourceView* texture, BaseShader* shader, BaseMesh* mesh);
-	MeshInstance(BaseShader* shader, BaseMesh* mesh);
-	~MeshInstance();
-	bool Render(ID3D11DeviceContext* context, XMMATRIX& view, XMMATRIX& projection);
+	MeshInstance(ID3D11ShaderResourceView* texture, SceneShader* shader, BaseMesh* mesh);
+	MeshInstance(SceneShader* shader, BaseMesh* mesh);
+	virtual ~MeshInstance();
+	virtual bool Submit(RenderQueue& queue);
 	void SetWorldMatrix(XMMATRIX wm);
 	XMMATRIX GetWorldMatrix();
 	void SetColour(XMFLOAT4 col);
 	void SetTexture(ID3D11ShaderResourceView* texture);
 	inline void SetRender(bool render) { render_ = render; }
+	inline void SetQuantisation(const PackedVertex::Quantisation* quantisation) { quantisation_ = quantisation; }
+	void SetBounds(const XMFLOAT3& min, const XMFLOAT3& max);
+	bool InFrustum(const Frustum& frustum);
 private:
-	bool render_;
+	//	Box around the mesh in its own space. Instances without one are never culled.
+	bool bounded_;
+	XMFLOAT3 bounds_min_;
+	XMFLOAT3 bounds_max_;
+protected:
+	DrawItem CreateDrawItem();
+
 protected:
+	bool render_;
 	XMMATRIX world_matrix_;
 	XMMATRIX scale_matrix_;
-	BaseShader* shader_;
+	SceneShader* shader_;
 	ID3D11ShaderResourceView* texture_;
 	BaseMesh* mesh_;
+	const PackedVertex::Quantisation* quantisation_;
 	XMFLOAT4 colour_;	
 };
\ No newline at end of file
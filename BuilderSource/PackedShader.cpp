@@ -0,0 +1,205 @@
+#include "PackedShader.h"
+
+PackedShader::PackedShader(ID3D11Device* device, HWND hwnd) : SceneShader(device, hwnd)
+{
+	initShader(L"packed_vs.cso", L"colour_ps.cso");
+
+	colour_ = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+	texture_ = nullptr;
+}
+
+PackedShader::~PackedShader()
+{
+	// Release the matrix constant buffer.
+	if (matrixBuffer)
+	{
+		matrixBuffer->Release();
+		matrixBuffer = 0;
+	}
+
+	if (colour_buffer_)
+	{
+		colour_buffer_->Release();
+		colour_buffer_ = 0;
+	}
+
+	if (quantisation_buffer_)
+	{
+		quantisation_buffer_->Release();
+		quantisation_buffer_ = 0;
+	}
+
+	//	Release the sampler state.
+	if (sampleState)
+	{
+		sampleState->Release();
+		sampleState = 0;
+	}
+
+	// Release the layout.
+	if (layout)
+	{
+		layout->Release();
+		layout = 0;
+	}
+
+	//Release base shader components
+	BaseShader::~BaseShader();
+}
+
+void PackedShader::initShader(WCHAR* vsFilename, WCHAR* psFilename)
+{
+	D3D11_BUFFER_DESC matrixBufferDesc;
+	D3D11_BUFFER_DESC colour_buffer_desc;
+	D3D11_BUFFER_DESC quantisation_buffer_desc;
+	D3D11_SAMPLER_DESC sampler_desc;
+
+	// Load (+ compile) shader files
+	loadPackedVertexShader(vsFilename);
+	loadPixelShader(psFilename);
+
+	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
+	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	matrixBufferDesc.ByteWidth = sizeof(ObjectBufferType);
+	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	matrixBufferDesc.MiscFlags = 0;
+	matrixBufferDesc.StructureByteStride = 0;
+	renderer->CreateBuffer(&matrixBufferDesc, NULL, &matrixBuffer);
+
+	// Create a texture sampler state description.
+	sampler_desc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	sampler_desc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+	sampler_desc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+	sampler_desc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+	sampler_desc.MipLODBias = 0.0f;
+	sampler_desc.MaxAnisotropy = 1;
+	sampler_desc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+	sampler_desc.BorderColor[0] = 0;
+	sampler_desc.BorderColor[1] = 0;
+	sampler_desc.BorderColor[2] = 0;
+	sampler_desc.BorderColor[3] = 0;
+	sampler_desc.MinLOD = 0;
+	sampler_desc.MaxLOD = D3D11_FLOAT32_MAX;
+	renderer->CreateSamplerState(&sampler_desc, &sampleState);
+
+	// The pixel shader is the ColourShader's, so takes the same lighting buffer.
+	colour_buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+	colour_buffer_desc.ByteWidth = sizeof(ColourBufferType);
+	colour_buffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	colour_buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	colour_buffer_desc.MiscFlags = 0;
+	colour_buffer_desc.StructureByteStride = 0;
+	renderer->CreateBuffer(&colour_buffer_desc, NULL, &colour_buffer_);
+
+	// How to unpack the positions of the mesh being drawn, in the vertex shader's third buffer.
+	quantisation_buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+	quantisation_buffer_desc.ByteWidth = sizeof(QuantisationBufferType);
+	quantisation_buffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	quantisation_buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	quantisation_buffer_desc.MiscFlags = 0;
+	quantisation_buffer_desc.StructureByteStride = 0;
+	renderer->CreateBuffer(&quantisation_buffer_desc, NULL, &quantisation_buffer_);
+}
+
+//	Same as BaseShader::loadVertexShader, but the layout reads a PackedVertex.
+void PackedShader::loadPackedVertexShader(WCHAR* filename)
+{
+	ID3DBlob* vertexShaderBuffer = 0;
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[3];
+
+	// Reads compiled shader into buffer (bytecode).
+	HRESULT result = D3DReadFileToBlob(filename, &vertexShaderBuffer);
+	if (result != S_OK)
+	{
+		MessageBox(NULL, filename, L"File ERROR", MB_OK);
+		exit(0);
+	}
+
+	renderer->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader);
+
+	// Fractions of the mesh's box, with a spare fourth.
+	polygonLayout[0].SemanticName = "POSITION";
+	polygonLayout[0].SemanticIndex = 0;
+	polygonLayout[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+	polygonLayout[0].InputSlot = 0;
+	polygonLayout[0].AlignedByteOffset = 0;
+	polygonLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[0].InstanceDataStepRate = 0;
+
+	// The normal folded onto an octahedron.
+	polygonLayout[1].SemanticName = "NORMAL";
+	polygonLayout[1].SemanticIndex = 0;
+	polygonLayout[1].Format = DXGI_FORMAT_R16G16_SNORM;
+	polygonLayout[1].InputSlot = 0;
+	polygonLayout[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[1].InstanceDataStepRate = 0;
+
+	polygonLayout[2].SemanticName = "TEXCOORD";
+	polygonLayout[2].SemanticIndex = 0;
+	polygonLayout[2].Format = DXGI_FORMAT_R16G16_FLOAT;
+	polygonLayout[2].InputSlot = 0;
+	polygonLayout[2].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[2].InstanceDataStepRate = 0;
+
+	renderer->CreateInputLayout(polygonLayout, 3, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &layout);
+
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+}
+
+//	A mesh without a quantisation isn't packed, so can't be drawn with this shader and leaves the last one in place.
+//		The whole number of texture repeats taken off v doesn't change how the texture is sampled, so isn't needed here.
+void PackedShader::SetMeshParameters(ID3D11DeviceContext* deviceContext, const PackedVertex::Quantisation* quantisation)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	QuantisationBufferType* quantisation_ptr;
+
+	if (!quantisation)
+	{
+		return;
+	}
+
+	deviceContext->Map(quantisation_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	quantisation_ptr = (QuantisationBufferType*)mappedResource.pData;
+	quantisation_ptr->position_offset = XMFLOAT4(quantisation->offset.x, quantisation->offset.y, quantisation->offset.z, 0.0f);
+	quantisation_ptr->position_scale = XMFLOAT4(quantisation->scale.x, quantisation->scale.y, quantisation->scale.z, 0.0f);
+	deviceContext->Unmap(quantisation_buffer_, 0);
+	deviceContext->VSSetConstantBuffers(2, 1, &quantisation_buffer_);
+}
+
+void PackedShader::SetObjectParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX &worldMatrix)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	ObjectBufferType* dataPtr;
+	ColourBufferType* colour_ptr;
+
+	// Lock the constant buffer so it can be written to. The view and projection are already in the frame buffer.
+	deviceContext->Map(matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	dataPtr = (ObjectBufferType*)mappedResource.pData;
+	dataPtr->world = XMMatrixTranspose(worldMatrix);
+	deviceContext->Unmap(matrixBuffer, 0);
+	deviceContext->VSSetConstantBuffers(0, 1, &matrixBuffer);
+
+	deviceContext->Map(colour_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	colour_ptr = (ColourBufferType*)mappedResource.pData;
+	colour_ptr->colour = colour_;
+	colour_ptr->light_ambient = XMFLOAT4(0.3f, 0.3f, 0.3f, 1.0f);
+	colour_ptr->light_diffuse = XMFLOAT4(0.8f, 0.8f, 0.8f, 1.0f);
+	colour_ptr->light_direction = XMFLOAT4(2.0f, -2.0f, 1.0f, 0.0f);
+	deviceContext->Unmap(colour_buffer_, 0);
+	deviceContext->PSSetConstantBuffers(0, 1, &colour_buffer_);
+}
+
+void PackedShader::SetTexture(ID3D11ShaderResourceView* texture)
+{
+	texture_ = texture;
+}
+
+void PackedShader::SetColour(float r, float g, float b)
+{
+	colour_ = XMFLOAT4(r, g, b, 0.0f);
+}
+
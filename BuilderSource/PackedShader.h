@@ -0,0 +1,37 @@
+#pragma once
+
+#include "ColourShader.h"
+#include "PackedVertex.h"
+
+using namespace std;
+using namespace DirectX;
+
+//	Lit like the ColourShader, but reads meshes whose vertices are PackedVertex.
+//		Only draws packed PipeMeshes, whose quantisation comes with each draw and is handed to the vertex shader whenever the mesh changes.
+class PackedShader : public SceneShader
+{
+public:
+	PackedShader(ID3D11Device* device, HWND hwnd);
+	~PackedShader();
+	void SetMeshParameters(ID3D11DeviceContext* deviceContext, const PackedVertex::Quantisation* quantisation);
+	void SetObjectParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX &world);
+	void SetTexture(ID3D11ShaderResourceView* texture);
+	void SetColour(float r, float g, float b);
+
+private:
+	struct QuantisationBufferType
+	{
+		XMFLOAT4 position_offset;
+		XMFLOAT4 position_scale;
+	};
+
+	void initShader(WCHAR*, WCHAR*);
+	void loadPackedVertexShader(WCHAR* filename);
+
+private:
+	ID3D11Buffer* matrixBuffer;
+	ID3D11Buffer* colour_buffer_;
+	ID3D11Buffer* quantisation_buffer_;
+	ID3D11ShaderResourceView* texture_;
+	XMFLOAT4 colour_;
+};
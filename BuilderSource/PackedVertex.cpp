@@ -0,0 +1,109 @@
+#include "PackedVertex.h"
+#include <cmath>
+
+namespace
+{
+	const float unorm_max = 65535.0f;
+	const float snorm_max = 32767.0f;
+
+	float Sign(float value)
+	{
+		return (value < 0.0f) ? -1.0f : 1.0f;
+	}
+
+	float Clamp(float value, float min, float max)
+	{
+		return (value < min) ? min : ((value > max) ? max : value);
+	}
+}
+
+//	Fit the fractions to the box around a mesh. Flat sides of the box still get a scale, so nothing divides by zero.
+//		min_v is the lowest v of the mesh, whose whole number of repeats is taken off every vertex.
+PackedVertex::Quantisation PackedVertex::CalculateQuantisation(const XMFLOAT3& min, const XMFLOAT3& max, float min_v)
+{
+	Quantisation quantisation;
+	quantisation.offset = min;
+	quantisation.scale.x = (max.x > min.x) ? max.x - min.x : 1.0f;
+	quantisation.scale.y = (max.y > min.y) ? max.y - min.y : 1.0f;
+	quantisation.scale.z = (max.z > min.z) ? max.z - min.z : 1.0f;
+	quantisation.v_offset = floorf(min_v);
+	return quantisation;
+}
+
+PackedVertex PackedVertex::Encode(const XMFLOAT3& position, const XMFLOAT2& texture, const XMFLOAT3& normal, const Quantisation& quantisation)
+{
+	PackedVertex vertex;
+
+	vertex.position[0] = static_cast<unsigned short>(Clamp((position.x - quantisation.offset.x) / quantisation.scale.x, 0.0f, 1.0f) * unorm_max + 0.5f);
+	vertex.position[1] = static_cast<unsigned short>(Clamp((position.y - quantisation.offset.y) / quantisation.scale.y, 0.0f, 1.0f) * unorm_max + 0.5f);
+	vertex.position[2] = static_cast<unsigned short>(Clamp((position.z - quantisation.offset.z) / quantisation.scale.z, 0.0f, 1.0f) * unorm_max + 0.5f);
+	vertex.position[3] = 0;
+
+	XMFLOAT2 encoded = EncodeNormal(normal);
+	vertex.normal[0] = static_cast<short>(floorf(Clamp(encoded.x, -1.0f, 1.0f) * snorm_max + 0.5f));
+	vertex.normal[1] = static_cast<short>(floorf(Clamp(encoded.y, -1.0f, 1.0f) * snorm_max + 0.5f));
+
+	vertex.texture[0] = PackedVector::XMConvertFloatToHalf(texture.x);
+	vertex.texture[1] = PackedVector::XMConvertFloatToHalf(texture.y - quantisation.v_offset);
+
+	return vertex;
+}
+
+//	The opposite of Encode, as the shader reads it, except that v gets its whole repeats back.
+void PackedVertex::Decode(const PackedVertex& vertex, const Quantisation& quantisation, XMFLOAT3& position, XMFLOAT2& texture, XMFLOAT3& normal)
+{
+	position.x = quantisation.offset.x + quantisation.scale.x * (vertex.position[0] / unorm_max);
+	position.y = quantisation.offset.y + quantisation.scale.y * (vertex.position[1] / unorm_max);
+	position.z = quantisation.offset.z + quantisation.scale.z * (vertex.position[2] / unorm_max);
+
+	//	-32768 reads as -1, as it does on the GPU.
+	XMFLOAT2 encoded;
+	encoded.x = (vertex.normal[0] < -snorm_max) ? -1.0f : vertex.normal[0] / snorm_max;
+	encoded.y = (vertex.normal[1] < -snorm_max) ? -1.0f : vertex.normal[1] / snorm_max;
+	normal = DecodeNormal(encoded);
+
+	texture.x = PackedVector::XMConvertHalfToFloat(vertex.texture[0]);
+	texture.y = PackedVector::XMConvertHalfToFloat(vertex.texture[1]) + quantisation.v_offset;
+}
+
+//	Project the normal onto the octahedron |x| + |y| + |z| = 1, then fold the lower half out over the corners
+//		of the upper half, so the whole sphere lies flat in the square from (-1, -1) to (1, 1).
+XMFLOAT2 PackedVertex::EncodeNormal(const XMFLOAT3& normal)
+{
+	float length = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+	if (length <= 0.0f)
+	{
+		return XMFLOAT2(0.0f, 0.0f);
+	}
+
+	float x = normal.x / length;
+	float y = normal.y / length;
+	if (normal.z < 0.0f)
+	{
+		float folded_x = (1.0f - fabsf(y)) * Sign(x);
+		float folded_y = (1.0f - fabsf(x)) * Sign(y);
+		x = folded_x;
+		y = folded_y;
+	}
+
+	return XMFLOAT2(x, y);
+}
+
+XMFLOAT3 PackedVertex::DecodeNormal(const XMFLOAT2& encoded)
+{
+	float x = encoded.x;
+	float y = encoded.y;
+	float z = 1.0f - fabsf(x) - fabsf(y);
+
+	//	Unfold the corners back under the octahedron.
+	if (z < 0.0f)
+	{
+		float unfolded_x = (1.0f - fabsf(y)) * Sign(x);
+		float unfolded_y = (1.0f - fabsf(x)) * Sign(y);
+		x = unfolded_x;
+		y = unfolded_y;
+	}
+
+	float length = sqrtf(x * x + y * y + z * z);
+	return XMFLOAT3(x / length, y / length, z / length);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+using namespace DirectX;
+
+//	Compact form of the BaseMesh's vertex for the track's rails, 16 bytes rather than 32.
+//		The position is three 16 bit fractions of the box around the mesh it belongs to, so it keeps to under
+//			a millimetre across a chunk of track.
+//		The normal is folded onto an octahedron and kept as two signed 16 bit fractions.
+//		The texture coordinates are half floats. The rails' v runs on along the whole track, so it is stored less
+//			a whole number of texture repeats, which doesn't change how the texture is sampled.
+//	Read by the PackedShader, see packed_vs.hlsl.
+struct PackedVertex
+{
+	unsigned short position[4];
+	short normal[2];
+	PackedVector::HALF texture[2];
+
+	//	How the positions of one mesh are packed: position = offset + scale * fraction.
+	struct Quantisation
+	{
+		XMFLOAT3 offset;
+		XMFLOAT3 scale;
+		float v_offset;
+	};
+
+	static Quantisation CalculateQuantisation(const XMFLOAT3& min, const XMFLOAT3& max, float min_v);
+	static PackedVertex Encode(const XMFLOAT3& position, const XMFLOAT2& texture, const XMFLOAT3& normal, const Quantisation& quantisation);
+	static void Decode(const PackedVertex& vertex, const Quantisation& quantisation, XMFLOAT3& position, XMFLOAT2& texture, XMFLOAT3& normal);
+	static XMFLOAT2 EncodeNormal(const XMFLOAT3& normal);
+	static XMFLOAT3 DecodeNormal(const XMFLOAT2& encoded);
+};
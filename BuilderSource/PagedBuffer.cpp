@@ -0,0 +1,102 @@
+#include "PagedBuffer.h"
+
+PagedBuffer::PagedBuffer(BufferBackend* backend, unsigned int element_size, unsigned int page_size, bool index_buffer) :
+	backend_(backend), buffer_(nullptr), element_size_(element_size), page_size_(page_size), page_count_(0), index_buffer_(index_buffer)
+{
+	if (page_size_ == 0)
+	{
+		page_size_ = 1;
+	}
+}
+
+//	Make sure the buffer can hold element_count elements, resizing it if it is too small or more than a page too big.
+//		There is always at least one page, so the buffer can be bound even while it is empty.
+bool PagedBuffer::Reserve(unsigned int element_count)
+{
+	unsigned int needed = (element_count + page_size_ - 1) / page_size_;
+	if (needed == 0)
+	{
+		needed = 1;
+	}
+
+	if (buffer_ && (needed <= page_count_) && (page_count_ <= needed + 1))
+	{
+		return true;
+	}
+
+	void* buffer = backend_->CreateBuffer(needed * page_size_ * element_size_, index_buffer_);
+	if (!buffer)
+	{
+		return false;
+	}
+
+	Release();
+	buffer_ = buffer;
+	page_count_ = needed;
+
+	return true;
+}
+
+//	Replace the contents of the buffer, resizing it to fit first.
+bool PagedBuffer::Write(const void* data, unsigned int element_count)
+{
+	if (!Reserve(element_count))
+	{
+		return false;
+	}
+
+	if (element_count > 0)
+	{
+		backend_->WriteBuffer(buffer_, 0, data, element_count * element_size_, true);
+	}
+
+	return true;
+}
+
+//	Overwrite part of the buffer, keeping the rest. Never resizes, so the region has to fit in what was reserved.
+bool PagedBuffer::WriteRegion(unsigned int first_element, const void* data, unsigned int element_count)
+{
+	if (!buffer_ || (first_element + element_count > GetCapacity()))
+	{
+		return false;
+	}
+
+	if (element_count > 0)
+	{
+		backend_->WriteBuffer(buffer_, first_element * element_size_, data, element_count * element_size_, false);
+	}
+
+	return true;
+}
+
+//	Replace the contents of the buffer by filling it in place, for data that would otherwise be built
+//		in a copy only to be written here. Unmap once the first element_count elements are filled.
+void* PagedBuffer::Map(unsigned int element_count)
+{
+	if (!Reserve(element_count))
+	{
+		return nullptr;
+	}
+
+	return backend_->MapBuffer(buffer_, true);
+}
+
+void PagedBuffer::Unmap()
+{
+	backend_->UnmapBuffer(buffer_);
+}
+
+void PagedBuffer::Release()
+{
+	if (buffer_)
+	{
+		backend_->ReleaseBuffer(buffer_);
+		buffer_ = nullptr;
+	}
+	page_count_ = 0;
+}
+
+PagedBuffer::~PagedBuffer()
+{
+	Release();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+//	Where the memory behind a PagedBuffer lives. Buffers are only ever written, never read back.
+//	The D3D11 backend keeps them on the GPU. The memory backend keeps them in system memory, so the paging
+//		can be run without a device.
+class BufferBackend
+{
+public:
+	virtual ~BufferBackend() {}
+	virtual void* CreateBuffer(unsigned int byte_width, bool index_buffer) = 0;
+	virtual void WriteBuffer(void* buffer, unsigned int byte_offset, const void* data, unsigned int byte_count, bool discard) = 0;
+	virtual void* MapBuffer(void* buffer, bool discard) = 0;
+	virtual void UnmapBuffer(void* buffer) = 0;
+	virtual void ReleaseBuffer(void* buffer) = 0;
+};
+
+//	A buffer that is sized to the data put in it, in whole pages.
+//	It grows a page at a time when the data no longer fits, and gives memory back once the data has shrunk
+//		by more than a page, so adding and removing a piece at a page boundary doesn't reallocate every time.
+//	Resizing creates a new buffer and drops the old one without copying, as the track mesh is always
+//		rewritten in full when it changes.
+class PagedBuffer
+{
+public:
+	PagedBuffer(BufferBackend* backend, unsigned int element_size, unsigned int page_size, bool index_buffer);
+	bool Reserve(unsigned int element_count);
+	bool Write(const void* data, unsigned int element_count);
+	bool WriteRegion(unsigned int first_element, const void* data, unsigned int element_count);
+	void* Map(unsigned int element_count);
+	void Unmap();
+	void Release();
+	inline void* GetBuffer() const { return buffer_; }
+	inline unsigned int GetCapacity() const { return page_count_ * page_size_; }
+	inline unsigned int GetPageCount() const { return page_count_; }
+	inline unsigned int GetByteSize() const { return page_count_ * page_size_ * element_size_; }
+	~PagedBuffer();
+
+private:
+	BufferBackend* backend_;
+	void* buffer_;
+	unsigned int element_size_;
+	unsigned int page_size_;
+	unsigned int page_count_;
+	bool index_buffer_;
+};
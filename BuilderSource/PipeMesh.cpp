@@ -1,198 +1,262 @@
 #include "PipeMesh.h"
+#include "ProfileExtruder.h"
 #include <math.h>
 #include <cmath>
 
-PipeMesh::PipeMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, float radius, unsigned int max_segments, unsigned int slice_count)
+PipeMesh::PipeMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, float radius, unsigned int slice_count, bool packed) :
+	buffer_backend_(device, deviceContext)
 {
-	device_context_ = deviceContext;
 	radius_ = radius;
 	slice_count_ = slice_count;
-	max_segments_ = max_segments;
+	packed_ = packed;
+	wide_indices_ = false;
+	ring_capacity_ = 0;
+	quantisation_ = PackedVertex::CalculateQuantisation(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f);
 
 	initBuffers(device);
-
-	prev_index_count_ = 0;
-
-	//allow_indices_override_ = false;
 }
 
 PipeMesh::~PipeMesh()
 {
+	//	The paged buffers own the D3D buffers, so they must not be released again by the base mesh.
+	delete vertex_buffer_;
+	delete index_buffer_;
+	vertexBuffer = nullptr;
+	indexBuffer = nullptr;
+
 	// Run parent deconstructor
 	BaseMesh::~BaseMesh();
 }
 
+//	Pages hold four track pieces, of 30 circles each.
+//		Indices start out 16 bit, and are only widened once the vertex buffer grows past what they can reach.
 void PipeMesh::initBuffers(ID3D11Device* device)
 {
-	VertexType* vertices;
-	unsigned long* indices;
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData, indexData;
-
-	//	30 Circles per segment.
-	vertexCount = 30 * (slice_count_+1) * max_segments_;
-	indexCount = 30 * slice_count_ * 6 * max_segments_;
-
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
-
-	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType) * vertexCount;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-	// Give the subresource structure a pointer to the vertex data.
-	vertexData.pSysMem = vertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
-	// Now create the vertex buffer.
-	device->CreateBuffer(&vertexBufferDesc, &vertexData, &vertexBuffer);
-
-	// Set up the description of the static index buffer.
-	indexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	indexBufferDesc.ByteWidth = sizeof(unsigned long) * indexCount;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.StructureByteStride = 0;
-	// Give the subresource structure a pointer to the index data.
-	indexData.pSysMem = indices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
-	// Create the index buffer.
-	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-
-	delete[] indices;
-	indices = 0;
+	vertex_buffer_ = new PagedBuffer(&buffer_backend_, packed_ ? sizeof(PackedVertex) : sizeof(VertexType), circles_per_page * (slice_count_ + 1), false);
+	index_buffer_ = new PagedBuffer(&buffer_backend_, sizeof(unsigned short), circles_per_page * slice_count_ * 6, true);
+
+	vertex_buffer_->Reserve(0);
+	index_buffer_->Reserve(0);
+
+	vertexCount = 0;
+	indexCount = 0;
+	SetBuffers();
 }
 
-void PipeMesh::Update()
+//	Copy rings built by a ProfileExtruder into the vertex buffer, resizing it to fit.
+void PipeMesh::Upload(const std::vector<VertexType>& vertices)
 {
-	CalculateVertices();
-
-	if (vertices_.empty() || (vertices_.size() > vertexCount))
+	if (vertices.empty())
 	{
+		Clear();
 		return;
 	}
 
-	//	Update the vertex buffer.
-	D3D11_MAPPED_SUBRESOURCE vertex_mapped_resource;
-	ZeroMemory(&vertex_mapped_resource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-	
-	device_context_->Map(vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &vertex_mapped_resource);
-	memcpy(vertex_mapped_resource.pData, &vertices_[0], sizeof(VertexType) * vertices_.size());
-	device_context_->Unmap(vertexBuffer, 0);
-
+	Upload(&vertices[0], vertices.size());
+}
 
-	CalculateIndices();
+//	Upload part of a larger set of rings, such as one chunk of the track.
+//		Every pipe's rings are joined the same way, so the indices are only built again when the vertex buffer
+//		changes size, and the pipe is drawn with just as many of them as join up these rings.
+void PipeMesh::Upload(const VertexType* vertices, unsigned int vertex_count)
+{
+	const unsigned int ring_count = vertex_count / (slice_count_ + 1);
+	if (ring_count < 2)
+	{
+		Clear();
+		return;
+	}
 
-	if (indices_.size() > indexCount)
+	if (packed_)
+	{
+		PackedVertex* packed = static_cast<PackedVertex*>(vertex_buffer_->Map(vertex_count));
+		if (!packed)
+		{
+			Clear();
+			return;
+		}
+		Pack(vertices, vertex_count, packed);
+		vertex_buffer_->Unmap();
+	}
+	else if (!vertex_buffer_->Write(vertices, vertex_count))
 	{
+		Clear();
 		return;
 	}
 
-	//	Update the index buffer.
-	D3D11_MAPPED_SUBRESOURCE index_mapped_resource;
-	ZeroMemory(&index_mapped_resource, sizeof(D3D11_MAPPED_SUBRESOURCE));
+	if (!BuildRingIndices())
+	{
+		Clear();
+		return;
+	}
 
-	device_context_->Map(indexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &index_mapped_resource);
-	memcpy(index_mapped_resource.pData, &indices_[0], sizeof(unsigned long int) * indices_.size());
-	device_context_->Unmap(indexBuffer, 0);
+	vertexCount = vertex_count;
+	indexCount = (ring_count - 1) * slice_count_ * 6;
+	SetBuffers();
+}
 
+//	Make room for vertex_count vertices, to be filled in a region at a time. Anything already uploaded may be lost.
+void PipeMesh::Reserve(unsigned int vertex_count)
+{
+	vertex_buffer_->Reserve(vertex_count);
+	vertexCount = vertex_count;
+	SetBuffers();
+}
 
-	circle_data_.clear();
-	vertices_.clear();
-	indices_.clear();
+//	Overwrite part of the vertex buffer, leaving the rest as it is.
+//		Doesn't wait for the GPU to finish with the buffer, so should only be used on regions where drawing
+//		the old contents for one more frame doesn't matter.
+//	Only for pipes that aren't packed, as the rest of a packed pipe's vertices are fitted to a box that the region may not fit.
+void PipeMesh::UploadRegion(unsigned int first_vertex, const std::vector<VertexType>& vertices)
+{
+	if (!vertices.empty() && !packed_)
+	{
+		vertex_buffer_->WriteRegion(first_vertex, &vertices[0], vertices.size());
+	}
 }
 
-void PipeMesh::Clear()
+//	Replace the index buffer without touching the vertices, for pipes that aren't joined as one run of rings.
+//		The indices should only reach vertices that have been reserved.
+void PipeMesh::SetIndices(const std::vector<unsigned long>& indices)
 {
-	//	Update the index buffer.
-	D3D11_MAPPED_SUBRESOURCE index_mapped_resource;
-	ZeroMemory(&index_mapped_resource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-	
-	std::vector<unsigned long> indices;
-	for (int i = 0; i < indexCount; i++)
+	ring_capacity_ = 0;
+
+	if (indices.empty() || !WriteIndices(&indices[0], indices.size()))
 	{
-		indices.push_back(-1);
+		indexCount = 0;
+		return;
 	}
 
-	device_context_->Map(indexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &index_mapped_resource);
+	indexCount = indices.size();
+	SetBuffers();
+}
 
-	memcpy(index_mapped_resource.pData, &indices[0], sizeof(unsigned long) * indexCount);
+//	Join up every ring the vertex buffer has room for, unless that has already been done for its current size.
+//		The indices are written straight into the mapped index buffer, at whichever size it is.
+bool PipeMesh::BuildRingIndices()
+{
+	const unsigned int ring_capacity = vertex_buffer_->GetCapacity() / (slice_count_ + 1);
+	if (ring_capacity == ring_capacity_)
+	{
+		return true;
+	}
 
-	device_context_->Unmap(indexBuffer, 0);
+	void* indices = MapIndices((ring_capacity - 1) * slice_count_ * 6);
+	if (!indices)
+	{
+		ring_capacity_ = 0;
+		return false;
+	}
 
-	prev_index_count_ = 0;
+	if (wide_indices_)
+	{
+		ProfileExtruder::WriteIndices(ring_capacity, slice_count_, static_cast<unsigned long*>(indices));
+	}
+	else
+	{
+		ProfileExtruder::WriteIndices(ring_capacity, slice_count_, static_cast<unsigned short*>(indices));
+	}
+	index_buffer_->Unmap();
 
+	ring_capacity_ = ring_capacity;
+	return true;
 }
 
-void PipeMesh::CalculateVertices()
+//	Copy indices into the index buffer, narrowing them on the way if it is 16 bit.
+bool PipeMesh::WriteIndices(const unsigned long* indices, unsigned int index_count)
 {
-	float slice_angle = 2.0f * 3.14159265359f / slice_count_;
+	void* mapped = MapIndices(index_count);
+	if (!mapped)
+	{
+		return false;
+	}
 
-	for (int j = 0; j < circle_data_.size(); j++)
+	if (wide_indices_)
+	{
+		unsigned long* wide = static_cast<unsigned long*>(mapped);
+		for (unsigned int i = 0; i < index_count; i++)
+		{
+			wide[i] = indices[i];
+		}
+	}
+	else
 	{
-		for (int i = 0; i <= slice_count_; i++)
+		unsigned short* narrow = static_cast<unsigned short*>(mapped);
+		for (unsigned int i = 0; i < index_count; i++)
 		{
-			VertexType vertex;
-			XMVECTOR pos = circle_data_[j].centre + (radius_ * cosf(slice_angle * i) * circle_data_[j].x_axis)
-				+ (radius_ * sinf(slice_angle * i) * circle_data_[j].y_axis);
-			vertex.position = XMFLOAT3(XMVectorGetX(pos), XMVectorGetY(pos), XMVectorGetZ(pos));
-			
-			vertex.texture = XMFLOAT2(((float)i / slice_count_), (1.0f - ((float)j / circle_data_.size())) * 40.0f);
+			narrow[i] = static_cast<unsigned short>(indices[i]);
+		}
+	}
+	index_buffer_->Unmap();
 
-			XMVECTOR normal = XMVector3Normalize(pos - circle_data_[j].centre);
-			vertex.normal = XMFLOAT3(XMVectorGetX(normal), XMVectorGetY(normal), XMVectorGetZ(normal));
+	return true;
+}
 
-			vertices_.push_back(vertex);
-		}
+//	Size the index buffer for index_count indices at the narrowest size that can reach every vertex in the
+//		vertex buffer, and map it to be written. Unmap it once they are all written.
+//		Changing size needs a new index buffer, which only happens when the vertex buffer crosses 65536 vertices.
+void* PipeMesh::MapIndices(unsigned int index_count)
+{
+	const bool wide = (vertex_buffer_->GetCapacity() > 65536);
+	if (wide != wide_indices_)
+	{
+		delete index_buffer_;
+		index_buffer_ = new PagedBuffer(&buffer_backend_, wide ? sizeof(unsigned long) : sizeof(unsigned short), circles_per_page * slice_count_ * 6, true);
+		wide_indices_ = wide;
 	}
+
+	return index_buffer_->Map(index_count);
 }
 
-void PipeMesh::CalculateIndices()
+//	Fit the quantisation to the vertices, and pack them straight into the mapped vertex buffer.
+//		The buffer is only written to, as reading back from it is slow.
+void PipeMesh::Pack(const VertexType* vertices, unsigned int vertex_count, PackedVertex* packed)
 {
-	for (int i = 0; i < circle_data_.size() - 1; i++)
+	XMVECTOR min = XMLoadFloat3(&vertices[0].position);
+	XMVECTOR max = min;
+	float min_v = vertices[0].texture.y;
+	for (unsigned int i = 1; i < vertex_count; i++)
 	{
-		for (int j = 0; j < slice_count_; j++)
-		{
-			indices_.push_back(i * (slice_count_ + 1) + j);
-			indices_.push_back((i + 1) * (slice_count_ + 1) + j);
-			indices_.push_back((i + 1) * (slice_count_ + 1) + (j + 1));
+		XMVECTOR position = XMLoadFloat3(&vertices[i].position);
+		min = XMVectorMin(min, position);
+		max = XMVectorMax(max, position);
+		min_v = (vertices[i].texture.y < min_v) ? vertices[i].texture.y : min_v;
+	}
 
-			indices_.push_back(i * (slice_count_ + 1) + j);
-			indices_.push_back((i + 1) * (slice_count_ + 1) + (j + 1));
-			indices_.push_back(i * (slice_count_ + 1) + (j + 1));
-		}
+	XMFLOAT3 box_min, box_max;
+	XMStoreFloat3(&box_min, min);
+	XMStoreFloat3(&box_max, max);
+	quantisation_ = PackedVertex::CalculateQuantisation(box_min, box_max, min_v);
+
+	for (unsigned int i = 0; i < vertex_count; i++)
+	{
+		packed[i] = PackedVertex::Encode(vertices[i].position, vertices[i].texture, vertices[i].normal, quantisation_);
 	}
+}
 
-	//	Ensure that if the number of indices have decreased, the old indices are overwritten.
-	if (indices_.size() < prev_index_count_)
+//	Stop drawing the pipe, and shrink its buffers to a single page if they have more than two.
+//		A buffer of one or two pages is kept as it is, like any buffer within a page of its size.
+//		The indices are kept if the buffers weren't resized, and otherwise built again on the next upload.
+void PipeMesh::Clear()
+{
+	const unsigned int ring_capacity = ring_capacity_;
+	vertex_buffer_->Reserve(0);
+	index_buffer_->Reserve(0);
+	if (vertex_buffer_->GetCapacity() / (slice_count_ + 1) != ring_capacity)
 	{
-		for (int k = indices_.size()-1; k < prev_index_count_; k++)
-		{
-			indices_.push_back(-1);
-		}
+		ring_capacity_ = 0;
 	}
 
-	prev_index_count_ = indices_.size();
+	vertexCount = 0;
+	indexCount = 0;
+	SetBuffers();
 }
 
-void PipeMesh::AddCircleOrigin(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis)
+//	Resizing creates new buffers, so the base mesh has to be pointed at them again.
+void PipeMesh::SetBuffers()
 {
-	CircleData circle;
-	
-	circle.centre = centre;
-	circle.x_axis = x_axis;
-	circle.y_axis = y_axis;
-
-	circle_data_.push_back(circle);
+	vertexBuffer = static_cast<ID3D11Buffer*>(vertex_buffer_->GetBuffer());
+	indexBuffer = static_cast<ID3D11Buffer*>(index_buffer_->GetBuffer());
 }
 
 void PipeMesh::sendData(ID3D11DeviceContext* deviceContext)
@@ -201,11 +265,11 @@ void PipeMesh::sendData(ID3D11DeviceContext* deviceContext)
 	unsigned int offset;
 
 	// Set vertex buffer stride and offset.
-	stride = sizeof(VertexType);
+	stride = packed_ ? sizeof(PackedVertex) : sizeof(VertexType);
 	offset = 0;
 
 	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
-	deviceContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	deviceContext->IASetIndexBuffer(indexBuffer, wide_indices_ ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
 	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 }
 
@@ -2,22 +2,33 @@
 #pragma once
 
 #include "../DXFramework/BaseMesh.h"
+#include "D3D11BufferBackend.h"
+#include "PackedVertex.h"
 #include <vector>
 
 using namespace DirectX;
 
+//	The buffers are sized to the track in pages, so there is no limit on the number of segments.
+//	The rings are always joined up the same way, so the indices are built when the buffers change size rather than
+//		uploaded with the vertices, and are 16 bit for as long as they can reach every vertex.
+//	A packed pipe keeps its vertices as PackedVertex, half the size, and must be drawn with the PackedShader.
+//		Its vertices are packed as they are uploaded, fitted to the box around them.
 class PipeMesh : public BaseMesh
 {
 
 public:
-	PipeMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, float radius, unsigned int max_segments, unsigned int slice_count = 10);
-	void Update();
-	void AddCircleOrigin(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis);
-	void CalculateVertices();
-	void CalculateIndices();
+	using BaseMesh::VertexType;
+
+	PipeMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, float radius, unsigned int slice_count = 10, bool packed = false);
+	void Upload(const std::vector<VertexType>& vertices);
+	void Upload(const VertexType* vertices, unsigned int vertex_count);
+	void Reserve(unsigned int vertex_count);
+	void UploadRegion(unsigned int first_vertex, const std::vector<VertexType>& vertices);
+	void SetIndices(const std::vector<unsigned long>& indices);
 	void Clear();
-	//inline void AllowIndicesOverride() { allow_indices_override_ = true; }
-	inline void SetSliceCount(int slice_count) { slice_count_ = slice_count; }
+	inline unsigned int GetBufferBytes() const { return vertex_buffer_->GetByteSize() + index_buffer_->GetByteSize(); }
+	inline bool IsPacked() const { return packed_; }
+	inline const PackedVertex::Quantisation& GetQuantisation() const { return quantisation_; }
 	void sendData(ID3D11DeviceContext* deviceContext);
 	~PipeMesh();
 
@@ -26,20 +37,25 @@ protected:
 	int resolution;
 
 private:
-	struct CircleData
-	{
-		XMVECTOR centre;
-		XMVECTOR x_axis;
-		XMVECTOR y_axis;
-	};
-
-	ID3D11DeviceContext* device_context_;
-	std::vector<VertexType> vertices_;
-	std::vector<unsigned long int> indices_;
-	unsigned int prev_index_count_;
-	std::vector<CircleData> circle_data_;
+	void SetBuffers();
+	void Pack(const VertexType* vertices, unsigned int vertex_count, PackedVertex* packed);
+	bool BuildRingIndices();
+	bool WriteIndices(const unsigned long* indices, unsigned int index_count);
+	void* MapIndices(unsigned int index_count);
+
+private:
+	static const unsigned int circles_per_page = 4 * 30;
+
+	D3D11BufferBackend buffer_backend_;
+	PagedBuffer* vertex_buffer_;
+	PagedBuffer* index_buffer_;
 	unsigned int slice_count_;
 	float radius_;
-	unsigned int max_segments_;
+	bool packed_;
+	PackedVertex::Quantisation quantisation_;
+
+	//	Rings the index buffer joins up, or 0 if it has to be built again.
+	unsigned int ring_capacity_;
+	bool wide_indices_;
 };
 
@@ -0,0 +1,139 @@
+#include "ProfileExtruder.h"
+#include <math.h>
+#include <cmath>
+
+namespace
+{
+	//	Sweep point_count profile points around each ring. When POINT_COUNT isn't zero it's the same as
+	//		point_count, and the compiler can unroll the inner loop.
+	template <unsigned int POINT_COUNT>
+	void ExtrudeRings(const XMFLOAT4* points, const float* u, unsigned int point_count,
+		const ProfileExtruder::Ring* rings, unsigned int ring_count, ProfileExtruder::VertexType* vertices)
+	{
+		const unsigned int count = (POINT_COUNT > 0) ? POINT_COUNT : point_count;
+
+		for (unsigned int i = 0; i < ring_count; i++)
+		{
+			const ProfileExtruder::Ring& ring = rings[i];
+			XMVECTOR centre = XMLoadFloat3(&ring.centre);
+			XMVECTOR x_axis = XMLoadFloat3(&ring.x_axis);
+			XMVECTOR y_axis = XMLoadFloat3(&ring.y_axis);
+
+			//	Normals only need the directions of the axes, so they are normalised once per ring rather than per vertex.
+			XMVECTOR x_normal = XMVector3Normalize(x_axis);
+			XMVECTOR y_normal = XMVector3Normalize(y_axis);
+
+			for (unsigned int j = 0; j < count; j++)
+			{
+				XMVECTOR point = XMLoadFloat4(&points[j]);
+				XMVECTOR position = XMVectorMultiplyAdd(y_axis, XMVectorSplatY(point), XMVectorMultiplyAdd(x_axis, XMVectorSplatX(point), centre));
+				XMVECTOR normal = XMVectorMultiplyAdd(y_normal, XMVectorSplatW(point), x_normal * XMVectorSplatZ(point));
+
+				ProfileExtruder::VertexType& vertex = vertices[j];
+				XMStoreFloat3(&vertex.position, position);
+				vertex.texture = XMFLOAT2(u[j], ring.v);
+				XMStoreFloat3(&vertex.normal, normal);
+			}
+
+			vertices += count;
+		}
+	}
+}
+
+ProfileExtruder::ProfileExtruder()
+{
+}
+
+//	A round profile, with the seam where the texture wraps around doubled up so it can have u of both 0 and 1.
+void ProfileExtruder::SetCircle(float radius, unsigned int slice_count, XMFLOAT2 offset)
+{
+	points_.clear();
+	u_.clear();
+
+	float slice_angle = 2.0f * 3.14159265359f / slice_count;
+	for (unsigned int i = 0; i <= slice_count; i++)
+	{
+		float cos_angle = cosf(slice_angle * i);
+		float sin_angle = sinf(slice_angle * i);
+
+		points_.push_back(XMFLOAT4(offset.x + radius * cos_angle, offset.y + radius * sin_angle, cos_angle, sin_angle));
+		u_.push_back((float)i / slice_count);
+	}
+}
+
+//	Write GetPointCount() vertices for each ring, one ring after another.
+void ProfileExtruder::Extrude(const Ring* rings, unsigned int ring_count, VertexType* vertices) const
+{
+	if (points_.empty() || (ring_count == 0))
+	{
+		return;
+	}
+
+	const XMFLOAT4* points = &points_[0];
+	const float* u = &u_[0];
+	const unsigned int point_count = points_.size();
+
+	//	Circles of 3, 4, 6, 8 and 10 slices.
+	switch (point_count)
+	{
+	case 4:
+		ExtrudeRings<4>(points, u, point_count, rings, ring_count, vertices);
+		break;
+	case 5:
+		ExtrudeRings<5>(points, u, point_count, rings, ring_count, vertices);
+		break;
+	case 7:
+		ExtrudeRings<7>(points, u, point_count, rings, ring_count, vertices);
+		break;
+	case 9:
+		ExtrudeRings<9>(points, u, point_count, rings, ring_count, vertices);
+		break;
+	case 11:
+		ExtrudeRings<11>(points, u, point_count, rings, ring_count, vertices);
+		break;
+	default:
+		ExtrudeRings<0>(points, u, point_count, rings, ring_count, vertices);
+		break;
+	}
+}
+
+//	Add the rings onto the end of vertices.
+void ProfileExtruder::Extrude(const Ring* rings, unsigned int ring_count, std::vector<VertexType>& vertices) const
+{
+	unsigned int first_vertex = vertices.size();
+	vertices.resize(first_vertex + ring_count * points_.size());
+
+	if (vertices.size() > first_vertex)
+	{
+		Extrude(rings, ring_count, &vertices[first_vertex]);
+	}
+}
+
+//	Join each ring of vertices to the next with a band of triangles. Indices count from the first ring.
+//		The profile is a circle with its seam doubled up, so it has one more point than it has slices.
+void ProfileExtruder::CalculateIndices(unsigned int ring_count, std::vector<unsigned long>& indices) const
+{
+	if (points_.empty())
+	{
+		return;
+	}
+
+	CalculateIndices(ring_count, points_.size() - 1, indices);
+}
+
+//	Join rings of slice_count + 1 vertices, adding the indices to the end of the list.
+void ProfileExtruder::CalculateIndices(unsigned int ring_count, unsigned int slice_count, std::vector<unsigned long>& indices)
+{
+	if (ring_count < 2)
+	{
+		return;
+	}
+
+	unsigned int first_index = indices.size();
+	indices.resize(first_index + (ring_count - 1) * slice_count * 6);
+	WriteIndices(ring_count, slice_count, &indices[first_index]);
+}
+
+ProfileExtruder::~ProfileExtruder()
+{
+}
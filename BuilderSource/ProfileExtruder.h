@@ -0,0 +1,63 @@
+#pragma once
+
+#include "PipeMesh.h"
+#include <vector>
+
+using namespace DirectX;
+
+//	Sweeps a round cross section along a run of frames, such as the rails and supports.
+//	The profile's points, normals and texture coordinates are worked out once when it is set, so each vertex of
+//		each ring is just a few multiply-adds, written straight into the destination. The loop over the points
+//		is unrolled at compile time for the slice counts the track uses.
+//	Does not touch the GPU, so can run on any thread.
+class ProfileExtruder
+{
+public:
+	typedef PipeMesh::VertexType VertexType;
+
+	//	Where a profile is placed. The axes should be at right angles. v is the texture coordinate along the sweep.
+	struct Ring
+	{
+		XMFLOAT3 centre;
+		XMFLOAT3 x_axis;
+		XMFLOAT3 y_axis;
+		float v;
+	};
+
+	ProfileExtruder();
+	void SetCircle(float radius, unsigned int slice_count, XMFLOAT2 offset = XMFLOAT2(0.0f, 0.0f));
+	void Extrude(const Ring* rings, unsigned int ring_count, VertexType* vertices) const;
+	void Extrude(const Ring* rings, unsigned int ring_count, std::vector<VertexType>& vertices) const;
+	void CalculateIndices(unsigned int ring_count, std::vector<unsigned long>& indices) const;
+	static void CalculateIndices(unsigned int ring_count, unsigned int slice_count, std::vector<unsigned long>& indices);
+	template<class T>
+	static void WriteIndices(unsigned int ring_count, unsigned int slice_count, T* indices);
+	inline unsigned int GetPointCount() const { return points_.size(); }
+	~ProfileExtruder();
+
+private:
+	//	Position in (x, y), outward normal in (z, w).
+	std::vector<XMFLOAT4> points_;
+	std::vector<float> u_;
+};
+
+//	Join each ring of slice_count + 1 vertices to the next with a band of triangles,
+//		writing (ring_count - 1) * slice_count * 6 indices of whichever size the index buffer is.
+template<class T>
+void ProfileExtruder::WriteIndices(unsigned int ring_count, unsigned int slice_count, T* indices)
+{
+	for (unsigned int i = 0; i + 1 < ring_count; i++)
+	{
+		for (unsigned int j = 0; j < slice_count; j++)
+		{
+			indices[0] = static_cast<T>(i * (slice_count + 1) + j);
+			indices[1] = static_cast<T>((i + 1) * (slice_count + 1) + j);
+			indices[2] = static_cast<T>((i + 1) * (slice_count + 1) + (j + 1));
+
+			indices[3] = static_cast<T>(i * (slice_count + 1) + j);
+			indices[4] = static_cast<T>((i + 1) * (slice_count + 1) + (j + 1));
+			indices[5] = static_cast<T>(i * (slice_count + 1) + (j + 1));
+			indices += 6;
+		}
+	}
+}
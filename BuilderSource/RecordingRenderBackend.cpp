@@ -0,0 +1,49 @@
+#include "RecordingRenderBackend.h"
+
+RecordingRenderBackend::RecordingRenderBackend()
+{
+	Reset();
+}
+
+void RecordingRenderBackend::SetFrame(const XMMATRIX& view, const XMMATRIX& projection)
+{
+	frame_count_++;
+}
+
+void RecordingRenderBackend::SetShader(SceneShader* shader)
+{
+	shader_changes_++;
+}
+
+void RecordingRenderBackend::SetTexture(ID3D11ShaderResourceView* texture)
+{
+	texture_changes_++;
+}
+
+void RecordingRenderBackend::SetMesh(BaseMesh* mesh, const PackedVertex::Quantisation* quantisation)
+{
+	mesh_changes_++;
+}
+
+void RecordingRenderBackend::Draw(const DrawItem& item)
+{
+	draw_calls_++;
+	instances_drawn_ += item.instance_buffer ? item.instance_count : 1;
+	drawn_meshes_.push_back(item.mesh);
+}
+
+//	Start counting again from nothing.
+void RecordingRenderBackend::Reset()
+{
+	frame_count_ = 0;
+	shader_changes_ = 0;
+	texture_changes_ = 0;
+	mesh_changes_ = 0;
+	draw_calls_ = 0;
+	instances_drawn_ = 0;
+	drawn_meshes_.clear();
+}
+
+RecordingRenderBackend::~RecordingRenderBackend()
+{
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "RenderQueue.h"
+
+//	Counts what the RenderQueue asks for instead of drawing it, standing in for the GPU so the sorting and
+//		batching of a frame can be checked without a device.
+class RecordingRenderBackend : public RenderBackend
+{
+public:
+	RecordingRenderBackend();
+	void SetFrame(const XMMATRIX& view, const XMMATRIX& projection);
+	void SetShader(SceneShader* shader);
+	void SetTexture(ID3D11ShaderResourceView* texture);
+	void SetMesh(BaseMesh* mesh, const PackedVertex::Quantisation* quantisation);
+	void Draw(const DrawItem& item);
+	void Reset();
+	inline unsigned int GetFrameCount() const { return frame_count_; }
+	inline unsigned int GetShaderChanges() const { return shader_changes_; }
+	inline unsigned int GetTextureChanges() const { return texture_changes_; }
+	inline unsigned int GetMeshChanges() const { return mesh_changes_; }
+	inline unsigned int GetDrawCalls() const { return draw_calls_; }
+	inline unsigned int GetInstancesDrawn() const { return instances_drawn_; }
+	inline const std::vector<const BaseMesh*>& GetDrawnMeshes() const { return drawn_meshes_; }
+	~RecordingRenderBackend();
+
+private:
+	unsigned int frame_count_;
+	unsigned int shader_changes_;
+	unsigned int texture_changes_;
+	unsigned int mesh_changes_;
+	unsigned int draw_calls_;
+	unsigned int instances_drawn_;
+
+	//	The mesh of each draw, in the order they were drawn.
+	std::vector<const BaseMesh*> drawn_meshes_;
+};
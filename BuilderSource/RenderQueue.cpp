@@ -0,0 +1,179 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace
+{
+	//	Where each id sits in a key. Shaders and textures have 16 bits each, and meshes the lower 32.
+	const int shader_shift = 48;
+	const int texture_shift = 32;
+	const unsigned long long max_shader_id = 0xFFFF;
+	const unsigned long long max_texture_id = 0xFFFF;
+	const unsigned long long max_mesh_id = 0xFFFFFFFF;
+}
+
+RenderQueue::RenderQueue()
+{
+	shader_ids_.count = 0;
+	texture_ids_.count = 0;
+	mesh_ids_.count = 0;
+
+	XMStoreFloat4x4(&view_, XMMatrixIdentity());
+	XMStoreFloat4x4(&projection_, XMMatrixIdentity());
+}
+
+//	Start collecting a frame seen through view and projection, which every draw in it shares.
+void RenderQueue::Begin(const XMMATRIX& view, const XMMATRIX& projection)
+{
+	items_.clear();
+	order_.clear();
+	ClearIds(shader_ids_);
+	ClearIds(texture_ids_);
+	ClearIds(mesh_ids_);
+	XMStoreFloat4x4(&view_, view);
+	XMStoreFloat4x4(&projection_, projection);
+}
+
+void RenderQueue::Submit(const DrawItem& item)
+{
+	unsigned long long shader = GetId(shader_ids_, item.shader);
+	unsigned long long texture = GetId(texture_ids_, item.texture);
+	unsigned long long mesh = GetId(mesh_ids_, item.mesh);
+
+	//	More of any of these in one frame than the key has room for would sort them wrongly.
+	assert(shader <= max_shader_id);
+	assert(texture <= max_texture_id);
+	assert(mesh <= max_mesh_id);
+
+	SortEntry entry;
+	entry.key = (shader << shader_shift) | (texture << texture_shift) | mesh;
+	entry.item = items_.size();
+
+	items_.push_back(item);
+	order_.push_back(entry);
+}
+
+//	Sort the frame's draws and send them to the backend, setting the view and projection once for all of them.
+//		What is bound is forgotten between frames, as other drawing happens in between.
+void RenderQueue::Flush(RenderBackend* backend)
+{
+	std::sort(order_.begin(), order_.end(), SortBefore);
+
+	backend->SetFrame(XMLoadFloat4x4(&view_), XMLoadFloat4x4(&projection_));
+
+	SceneShader* shader = nullptr;
+	ID3D11ShaderResourceView* texture = nullptr;
+	BaseMesh* mesh = nullptr;
+
+	for (int i = 0; i < order_.size(); i++)
+	{
+		const DrawItem& item = items_[order_[i].item];
+
+		//	Some shaders take parameters from the mesh, so the mesh is set again with each new shader.
+		if (item.shader != shader)
+		{
+			backend->SetShader(item.shader);
+			shader = item.shader;
+			mesh = nullptr;
+		}
+
+		if (item.texture && (item.texture != texture))
+		{
+			backend->SetTexture(item.texture);
+			texture = item.texture;
+		}
+
+		if (item.mesh != mesh)
+		{
+			backend->SetMesh(item.mesh, item.quantisation);
+			mesh = item.mesh;
+		}
+
+		backend->Draw(item);
+	}
+
+	items_.clear();
+	order_.clear();
+}
+
+unsigned int RenderQueue::GetId(IdTable& table, const void* pointer)
+{
+	if (!pointer)
+	{
+		return 0;
+	}
+
+	if (table.count > 0)
+	{
+		unsigned int slot = FindSlot(table, pointer);
+		if (table.pointers[slot])
+		{
+			return table.ids[slot];
+		}
+	}
+
+	//	Kept at most half full, so the probes stay short.
+	if ((table.count + 1) * 2 > table.pointers.size())
+	{
+		GrowIds(table);
+	}
+
+	unsigned int slot = FindSlot(table, pointer);
+	table.count++;
+	table.pointers[slot] = pointer;
+	table.ids[slot] = table.count;
+
+	return table.count;
+}
+
+//	The slot holding pointer, or the empty slot where it would go.
+unsigned int RenderQueue::FindSlot(const IdTable& table, const void* pointer)
+{
+	const unsigned int mask = table.pointers.size() - 1;
+
+	//	Resources are aligned, so the low bits are dropped before the bits are mixed.
+	unsigned int slot = (unsigned int)(((uintptr_t)pointer >> 4) * 2654435761u) & mask;
+	while (table.pointers[slot] && (table.pointers[slot] != pointer))
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	return slot;
+}
+
+//	Double the number of slots, which is always a power of two, and put the pointers back in.
+void RenderQueue::GrowIds(IdTable& table)
+{
+	std::vector<const void*> pointers(table.pointers.empty() ? 64 : table.pointers.size() * 2, nullptr);
+	std::vector<unsigned int> ids(pointers.size(), 0);
+	pointers.swap(table.pointers);
+	ids.swap(table.ids);
+
+	for (int i = 0; i < pointers.size(); i++)
+	{
+		if (pointers[i])
+		{
+			unsigned int slot = FindSlot(table, pointers[i]);
+			table.pointers[slot] = pointers[i];
+			table.ids[slot] = ids[i];
+		}
+	}
+}
+
+void RenderQueue::ClearIds(IdTable& table)
+{
+	std::fill(table.pointers.begin(), table.pointers.end(), nullptr);
+	table.count = 0;
+}
+
+//	By key, then by the order they were submitted in.
+bool RenderQueue::SortBefore(const SortEntry& a, const SortEntry& b)
+{
+	return (a.key < b.key) || ((a.key == b.key) && (a.item < b.item));
+}
+
+RenderQueue::~RenderQueue()
+{
+}
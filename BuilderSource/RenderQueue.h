@@ -0,0 +1,97 @@
+#pragma once
+
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <vector>
+#include "PackedVertex.h"
+
+class SceneShader;
+class BaseMesh;
+
+using namespace DirectX;
+
+//	One draw collected by the RenderQueue: what to draw it with, and where.
+struct DrawItem
+{
+	SceneShader* shader;
+	ID3D11ShaderResourceView* texture;
+	BaseMesh* mesh;
+
+	//	How the mesh's vertices are packed, for meshes drawn with the PackedShader, or nullptr.
+	const PackedVertex::Quantisation* quantisation;
+
+	unsigned int index_count;
+	XMFLOAT4X4 world;
+	XMFLOAT4 colour;
+
+	//	The placement of each copy of an instanced draw, read from slot 1, or nullptr to draw the mesh once.
+	ID3D11Buffer* instance_buffer;
+	unsigned int instance_stride;
+	unsigned int instance_count;
+};
+
+//	Where the RenderQueue sends its state changes and draws, which it only sends when something has changed.
+//	The D3D11 backend draws them. The recording backend counts them, so the batching can be checked without a device.
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() {}
+	virtual void SetFrame(const XMMATRIX& view, const XMMATRIX& projection) = 0;
+	virtual void SetShader(SceneShader* shader) = 0;
+	virtual void SetTexture(ID3D11ShaderResourceView* texture) = 0;
+	virtual void SetMesh(BaseMesh* mesh, const PackedVertex::Quantisation* quantisation) = 0;
+	virtual void Draw(const DrawItem& item) = 0;
+};
+
+//	Collects a frame's draws, then makes them in an order that changes as little state as it can.
+//	Each draw is given a key from its shader, then its texture, then its mesh, so sorting on the key brings draws
+//		that share them together. Draws with equal keys keep the order they were submitted in.
+//	The ids in the key are numbered afresh each frame, so meshes that are freed and rebuilt don't leave ids behind,
+//		and an address that is reused can't inherit an old id.
+//	Draws without a texture leave the last one bound, as the shaders always sample one. They have the id 0,
+//		so they are sorted before the shader's textured draws.
+//	Everything is kept between frames, so once the scene has been drawn once queueing it again doesn't allocate.
+class RenderQueue
+{
+public:
+	RenderQueue();
+	void Begin(const XMMATRIX& view, const XMMATRIX& projection);
+	void Submit(const DrawItem& item);
+	void Flush(RenderBackend* backend);
+	inline unsigned int GetDrawCount() const { return items_.size(); }
+	~RenderQueue();
+
+private:
+	struct SortEntry
+	{
+		unsigned long long key;
+		unsigned int item;
+	};
+
+	//	Numbers each pointer seen this frame from 1, in the order they were first seen. A null pointer is 0.
+	//		Open addressing over arrays that are kept between frames, so emptying it for the next frame doesn't free anything.
+	struct IdTable
+	{
+		std::vector<const void*> pointers;
+		std::vector<unsigned int> ids;
+		unsigned int count;
+	};
+
+	unsigned int GetId(IdTable& table, const void* pointer);
+	static unsigned int FindSlot(const IdTable& table, const void* pointer);
+	static void GrowIds(IdTable& table);
+	static void ClearIds(IdTable& table);
+	static bool SortBefore(const SortEntry& a, const SortEntry& b);
+
+private:
+	std::vector<DrawItem> items_;
+	std::vector<SortEntry> order_;
+
+	//	Small numbers for each shader, texture and mesh in the frame, to build the keys from.
+	IdTable shader_ids_;
+	IdTable texture_ids_;
+	IdTable mesh_ids_;
+
+	XMFLOAT4X4 view_;
+	XMFLOAT4X4 projection_;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+
+//	Keeps objects that are expensive to make, such as meshes with their own GPU buffers, for reuse instead of deleting them.
+//	An object is reached through a handle holding its slot and the slot's generation when it was handed out.
+//		Releasing the object moves its slot on a generation, so any handle still held to it stops resolving
+//		rather than reaching whatever the slot is reused for next.
+//	The pool owns its objects and deletes them all when it is destroyed.
+template <class T>
+class ResourcePool
+{
+public:
+	struct Handle
+	{
+		unsigned int index;
+		unsigned int generation;
+	};
+
+	ResourcePool()
+	{
+		created_count_ = 0;
+		reused_count_ = 0;
+	}
+
+	//	Hand out an object that was released earlier, if there is one.
+	bool Reuse(Handle& handle)
+	{
+		if (free_slots_.empty())
+		{
+			return false;
+		}
+
+		handle.index = free_slots_.back();
+		handle.generation = slots_[handle.index].generation;
+		free_slots_.pop_back();
+		reused_count_++;
+		return true;
+	}
+
+	//	Take ownership of a newly made object and hand it out.
+	Handle Add(T* object)
+	{
+		Slot slot;
+		slot.object = object;
+		slot.generation = 0;
+		slots_.push_back(slot);
+		created_count_++;
+
+		Handle handle;
+		handle.index = slots_.size() - 1;
+		handle.generation = 0;
+		return handle;
+	}
+
+	//	Give an object back to be handed out again. Handles to it stop resolving.
+	void Release(Handle handle)
+	{
+		if (!IsValid(handle))
+		{
+			return;
+		}
+
+		slots_[handle.index].generation++;
+		free_slots_.push_back(handle.index);
+	}
+
+	//	A slot that is free has moved on a generation since its last handle was given out, and won't be handed out
+	//		again until it's reused, so only handles to objects in use resolve.
+	inline bool IsValid(Handle handle) const
+	{
+		return (handle.index < slots_.size()) && (slots_[handle.index].generation == handle.generation);
+	}
+
+	inline T* Get(Handle handle) const { return IsValid(handle) ? slots_[handle.index].object : nullptr; }
+
+	//	Every object, whether in use or not, for reporting on all of them.
+	inline unsigned int GetSlotCount() const { return slots_.size(); }
+	inline T* GetSlot(unsigned int index) const { return slots_[index].object; }
+
+	inline unsigned int GetLiveCount() const { return slots_.size() - free_slots_.size(); }
+	inline unsigned int GetFreeCount() const { return free_slots_.size(); }
+	inline unsigned int GetCreatedCount() const { return created_count_; }
+	inline unsigned int GetReusedCount() const { return reused_count_; }
+
+	~ResourcePool()
+	{
+		for (int i = 0; i < slots_.size(); i++)
+		{
+			delete slots_[i].object;
+			slots_[i].object = nullptr;
+		}
+		slots_.clear();
+	}
+
+private:
+	struct Slot
+	{
+		T* object;
+		unsigned int generation;
+	};
+
+	std::vector<Slot> slots_;
+	std::vector<unsigned int> free_slots_;
+	unsigned int created_count_;
+	unsigned int reused_count_;
+};
@@ -0,0 +1,131 @@
+#include "RideAnalytics.h"
+
+#include "Track.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+RideAnalytics::RideAnalytics() : min_speed_(8.0f), sample_spacing_(0.5f)
+{
+	stats_ = Stats();
+}
+
+//	Simulate along the track at a fixed spacing and collect the stats.
+//		The track is left reset, ready to simulate from the start.
+void RideAnalytics::Analyse(Track* track)
+{
+	stats_ = Stats();
+
+	if (!track || track->GetTrackPieceCount() == 0)
+	{
+		return;
+	}
+
+	const float gravity = 9.81f;
+	const float track_length = track->GetTrackLength();
+
+	int sample_count = std::max(3, (int)ceilf(track_length / sample_spacing_) + 1);
+	const float step = track_length / (float)(sample_count - 1);
+
+	//	The highest point sets the energy of the train, so it has to be found before the speeds.
+	float max_height = -FLT_MAX;
+	float min_height = FLT_MAX;
+	for (int i = 0; i < sample_count; i++)
+	{
+		float height = track->GetPointAtDistance((float)i / (float)(sample_count - 1)).y;
+		max_height = std::max(max_height, height);
+		min_height = std::min(min_height, height);
+	}
+
+	stats_.length = track_length;
+	stats_.max_height = max_height;
+	stats_.max_drop = max_height - min_height;
+	stats_.max_vertical_g = -FLT_MAX;
+	stats_.min_vertical_g = FLT_MAX;
+
+	SL::Vector world_up(0.0f, 1.0f, 0.0f);
+	SL::Vector previous_forward;
+	SL::Vector forward;
+
+	track->Reset();
+	track->UpdateSimulation(0.0f);
+	forward = track->GetTangent();
+
+	for (int i = 0; i < sample_count; i++)
+	{
+		float d = (float)i / (float)(sample_count - 1);
+		float height = track->GetPointAtDistance(d).y;
+
+		//	One sample ahead, so the curvature can be found with a central difference.
+		SL::Vector next_forward = forward;
+		DirectX::XMFLOAT3 up_value = track->GetUp();
+		DirectX::XMFLOAT3 right_value = track->GetRight();
+		if (i < sample_count - 1)
+		{
+			track->UpdateSimulation((float)(i + 1) / (float)(sample_count - 1));
+			next_forward = track->GetTangent();
+		}
+
+		SL::Vector curvature;
+		if (i > 0 && i < sample_count - 1)
+		{
+			curvature = next_forward.Subtract(previous_forward).Scaled(0.5f / step);
+		}
+
+		float speed_squared = min_speed_ * min_speed_ + 2.0f * gravity * (max_height - height);
+		float speed = sqrtf(speed_squared);
+
+		SL::Vector up(up_value.x, up_value.y, up_value.z);
+		SL::Vector right(right_value.x, right_value.y, right_value.z);
+		SL::Vector felt = curvature.Scaled(speed_squared).Add(world_up.Scaled(gravity));
+
+		float vertical_g = felt.Dot(up) / gravity;
+		float lateral_g = fabsf(felt.Dot(right)) / gravity;
+
+		stats_.max_speed = std::max(stats_.max_speed, speed);
+		stats_.max_vertical_g = std::max(stats_.max_vertical_g, vertical_g);
+		stats_.min_vertical_g = std::min(stats_.min_vertical_g, vertical_g);
+		stats_.max_lateral_g = std::max(stats_.max_lateral_g, lateral_g);
+
+		if (i < sample_count - 1)
+		{
+			float time = step / speed;
+			stats_.duration += time;
+			if (vertical_g < 0.0f)
+			{
+				stats_.airtime += time;
+			}
+		}
+
+		previous_forward = forward;
+		forward = next_forward;
+	}
+
+	track->Reset();
+}
+
+//	A rough score for how much fun the ride is. Speed, drops, airtime and strong positive g all add to it.
+float RideAnalytics::GetExcitement()
+{
+	float excitement = stats_.max_speed / 10.0f;
+	excitement += stats_.max_drop / 20.0f;
+	excitement += stats_.airtime;
+	excitement += std::max(0.0f, stats_.max_vertical_g - 1.0f) * 0.5f;
+	excitement += stats_.duration / 60.0f;
+
+	return excitement;
+}
+
+//	How far the forces go past what riders can comfortably take. Zero for a comfortable ride.
+float RideAnalytics::GetIntensity()
+{
+	float intensity = std::max(0.0f, stats_.max_vertical_g - 4.5f);
+	intensity += std::max(0.0f, -1.5f - stats_.min_vertical_g);
+	intensity += std::max(0.0f, stats_.max_lateral_g - 1.5f);
+
+	return intensity;
+}
+
+RideAnalytics::~RideAnalytics()
+{
+}
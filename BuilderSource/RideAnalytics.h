@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../Spline-Library/vector.h"
+
+class Track;
+
+//	Estimates what the ride is like to sit on.
+//	Speed comes from energy, with the train cresting the highest point at the minimum speed and losing nothing
+//		to friction. The forces felt by the rider are split into vertical and lateral parts using the track's frame,
+//		so banking is taken into account. All forces are in multiples of g.
+class RideAnalytics
+{
+public:
+	struct Stats
+	{
+		//	In metres.
+		float length;
+		float max_height;
+		float max_drop;
+
+		//	In metres per second, and seconds.
+		float max_speed;
+		float duration;
+
+		float max_vertical_g;
+		float min_vertical_g;
+		float max_lateral_g;
+
+		//	Seconds spent with less than zero vertical g.
+		float airtime;
+	};
+
+	RideAnalytics();
+	void Analyse(Track* track);
+	float GetExcitement();
+	float GetIntensity();
+	inline const Stats& GetStats() const { return stats_; }
+	inline void SetMinSpeed(float min_speed) { min_speed_ = min_speed; }
+	inline void SetSampleSpacing(float sample_spacing) { sample_spacing_ = sample_spacing; }
+	~RideAnalytics();
+
+private:
+	Stats stats_;
+	float min_speed_;
+	float sample_spacing_;
+};
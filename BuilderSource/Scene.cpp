@@ -0,0 +1,44 @@
+#include "Scene.h"
+#include "LineController.h"
+
+Scene::Scene()
+{
+	line_controller_ = nullptr;
+}
+
+void Scene::Add(MeshInstance* instance)
+{
+	objects_.push_back(instance);
+}
+
+void Scene::SetLineController(LineController* line_controller)
+{
+	line_controller_ = line_controller;
+}
+
+//	Draw all mesh instances that can be seen by the camera, sorted to change as little state between draws as possible.
+void Scene::Render(const XMMATRIX& view, const XMMATRIX& projection, RenderBackend* backend)
+{
+	Frustum frustum;
+	frustum.Build(view, projection);
+
+	render_queue_.Begin(view, projection);
+	for (int i = 0; i < objects_.size(); i++)
+	{
+		if (objects_[i]->InFrustum(frustum))
+		{
+			objects_[i]->Submit(render_queue_);
+		}
+	}
+
+	if (line_controller_)
+	{
+		line_controller_->Submit(render_queue_);
+	}
+
+	render_queue_.Flush(backend);
+}
+
+Scene::~Scene()
+{
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "MeshInstance.h"
+#include "RenderQueue.h"
+#include <vector>
+
+class LineController;
+
+//	Everything drawn in the 3D view, and the queue it is drawn through.
+//	Each frame the instances the camera can see are queued, along with the lines, then drawn by the backend with as
+//		few state changes as the queue can manage. Given a recording backend, a whole frame is drawn without a device.
+//	The scene only keeps pointers to what it draws, it doesn't own any of it.
+class Scene
+{
+public:
+	Scene();
+	void Add(MeshInstance* instance);
+	void SetLineController(LineController* line_controller);
+	void Render(const XMMATRIX& view, const XMMATRIX& projection, RenderBackend* backend);
+	inline unsigned int GetInstanceCount() const { return objects_.size(); }
+	~Scene();
+
+private:
+	std::vector<MeshInstance*> objects_;
+	LineController* line_controller_;
+	RenderQueue render_queue_;
+};
@@ -0,0 +1,25 @@
+#include "SceneShader.h"
+
+SceneShader::SceneShader(ID3D11Device* device, HWND hwnd) : BaseShader(device, hwnd)
+{
+}
+
+//	Make this the shader that draws, with its input layout and sampler.
+//		Only needs doing when the shader changes, as nothing else in a draw touches them.
+void SceneShader::Bind(ID3D11DeviceContext* context)
+{
+	context->IASetInputLayout(layout);
+
+	context->VSSetShader(vertexShader, NULL, 0);
+	context->PSSetShader(pixelShader, NULL, 0);
+	context->HSSetShader(NULL, NULL, 0);
+	context->DSSetShader(NULL, NULL, 0);
+	context->GSSetShader(NULL, NULL, 0);
+
+	context->PSSetSamplers(0, 1, &sampleState);
+}
+
+//	Called when the mesh being drawn changes, with how its vertices are packed, or nullptr if they aren't.
+void SceneShader::SetMeshParameters(ID3D11DeviceContext* context, const PackedVertex::Quantisation* quantisation)
+{
+}
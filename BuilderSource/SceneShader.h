@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../DXFramework/BaseShader.h"
+#include "PackedVertex.h"
+
+using namespace std;
+using namespace DirectX;
+
+//	A shader the RenderQueue can draw the scene with.
+//	The view and projection are the same for every draw in a frame, so they are kept in a constant buffer of their
+//		own in slot b1 of the vertex shader, written once a frame by the render backend. Each draw only sets the
+//		world matrix in slot b0, see SetObjectParameters.
+class SceneShader : public BaseShader
+{
+public:
+	//	What the render backend writes to slot b1 at the start of each frame.
+	struct FrameBufferType
+	{
+		XMMATRIX view;
+		XMMATRIX projection;
+	};
+
+	SceneShader(ID3D11Device* device, HWND hwnd);
+	void Bind(ID3D11DeviceContext* context);
+	virtual void SetMeshParameters(ID3D11DeviceContext* context, const PackedVertex::Quantisation* quantisation);
+	virtual void SetObjectParameters(ID3D11DeviceContext* context, const XMMATRIX& world) = 0;
+
+protected:
+	//	What each draw writes to slot b0.
+	struct ObjectBufferType
+	{
+		XMMATRIX world;
+	};
+};
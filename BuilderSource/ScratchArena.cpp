@@ -0,0 +1,67 @@
+#include "ScratchArena.h"
+
+#include <cstdint>
+
+ScratchArena::ScratchArena(size_t block_size)
+{
+	block_size_ = (block_size > 0) ? block_size : 1;
+	block_ = 0;
+	offset_ = 0;
+	used_ = 0;
+}
+
+//	Take back everything that has been handed out, keeping the blocks for the next bake.
+void ScratchArena::Reset()
+{
+	block_ = 0;
+	offset_ = 0;
+	used_ = 0;
+}
+
+size_t ScratchArena::GetCapacity() const
+{
+	size_t capacity = 0;
+	for (int i = 0; i < blocks_.size(); i++)
+	{
+		capacity += blocks_[i].size;
+	}
+	return capacity;
+}
+
+//	Carve size bytes out of the current block, moving on to the next block, or adding one, when it doesn't fit.
+void* ScratchArena::AllocateBytes(size_t size, size_t alignment)
+{
+	while (block_ < blocks_.size())
+	{
+		Block& block = blocks_[block_];
+		uintptr_t start = reinterpret_cast<uintptr_t>(block.memory) + offset_;
+		size_t padding = (alignment - start % alignment) % alignment;
+
+		if (offset_ + padding + size <= block.size)
+		{
+			void* memory = block.memory + offset_ + padding;
+			offset_ += padding + size;
+			used_ += padding + size;
+			return memory;
+		}
+
+		block_++;
+		offset_ = 0;
+	}
+
+	//	Big enough for this allocation, however it has to be aligned.
+	Block block;
+	block.size = (size + alignment > block_size_) ? size + alignment : block_size_;
+	block.memory = new char[block.size];
+	blocks_.push_back(block);
+
+	return AllocateBytes(size, alignment);
+}
+
+ScratchArena::~ScratchArena()
+{
+	for (int i = 0; i < blocks_.size(); i++)
+	{
+		delete[] blocks_[i].memory;
+	}
+}
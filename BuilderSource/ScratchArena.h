@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+//	Memory for the working space of one bake, handed out by moving a pointer along and taken back all at once.
+//	The blocks it hands out from are kept when it is reset, so once a bake has been run the next one of the same
+//		size or smaller doesn't allocate at all. A bake that needs more adds a block, which is kept from then on.
+//	Nothing is destructed, so only types that don't need it should go in here. Not thread safe: hand out the
+//		memory before splitting the work over a JobSystem, and let each job fill in its own share.
+class ScratchArena
+{
+public:
+	ScratchArena(size_t block_size = 1 << 20);
+	void Reset();
+	inline size_t GetUsed() const { return used_; }
+	size_t GetCapacity() const;
+	~ScratchArena();
+
+	//	Room for count T, each default constructed.
+	template<class T> T* Allocate(size_t count)
+	{
+		T* memory = static_cast<T*>(AllocateBytes(count * sizeof(T), alignof(T)));
+		for (size_t i = 0; i < count; i++)
+		{
+			new (&memory[i]) T;
+		}
+		return memory;
+	}
+
+private:
+	struct Block
+	{
+		char* memory;
+		size_t size;
+	};
+
+	void* AllocateBytes(size_t size, size_t alignment);
+
+private:
+	std::vector<Block> blocks_;
+	size_t block_size_;
+
+	//	The block being handed out from, and how far into it.
+	size_t block_;
+	size_t offset_;
+	size_t used_;
+};
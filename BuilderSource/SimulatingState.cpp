@@ -1,14 +1,14 @@
 #include "SimulatingState.h"
 
-#include "TrackMesh.h"
-
 SimulatingState::SimulatingState()
 {
 	t_ = 0.0f;
 	track_ = nullptr;
+	track_offset_ = XMFLOAT3(0.0f, 0.0f, 0.0f);
 	track_top_speed_ = 0.5f;
 	track_min_speed_ = 0.2f;
 	track_speed_ = track_min_speed_;
+	camera_rig_ = (int)CameraPath::Rig::FRONT_SEAT;
 }
 
 void SimulatingState::Init(void* ptr)
@@ -16,6 +16,12 @@ void SimulatingState::Init(void* ptr)
 	track_ = static_cast<Track*>(ptr);
 }
 
+//	The placement of the track mesh, which the track's own points don't include.
+void SimulatingState::SetTrackWorldMatrix(const XMMATRIX& world)
+{
+	XMStoreFloat3(&track_offset_, world.r[3]);
+}
+
 void SimulatingState::Update(float delta_time)
 {
 	SL::Vector tangent = track_->GetTangent();
@@ -62,17 +68,11 @@ void SimulatingState::AddLines()
 {
 	if (line_controller_)
 	{
-		XMMATRIX track_matrix = track_->GetTrackMesh()->GetWorldMatrix();
-		XMFLOAT3 offset;
-		offset.x = XMVectorGetX(track_matrix.r[3]);
-		offset.y = XMVectorGetY(track_matrix.r[3]);
-		offset.z = XMVectorGetZ(track_matrix.r[3]);
-
 		line_controller_->Clear();
 
 		//	Build the transform for the object travelling along the spline.
 		XMFLOAT3 start = track_->GetPoint();
-		start = XMFLOAT3(start.x + offset.x, start.y + offset.y, start.z + offset.z);
+		start = XMFLOAT3(start.x + track_offset_.x, start.y + track_offset_.y, start.z + track_offset_.z);
 
 		XMFLOAT3 forward = track_->GetForward();
 		XMFLOAT3 end(start.x + forward.x, start.y + forward.y, start.z + forward.z);
@@ -127,11 +127,26 @@ void SimulatingState::RenderUI()
 	ImGui::Separator();
 	ImGui::Spacing();
 	ImGui::Checkbox("Back to Editing", &exit_);
+	ImGui::Spacing();
+	ImGui::Separator();
+	ImGui::Spacing();
+	ImGui::Text("Camera");
+	for (int i = 0; i < (int)CameraPath::Rig::RIG_COUNT; i++)
+	{
+		ImGui::RadioButton(CameraPath::GetRigName((CameraPath::Rig)i), &camera_rig_, i);
+	}
 }
 
+//	Sample the baked camera path at the current distance along the track.
+void SimulatingState::GetCamera(DirectX::XMVECTOR& eye, DirectX::XMVECTOR& look_at, DirectX::XMVECTOR& up)
+{
+	camera_path_.Sample((CameraPath::Rig)camera_rig_, t_, eye, look_at, up);
+}
 
 void SimulatingState::OnEnter()
 {
+	//	The track cannot change while riding, so bake the camera paths once up front.
+	camera_path_.Bake(track_);
 }
 
 ApplicationState::APPLICATIONSTATE SimulatingState::OnExit()
@@ -2,6 +2,7 @@
 
 #include "ApplicationState.h"
 #include "Track.h"
+#include "CameraPath.h"
 
 #include "LineController.h"
 
@@ -10,10 +11,12 @@ class SimulatingState : public ApplicationState
 public:
 	SimulatingState();
 	void Init(void* ptr);
+	void SetTrackWorldMatrix(const XMMATRIX& world);
 	void Update(float delta_time);
 	void RenderUI();
 	void OnEnter();
 	APPLICATIONSTATE OnExit();
+	void GetCamera(DirectX::XMVECTOR& eye, DirectX::XMVECTOR& look_at, DirectX::XMVECTOR& up);
 
 	~SimulatingState();
 
@@ -23,8 +26,12 @@ private:
 private:
 	float t_;
 	Track* track_;
+	//	Where the track is placed in the world, for the lines drawn along it.
+	XMFLOAT3 track_offset_;
 	float track_speed_;
 	float track_top_speed_;
 	float track_min_speed_;
+	CameraPath camera_path_;
+	int camera_rig_;
 
 };
\ No newline at end of file
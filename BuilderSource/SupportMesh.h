@@ -1,13 +1,12 @@
-//	Class for the support structure of the track.
-//		Stores mesh data.
-//		Each support mesh consists of  1 or 2 strucres.
-//		The first structure is optional and can be any orientation.
-//		The second structure is mandatory and is always vertical.
-//		A track piece will only have two support structure segments if it cannot be supported by a single vertical segment 
-//			(It is upside down)
+//	Unit cylinder shared by every pillar of the track's support structures.
+//		Runs from the origin up to (0, 1, 0) with a radius of 1, and is stretched into place by each instance,
+//			see TrackGeometry::SupportInstance.
+//		A support under track that is upside down is made of two pillars, the first angled out from the track
+//			and the second vertical, with a sphere where they join.
 #pragma once
 
 #include "../DXFramework/BaseMesh.h"
+#include "ProfileExtruder.h"
 #include <vector>
 
 using namespace DirectX;
@@ -16,13 +15,10 @@ class SupportMesh : public BaseMesh
 {
 
 public:
-	SupportMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, XMVECTOR vertical_from_, XMVECTOR vertical_to_,
-		XMVECTOR angled_from_, XMVECTOR angled_to_, XMVECTOR angled_x_, XMVECTOR angled_z_);
-	SupportMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, XMVECTOR vertical_from_, XMVECTOR vertical_to_);
+	SupportMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, unsigned int slice_count = 10);
 	void AddCircleOrigin(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis);
 	void CalculateVertices();
 	void CalculateIndices();
-	inline void SetSliceCount(int slice_count) { slice_count_ = slice_count; }
 	void sendData(ID3D11DeviceContext* deviceContext);
 	virtual ~SupportMesh();
 
@@ -31,23 +27,12 @@ protected:
 	int resolution;
 
 private:
-	struct CircleData
-	{
-		XMVECTOR centre;
-		XMVECTOR x_axis;
-		XMVECTOR y_axis;
-	};
-	std::vector<CircleData> circle_data_;
+	std::vector<ProfileExtruder::Ring> circle_data_;
+	ProfileExtruder profile_;
 	ID3D11DeviceContext* device_context_;
 	std::vector<VertexType> vertices_;
 	std::vector<unsigned long int> indices_;
 	unsigned int slice_count_;
 	float radius_;
-	XMVECTOR vertical_from_;
-	XMVECTOR vertical_to_;
-	XMVECTOR angled_from_;
-	XMVECTOR angled_to_;
-	XMVECTOR angled_x_;
-	XMVECTOR angled_z_;
 };
 
@@ -1,22 +1,21 @@
 #include "Track.h"
-#include "SplineMesh.h"
-#include "RightTurn.h"
-#include "Straight.h"
-#include "LeftTurn.h"
-#include "ClimbUp.h"
-#include "ClimbDown.h"
 #include "CompleteTrack.h"
+#include "FromFile.h"
 #include "../Spline-Library/matrix3x3.h"
-#include "PipeMesh.h"
-#include "TrackMesh.h"
+#include "TrackMeshSink.h"
+#include "TrackGeometry.h"
+#include "TrackPieceCache.h"
 #include "../Spline-Library/CRSplineController.h"
 #include "Collision.h"
+#include "JobSystem.h"
 
 //	Handles creation of the track, and is able to simulate moving along the spline, given starting conditions.
-Track::Track(const int resolution, TrackMesh* track_mesh) :
-	resolution_(resolution), track_mesh_(track_mesh), t_(0.0f)
+//		A track without a mesh can still be simulated and baked into a TrackGeometry, and the mesh is sized to the track, so there is no limit on its length.
+Track::Track(const int resolution, TrackMeshSink* mesh_sink) :
+	mesh_sink_(mesh_sink), resolution_(resolution), t_(0.0f)
 {
-	max_segments_ = track_mesh->GetMaxSegments();
+	geometry_ = new TrackGeometry();
+	geometry_cache_ = new TrackPieceCache(resolution);
 
 	spline_controller_ = new SL::CRSplineController(resolution);
 
@@ -40,6 +39,14 @@ Track::Track(const int resolution, TrackMesh* track_mesh) :
 	preview_active_ = true;
 
 	min_height_ = -3.0f;
+	jobs_ = nullptr;
+	bake_snapshots_ = false;
+
+	back_start_.roll = 0.0f;
+	back_start_.target_roll = 0.0f;
+	back_start_.forward = forward_;
+	back_start_.right = right_;
+	back_start_.up = up_;
 }
 
 //	Remove the last track piece from the track. Also removes the last spline segment from the spline controller.
@@ -58,15 +65,15 @@ void Track::RemoveBack()
 		delete piece_to_remove;
 		piece_to_remove = 0;
 	}
-	
-	//	The track has changed length, so need to recalculate which distances along the spline each track piece lies within.
-	CalculatePieceBoundaries();
 
-	//	The preview mesh should no longer be displayed as it was removed.
-	track_mesh_->ClearPreview();
+	if (mesh_sink_)
+	{
+		//	The preview mesh should no longer be displayed as it was removed.
+		mesh_sink_->ClearPreview();
 
-	//	Stop displaying the support structures.
-	track_mesh_->ClearSupports();
+		//	Stop displaying the support structures.
+		mesh_sink_->ClearSupports();
+	}
 
 }
 
@@ -74,34 +81,16 @@ void Track::AddTrackPiece(TrackPiece::Tag tag)
 {
 	TrackPiece* track_piece = nullptr;
 
-	switch (tag)
+	if (tag == TrackPiece::Tag::COMPLETE_TRACK)
 	{
-	case TrackPiece::Tag::STRAIGHT:
-		track_piece = new Straight();
-		break;
-
-	case TrackPiece::Tag::RIGHT_TURN: 
-		track_piece = new RightTurn();
-		break;
-
-	case TrackPiece::Tag::LEFT_TURN:
-		track_piece = new LeftTurn();
-		break;
-
-	case TrackPiece::Tag::CLIMB_UP:
-		track_piece = new ClimbUp();
-		break;
-
-	case TrackPiece::Tag::CLIMB_DOWN:
-		track_piece = new ClimbDown();
-		break;
-
-	case TrackPiece::Tag::COMPLETE_TRACK:
 		if (track_pieces_.size() > 1)
 		{
 			track_piece = new CompleteTrack(spline_controller_->JoinSelf());
 		}
-		break;
+	}
+	else
+	{
+		track_piece = TrackPiece::CreateStockPiece(tag);
 	}
 
 	//	Add the spline segment from the newly created track piece to the spline representing the track.
@@ -119,6 +108,363 @@ void Track::AddTrackPiece(TrackPiece::Tag tag)
 	}
 }
 
+//	Insert a new track piece before the piece at index. The rest of the track is moved to stay attached.
+bool Track::InsertTrackPiece(int index, TrackPiece::Tag tag)
+{
+	TrackPiece* track_piece = TrackPiece::CreateStockPiece(tag);
+	if (!track_piece)
+	{
+		return false;
+	}
+
+	//	Maintain the roll from the previous track piece.
+	if (index > 0 && index <= (int)track_pieces_.size())
+	{
+		track_piece->SetRollTarget(track_pieces_[index - 1]->GetRollTarget());
+	}
+
+	return InsertPiece(index, track_piece, nullptr);
+}
+
+//	Remove the track piece at index. The rest of the track is moved to close the gap.
+bool Track::RemoveTrackPiece(int index)
+{
+	if (index < 0 || index >= (int)track_pieces_.size())
+	{
+		return false;
+	}
+
+	if (index == track_pieces_.size() - 1)
+	{
+		RemoveBack();
+		return true;
+	}
+
+	bool complete = IsComplete();
+	float closing_roll = OpenTrack(complete);
+
+	//	The closing piece cannot survive with fewer than two other pieces.
+	if (track_pieces_.size() <= 2)
+	{
+		complete = false;
+	}
+
+	spline_controller_->RemoveSegment(index);
+	delete track_pieces_[index];
+	track_pieces_.erase(track_pieces_.begin() + index);
+
+	CloseTrack(complete, closing_roll);
+
+	return true;
+}
+
+//	Swap the track piece at index for a new piece of a different type, keeping its roll.
+bool Track::ReplaceTrackPiece(int index, TrackPiece::Tag tag)
+{
+	if (index < 0 || index >= (int)track_pieces_.size())
+	{
+		return false;
+	}
+
+	TrackPiece* track_piece = TrackPiece::CreateStockPiece(tag);
+	if (!track_piece)
+	{
+		return false;
+	}
+
+	track_piece->SetRollTarget(track_pieces_[index]->GetRollTarget());
+
+	return ReplacePiece(index, track_piece, nullptr);
+}
+
+//	Take an immutable snapshot of a track piece.
+//		The piece keeps its last snapshot and hands it out again until the piece changes, so snapshotting a whole track
+//		only allocates for the pieces edited since the last time. Its setters drop the snapshot, and a piece the spline
+//		controller has moved or measured again no longer matches it.
+TrackPiece::StatePtr Track::CaptureTrackPiece(int index)
+{
+	if (index < 0 || index >= (int)track_pieces_.size())
+	{
+		return TrackPiece::StatePtr();
+	}
+
+	TrackPiece* track_piece = track_pieces_[index];
+	const TrackPiece::StatePtr& captured = track_piece->GetCapturedState();
+	if (captured && IsCaptureCurrent(index, *captured))
+	{
+		return captured;
+	}
+
+	std::shared_ptr<TrackPiece::State> state = std::make_shared<TrackPiece::State>();
+	state->tag = track_piece->GetTag();
+	for (int i = 0; i < 4; i++)
+	{
+		state->control_points[i] = track_piece->GetControlPoint(i);
+	}
+	state->tension = track_piece->GetTension();
+	state->roll_target = track_piece->GetRollTarget();
+	state->arc_table = spline_controller_->GetSegmentTable(index);
+
+	track_piece->SetCapturedState(state);
+	return state;
+}
+
+//	Whether a snapshot still describes the piece at index, which is a handful of comparisons rather than an allocation.
+bool Track::IsCaptureCurrent(int index, const TrackPiece::State& state)
+{
+	TrackPiece* track_piece = track_pieces_[index];
+	if (state.arc_table != spline_controller_->GetSegmentTable(index) || state.tension != track_piece->GetTension() || state.roll_target != track_piece->GetRollTarget())
+	{
+		return false;
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		SL::Vector point = track_piece->GetControlPoint(i);
+		SL::Vector captured = state.control_points[i];
+		if (point.X() != captured.X() || point.Y() != captured.Y() || point.Z() != captured.Z())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	Put a saved track piece back into the track, either as a new piece or over the piece at index.
+//		The saved arc length table is reused, so the restored segment is not measured again.
+bool Track::RestoreTrackPiece(int index, const TrackPiece::StatePtr& state, bool insert)
+{
+	if (!state)
+	{
+		return false;
+	}
+
+	//	The closing piece is always rebuilt from the ends of the track, so only its roll is restored.
+	if (state->tag == TrackPiece::Tag::COMPLETE_TRACK)
+	{
+		if (insert && !IsComplete() && index == track_pieces_.size())
+		{
+			AddTrackPiece(TrackPiece::Tag::COMPLETE_TRACK);
+		}
+
+		if (!IsComplete() || index != track_pieces_.size() - 1)
+		{
+			return false;
+		}
+
+		track_pieces_.back()->SetRollTarget(state->roll_target);
+		if (IsCaptureCurrent(index, *state))
+		{
+			track_pieces_.back()->SetCapturedState(state);
+		}
+		return true;
+	}
+
+	if (!insert && (index < 0 || index >= (int)track_pieces_.size()))
+	{
+		return false;
+	}
+
+	//	Reuse the existing piece when only its shape or roll has changed.
+	TrackPiece* track_piece = nullptr;
+	if (!insert && track_pieces_[index]->GetTag() == state->tag)
+	{
+		track_piece = track_pieces_[index];
+	}
+	else if (state->tag == TrackPiece::Tag::NUMBER_OF_TYPES)
+	{
+		track_piece = new FromFile();
+	}
+	else
+	{
+		track_piece = TrackPiece::CreateStockPiece(state->tag);
+	}
+
+	if (!track_piece)
+	{
+		return false;
+	}
+
+	track_piece->SetControlPoints(state->control_points[0], state->control_points[1], state->control_points[2], state->control_points[3]);
+	track_piece->SetTension(state->tension);
+	track_piece->SetRollTarget(state->roll_target);
+
+	bool restored = insert ? InsertPiece(index, track_piece, state->arc_table) : ReplacePiece(index, track_piece, state->arc_table);
+	if (restored)
+	{
+		//	Capturing the piece again hands back the saved snapshot, unless the piece was moved to join the track.
+		track_piece->SetCapturedState(state);
+	}
+
+	return restored;
+}
+
+//	Put saved shapes back over many pieces at once, such as after the whole track has been smoothed.
+//		states[i] is restored over piece i, or piece i is left alone if it is null. Every piece keeps its type.
+//		Restoring the pieces one at a time would move the rest of the track after each of them, so this instead moves
+//		each piece once, in order.
+bool Track::RestoreTrackPieceShapes(const std::vector<TrackPiece::StatePtr>& states)
+{
+	bool complete = IsComplete();
+	int piece_count = track_pieces_.size() - (complete ? 1 : 0);
+
+	if (states.size() > piece_count)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < states.size(); i++)
+	{
+		if (states[i] && states[i]->tag != track_pieces_[i]->GetTag())
+		{
+			return false;
+		}
+	}
+
+	float closing_roll = OpenTrack(complete);
+
+	bool restored = true;
+	bool moved = false;
+	for (int i = 0; i < piece_count; i++)
+	{
+		TrackPiece* track_piece = track_pieces_[i];
+		const TrackPiece::StatePtr state = (i < states.size()) ? states[i] : TrackPiece::StatePtr();
+
+		if (state)
+		{
+			track_piece->SetControlPoints(state->control_points[0], state->control_points[1], state->control_points[2], state->control_points[3]);
+			track_piece->SetTension(state->tension);
+			track_piece->SetRollTarget(state->roll_target);
+
+			if (spline_controller_->ReplaceSegment(i, track_piece->GetSpline(), track_piece->GetTension(), track_piece->ShouldSmooth(), state->arc_table, false))
+			{
+				moved = true;
+				continue;
+			}
+
+			restored = false;
+		}
+
+		//	A piece after one that has changed still has to join on to it.
+		if (moved || !restored)
+		{
+			spline_controller_->ReattachSegment(i);
+		}
+	}
+
+	CloseTrack(complete, closing_roll);
+
+	return restored;
+}
+
+bool Track::InsertPiece(int index, TrackPiece* track_piece, SL::CRSplineController::ArcTable arc_table)
+{
+	//	The closing piece is rebuilt after the edit, so an insert after it goes before it instead.
+	bool complete = IsComplete();
+	if (complete && index >= (int)track_pieces_.size())
+	{
+		index = track_pieces_.size() - 1;
+	}
+
+	if (index < 0 || index > (int)track_pieces_.size())
+	{
+		delete track_piece;
+		return false;
+	}
+
+	float closing_roll = OpenTrack(complete);
+
+	if (!spline_controller_->InsertSegment(index, track_piece->GetSpline(), track_piece->GetTension(), track_piece->ShouldSmooth(), arc_table))
+	{
+		delete track_piece;
+		CloseTrack(complete, closing_roll);
+		return false;
+	}
+
+	track_pieces_.insert(track_pieces_.begin() + index, track_piece);
+
+	CloseTrack(complete, closing_roll);
+
+	return true;
+}
+
+//	Replace the piece at index. If track_piece is the piece already at index, it is re-attached in place.
+bool Track::ReplacePiece(int index, TrackPiece* track_piece, SL::CRSplineController::ArcTable arc_table)
+{
+	bool complete = IsComplete();
+	bool in_place = (track_pieces_[index] == track_piece);
+
+	if (complete && index == track_pieces_.size() - 1)
+	{
+		if (!in_place)
+		{
+			delete track_piece;
+		}
+		return false;
+	}
+
+	float closing_roll = OpenTrack(complete);
+
+	if (!spline_controller_->ReplaceSegment(index, track_piece->GetSpline(), track_piece->GetTension(), track_piece->ShouldSmooth(), arc_table))
+	{
+		if (!in_place)
+		{
+			delete track_piece;
+		}
+		CloseTrack(complete, closing_roll);
+		return false;
+	}
+
+	if (!in_place)
+	{
+		//	The old spline segment has already been deleted by the spline controller.
+		track_pieces_[index]->SetSplineSegment(nullptr);
+		delete track_pieces_[index];
+		track_pieces_[index] = track_piece;
+	}
+
+	CloseTrack(complete, closing_roll);
+
+	return true;
+}
+
+bool Track::IsComplete()
+{
+	return !track_pieces_.empty() && track_pieces_.back()->GetTag() == TrackPiece::Tag::COMPLETE_TRACK;
+}
+
+//	The closing piece joins the last piece to the first, so has to be removed while the middle of the track is edited.
+//		Returns its roll target so that it can be restored.
+float Track::OpenTrack(bool complete)
+{
+	if (!complete)
+	{
+		return 0.0f;
+	}
+
+	float roll = track_pieces_.back()->GetRollTarget();
+	spline_controller_->RemoveBack();
+	delete track_pieces_.back();
+	track_pieces_.pop_back();
+
+	return roll;
+}
+
+void Track::CloseTrack(bool complete, float roll)
+{
+	if (!complete)
+	{
+		return;
+	}
+
+	AddTrackPiece(TrackPiece::Tag::COMPLETE_TRACK);
+	if (IsComplete())
+	{
+		track_pieces_.back()->SetRollTarget(roll);
+	}
+}
+
 void Track::AddTrackPieceFromFile(TrackPiece* track_piece)
 {
 	if (track_piece)
@@ -132,7 +478,6 @@ void Track::AddTrackPieceFromFile(TrackPiece* track_piece)
 //	Function assumes that there has already been track pieces added from a file.
 void Track::LoadTrack()
 {
-	CalculatePieceBoundaries();
 	GenerateMesh();
 	GenerateSupportStructures();
 	Reset();
@@ -146,42 +491,33 @@ void Track::EraseTrack()
 	up_store_ = initial_up_;
 	forward_store_ = initial_forward_;
 	right_store_ = initial_right_;
+	roll_channel_.reset();
 
-	//	Delete all of the track pieces.
+	//	Delete all of the track pieces, along with their spline segments.
 	for (int i = 0; i < track_pieces_.size(); i++)
 	{
-		TrackPiece* piece_to_remove = track_pieces_[i];
-		if (piece_to_remove)
+		if (track_pieces_[i])
 		{
-			spline_controller_->RemoveBack();
-
-			track_pieces_.pop_back();
-			delete piece_to_remove;
-			piece_to_remove = 0;
+			delete track_pieces_[i];
+			track_pieces_[i] = 0;
 		}
 	}
 	track_pieces_.clear();
+
+	while (spline_controller_->GetSegmentCount() > 0)
+	{
+		spline_controller_->RemoveBack();
+	}
 	spline_controller_->ClearSegments();
 
 	Reset();	
 }
 
-//	For each track piece, calculate the distances along the spline that it starts and ends at, in terms of t.
-void Track::CalculatePieceBoundaries()
+//	The length of the piece at index, kept by the spline controller as segments are measured,
+//		so no pass over the pieces is needed after an edit.
+float Track::GetPieceLength(int index)
 {
-	if (track_pieces_.empty())
-	{
-		return;
-	}
-
-	//	Calculate the values of t that the ends of each track piece lie on.
-	float length_to = 0.0f;
-	for (int i = 0; i < track_pieces_.size(); i++)
-	{
-		track_pieces_[i]->bounding_values_.t0 = spline_controller_->GetTimeAtDistance(length_to / spline_controller_->GetArcLength());
-		length_to += track_pieces_[i]->GetLength();
-		track_pieces_[i]->bounding_values_.t1 = spline_controller_->GetTimeAtDistance(length_to / spline_controller_->GetArcLength());
-	}
+	return spline_controller_->GetSegmentLength(index);
 }
 
 void Track::CalculateEndOfSimulation()
@@ -203,57 +539,260 @@ void Track::CalculateEndOfSimulation()
 	Reset();
 }
 
-void Track::StoreMeshData()
+//	Simulate along the track a track piece at a time, storing as many frames for each piece as its shape needs,
+//		see TrackGeometry::GetFramesForPiece. The geometry only places rings around the frames it needs, see TrackGeometry::Finalise.
+//		Unedited stock pieces are copied out of the geometry cache rather than simulated.
+//	With bake_snapshots_, each piece's geometry is also kept with the snapshot the piece was restored from, and a piece
+//		whose snapshot has been baked before is laid from there, as long as the track still reaches it the same way.
+void Track::StoreMeshData(TrackGeometry* geometry)
 {
-	//	Store data needed for the mesh to generate itself.
-	for (int i = 0; i < (30 * track_pieces_.size()); i++)
+	geometry->Clear();
+
+	if (track_pieces_.size() == 0)
 	{
-		float t = (float)i / (float)(30 * track_pieces_.size() - 1);
+		return;
+	}
 
-		UpdateSimulation(t);
+	float track_length = spline_controller_->GetArcLength();
+	float distance = 0.0f;
 
-		XMFLOAT3 pos = GetPointAtDistance(t);
-		XMVECTOR centre = XMVectorSet(pos.x, pos.y, pos.z, 0.0f);
+	for (int i = 0; i < track_pieces_.size(); i++)
+	{
+		float piece_length = spline_controller_->GetSegmentLength(i);
 
-		XMVECTOR x = XMVectorSet(GetRight().x, GetRight().y, GetRight().z, 0.0f);
-		XMVECTOR y = XMVectorSet(GetUp().x, GetUp().y, GetUp().z, 0.0f);
-		XMVECTOR z = XMVectorSet(GetForward().x, GetForward().y, GetForward().z, 0.0f);
+		UpdateSimulation(distance / track_length);
 
-		track_mesh_->StorePoints(centre, x, y, z);
+		SimulationValues start;
+		start.roll = roll_;
+		start.target_roll = (i > 0) ? track_pieces_[i - 1]->GetRollTarget() : 0.0f;
+		start.forward = forward_;
+		start.right = right_;
+		start.up = up_;
 
-		if (i % track_mesh_->GetCrossTieFrequency() == 0)
+		if (i == track_pieces_.size() - 1)
 		{
-			track_mesh_->AddCrossTie(centre, x, y, z);
+			back_start_ = start;
 		}
 
-		//	Reached the end of simulating the track.
-		if (t == 1.0f)
+		const TrackPiece::State* snapshot = GetBakeSnapshot(i);
+		if (snapshot && StoreBakedPiece(geometry, *snapshot))
 		{
-			//	Take a 'snapshot' of the simulation, so that it can be continued by the track preview.
-			StoreSimulationValues();
+			distance += piece_length;
+			continue;
+		}
+
+		//	The first piece rolls from wherever the track starts, so it is always simulated.
+		//		Cached pieces follow the roll targets, so a roll channel means simulating every piece.
+		if ((i == 0) || roll_channel_ || !StoreCachedPiece(geometry, i, distance / track_length))
+		{
+			float start_roll = (i > 0) ? track_pieces_[i - 1]->GetRollTarget() : roll_ / 0.0174533f;
+			const unsigned int frame_count = TrackGeometry::GetFramesForPiece(spline_controller_->GetSegment(i), piece_length,
+				start_roll, track_pieces_[i]->GetRollTarget());
+			const unsigned int cross_tie_step = frame_count / TrackGeometry::GetCrossTiesPerPiece();
+
+			geometry->BeginPiece(frame_count);
+			for (unsigned int k = 0; k < frame_count; k++)
+			{
+				float d = (distance + piece_length * k / frame_count) / track_length;
+
+				UpdateSimulation(d);
+				StoreFrame(geometry, d, (k % cross_tie_step) == 0);
+			}
 		}
+
+		if (snapshot)
+		{
+			KeepBakedPiece(geometry, *snapshot, start);
+		}
+
+		distance += piece_length;
 	}
 
+	//	Close the end of the track.
+	UpdateSimulation(1.0f);
+	StoreFrame(geometry, 1.0f, false);
+
+	//	Take a 'snapshot' of the simulation, so that it can be continued by the track preview.
+	StoreSimulationValues();
+
+	scratch_.Reset();
+	geometry->Finalise(scratch_, jobs_);
+
 	//	Return the track to a state where it is ready to start simulating.
 	Reset();
 }
 
+void Track::StoreFrame(TrackGeometry* geometry, float d, bool cross_tie)
+{
+	XMFLOAT3 pos = GetPointAtDistance(d);
+	XMVECTOR centre = XMVectorSet(pos.x, pos.y, pos.z, 0.0f);
+
+	XMVECTOR x = XMVectorSet(right_.X(), right_.Y(), right_.Z(), 0.0f);
+	XMVECTOR y = XMVectorSet(up_.X(), up_.Y(), up_.Z(), 0.0f);
+	XMVECTOR z = XMVectorSet(forward_.X(), forward_.Y(), forward_.Z(), 0.0f);
+
+	geometry->AddFrame(centre, x, y, z);
+
+	if (cross_tie)
+	{
+		geometry->AddCrossTie(centre, x, y, z);
+	}
+}
+
+//	Place the cached geometry for the track piece at index, starting from the current frame.
+//	On success the simulation is moved on to the end of the piece, as if it had been simulated.
+bool Track::StoreCachedPiece(TrackGeometry* geometry, int index, float d)
+{
+	TrackPiece* track_piece = track_pieces_[index];
+	float start_roll = track_pieces_[index - 1]->GetRollTarget();
+
+	const TrackPieceCache::Entry* entry = geometry_cache_->Find(track_piece->GetTag(), track_piece->GetTension(),
+		start_roll, track_piece->GetRollTarget());
+	if (!entry)
+	{
+		return false;
+	}
+
+	XMFLOAT3 pos = GetPointAtDistance(d);
+	XMVECTOR position = XMVectorSet(pos.x, pos.y, pos.z, 0.0f);
+	XMVECTOR forward = XMVectorSet(forward_.X(), forward_.Y(), forward_.Z(), 0.0f);
+	XMVECTOR up = XMVectorSet(up_.X(), up_.Y(), up_.Z(), 0.0f);
+
+	XMMATRIX transform;
+	if (!geometry_cache_->GetPlacement(*entry, track_piece, position, forward, up, transform))
+	{
+		return false;
+	}
+
+	geometry->Append(entry->geometry, transform);
+
+	XMFLOAT3 end_forward, end_up;
+	XMStoreFloat3(&end_forward, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&entry->end_forward), transform)));
+	XMStoreFloat3(&end_up, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&entry->end_up), transform)));
+
+	forward_.Set(end_forward.x, end_forward.y, end_forward.z);
+	up_.Set(end_up.x, end_up.y, end_up.z);
+	right_ = up_.Cross(forward_);
+	roll_ = track_piece->GetRollTarget() * 0.0174533f;
+
+	return true;
+}
+
+//	The snapshot the piece at index was restored from, if its geometry can be kept with it.
+//		Pieces baked under a roll channel depend on the whole track, so aren't kept.
+const TrackPiece::State* Track::GetBakeSnapshot(int index)
+{
+	if (!bake_snapshots_ || roll_channel_)
+	{
+		return nullptr;
+	}
+
+	const TrackPiece::StatePtr& snapshot = track_pieces_[index]->GetCapturedState();
+	if (!snapshot || !IsCaptureCurrent(index, *snapshot))
+	{
+		return nullptr;
+	}
+
+	return snapshot.get();
+}
+
+//	Lay a piece as it was baked from snapshot before, if the simulation has reached it in a frame it was baked from.
+//	On success the simulation is moved on to where it was left by the piece, as if it had been simulated.
+bool Track::StoreBakedPiece(TrackGeometry* geometry, const TrackPiece::State& snapshot)
+{
+	const float tolerance = 1.0e-5f;
+
+	XMVECTOR forward = XMVectorSet(forward_.X(), forward_.Y(), forward_.Z(), 0.0f);
+	XMVECTOR up = XMVectorSet(up_.X(), up_.Y(), up_.Z(), 0.0f);
+
+	const BakedPiece* found = nullptr;
+	for (int i = 0; (i < TrackPiece::State::BAKE_COUNT) && !found; i++)
+	{
+		const BakedPiece* baked = snapshot.baked[i].get();
+		if (baked && (fabsf(roll_ - baked->start_roll) <= tolerance) &&
+			(XMVectorGetX(XMVector3Length(forward - XMLoadFloat3(&baked->start_forward))) <= tolerance) &&
+			(XMVectorGetX(XMVector3Length(up - XMLoadFloat3(&baked->start_up))) <= tolerance))
+		{
+			found = baked;
+		}
+	}
+
+	if (!found)
+	{
+		return false;
+	}
+
+	const BakedPiece& baked = *found;
+	geometry->AppendBakedPiece(baked);
+
+	forward_.Set(baked.end_forward.x, baked.end_forward.y, baked.end_forward.z);
+	up_.Set(baked.end_up.x, baked.end_up.y, baked.end_up.z);
+	right_.Set(baked.end_right.x, baked.end_right.y, baked.end_right.z);
+	roll_ = baked.end_roll;
+
+	return true;
+}
+
+//	Keep the piece just laid with the snapshot it was restored from, along with where the simulation started and left it.
+void Track::KeepBakedPiece(TrackGeometry* geometry, const TrackPiece::State& snapshot, const SimulationValues& start)
+{
+	std::shared_ptr<BakedPiece> baked = std::make_shared<BakedPiece>();
+	geometry->KeepLastPiece(*baked);
+
+	SL::Vector start_forward = start.forward;
+	SL::Vector start_up = start.up;
+	baked->start_forward = XMFLOAT3(start_forward.X(), start_forward.Y(), start_forward.Z());
+	baked->start_up = XMFLOAT3(start_up.X(), start_up.Y(), start_up.Z());
+	baked->start_roll = start.roll;
+	baked->end_forward = XMFLOAT3(forward_.X(), forward_.Y(), forward_.Z());
+	baked->end_up = XMFLOAT3(up_.X(), up_.Y(), up_.Z());
+	baked->end_right = XMFLOAT3(right_.X(), right_.Y(), right_.Z());
+	baked->end_roll = roll_;
+
+	for (int i = TrackPiece::State::BAKE_COUNT - 1; i > 0; i--)
+	{
+		snapshot.baked[i] = snapshot.baked[i - 1];
+	}
+	snapshot.baked[0] = baked;
+}
+
 void Track::GenerateSupportStructures()
 {
-	track_mesh_->ClearSupports();
+	if (!mesh_sink_)
+	{
+		return;
+	}
+
+	StoreSupportData(geometry_);
+	mesh_sink_->UploadSupports(*geometry_);
+}
+
+//	Place the support structures, without creating any meshes for them.
+//		Stepping along the track has to be done in order, as each frame follows on from the last, but testing each
+//		support against the track doesn't, and is most of the work on a long track, so is spread over the job system.
+void Track::StoreSupportData(TrackGeometry* geometry)
+{
+	geometry->ClearSupports();
 
 	//	Represent the track as a series of spheres, for collision detection.
 	//	Each track piece is represented by 12 spheres.
 	unsigned int sphere_count = 12 * track_pieces_.size();
 
-	auto circle_centres = GetBoundingSphereCentres(sphere_count);
+	scratch_.Reset();
+	SL::Vector* circle_centres = scratch_.Allocate<SL::Vector>(sphere_count);
+	GetBoundingSphereCentres(sphere_count, circle_centres);
 	auto circle_radius = GetTrackLength() / sphere_count;
 
 	//	Vectors to represent the pillars.
 	XMVECTOR from, to, forward, right, up, angled_from, angled_to;
 
+	//	One candidate for every sixth step.
+	unsigned int step_count = track_pieces_.size() * 30;
+	SupportCandidate* candidates = scratch_.Allocate<SupportCandidate>((step_count + 5) / 6);
+	unsigned int candidate_count = 0;
+
 	//	Step along the track and add supports at set intervals.
-	for (int i = 0; i < track_pieces_.size() * 30.0f; i++)
+	for (unsigned int i = 0; i < step_count; i++)
 	{
 		float t = (float)i / (float)(30 * track_pieces_.size() - 1);
 
@@ -267,29 +806,19 @@ void Track::GenerateSupportStructures()
 			right = XMLoadFloat3(&GetRight());
 			up = XMLoadFloat3(&GetUp());
 
+			SupportCandidate candidate;
+			XMStoreFloat3(&candidate.forward, forward);
+			XMStoreFloat3(&candidate.up, up);
+
 			//	Test the track is the correct way up so that the support structure does not get placed inside the track.
 			if(up_.Dot(SL::Vector(0, 1, 0)) >= 0.0f)
 			{
 				from = XMVectorSet(point.X(), point.Y(), point.Z(), 0.0f);
 				from = from - up * 0.3f;
 				to = XMVectorSet(XMVectorGetX(from), min_height_, XMVectorGetZ(from), 0.0f);
-				SL::Vector ray_origin(XMVectorGetX(from), XMVectorGetY(from) - circle_radius, XMVectorGetZ(from));
-
-				bool no_collisions = true;
-
-				//	Test if the support would intersect with any of the track.
-				for (int i = 0; i < circle_centres.size(); i++)
-				{
-					if (Collision::RayInSphere(ray_origin, SL::Vector(0.0f, -1.0f, 0.0f), circle_radius, circle_centres[i]))
-					{
-						no_collisions = false;
-					}
-				}
 
-				if (no_collisions)
-				{
-					track_mesh_->AddSupportVertical(from, to);
-				}
+				candidate.segmented = false;
+				candidate.ray_origin = SL::Vector(XMVectorGetX(from), XMVectorGetY(from) - circle_radius, XMVectorGetZ(from));
 			}
 			else 
 			{
@@ -308,25 +837,54 @@ void Track::GenerateSupportStructures()
 				//	Segment 2:
 				from = angled_to;	
 				to = XMVectorSet(XMVectorGetX(from), min_height_, XMVectorGetZ(from), 0.0f);
-				SL::Vector ray_origin(XMVectorGetX(from), XMVectorGetY(from), XMVectorGetZ(from));
 
-				bool no_collisions = true;
+				candidate.segmented = true;
+				candidate.ray_origin = SL::Vector(XMVectorGetX(from), XMVectorGetY(from), XMVectorGetZ(from));
+				XMStoreFloat3(&candidate.angled_from, angled_from);
+				XMStoreFloat3(&candidate.angled_to, angled_to);
+			}
 
-				//	Test if the support would intersect with any of the track.
-				for (int i = 0; i < circle_centres.size(); i++)
-				{
-					if (Collision::RayInSphere(ray_origin, SL::Vector(0.0f, -1.0f, 0.0f), circle_radius, circle_centres[i]))
-					{
-						no_collisions = false;
-					}
-				}
+			XMStoreFloat3(&candidate.from, from);
+			XMStoreFloat3(&candidate.to, to);
+			candidates[candidate_count++] = candidate;
+		}
+	}
 
-				if (no_collisions)
-				{
-					track_mesh_->AddSupportSegmented(from, to, angled_from, angled_to, forward, up);
-				}
+	//	Test if each support would intersect with any of the track.
+	JobSystem::ParallelFor(jobs_, candidate_count, [candidates, circle_centres, sphere_count, circle_radius](unsigned int i)
+	{
+		SupportCandidate& candidate = candidates[i];
+		candidate.clear = true;
+
+		for (unsigned int j = 0; j < sphere_count; j++)
+		{
+			if (Collision::RayInSphere(candidate.ray_origin, SL::Vector(0.0f, -1.0f, 0.0f), circle_radius, circle_centres[j]))
+			{
+				candidate.clear = false;
+				break;
 			}
 		}
+	});
+
+	//	Added in the order they were found, so the supports come out the same however the tests were split up.
+	for (unsigned int i = 0; i < candidate_count; i++)
+	{
+		const SupportCandidate& candidate = candidates[i];
+		if (!candidate.clear)
+		{
+			continue;
+		}
+
+		if (candidate.segmented)
+		{
+			geometry->AddSupportSegmented(XMLoadFloat3(&candidate.from), XMLoadFloat3(&candidate.to),
+				XMLoadFloat3(&candidate.angled_from), XMLoadFloat3(&candidate.angled_to),
+				XMLoadFloat3(&candidate.forward), XMLoadFloat3(&candidate.up));
+		}
+		else
+		{
+			geometry->AddSupportVertical(XMLoadFloat3(&candidate.from), XMLoadFloat3(&candidate.to));
+		}
 	}
 
 	Reset();
@@ -349,16 +907,25 @@ void Track::UpdateSimulation(float t)
 	right_ = up_.Cross(forward_).Normalised();
 	up_ = forward_.Cross(right_).Normalised();
 
-	//	The start and target roll for this timestep.
-	float start_roll = roll_;
-	if ((track_pieces_.size() > 1) && (active_index > 0 ))
+	float target_roll = 0.0f;
+	if (roll_channel_)
 	{
-		start_roll = track_pieces_.at(active_index - 1)->GetRollTarget();
+		target_roll = SampleRollChannel(t);
 	}
+	else
+	{
+		//	The start and target roll for this timestep.
+		float start_roll = roll_;
+		if ((track_pieces_.size() > 1) && (active_index > 0 ))
+		{
+			start_roll = track_pieces_.at(active_index - 1)->GetRollTarget();
+		}
 
-	//	Scale t between t0 and t1 for this track piece to be between 0 and 1;
-	float roll_time = (t_ - active_track_piece->bounding_values_.t0) / (active_track_piece->bounding_values_.t1 - active_track_piece->bounding_values_.t0);
-	float target_roll = Lerpf(start_roll * 0.0174533f, active_track_piece->GetRollTarget() * 0.0174533f, roll_time);
+		//	Each piece is a single spline segment, so it runs from t = index / count to (index + 1) / count.
+		//		Scale t between them to be between 0 and 1.
+		float roll_time = t_ * track_pieces_.size() - active_index;
+		target_roll = Lerpf(start_roll * 0.0174533f, active_track_piece->GetRollTarget() * 0.0174533f, roll_time);
+	}
 
 	//	Get the difference between the desired roll and the current roll.
 	float angle_needed = target_roll - roll_;
@@ -396,48 +963,35 @@ void Track::StoreSimulationValues()
 }
 
 //	Sphere centres used in collision detection for the support structures.
-std::vector<SL::Vector> Track::GetBoundingSphereCentres(int sphere_count)
+//		circle_centres needs room for sphere_count centres.
+void Track::GetBoundingSphereCentres(int sphere_count, SL::Vector* circle_centres)
 {
-	std::vector<SL::Vector> circle_centres;
 	float distance = 0.0f;
 	float distance_increment = 1.0f / sphere_count;
 
 	for (int i = 0; i < sphere_count; i++)
 	{
-		circle_centres.push_back(spline_controller_->GetPointAtDistance(distance));
+		circle_centres[i] = spline_controller_->GetPointAtDistance(distance);
 		distance += distance_increment;
 	}
-
-	return circle_centres;
 }
 
-//	Binary search for track piece that t lies on.
+//	Find the track piece that t lies on.
 //		Used to get track piece attributes based on the current time.
 int Track::GetActiveTrackPiece()
 {
-	int mid = 0;
-	int left = 0;
-	int right = track_pieces_.size() - 1;
+	int index = (int)(t_ * track_pieces_.size());
 
-	while (left <= right)
+	if (index < 0)
 	{
-		mid = (left + right) / 2;
-
-		if ((track_pieces_[mid]->bounding_values_.t0 <= t_) && (track_pieces_[mid]->bounding_values_.t1 >= t_))
-		{
-			return mid;
-		}
-
-		if (track_pieces_[mid]->bounding_values_.t0 > t_)
-		{
-			right = mid - 1;
-		}
-		else
-		{
-			left = mid + 1;
-		}
+		index = 0;
+	}
+	else if (index > (int)track_pieces_.size() - 1)
+	{
+		index = track_pieces_.size() - 1;
 	}
-	return mid;
+
+	return index;
 }
 
 //	Update the last track piece with the preview track data.
@@ -454,26 +1008,29 @@ void Track::UpdateBack(TrackPiece* track_piece)
 		back->SetControlPoint(2, track_piece->GetControlPoint(2));
 		back->SetControlPoint(3, track_piece->GetControlPoint(3));
 		back->SetTension(track_piece->GetTension());
-		back->CalculateSpline();
 		back->SetRollTarget(track_piece->GetRollTarget());
-		back->SetLength(track_piece->GetLength());
 
-		//	TODO: Make track length calculations based on preview track piece lengths, less accurate but better performance.
-		RecalculateTrackLength();
-		CalculatePieceBoundaries();
+		//	Only the last segment has changed, so only it needs to be measured again.
+		spline_controller_->UpdateSegment(track_pieces_.size() - 1, back->GetTension());
 	}
 }
 
+//	Bake and upload the mesh on the calling thread. The track builder uses the TrackBaker instead.
 void Track::GenerateMesh()
 {
+	if (!mesh_sink_)
+	{
+		return;
+	}
+
 	if (track_pieces_.size() == 0)
 	{
-		track_mesh_->Clear();
+		mesh_sink_->Clear();
 		return;
 	}
 
-	StoreMeshData();
-	track_mesh_->UpdateSimulatingMesh();
+	StoreMeshData(geometry_);
+	mesh_sink_->UploadTrack(*geometry_);
 }
 
 int Track::GetTrackPieceCount()
@@ -564,6 +1121,30 @@ SL::Vector Track::GetRightStore()
 	return right_store_;
 }
 
+//	Interpolate the roll channel at distance d, where 0<d<1.
+float Track::SampleRollChannel(float d)
+{
+	const std::vector<float>& roll = *roll_channel_;
+	if (roll.empty())
+	{
+		return 0.0f;
+	}
+
+	float position = d * (float)(roll.size() - 1);
+	if (position <= 0.0f)
+	{
+		return roll.front();
+	}
+
+	int index = (int)position;
+	if (index >= (int)roll.size() - 1)
+	{
+		return roll.back();
+	}
+
+	return Lerpf(roll[index], roll[index + 1], position - (float)index);
+}
+
 float Track::Lerpf(float f0, float f1, float t)
 {
 	return (1.0f - t) * f0 + t * f1;
@@ -596,35 +1177,6 @@ TrackPiece* Track::GetBack()
 	return track_pieces_.back();
 }
 
-TrackMesh* Track::GetTrackMesh()
-{
-	return track_mesh_;
-}
-
-DirectX::XMVECTOR Track::GetCameraEye()
-{
-	XMFLOAT3 point = GetPoint();
-	XMFLOAT3 up = GetUp();
-	XMVECTOR upv = XMLoadFloat3(&up);
-	XMFLOAT3 forward = GetForward();
-	XMVECTOR forwardv = XMLoadFloat3(&forward);
-	forwardv = XMVectorScale(forwardv, 0.5f);
-	upv = XMVectorScale(upv, 0.15f);
-	return XMLoadFloat3(&point) + upv - forwardv;
-}
-
-DirectX::XMVECTOR Track::GetCameraLookAt()
-{
-	XMFLOAT3 forward = GetForward();
-	return GetCameraEye() + XMLoadFloat3(&forward);
-}
-
-DirectX::XMVECTOR Track::GetCameraUp()
-{
-	XMFLOAT3 up = GetUp();
-	return XMLoadFloat3(&up);
-}
-
 Track::~Track()
 {
 	for (int i = 0; i < track_pieces_.size(); i++)
@@ -642,4 +1194,16 @@ Track::~Track()
 		delete spline_controller_;
 		spline_controller_ = 0;
 	}	
+
+	if (geometry_)
+	{
+		delete geometry_;
+		geometry_ = 0;
+	}
+
+	if (geometry_cache_)
+	{
+		delete geometry_cache_;
+		geometry_cache_ = 0;
+	}
 }
@@ -1,22 +1,41 @@
 #pragma once
 
 #include "TrackPiece.h"
+#include "ScratchArena.h"
 #include <vector>
 #include <directxmath.h>
+#include "../Spline-Library/CRSplineController.h"
 
 class SplineMesh;
-class TrackMesh;
-
-namespace SL
-{
-	class CRSplineController;
-}
+class TrackMeshSink;
+class TrackGeometry;
+class TrackPieceCache;
+class JobSystem;
 
 class Track
 {
 public:
-	Track(const int resolution, TrackMesh* track_mesh);
+	//	Roll in radians at evenly spaced distances along the track, from the first sample at the start to the last at the end.
+	typedef std::shared_ptr<const std::vector<float>> RollChannel;
+
+	//	The frame and roll of the simulation somewhere along the track, and the roll target of the piece before.
+	struct SimulationValues
+	{
+		float roll;
+		float target_roll;
+		SL::Vector forward;
+		SL::Vector right;
+		SL::Vector up;
+	};
+
+	Track(const int resolution, TrackMeshSink* mesh_sink);
 	void AddTrackPiece(TrackPiece::Tag tag);
+	bool InsertTrackPiece(int index, TrackPiece::Tag tag);
+	bool RemoveTrackPiece(int index);
+	bool ReplaceTrackPiece(int index, TrackPiece::Tag tag);
+	TrackPiece::StatePtr CaptureTrackPiece(int index);
+	bool RestoreTrackPiece(int index, const TrackPiece::StatePtr& state, bool insert);
+	bool RestoreTrackPieceShapes(const std::vector<TrackPiece::StatePtr>& states);
 	void AddTrackPieceFromFile(TrackPiece* track_piece);
 	void LoadTrack();
 	void UpdateSimulation(float t);
@@ -29,13 +48,10 @@ public:
 	void RemoveBack();
 	void CalculateEndOfSimulation();
 	void UpdateBack(TrackPiece* track_piece);
-	inline unsigned int GetMaxTrackPieceCount() { return max_segments_; }
+	inline int GetResolution() { return resolution_; }
 	TrackPiece* GetBack();
-	TrackMesh* GetTrackMesh();
+	bool IsComplete();
 	TrackPiece* GetTrackPiece(int index);
-	DirectX::XMVECTOR GetCameraEye();
-	DirectX::XMVECTOR GetCameraLookAt();
-	DirectX::XMVECTOR GetCameraUp();
 	DirectX::XMFLOAT3 GetPoint();
 	DirectX::XMFLOAT3 GetPointAtDistance(float d);
 	DirectX::XMFLOAT3 GetPointAtTime(float t);
@@ -48,22 +64,58 @@ public:
 	SL::Vector GetRightStore();
 	inline float GetTargetRollStore() { return target_roll_store_; }
 	inline float GetRollStore() { return roll_store_; }
-	void CalculatePieceBoundaries();
-	void StoreMeshData();
+	inline float GetRoll() { return roll_; }
+	inline float GetMinHeight() { return min_height_; }
+	inline void SetRollChannel(RollChannel roll_channel) { roll_channel_ = roll_channel; }
+	inline RollChannel GetRollChannel() { return roll_channel_; }
+	inline void SetJobSystem(JobSystem* jobs) { jobs_ = jobs; }
+	inline void SetBakeSnapshots(bool bake_snapshots) { bake_snapshots_ = bake_snapshots; }
+	inline const SimulationValues& GetBackStart() { return back_start_; }
+	float GetPieceLength(int index);
+	void StoreMeshData(TrackGeometry* geometry);
+	void StoreSupportData(TrackGeometry* geometry);
 	void GenerateSupportStructures();
 	~Track();
 
 private:
+	//	Where a support could go, found by stepping along the track and then tested against the track on its own.
+	//		Segmented supports are angled out from the track before going down.
+	struct SupportCandidate
+	{
+		DirectX::XMFLOAT3 from;
+		DirectX::XMFLOAT3 to;
+		DirectX::XMFLOAT3 angled_from;
+		DirectX::XMFLOAT3 angled_to;
+		DirectX::XMFLOAT3 forward;
+		DirectX::XMFLOAT3 up;
+		SL::Vector ray_origin;
+		bool segmented;
+		bool clear;
+	};
+
+	bool InsertPiece(int index, TrackPiece* track_piece, SL::CRSplineController::ArcTable arc_table);
+	bool ReplacePiece(int index, TrackPiece* track_piece, SL::CRSplineController::ArcTable arc_table);
+	float OpenTrack(bool complete);
+	bool IsCaptureCurrent(int index, const TrackPiece::State& state);
+	void CloseTrack(bool complete, float roll);
 	void StoreSimulationValues();
-	std::vector<SL::Vector> GetBoundingSphereCentres(int sphere_count);
+	void StoreFrame(TrackGeometry* geometry, float d, bool cross_tie);
+	bool StoreCachedPiece(TrackGeometry* geometry, int index, float d);
+	const TrackPiece::State* GetBakeSnapshot(int index);
+	bool StoreBakedPiece(TrackGeometry* geometry, const TrackPiece::State& snapshot);
+	void KeepBakedPiece(TrackGeometry* geometry, const TrackPiece::State& snapshot, const SimulationValues& start);
+	void GetBoundingSphereCentres(int sphere_count, SL::Vector* circle_centres);
 	int GetActiveTrackPiece();
 	float Lerpf(float f0, float f1, float t);
+	float SampleRollChannel(float d);
 
 private:
-	unsigned int max_segments_;
 	std::vector<TrackPiece*> track_pieces_;
 	SL::CRSplineController* spline_controller_;
-	TrackMesh* track_mesh_;
+	//	Where the baked geometry is drawn, if anywhere.
+	TrackMeshSink* mesh_sink_;
+	TrackGeometry* geometry_;
+	TrackPieceCache* geometry_cache_;
 	int resolution_;
 	float t_;
 	SL::Vector initial_forward_;
@@ -80,4 +132,20 @@ private:
 	SL::Vector up_store_;
 	bool preview_active_;
 	float min_height_;
+
+	//	Replaces the roll targets of the pieces when set.
+	RollChannel roll_channel_;
+
+	//	Spreads the parts of a bake that don't depend on each other over several threads, when set.
+	JobSystem* jobs_;
+
+	//	Whether a bake keeps each piece's geometry with the snapshot the piece was restored from, and lays it again
+	//		from there next time. The snapshots are shared, so only for a track that is only baked on one thread.
+	bool bake_snapshots_;
+
+	//	Where the last piece started, in the last bake.
+	SimulationValues back_start_;
+
+	//	Working space for one stage of a bake at a time, taken back when the next stage starts.
+	ScratchArena scratch_;
 };
\ No newline at end of file
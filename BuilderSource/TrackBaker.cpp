@@ -0,0 +1,364 @@
+#include "TrackBaker.h"
+
+#include "Track.h"
+#include "TrackPreview.h"
+#include "TrackMeshSink.h"
+#include "JobSystem.h"
+
+TrackBaker::TrackBaker(int resolution)
+{
+	running_ = true;
+	baking_ = false;
+	generation_ = 0;
+
+	pending_.auto_bank = false;
+	pending_.bank_speed = BankingSolver::default_min_speed;
+	pending_.bake_track = false;
+	pending_.bake_supports = false;
+	pending_.bake_preview = false;
+	pending_.generation = 0;
+	job_pending_ = false;
+
+	track_back_ = new TrackGeometry();
+	track_ready_ = new TrackGeometry();
+	track_front_ = new TrackGeometry();
+	preview_back_ = new TrackGeometry();
+	preview_ready_ = new TrackGeometry();
+	preview_front_ = new TrackGeometry();
+	track_ready_flag_ = false;
+	supports_ready_flag_ = false;
+	preview_ready_flag_ = false;
+	track_generation_ = 0;
+	preview_generation_ = 0;
+
+	//	The worker has its own track and preview to simulate, so the ones being edited are never touched.
+	track_ = new Track(resolution, nullptr);
+	track_->SetBakeSnapshots(true);
+	jobs_ = new JobSystem(JobSystem::GetDefaultWorkerCount());
+	track_->SetJobSystem(jobs_);
+	preview_ = new TrackPreview(nullptr);
+
+	preview_start_.roll = 0.0f;
+	preview_start_.target_roll = 0.0f;
+	preview_start_.forward = SL::Vector(0.0f, 0.0f, 1.0f);
+	preview_start_.right = SL::Vector(1.0f, 0.0f, 0.0f);
+	preview_start_.up = SL::Vector(0.0f, 1.0f, 0.0f);
+
+	worker_ = std::thread(&TrackBaker::Run, this);
+}
+
+//	Snapshot every track piece and queue a bake of the whole track, replacing any track bake still waiting.
+//		Each piece hands back the snapshot it was last captured with unless it has changed since, so only the edited
+//		pieces are copied, and the rest of the request is a pointer a piece.
+//		With auto_bank, the worker also solves the bank angles for a train cresting at bank_speed.
+void TrackBaker::RequestTrack(Track* track, bool supports, bool auto_bank, float bank_speed)
+{
+	request_pieces_.resize(track->GetTrackPieceCount());
+	for (int i = 0; i < request_pieces_.size(); i++)
+	{
+		request_pieces_[i] = track->CaptureTrackPiece(i);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	pending_.pieces.swap(request_pieces_);
+	request_pieces_.clear();
+	pending_.auto_bank = auto_bank;
+	pending_.bank_speed = bank_speed;
+	pending_.bake_track = true;
+	pending_.bake_supports = pending_.bake_supports || supports;
+	pending_.generation = generation_;
+	job_pending_ = true;
+
+	condition_.notify_all();
+}
+
+//	Snapshot the preview piece and queue a bake of the preview, replacing any preview bake still waiting.
+void TrackBaker::RequestPreview(TrackPiece* preview_piece)
+{
+	std::shared_ptr<TrackPiece::State> state = std::make_shared<TrackPiece::State>();
+	state->tag = preview_piece->GetTag();
+	for (int i = 0; i < 4; i++)
+	{
+		state->control_points[i] = preview_piece->GetControlPoint(i);
+	}
+	state->tension = preview_piece->GetTension();
+	state->roll_target = preview_piece->GetRollTarget();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	pending_.preview = state;
+	pending_.bake_preview = true;
+	pending_.generation = generation_;
+	job_pending_ = true;
+
+	condition_.notify_all();
+}
+
+//	Drop anything waiting to be baked or uploaded. A bake already in progress is discarded when it finishes.
+void TrackBaker::Cancel()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	generation_++;
+
+	pending_.pieces.clear();
+	pending_.preview.reset();
+	pending_.bake_track = false;
+	pending_.bake_supports = false;
+	pending_.bake_preview = false;
+	job_pending_ = false;
+
+	track_ready_flag_ = false;
+	supports_ready_flag_ = false;
+	preview_ready_flag_ = false;
+	roll_channel_ready_.reset();
+}
+
+//	Called from the render thread. Upload any geometry that has finished baking since the last call,
+//		and give the track the bank angles it was baked with.
+//		The geometry is taken out of the ready slots under the lock and uploaded once it is released,
+//		so the worker can hand over its next bake while this one is being sent to the GPU.
+bool TrackBaker::Collect(TrackMeshSink* track_mesh, Track* track)
+{
+	bool upload_track = false;
+	bool upload_supports = false;
+	bool upload_preview = false;
+	std::shared_ptr<const std::vector<float>> roll_channel;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (track_ready_flag_)
+		{
+			if (track_generation_ == generation_)
+			{
+				std::swap(track_ready_, track_front_);
+				roll_channel.swap(roll_channel_ready_);
+				upload_track = true;
+				upload_supports = supports_ready_flag_;
+			}
+
+			track_ready_flag_ = false;
+			supports_ready_flag_ = false;
+			roll_channel_ready_.reset();
+		}
+
+		if (preview_ready_flag_)
+		{
+			if (preview_generation_ == generation_)
+			{
+				std::swap(preview_ready_, preview_front_);
+				upload_preview = true;
+			}
+
+			preview_ready_flag_ = false;
+		}
+	}
+
+	if (upload_track)
+	{
+		track->SetRollChannel(roll_channel);
+		track_mesh->UploadTrack(*track_front_);
+
+		if (upload_supports)
+		{
+			track_mesh->UploadSupports(*track_front_);
+		}
+	}
+
+	if (upload_preview)
+	{
+		track_mesh->UploadPreview(*preview_front_);
+	}
+
+	return upload_track || upload_preview;
+}
+
+//	Block until every request so far has been baked. Used before the track is ridden.
+void TrackBaker::Wait()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	condition_.wait(lock, [this] { return !job_pending_ && !baking_; });
+}
+
+bool TrackBaker::IsBusy()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return job_pending_ || baking_ || track_ready_flag_ || preview_ready_flag_;
+}
+
+void TrackBaker::Run()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	while (running_)
+	{
+		condition_.wait(lock, [this] { return job_pending_ || !running_; });
+		if (!running_)
+		{
+			break;
+		}
+
+		//	Take the latest request, leaving an empty one for the render thread to fill.
+		Job job;
+		job.pieces.swap(pending_.pieces);
+		job.preview.swap(pending_.preview);
+		job.auto_bank = pending_.auto_bank;
+		job.bank_speed = pending_.bank_speed;
+		job.bake_track = pending_.bake_track;
+		job.bake_supports = pending_.bake_supports;
+		job.bake_preview = pending_.bake_preview;
+		job.generation = pending_.generation;
+
+		pending_.bake_track = false;
+		pending_.bake_supports = false;
+		pending_.bake_preview = false;
+		job_pending_ = false;
+		baking_ = true;
+
+		lock.unlock();
+
+		//	The track is baked first, as the preview continues on from the end of it.
+		if (job.bake_track)
+		{
+			BakeTrack(job);
+		}
+		if (job.bake_preview && job.preview)
+		{
+			BakePreview(job);
+		}
+
+		lock.lock();
+
+		if (job.bake_track)
+		{
+			std::swap(track_back_, track_ready_);
+			roll_channel_ready_ = track_->GetRollChannel();
+			track_ready_flag_ = true;
+			supports_ready_flag_ = job.bake_supports;
+			track_generation_ = job.generation;
+		}
+		if (job.bake_preview && job.preview)
+		{
+			std::swap(preview_back_, preview_ready_);
+			preview_ready_flag_ = true;
+			preview_generation_ = job.generation;
+		}
+
+		baking_ = false;
+		condition_.notify_all();
+	}
+}
+
+//	Bring the worker's copy of the track up to the snapshots and bake it.
+//		Pieces up to the first snapshot that differs from the last bake are left where they are, and the rest are
+//		restored in order. Each snapshot keeps the geometry it was baked into, so a piece that comes back unchanged,
+//		such as on undo or redo, is laid from there rather than simulated again.
+void TrackBaker::BakeTrack(const Job& job)
+{
+	int piece_count = job.pieces.size();
+	int kept_count = 0;
+	while (kept_count < piece_count && kept_count < baked_pieces_.size() && job.pieces[kept_count] == baked_pieces_[kept_count])
+	{
+		kept_count++;
+	}
+
+	if (kept_count == 0)
+	{
+		track_->EraseTrack();
+	}
+	while (track_->GetTrackPieceCount() > kept_count)
+	{
+		track_->RemoveBack();
+	}
+
+	bool restored = (track_->GetTrackPieceCount() == kept_count);
+	for (int i = kept_count; i < piece_count; i++)
+	{
+		restored = track_->RestoreTrackPiece(i, job.pieces[i], true) && restored;
+	}
+
+	//	Only a track that matches its snapshots can be kept for the next bake.
+	if (restored)
+	{
+		baked_pieces_ = job.pieces;
+	}
+	else
+	{
+		baked_pieces_.clear();
+	}
+
+	//	The channel covers the whole track, so it can only be solved once the last piece is back.
+	//		A failed solve leaves the pieces' own roll targets in place.
+	track_->SetRollChannel(nullptr);
+	if (job.auto_bank)
+	{
+		banking_.SetMinSpeed(job.bank_speed);
+		if (!banking_.Solve(track_))
+		{
+			track_->SetRollChannel(nullptr);
+		}
+	}
+
+	track_->StoreMeshData(track_back_);
+
+	//	The preview is the last track piece, so it starts where the bake reached the start of it.
+	const Track::SimulationValues& back_start = track_->GetBackStart();
+	preview_start_.roll = back_start.roll;
+	preview_start_.target_roll = back_start.target_roll;
+	preview_start_.forward = back_start.forward;
+	preview_start_.right = back_start.right;
+	preview_start_.up = back_start.up;
+
+	track_back_->ClearSupports();
+	if (job.bake_supports)
+	{
+		track_->StoreSupportData(track_back_);
+	}
+}
+
+void TrackBaker::BakePreview(const Job& job)
+{
+	preview_->InitTrackPiece(*job.preview);
+	preview_->InitialiseSimulation(preview_start_.roll, preview_start_.forward, preview_start_.right,
+		preview_start_.up, preview_start_.target_roll);
+
+	preview_->GenerateMesh(preview_back_);
+}
+
+TrackBaker::~TrackBaker()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		running_ = false;
+		condition_.notify_all();
+	}
+
+	if (worker_.joinable())
+	{
+		worker_.join();
+	}
+
+	if (track_)
+	{
+		delete track_;
+		track_ = nullptr;
+	}
+
+	if (preview_)
+	{
+		delete preview_;
+		preview_ = nullptr;
+	}
+
+	if (jobs_)
+	{
+		delete jobs_;
+		jobs_ = nullptr;
+	}
+
+	delete track_back_;
+	delete track_ready_;
+	delete track_front_;
+	delete preview_back_;
+	delete preview_ready_;
+	delete preview_front_;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "TrackPiece.h"
+#include "TrackGeometry.h"
+#include "BankingSolver.h"
+#include "../Spline-Library/vector.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class Track;
+class TrackPreview;
+class TrackMeshSink;
+class JobSystem;
+
+//	Bakes the track and preview meshes on a worker thread.
+//		The parts of a track bake that can run side by side are spread over a job system of its own.
+//		Automatic bank angles are solved on the worker too, and handed back to the track when the bake is collected.
+//	Requests are snapshots of the track pieces, so the worker never reads the track being edited.
+//		Unchanged pieces hand back the snapshot they were last captured with, and each snapshot keeps the geometry
+//		it was baked into, so a bake only simulates the pieces that are new to it, however they came back.
+//	Only the most recent request of each kind is kept, and finished geometry waits in a ready slot
+//		until the render thread collects it, and is uploaded from a buffer of the render thread's own.
+class TrackBaker
+{
+public:
+	TrackBaker(int resolution);
+	void RequestTrack(Track* track, bool supports = false, bool auto_bank = false, float bank_speed = BankingSolver::default_min_speed);
+	void RequestPreview(TrackPiece* preview_piece);
+	void Cancel();
+	bool Collect(TrackMeshSink* track_mesh, Track* track);
+	void Wait();
+	bool IsBusy();
+	~TrackBaker();
+
+private:
+	struct Job
+	{
+		std::vector<TrackPiece::StatePtr> pieces;
+		TrackPiece::StatePtr preview;
+		bool auto_bank;
+		float bank_speed;
+		bool bake_track;
+		bool bake_supports;
+		bool bake_preview;
+		unsigned int generation;
+	};
+
+	//	Simulation values at the start of the last track piece, used to continue the track into the preview.
+	struct PreviewStart
+	{
+		float roll;
+		float target_roll;
+		SL::Vector forward;
+		SL::Vector right;
+		SL::Vector up;
+	};
+
+	void Run();
+	void BakeTrack(const Job& job);
+	void BakePreview(const Job& job);
+
+private:
+	std::thread worker_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	bool running_;
+	bool baking_;
+	unsigned int generation_;
+
+	//	Pending request, written by the render thread.
+	Job pending_;
+	bool job_pending_;
+	//	The snapshots for the next track request, only used by the render thread. Swapped with the pending request,
+	//		so a request the worker hasn't taken yet lends its room to the next one.
+	std::vector<TrackPiece::StatePtr> request_pieces_;
+
+	//	Finished geometry. The worker bakes into the back buffer and swaps it into the ready slot.
+	//		The render thread swaps the ready slot with its front buffer, and uploads from that without the lock.
+	TrackGeometry* track_back_;
+	TrackGeometry* track_ready_;
+	TrackGeometry* track_front_;
+	TrackGeometry* preview_back_;
+	TrackGeometry* preview_ready_;
+	TrackGeometry* preview_front_;
+	bool track_ready_flag_;
+	bool supports_ready_flag_;
+	bool preview_ready_flag_;
+	//	The bank angles the ready track was baked with, if any.
+	std::shared_ptr<const std::vector<float>> roll_channel_ready_;
+	unsigned int track_generation_;
+	unsigned int preview_generation_;
+
+	//	Only used by the worker thread.
+	JobSystem* jobs_;
+	Track* track_;
+	//	The snapshots the worker's track was last restored from, so the pieces they share with the next job can stay.
+	std::vector<TrackPiece::StatePtr> baked_pieces_;
+	TrackPreview* preview_;
+	PreviewStart preview_start_;
+	BankingSolver banking_;
+};
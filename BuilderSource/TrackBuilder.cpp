@@ -7,9 +7,9 @@
 #include "ClimbUp.h"
 #include "ClimbDown.h"
 #include "CompleteTrack.h"
-#include "TrackMesh.h"
+#include "TrackMeshSink.h"
 
-TrackBuilder::TrackBuilder(Track* track) : track_(track), track_piece_(nullptr)
+TrackBuilder::TrackBuilder(Track* track, TrackMeshSink* track_mesh) : track_(track), track_mesh_(track_mesh), track_piece_(nullptr), baker_(track->GetResolution())
 {
 	//	Size based on total number of different track piece types.
 	track_piece_types_ = new TrackPieceType[static_cast<int>(TrackPiece::Tag::NUMBER_OF_TYPES)];
@@ -22,10 +22,23 @@ TrackBuilder::TrackBuilder(Track* track) : track_(track), track_piece_(nullptr)
 	active_control_point_[2] = edit_mode_->GetP2State();
 	active_control_point_[3] = edit_mode_->GetP3State();
 	update_preview_mesh_ = false;
+	remove_last_piece_ = false;
 	undo_ = false;
+	redo_ = false;
 	build_supports_ = false;
+	close_loop_ = false;
+	smooth_joints_ = false;
+	auto_bank_ = false;
+	bank_speed_ = BankingSolver::default_min_speed;
+	baked_auto_bank_ = false;
+	baked_bank_speed_ = bank_speed_;
+	selected_piece_ = 0;
+	edit_piece_type_ = static_cast<int>(TrackPiece::Tag::STRAIGHT);
+	insert_piece_ = false;
+	replace_piece_ = false;
+	remove_piece_ = false;
 	track_load_toggle_ = false;
-	track_preview_ = new TrackPreview(track->GetTrackMesh());
+	track_preview_ = new TrackPreview(track_mesh);
 	track_piece_ = track_preview_->GetPreviewPiece();
 	preview_finished_ = false;
 	translation_[0] = 0;
@@ -55,16 +68,71 @@ void TrackBuilder::SetEditModeType(EditMode::EditModeTag tag)
 	edit_mode_types_[static_cast<int>(tag)].is_active = true;
 }
 
+bool* TrackBuilder::SetRemoveLastPiece()
+{
+	return &remove_last_piece_;
+}
+
 bool* TrackBuilder::SetUndo()
 {
 	return &undo_;
 }
 
+bool* TrackBuilder::SetRedo()
+{
+	return &redo_;
+}
+
 bool* TrackBuilder::SetBuildSupports()
 {
 	return &build_supports_;
 }
 
+bool* TrackBuilder::SetCloseLoop()
+{
+	return &close_loop_;
+}
+
+bool* TrackBuilder::SetSmoothJoints()
+{
+	return &smooth_joints_;
+}
+
+bool* TrackBuilder::SetAutoBank()
+{
+	return &auto_bank_;
+}
+
+float* TrackBuilder::SetBankSpeed()
+{
+	return &bank_speed_;
+}
+
+int* TrackBuilder::SetSelectedPiece()
+{
+	return &selected_piece_;
+}
+
+int* TrackBuilder::SetEditPieceType()
+{
+	return &edit_piece_type_;
+}
+
+bool* TrackBuilder::SetInsertPiece()
+{
+	return &insert_piece_;
+}
+
+bool* TrackBuilder::SetReplacePiece()
+{
+	return &replace_piece_;
+}
+
+bool* TrackBuilder::SetRemovePiece()
+{
+	return &remove_piece_;
+}
+
 //	Update the track based on user input.
 void TrackBuilder::UpdateTrack()
 {
@@ -85,14 +153,36 @@ void TrackBuilder::UpdateTrack()
 	if (build_supports_)
 	{
 		FinishPreview();
-		track_->GenerateSupportStructures();
+		RequestBake(true);
 		build_supports_ = false;
 	}
 
-	if (undo_)
+	if (insert_piece_ || replace_piece_ || remove_piece_)
 	{
-		Undo();
-		undo_ = false;
+		EditSelectedPiece();
+	}
+
+	if (undo_ || redo_)
+	{
+		UndoRedo();
+	}
+
+	if (close_loop_)
+	{
+		CloseLoop();
+	}
+
+	//	Rebake when automatic banking is switched on or off, or its speed changes.
+	//		This compares against what was asked for rather than the track's roll channel, which a failed solve leaves empty.
+	if ((track_->GetTrackPieceCount() > 0) && ((auto_bank_ != baked_auto_bank_) || (auto_bank_ && bank_speed_ != baked_bank_speed_)))
+	{
+		RequestBake();
+	}
+
+	if (remove_last_piece_)
+	{
+		RemoveLastPiece();
+		remove_last_piece_ = false;
 	}
 	else
 	{
@@ -107,11 +197,14 @@ void TrackBuilder::UpdateTrack()
 
 	if (update_preview_mesh_)
 	{
-		track_preview_->GenerateMesh();
+		baker_.RequestPreview(track_piece_);
 		update_preview_mesh_ = false;
 	}
+
+	//	Pick up any meshes that the worker has finished baking, along with the bank angles solved for them.
+	baker_.Collect(track_mesh_, track_);
 	
-	track_->GetTrackMesh()->SetTranslation(translation_[0], translation_[1], translation_[2]);
+	track_mesh_->SetTranslation(translation_[0], translation_[1], translation_[2]);
 }
 
 void TrackBuilder::Build()
@@ -126,8 +219,7 @@ void TrackBuilder::Build()
 			//	There will be no track preview to change when there are no track pieces, or when the track has been loaded.
 			if (track_->GetTrackPieceCount() != 0 && !track_load_toggle_)
 			{
-				track_->UpdateBack(track_piece_);
-				track_->GenerateMesh();
+				CommitPreview();
 			}
 
 			//	Reset track load toggle.
@@ -136,17 +228,20 @@ void TrackBuilder::Build()
 				track_load_toggle_ = false;
 			}
 
+			int piece_count = track_->GetTrackPieceCount();
 			track_->AddTrackPiece(track_piece_types_[i].tag);
+			if (track_->GetTrackPieceCount() > piece_count)
+			{
+				history_.Record(TrackHistory::CommandType::ADD, piece_count, TrackPiece::StatePtr(), track_->CaptureTrackPiece(piece_count));
+			}
 			SetTrackPieceData();
 
-			//	Pass the new track piece to the preview track for simulation.
+			//	Pass the new track piece to the preview track for editing.
 			track_preview_->InitTrackPiece(track_->GetBack());
 			track_preview_->SetPreviewActive(true);
 
-			//	Pass starting conditions for simulation to the track preview. 
-			track_preview_->InitialiseSimulation(track_->GetRollStore(), track_->GetForwardStore(),
-			track_->GetRightStore(), track_->GetUpStore(), track_->GetTargetRollStore());
-
+			//	The baker continues the simulation from the end of the track into the preview.
+			RequestBake();
 			update_preview_mesh_ = true;
 			
 		}
@@ -161,6 +256,12 @@ void TrackBuilder::Build()
 			update_preview_mesh_ = true;
 		}
 
+		if ((track_piece_->GetTension() != track_piece_data_.tension) && track_preview_->GetPreviewActive())
+		{
+			track_piece_->SetTension(track_piece_data_.tension);
+			update_preview_mesh_ = true;
+		}
+
 		if (update_preview_mesh_)
 		{
 			SL::Vector p0(track_piece_data_.p0_x, track_piece_data_.p0_y, track_piece_data_.p0_z);
@@ -176,15 +277,25 @@ void TrackBuilder::Build()
 	}
 }
 
-void TrackBuilder::Undo()
+void TrackBuilder::RemoveLastPiece()
 {
 	if (track_->GetTrackPieceCount() == 0)
 	{
 		return;
 	}
-	else if (track_->GetTrackPieceCount() == 1)
+
+	if (track_preview_->GetPreviewActive())
+	{
+		CommitPreview();
+	}
+
+	int index = track_->GetTrackPieceCount() - 1;
+	history_.Record(TrackHistory::CommandType::REMOVE, index, track_->CaptureTrackPiece(index), TrackPiece::StatePtr());
+
+	if (track_->GetTrackPieceCount() == 1)
 	{
-		EraseTrack();
+		track_->EraseTrack();
+		OnTrackChanged();
 		return;
 	}
 
@@ -196,20 +307,238 @@ void TrackBuilder::Undo()
 	SetTrackPieceData();
 	track_preview_->SetPreviewActive(false);
 	preview_finished_ = true;
+}
+
+//	Insert, replace or remove a track piece in the middle of the track.
+void TrackBuilder::EditSelectedPiece()
+{
+	//	Any changes to the preview piece must be in the track before the rest of it moves.
+	if (track_preview_->GetPreviewActive())
+	{
+		FinishPreview();
+	}
+
+	TrackPiece::Tag tag = static_cast<TrackPiece::Tag>(edit_piece_type_);
+	bool changed = false;
+
+	if (insert_piece_)
+	{
+		//	An insert after the closing piece goes before it, so find where the piece actually ended up.
+		int index = selected_piece_ + 1;
+		if (track_->IsComplete() && index >= track_->GetTrackPieceCount())
+		{
+			index = track_->GetTrackPieceCount() - 1;
+		}
+
+		changed = track_->InsertTrackPiece(index, tag);
+		if (changed)
+		{
+			history_.Record(TrackHistory::CommandType::INSERT, index, TrackPiece::StatePtr(), track_->CaptureTrackPiece(index));
+		}
+	}
+	else if (replace_piece_)
+	{
+		TrackPiece::StatePtr before = track_->CaptureTrackPiece(selected_piece_);
+		changed = track_->ReplaceTrackPiece(selected_piece_, tag);
+		if (changed)
+		{
+			history_.Record(TrackHistory::CommandType::REPLACE, selected_piece_, before, track_->CaptureTrackPiece(selected_piece_));
+		}
+	}
+	else
+	{
+		TrackPiece::StatePtr before = track_->CaptureTrackPiece(selected_piece_);
+		if (track_->GetTrackPieceCount() == 1)
+		{
+			track_->EraseTrack();
+			changed = true;
+		}
+		else
+		{
+			changed = track_->RemoveTrackPiece(selected_piece_);
+		}
+
+		if (changed)
+		{
+			history_.Record(TrackHistory::CommandType::REMOVE, selected_piece_, before, TrackPiece::StatePtr());
+		}
+	}
+
+	insert_piece_ = false;
+	replace_piece_ = false;
+	remove_piece_ = false;
+
+	if (selected_piece_ > track_->GetTrackPieceCount() - 1)
+	{
+		selected_piece_ = track_->GetTrackPieceCount() > 0 ? track_->GetTrackPieceCount() - 1 : 0;
+	}
+
+	if (changed)
+	{
+		OnTrackChanged();
+	}
+}
+
+//	Write the preview piece into the end of the track, recording the change in the history.
+void TrackBuilder::CommitPreview()
+{
+	if (track_->GetTrackPieceCount() == 0)
+	{
+		return;
+	}
+
+	int index = track_->GetTrackPieceCount() - 1;
+	TrackPiece::StatePtr before = track_->CaptureTrackPiece(index);
+
+	track_->UpdateBack(track_piece_);
+
+	//	Smoothing moves the pieces around the one being committed, so it is undone along with it.
+	if (smooth_joints_)
+	{
+		history_.BeginGroup();
+	}
+
+	history_.RecordEdit(index, before, track_->CaptureTrackPiece(index));
+
+	if (smooth_joints_)
+	{
+		SmoothJoints();
+		history_.EndGroup();
+	}
+}
+
+//	Solve for continuous curvature over the whole track, recording every piece that changed.
+void TrackBuilder::SmoothJoints()
+{
+	std::vector<TrackPiece::StatePtr> before(track_->GetTrackPieceCount());
+	for (int i = 0; i < track_->GetTrackPieceCount(); i++)
+	{
+		before[i] = track_->CaptureTrackPiece(i);
+	}
+
+	smoother_.Smooth(track_);
+
+	for (int i = 0; i < track_->GetTrackPieceCount(); i++)
+	{
+		history_.RecordEdit(i, before[i], track_->CaptureTrackPiece(i));
+	}
+}
+
+void TrackBuilder::UndoRedo()
+{
+	//	Pending preview changes become the most recent step, so they are the first to be undone.
+	if (track_preview_->GetPreviewActive())
+	{
+		FinishPreview();
+	}
+
+	bool changed = undo_ ? history_.Undo(track_) : history_.Redo(track_);
 	undo_ = false;
+	redo_ = false;
+
+	if (changed)
+	{
+		OnTrackChanged();
+	}
+}
+
+//	Reshape the end of a complete track so it runs smoothly into the start.
+//		Every piece the solver changes is recorded in one group, so a single undo puts the track back.
+void TrackBuilder::CloseLoop()
+{
+	close_loop_ = false;
+
+	if (!track_->IsComplete())
+	{
+		return;
+	}
+
+	if (track_preview_->GetPreviewActive())
+	{
+		FinishPreview();
+	}
+
+	std::vector<TrackPiece::StatePtr> before(track_->GetTrackPieceCount());
+	for (int i = 0; i < track_->GetTrackPieceCount(); i++)
+	{
+		before[i] = track_->CaptureTrackPiece(i);
+	}
+
+	//	Even if the solve fails part way, any pieces it has already changed are recorded so they can be undone.
+	loop_closure_.Solve(track_);
+	if (loop_closure_.GetFirstIndex() < 0)
+	{
+		return;
+	}
+
+	history_.BeginGroup();
+	for (int i = loop_closure_.GetFirstIndex(); i < track_->GetTrackPieceCount(); i++)
+	{
+		history_.RecordEdit(i, before[i], track_->CaptureTrackPiece(i));
+	}
+	history_.EndGroup();
+
+	OnTrackChanged();
+}
+
+//	Queue a bake of the track. Automatic bank angles are solved by the worker as part of the bake,
+//		and the track is given them when the bake is collected.
+//		The roll channel is solved for the track as it is now, so it has to be redone on every change.
+void TrackBuilder::RequestBake(bool supports)
+{
+	if (!auto_bank_)
+	{
+		track_->SetRollChannel(nullptr);
+	}
+
+	baker_.RequestTrack(track_, supports, auto_bank_, bank_speed_);
+
+	baked_auto_bank_ = auto_bank_;
+	baked_bank_speed_ = bank_speed_;
+}
+
+//	Rebuild the mesh after the track has been edited somewhere other than its end.
+void TrackBuilder::OnTrackChanged()
+{
+	if (selected_piece_ > track_->GetTrackPieceCount() - 1)
+	{
+		selected_piece_ = track_->GetTrackPieceCount() > 0 ? track_->GetTrackPieceCount() - 1 : 0;
+	}
+
+	if (track_->GetTrackPieceCount() == 0)
+	{
+		baker_.Cancel();
+		track_preview_->EraseTrack();
+		track_mesh_->Clear();
+		track_->Reset();
+		return;
+	}
+
+	track_mesh_->ClearSupports();
+	RequestBake();
+
+	//	The end of the track may have moved, so the preview piece must match the new end-piece.
+	track_preview_->InitTrackPiece(track_->GetBack());
+	SetTrackPieceData();
+	track_preview_->SetPreviewActive(false);
 }
 
 void TrackBuilder::EraseTrack()
 {
+	baker_.Cancel();
+	history_.Clear();
 	track_->EraseTrack();
 	track_preview_->EraseTrack();
-	track_->GetTrackMesh()->Clear();
+	track_mesh_->Clear();
 	track_->Reset();
 }
 
+//	The loaded track has already generated its own mesh, so anything still baking is out of date.
 void TrackBuilder::SetTrackLoadToggle()
 {
+	baker_.Cancel();
 	track_preview_->SetPreviewActive(false);
+	history_.Clear();
 
 	track_load_toggle_ = true;
 }
@@ -246,6 +575,7 @@ void TrackBuilder::SetTrackPieceData()
 		track_piece_data_.p3_z = p3.Z();
 
 		track_piece_data_.roll_target = track_piece->GetRollTarget();
+		track_piece_data_.tension = track_piece->GetTension();
 	}
 }
 
@@ -287,6 +617,11 @@ int* TrackBuilder::SetRollTarget()
 	return &track_piece_data_.roll_target;
 }
 
+float* TrackBuilder::SetTension()
+{
+	return &track_piece_data_.tension;
+}
+
 bool TrackBuilder::GetActiveControlPoint(int control_point)
 {
 	return active_control_point_[control_point];
@@ -304,12 +639,19 @@ bool* TrackBuilder::SetPreviewFinished()
 
 void TrackBuilder::FinishPreview()
 {
-	track_->UpdateBack(track_piece_);
-	track_->GenerateMesh();
+	CommitPreview();
+	RequestBake();
 	track_preview_->SetPreviewActive(false);
 	preview_finished_ = false;
 }
 
+//	Wait for the worker and upload the result, so that the mesh matches the track before it is ridden.
+void TrackBuilder::FinishBaking()
+{
+	baker_.Wait();
+	baker_.Collect(track_mesh_, track_);
+}
+
 bool TrackBuilder::GetPreviewActive()
 {
 	return track_preview_->GetPreviewActive();
@@ -333,7 +675,7 @@ void TrackBuilder::SetEditMode(EditMode::EditModeTag tag)
 
 void TrackBuilder::UpdatePreviewMesh()
 {
-	track_preview_->GenerateMesh();
+	baker_.RequestPreview(track_piece_);
 }
 
 void TrackBuilder::SetControlPoint(int control_point, char element, float value)
@@ -2,8 +2,13 @@
 
 #include "Track.h"
 #include "EditMode.h"
+#include "TrackHistory.h"
+#include "TrackBaker.h"
+#include "LoopClosure.h"
+#include "TrackSmoother.h"
 
 class TrackPreview;
+class TrackMeshSink;
 
 class TrackBuilder
 {
@@ -26,8 +31,9 @@ public:
 		float p2_x, p2_y, p2_z;
 		float p3_x, p3_y, p3_z;
 		int roll_target;
+		float tension;
 	};
-	TrackBuilder(Track* track);
+	TrackBuilder(Track* track, TrackMeshSink* track_mesh);
 	void UpdateTrack();
 	void UpdatePreviewMesh();
 	bool* SetTrackPieceType(TrackPiece::Tag tag);
@@ -38,10 +44,25 @@ public:
 	void EraseTrack();
 	bool* SetPreviewFinished();
 	void FinishPreview();
+	void FinishBaking();
+	inline bool IsBaking() { return baker_.IsBusy(); }
 	bool GetPreviewActive();
+	bool* SetRemoveLastPiece();
 	bool* SetUndo();
+	bool* SetRedo();
+	inline TrackHistory* GetHistory() { return &history_; }
 	bool* SetBuildSupports();
+	bool* SetCloseLoop();
+	bool* SetSmoothJoints();
+	bool* SetAutoBank();
+	float* SetBankSpeed();
+	int* SetSelectedPiece();
+	int* SetEditPieceType();
+	bool* SetInsertPiece();
+	bool* SetReplacePiece();
+	bool* SetRemovePiece();
 	int* SetRollTarget();
+	float* SetTension();
 	void SetTrackLoadToggle();
 	float* GetTranslation();
 	void SetControlPoint(int control_point, char element, float value);
@@ -71,10 +92,18 @@ private:
 	void InitTrackPieceTypes();
 	void InitEditModeTypes();
 	void Build();
-	void Undo();
+	void RemoveLastPiece();
+	void EditSelectedPiece();
+	void CommitPreview();
+	void UndoRedo();
+	void OnTrackChanged();
+	void CloseLoop();
+	void SmoothJoints();
+	void RequestBake(bool supports = false);
 
 private:
 	Track* track_;
+	TrackMeshSink* track_mesh_;
 	TrackPreview* track_preview_;
 	TrackPieceType* track_piece_types_;
 	TrackPieceData track_piece_data_;
@@ -89,7 +118,25 @@ private:
 	void SetEditMode(EditMode::EditModeTag tag);
 	bool update_preview_mesh_;
 	bool preview_finished_;
+	bool remove_last_piece_;
 	bool undo_;
+	bool redo_;
+	TrackHistory history_;
+	TrackBaker baker_;
 	bool build_supports_;
+	bool close_loop_;
+	LoopClosure loop_closure_;
+	bool smooth_joints_;
+	TrackSmoother smoother_;
+	bool auto_bank_;
+	float bank_speed_;
+	//	The banking asked for by the last bake, so a change in the settings is only baked once.
+	bool baked_auto_bank_;
+	float baked_bank_speed_;
+	int selected_piece_;
+	int edit_piece_type_;
+	bool insert_piece_;
+	bool replace_piece_;
+	bool remove_piece_;
 	float translation_[3];
 };
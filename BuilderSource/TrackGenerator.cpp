@@ -0,0 +1,211 @@
+#include "TrackGenerator.h"
+
+#include "Track.h"
+#include <algorithm>
+
+namespace
+{
+	//	The cell behind the start, facing it. The way home ends here, so the closing piece is a straight.
+	const TrackGrid::Cell home = { 0, 0, -1, 0 };
+}
+
+TrackGenerator::TrackGenerator()
+{
+	constraints_.footprint = 6;
+	constraints_.max_height = 4;
+	constraints_.min_pieces = 16;
+	constraints_.max_pieces = 40;
+	constraints_.must_close = true;
+}
+
+//	Lay out a track from the seed and build it into the track. The same seed always gives the same track.
+//		Returns false, leaving the track empty, if no layout could be found within the constraints.
+bool TrackGenerator::Generate(unsigned int seed, Track* track)
+{
+	track->EraseTrack();
+	layout_.clear();
+	random_.seed(seed);
+
+	grid_.Resize(constraints_.footprint, constraints_.max_height);
+
+	end_.x = 0;
+	end_.y = 0;
+	end_.z = 0;
+	end_.heading = 0;
+	grid_.Occupy(end_);
+
+	//	The cell behind the start is kept free for the end of the track, including the corners of turns.
+	if (constraints_.must_close)
+	{
+		grid_.Occupy(home);
+	}
+
+	std::uniform_int_distribution<int> length(constraints_.min_pieces, std::max(constraints_.min_pieces, constraints_.max_pieces));
+	if (!Walk(length(random_)))
+	{
+		return false;
+	}
+
+	if (constraints_.must_close)
+	{
+		grid_.Vacate(home);
+		if (!FindWayHome())
+		{
+			return false;
+		}
+	}
+
+	Build(track);
+
+	return true;
+}
+
+//	Add random pieces that stay inside the footprint and don't run back into the track.
+//		A walk that boxes itself in is cut short, and only fails if it is shorter than the minimum.
+bool TrackGenerator::Walk(int piece_count)
+{
+	for (int i = 0; i < piece_count; i++)
+	{
+		//	Pick from the pieces that fit, in proportion to their weights.
+		Cell moves[TrackGrid::stock_count];
+		int total_weight = 0;
+		for (int k = 0; k < TrackGrid::stock_count; k++)
+		{
+			//	Every piece moves forwards, so a piece that leaves the track facing a wall or itself is a dead end.
+			bool valid = grid_.CanMove(end_, TrackGrid::stock_tags[k], moves[k]) && grid_.HasMove(moves[k], 1, false);
+			weights_[k] = valid ? TrackGrid::stock_weights[k] : 0;
+			total_weight += weights_[k];
+		}
+
+		if (total_weight == 0)
+		{
+			return i >= constraints_.min_pieces;
+		}
+
+		int value = std::uniform_int_distribution<int>(0, total_weight - 1)(random_);
+		int choice = 0;
+		while (value >= weights_[choice])
+		{
+			value -= weights_[choice];
+			choice++;
+		}
+
+		grid_.Occupy(end_, TrackGrid::stock_tags[choice], moves[choice]);
+		end_ = moves[choice];
+		layout_.push_back(TrackGrid::stock_tags[choice]);
+	}
+
+	return true;
+}
+
+//	Breadth first search over cells and headings for the fewest pieces that reach the cell behind the start, facing it.
+bool TrackGenerator::FindWayHome()
+{
+	const int width = constraints_.footprint * 2 + 1;
+	const int state_count = grid_.GetCellCount() * 4;
+
+	previous_state_.assign(state_count, -1);
+	previous_tag_.assign(state_count, 0);
+	queue_.clear();
+
+	int start = GetStateIndex(end_);
+	int goal = GetStateIndex(home);
+	previous_state_[start] = start;
+	queue_.push_back(start);
+
+	for (int head = 0; head < queue_.size() && previous_state_[goal] < 0; head++)
+	{
+		int state = queue_[head];
+
+		Cell cell;
+		cell.heading = state % 4;
+		int index = state / 4;
+		cell.x = index % width - constraints_.footprint;
+		index /= width;
+		cell.z = index % width - constraints_.footprint;
+		cell.y = index / width;
+
+		for (int i = 0; i < TrackGrid::stock_count; i++)
+		{
+			Cell next;
+			if (!grid_.CanMove(cell, TrackGrid::stock_tags[i], next))
+			{
+				continue;
+			}
+
+			int next_state = GetStateIndex(next);
+			if (previous_state_[next_state] >= 0)
+			{
+				continue;
+			}
+
+			previous_state_[next_state] = state;
+			previous_tag_[next_state] = i;
+			queue_.push_back(next_state);
+		}
+	}
+
+	if (previous_state_[goal] < 0)
+	{
+		return false;
+	}
+
+	//	Walk back from the goal, then add the pieces in the order they are driven.
+	std::vector<TrackPiece::Tag> way_home;
+	for (int state = goal; state != start; state = previous_state_[state])
+	{
+		way_home.push_back(TrackGrid::stock_tags[previous_tag_[state]]);
+	}
+
+	//	The search only avoids the track laid before it, so lay the way home on the grid too,
+	//		turning down the rare one that runs back into itself.
+	for (int i = way_home.size() - 1; i >= 0; i--)
+	{
+		Cell next;
+		if (!grid_.CanMove(end_, way_home[i], next))
+		{
+			return false;
+		}
+
+		grid_.Occupy(end_, way_home[i], next);
+		end_ = next;
+	}
+	layout_.insert(layout_.end(), way_home.rbegin(), way_home.rend());
+
+	return true;
+}
+
+int TrackGenerator::GetStateIndex(const Cell& cell)
+{
+	return grid_.GetCellIndex(cell) * 4 + cell.heading;
+}
+
+//	Add the pieces to the track, banking into the turns and levelling out everywhere else.
+void TrackGenerator::Build(Track* track)
+{
+	for (int i = 0; i < layout_.size(); i++)
+	{
+		track->AddTrackPiece(layout_[i]);
+
+		float roll_target = 0.0f;
+		if (layout_[i] == TrackPiece::Tag::RIGHT_TURN)
+		{
+			roll_target = -45.0f;
+		}
+		else if (layout_[i] == TrackPiece::Tag::LEFT_TURN)
+		{
+			roll_target = 45.0f;
+		}
+		track->GetBack()->SetRollTarget(roll_target);
+	}
+
+	if (constraints_.must_close)
+	{
+		track->AddTrackPiece(TrackPiece::Tag::COMPLETE_TRACK);
+		track->GetBack()->SetRollTarget(0.0f);
+	}
+}
+
+TrackGenerator::~TrackGenerator()
+{
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "TrackGrid.h"
+#include <vector>
+#include <random>
+
+class Track;
+
+//	Assembles random tracks from the stock pieces.
+//	Every stock piece moves the end of the track by whole multiples of 10 metres and leaves it facing along
+//		one of the four compass directions, so layouts are planned on a grid before any spline is built.
+//		A random walk lays out most of the track, then a breadth first search over the grid finds the
+//		shortest way back to the start, arriving one straight behind it so the closing piece is a straight.
+class TrackGenerator
+{
+public:
+	struct Constraints
+	{
+		//	Half the width of the square the track has to stay inside, in grid cells either side of the start.
+		int footprint;
+
+		//	Highest level the track can climb to, in grid cells above the start.
+		int max_height;
+
+		//	Length of the random part of the track, in pieces. The way home is added on top.
+		int min_pieces;
+		int max_pieces;
+
+		//	Finish the track with a closing piece. Otherwise the track is just the random walk.
+		bool must_close;
+	};
+
+	TrackGenerator();
+	bool Generate(unsigned int seed, Track* track);
+	inline Constraints& GetConstraints() { return constraints_; }
+	inline const std::vector<TrackPiece::Tag>& GetLayout() const { return layout_; }
+	~TrackGenerator();
+
+private:
+	typedef TrackGrid::Cell Cell;
+
+	bool Walk(int piece_count);
+	bool FindWayHome();
+	int GetStateIndex(const Cell& cell);
+	void Build(Track* track);
+
+private:
+	Constraints constraints_;
+	std::mt19937 random_;
+	std::vector<TrackPiece::Tag> layout_;
+	Cell end_;
+	int weights_[TrackGrid::stock_count];
+
+	//	Grid cells the track already passes through.
+	TrackGrid grid_;
+
+	//	Search state for the way home, indexed by cell and heading.
+	std::vector<int> previous_state_;
+	std::vector<int> previous_tag_;
+	std::vector<int> queue_;
+};
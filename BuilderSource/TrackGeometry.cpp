@@ -0,0 +1,608 @@
+#include "TrackGeometry.h"
+#include "CrossTieMesh.h"
+#include "JobSystem.h"
+#include "ScratchArena.h"
+#include "../Spline-Library/CRSpline.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+	//	Must match the rail meshes created by the TrackMesh. The rails sit offset from the centre of the track.
+	const float rail_radius[3] = { 0.06f, 0.06f, 0.26f };
+	const XMFLOAT2 rail_offset[3] = { XMFLOAT2(-0.35f, 0.0f), XMFLOAT2(0.35f, 0.0f), XMFLOAT2(0.0f, -0.30f) };
+	const unsigned int rail_slices[TrackGeometry::LOD_COUNT][3] = { { 10, 10, 6 }, { 6, 6, 4 }, { 4, 4, 3 } };
+
+	//	Rings are only placed where they are needed to follow the track. A ring can be skipped as long as the
+	//		frames it spans haven't turned or rolled further than the angle whose cosine is lod_min_cos, and their
+	//		centres are within lod_flatness metres of a straight line. No more than lod_max_step frames are skipped at a time.
+	//		Each level of detail is coarser than the last.
+	const unsigned int lod_max_step[TrackGeometry::LOD_COUNT] = { 10, 15, 30 };
+	const float lod_min_cos[TrackGeometry::LOD_COUNT] = { 0.9945f, 0.978f, 0.906f };
+	const float lod_flatness[TrackGeometry::LOD_COUNT] = { 0.01f, 0.05f, 0.2f };
+
+	//	Every lod_cross_tie_step'th cross tie is kept at each level. Zero drops them all.
+	const unsigned int lod_cross_tie_step[TrackGeometry::LOD_COUNT] = { 1, 2, 0 };
+
+	//	Sizes of the support pillars and the joints between their segments.
+	const float support_radius = 0.2f;
+	const float support_joint_radius = 0.19f;
+	const unsigned int support_slices[TrackGeometry::LOD_COUNT] = { 10, 6, 4 };
+
+	//	The rail texture repeats every 8 frames of a piece sampled at the usual rate, so it no longer stretches with the length of the track.
+	const float rail_texture_step = 0.125f;
+
+	//	Pieces are sampled with a frame at least every frame_spacing metres, and every frame_turn radians the track
+	//		turns or rolls through, so the rings can follow the track closely wherever it bends. The turn is measured
+	//		between turn_samples + 1 tangents along the piece. Frames come in whole steps between the cross ties,
+	//		of up to max_frames_per_tie frames, so every piece keeps the same evenly spaced ties.
+	const float frame_spacing = 0.75f;
+	const float frame_turn = 0.05f;
+	const unsigned int turn_samples = 8;
+	const unsigned int max_frames_per_tie = 6;
+
+	//	Serial number of the next BakedPiece. Tracks are baked on more than one thread, so it is shared between them.
+	std::atomic<unsigned long long> next_baked_serial(1);
+}
+
+TrackGeometry::TrackGeometry()
+{
+	frame_count_ = 0;
+	texture_v_ = 0.0f;
+	texture_v_step_ = rail_texture_step;
+	chunk_builds_ = nullptr;
+	adaptive_ = true;
+
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			rail_profiles_[lod][i].SetCircle(rail_radius[i], rail_slices[lod][i], rail_offset[i]);
+		}
+	}
+}
+
+unsigned int TrackGeometry::GetRailSlices(Part part, int lod)
+{
+	return rail_slices[lod][static_cast<int>(part)];
+}
+
+unsigned int TrackGeometry::GetSupportSlices(int lod)
+{
+	return support_slices[lod];
+}
+
+//	How many frames to sample a piece with, from its length and how far it turns and rolls from start to end.
+//		Always a whole number of frames for each of the piece's cross ties. Rolls are in degrees.
+unsigned int TrackGeometry::GetFramesForPiece(SL::CRSpline* segment, float length, float start_roll, float roll_target)
+{
+	float turn = fabsf(roll_target - start_roll) * 0.0174533f;
+
+	SL::Vector previous = segment->GetTangent(0.0f).Normalised();
+	for (unsigned int i = 1; i <= turn_samples; i++)
+	{
+		SL::Vector tangent = segment->GetTangent((float)i / turn_samples).Normalised();
+		turn += acosf(std::max(-1.0f, std::min(previous.Dot(tangent), 1.0f)));
+		previous = tangent;
+	}
+
+	float wanted = std::max(length / frame_spacing, turn / frame_turn);
+	unsigned int frames_per_tie = (unsigned int)ceilf(wanted / GetCrossTiesPerPiece());
+	frames_per_tie = std::max(1u, std::min(frames_per_tie, max_frames_per_tie));
+
+	return frames_per_tie * GetCrossTiesPerPiece();
+}
+
+//	Start a new piece of frame_count frames. The chunks are cut between pieces, and the rail texture is spread over
+//		each piece's frames. Geometry laid without starting any pieces is taken to be a single piece.
+void TrackGeometry::BeginPiece(unsigned int frame_count)
+{
+	Piece piece;
+	piece.first_frame = frames_.size();
+	piece.first_cross_tie = cross_ties_[0].size();
+	piece.serial = 0;
+	pieces_.push_back(piece);
+
+	texture_v_step_ = (frame_count > 0) ? rail_texture_step * GetFramesPerPiece() / frame_count : rail_texture_step;
+}
+
+//	Carry the rail texture on from earlier geometry, as if it had been laid at the usual rate.
+void TrackGeometry::SetTextureFrame(unsigned int frame)
+{
+	texture_v_ = frame * rail_texture_step;
+}
+
+//	Store a frame of reference along the track. The rings of the rails are placed around a selection of
+//		these frames once every frame is known, see Finalise.
+void TrackGeometry::AddFrame(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis)
+{
+	Frame frame;
+	XMStoreFloat3(&frame.centre, centre);
+	XMStoreFloat3(&frame.x_axis, x_axis);
+	XMStoreFloat3(&frame.y_axis, y_axis);
+	frame.v = texture_v_;
+	frames_.push_back(frame);
+
+	texture_v_ += texture_v_step_;
+
+	frame_count_++;
+}
+
+//	The axes are the frame of the track at the tie, which is turned into the rotation of the tie's own space onto it.
+void TrackGeometry::AddCrossTie(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis)
+{
+	XMMATRIX frame;
+	frame.r[0] = XMVectorSetW(XMVector3Normalize(x_axis), 0.0f);
+	frame.r[1] = XMVectorSetW(XMVector3Normalize(y_axis), 0.0f);
+	frame.r[2] = XMVectorSetW(XMVector3Normalize(z_axis), 0.0f);
+	frame.r[3] = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+
+	CrossTie cross_tie;
+	XMStoreFloat3(&cross_tie.position, centre);
+	XMStoreFloat4(&cross_tie.rotation, XMQuaternionNormalize(XMQuaternionRotationMatrix(frame)));
+	cross_ties_[0].push_back(cross_tie);
+}
+
+//	Copy the frames and cross ties of another geometry onto the end of this one, moving them by transform.
+//		Used to place track pieces that were baked once in their own local space. The transform must only move and turn them.
+void TrackGeometry::Append(const TrackGeometry& geometry, const XMMATRIX& transform)
+{
+	float v_offset = texture_v_;
+
+	for (int i = 0; i < geometry.pieces_.size(); i++)
+	{
+		Piece piece = geometry.pieces_[i];
+		piece.first_frame += frames_.size();
+		piece.first_cross_tie += cross_ties_[0].size();
+		piece.serial = 0;
+		pieces_.push_back(piece);
+	}
+
+	const std::vector<CrossTie>& source = geometry.cross_ties_[0];
+	XMVECTOR turn = XMQuaternionRotationMatrix(transform);
+
+	cross_ties_[0].reserve(cross_ties_[0].size() + source.size());
+	for (int i = 0; i < source.size(); i++)
+	{
+		CrossTie cross_tie;
+		XMStoreFloat3(&cross_tie.position, XMVector3Transform(XMLoadFloat3(&source[i].position), transform));
+		XMStoreFloat4(&cross_tie.rotation, XMQuaternionNormalize(XMQuaternionMultiply(XMLoadFloat4(&source[i].rotation), turn)));
+		cross_ties_[0].push_back(cross_tie);
+	}
+
+	frames_.reserve(frames_.size() + geometry.frames_.size());
+	for (int i = 0; i < geometry.frames_.size(); i++)
+	{
+		Frame frame = geometry.frames_[i];
+		XMStoreFloat3(&frame.centre, XMVector3Transform(XMLoadFloat3(&frame.centre), transform));
+		XMStoreFloat3(&frame.x_axis, XMVector3TransformNormal(XMLoadFloat3(&frame.x_axis), transform));
+		XMStoreFloat3(&frame.y_axis, XMVector3TransformNormal(XMLoadFloat3(&frame.y_axis), transform));
+		frame.v += v_offset;
+		frames_.push_back(frame);
+	}
+
+	frame_count_ += geometry.frame_count_;
+	texture_v_ += geometry.texture_v_;
+	texture_v_step_ = geometry.texture_v_step_;
+}
+
+//	Lay a piece just as it was baked before, carrying the rail texture on from the pieces before it.
+void TrackGeometry::AppendBakedPiece(const BakedPiece& baked)
+{
+	Piece piece;
+	piece.first_frame = frames_.size();
+	piece.first_cross_tie = cross_ties_[0].size();
+	piece.serial = baked.serial;
+	pieces_.push_back(piece);
+
+	cross_ties_[0].insert(cross_ties_[0].end(), baked.cross_ties.begin(), baked.cross_ties.end());
+
+	float v_offset = texture_v_;
+	frames_.reserve(frames_.size() + baked.frames.size());
+	for (int i = 0; i < baked.frames.size(); i++)
+	{
+		Frame frame = baked.frames[i];
+		frame.v += v_offset;
+		frames_.push_back(frame);
+	}
+
+	frame_count_ += baked.frames.size();
+	texture_v_ += baked.texture_v;
+	texture_v_step_ = baked.texture_v_step;
+}
+
+//	Copy the last piece laid into baked, and give both a new serial number, so chunks built from it can be recognised.
+//		The simulation values are left to the caller.
+void TrackGeometry::KeepLastPiece(BakedPiece& baked)
+{
+	if (pieces_.empty())
+	{
+		return;
+	}
+
+	Piece& piece = pieces_.back();
+	piece.serial = next_baked_serial++;
+	baked.serial = piece.serial;
+
+	baked.cross_ties.assign(cross_ties_[0].begin() + piece.first_cross_tie, cross_ties_[0].end());
+	baked.frames.assign(frames_.begin() + piece.first_frame, frames_.end());
+
+	float v_start = baked.frames.empty() ? texture_v_ : baked.frames[0].v;
+	for (int i = 0; i < baked.frames.size(); i++)
+	{
+		baked.frames[i].v -= v_start;
+	}
+
+	baked.texture_v = texture_v_ - v_start;
+	baked.texture_v_step = texture_v_step_;
+}
+
+void TrackGeometry::AddSupportVertical(XMVECTOR from, XMVECTOR to)
+{
+	AddPillar(from, to, XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), FindChunk(from));
+}
+
+//	An angled pillar out from the track, then a vertical one down to the ground, with a joint where they meet.
+void TrackGeometry::AddSupportSegmented(XMVECTOR vertical_from, XMVECTOR vertical_to,
+	XMVECTOR angled_from, XMVECTOR angled_to, XMVECTOR angled_x, XMVECTOR angled_z)
+{
+	unsigned int chunk = FindChunk(angled_from);
+
+	AddPillar(angled_from, angled_to, angled_x, angled_z, chunk);
+	AddPillar(vertical_from, vertical_to, XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), chunk);
+
+	SupportInstance joint;
+	XMStoreFloat4x4(&joint.world, XMMatrixScaling(support_joint_radius, support_joint_radius, support_joint_radius)
+		* XMMatrixTranslationFromVector(vertical_from));
+	joint.chunk = chunk;
+	joints_.push_back(joint);
+}
+
+//	Stretch the unit cylinder from one point to another. Its round sides lie along the two axes, which must be
+//		at right angles to the pillar.
+void TrackGeometry::AddPillar(XMVECTOR from, XMVECTOR to, XMVECTOR x_axis, XMVECTOR z_axis, unsigned int chunk)
+{
+	XMMATRIX world;
+	world.r[0] = XMVector3Normalize(x_axis) * support_radius;
+	world.r[1] = XMVectorSetW(to - from, 0.0f);
+	world.r[2] = XMVector3Normalize(z_axis) * support_radius;
+	world.r[3] = XMVectorSetW(from, 1.0f);
+
+	SupportInstance pillar;
+	XMStoreFloat4x4(&pillar.world, world);
+	pillar.chunk = chunk;
+	pillars_.push_back(pillar);
+}
+
+//	The chunk whose box holds the point, or the first chunk if none do.
+unsigned int TrackGeometry::FindChunk(XMVECTOR point) const
+{
+	for (unsigned int i = 0; i < chunks_.size(); i++)
+	{
+		XMVECTOR min = XMLoadFloat3(&chunks_[i].min);
+		XMVECTOR max = XMLoadFloat3(&chunks_[i].max);
+		if (XMVector3InBounds(point - (min + max) * 0.5f, (max - min) * 0.5f))
+		{
+			return i;
+		}
+	}
+
+	return 0;
+}
+
+//	Place the rings of each rail, and split the track into chunks for culling.
+void TrackGeometry::Finalise(ScratchArena& scratch, JobSystem* jobs)
+{
+	CalculateChunks(scratch, jobs);
+}
+
+//	Chunks are cut every few pieces, and bounded by the vertices and ties inside them.
+//		Each chunk's last frame is the next chunk's first, so the rails join up.
+//	The chunks choose their rings, then each is handed its own range of the vertices and ties, then fills that range in.
+//		Only handing out the ranges depends on the chunks before, and it is just a running total, so the rest is
+//		spread over the job system.
+void TrackGeometry::CalculateChunks(ScratchArena& scratch, JobSystem* jobs)
+{
+	const unsigned int pieces_per_chunk = GetPiecesPerChunk();
+	const unsigned int piece_count = pieces_.empty() ? 1 : pieces_.size();
+	const unsigned int cross_tie_count = cross_ties_[0].size();
+
+	unsigned int chunk_count = 0;
+	if ((frame_count_ > 1) || (cross_tie_count > 0))
+	{
+		chunk_count = (piece_count + pieces_per_chunk - 1) / pieces_per_chunk;
+	}
+
+	//	All of the working space is handed out here, before the chunks are split over the jobs.
+	chunks_.resize(chunk_count);
+	chunk_builds_ = scratch.Allocate<ChunkBuild>(chunk_count);
+	for (unsigned int i = 0; i < chunk_count; i++)
+	{
+		ChunkBuild& build = chunk_builds_[i];
+		unsigned int first_piece = i * pieces_per_chunk;
+		unsigned int end_piece = first_piece + pieces_per_chunk;
+		build.first_frame = GetPieceFrame(first_piece);
+		build.first_cross_tie = GetPieceCrossTie(first_piece);
+
+		//	The last chunk runs on to the frame that closes the track, and takes any ties that are left.
+		unsigned int last_frame = (end_piece < piece_count) ? GetPieceFrame(end_piece) : frame_count_ - 1;
+		unsigned int end_cross_tie = (end_piece < piece_count) ? GetPieceCrossTie(end_piece) : cross_tie_count;
+
+		build.frame_count = 0;
+		if ((frame_count_ > 0) && (build.first_frame < last_frame))
+		{
+			build.frame_count = last_frame - build.first_frame + 1;
+		}
+		build.cross_tie_count = end_cross_tie - build.first_cross_tie;
+		chunks_[i].key = CalculateChunkKey(first_piece, end_piece);
+
+		for (int lod = 0; lod < LOD_COUNT; lod++)
+		{
+			build.frames[lod] = scratch.Allocate<unsigned int>(build.frame_count);
+			build.ring_count[lod] = 0;
+		}
+		build.rings = scratch.Allocate<Frame>(build.frame_count);
+	}
+
+	JobSystem::ParallelFor(jobs, chunk_count, [this](unsigned int chunk) { SelectChunkFrames(chunk); });
+
+	//	Level 0 is the whole track's mesh. Its rings run on from one chunk to the next, sharing the ring at the join,
+	//		so the whole track can still be drawn as one mesh.
+	//	Lower levels are built for each chunk on its own, and take a share of the cross ties.
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		unsigned int ring_total = 0;
+		unsigned int tie_total = 0;
+
+		for (unsigned int i = 0; i < chunk_count; i++)
+		{
+			ChunkBuild& build = chunk_builds_[i];
+			Chunk& chunk = chunks_[i];
+
+			unsigned int ring_count = build.ring_count[lod];
+			bool shared = (lod == 0) && (ring_count > 0) && (ring_total > 0);
+			unsigned int first_ring = ring_total - (shared ? 1 : 0);
+			ring_total = first_ring + ring_count;
+
+			if (lod == 0)
+			{
+				build.shares_first_ring = shared;
+			}
+
+			for (int j = 0; j < 3; j++)
+			{
+				unsigned int ring = rail_profiles_[lod][j].GetPointCount();
+				chunk.first_vertex[lod][j] = first_ring * ring;
+				chunk.vertex_count[lod][j] = ring_count * ring;
+			}
+
+			if (lod == 0)
+			{
+				chunk.first_cross_tie[0] = build.first_cross_tie;
+				chunk.cross_tie_count[0] = build.cross_tie_count;
+			}
+			else
+			{
+				unsigned int step = lod_cross_tie_step[lod];
+				chunk.first_cross_tie[lod] = tie_total;
+				chunk.cross_tie_count[lod] = (step > 0) ? (build.cross_tie_count + step - 1) / step : 0;
+				tie_total += chunk.cross_tie_count[lod];
+			}
+		}
+
+		for (int j = 0; j < 3; j++)
+		{
+			parts_[lod][j].vertices.resize(ring_total * rail_profiles_[lod][j].GetPointCount());
+		}
+
+		if (lod > 0)
+		{
+			cross_ties_[lod].resize(tie_total);
+		}
+	}
+
+	JobSystem::ParallelFor(jobs, chunk_count, [this](unsigned int chunk) { BuildChunk(chunk); });
+
+	//	A chunk's box takes in the ring it shares, which the chunk before builds, so waits until every chunk is built.
+	JobSystem::ParallelFor(jobs, chunk_count, [this](unsigned int chunk) { BoundChunk(chunk); });
+
+	chunk_builds_ = nullptr;
+}
+
+//	A chunk is built from the frames of its own pieces and the first frame of the piece after it, or the frame that
+//		closes the track, so its key mixes the serial numbers of all of them, and whether it is the last chunk.
+unsigned long long TrackGeometry::CalculateChunkKey(unsigned int first_piece, unsigned int end_piece) const
+{
+	const unsigned int piece_count = pieces_.size();
+	if (first_piece >= piece_count)
+	{
+		return 0;
+	}
+
+	bool last = (end_piece >= piece_count);
+
+	unsigned long long key = 14695981039346656037ull;
+	for (unsigned int i = first_piece; (i <= end_piece) && (i < piece_count); i++)
+	{
+		if (pieces_[i].serial == 0)
+		{
+			return 0;
+		}
+
+		key = (key ^ pieces_[i].serial) * 1099511628211ull;
+	}
+
+	key = (key ^ (last ? 1ull : 0ull)) * 1099511628211ull;
+	return (key != 0) ? key : 1;
+}
+
+void TrackGeometry::SelectChunkFrames(unsigned int chunk)
+{
+	ChunkBuild& build = chunk_builds_[chunk];
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		build.ring_count[lod] = SelectFrames(build.first_frame, build.frame_count, lod, build.frames[lod]);
+	}
+}
+
+//	Extrude the chunk's rings into its range of each rail, and copy its share of the cross ties into each lower level.
+void TrackGeometry::BuildChunk(unsigned int chunk)
+{
+	ChunkBuild& build = chunk_builds_[chunk];
+	const Chunk& range = chunks_[chunk];
+
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		const unsigned int* frames = build.frames[lod];
+		unsigned int skip = ((lod == 0) && build.shares_first_ring) ? 1 : 0;
+
+		unsigned int ring_count = 0;
+		for (unsigned int i = skip; i < build.ring_count[lod]; i++)
+		{
+			build.rings[ring_count++] = frames_[frames[i]];
+		}
+
+		if (ring_count > 0)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				unsigned int first_vertex = range.first_vertex[lod][i] + skip * rail_profiles_[lod][i].GetPointCount();
+				rail_profiles_[lod][i].Extrude(build.rings, ring_count, &parts_[lod][i].vertices[first_vertex]);
+			}
+		}
+
+		if (lod > 0)
+		{
+			for (unsigned int i = 0; i < range.cross_tie_count[lod]; i++)
+			{
+				cross_ties_[lod][range.first_cross_tie[lod] + i] = cross_ties_[0][build.first_cross_tie + i * lod_cross_tie_step[lod]];
+			}
+		}
+	}
+}
+
+void TrackGeometry::BoundChunk(unsigned int chunk)
+{
+	Chunk& bounded = chunks_[chunk];
+	const XMVECTOR tie_reach = XMVectorReplicate(CrossTieMesh::GetReach());
+
+	XMVECTOR min = XMVectorReplicate(FLT_MAX);
+	XMVECTOR max = XMVectorReplicate(-FLT_MAX);
+	for (int i = 0; i < static_cast<int>(Part::PART_COUNT); i++)
+	{
+		for (unsigned int j = bounded.first_vertex[0][i]; j < bounded.first_vertex[0][i] + bounded.vertex_count[0][i]; j++)
+		{
+			XMVECTOR position = XMLoadFloat3(&parts_[0][i].vertices[j].position);
+			min = XMVectorMin(min, position);
+			max = XMVectorMax(max, position);
+		}
+	}
+
+	for (unsigned int i = bounded.first_cross_tie[0]; i < bounded.first_cross_tie[0] + bounded.cross_tie_count[0]; i++)
+	{
+		XMVECTOR position = XMLoadFloat3(&cross_ties_[0][i].position);
+		min = XMVectorMin(min, position - tie_reach);
+		max = XMVectorMax(max, position + tie_reach);
+	}
+
+	XMStoreFloat3(&bounded.min, min);
+	XMStoreFloat3(&bounded.max, max);
+}
+
+//	Choose which of a run of frames get rings, always keeping the first and last so chunks meet at every level.
+//		Greedily reaches as far from the last ring as the tolerances allow.
+//	frames needs room for frame_count entries. Returns how many were chosen.
+unsigned int TrackGeometry::SelectFrames(unsigned int first_frame, unsigned int frame_count, int lod, unsigned int* frames) const
+{
+	if (frame_count < 2)
+	{
+		return 0;
+	}
+
+	unsigned int last = first_frame + frame_count - 1;
+	unsigned int max_step = ((lod == 0) && !adaptive_) ? 1 : lod_max_step[lod];
+
+	unsigned int count = 0;
+	unsigned int kept = first_frame;
+	frames[count++] = kept;
+	while (kept < last)
+	{
+		unsigned int next = kept + 1;
+		while ((next < last) && (next + 1 - kept <= max_step) && SpanFlat(kept, next + 1, lod))
+		{
+			next++;
+		}
+
+		frames[count++] = next;
+		kept = next;
+	}
+
+	return count;
+}
+
+//	Whether the frames between first and last can be drawn as a single band of triangles:
+//		none of them face too differently from the first, and none stray too far from the straight line between the ends.
+bool TrackGeometry::SpanFlat(unsigned int first, unsigned int last, int lod) const
+{
+	XMVECTOR start = XMLoadFloat3(&frames_[first].centre);
+	XMVECTOR chord = XMLoadFloat3(&frames_[last].centre) - start;
+	float chord_length_sq = XMVectorGetX(XMVector3LengthSq(chord));
+	XMVECTOR x_first = XMVector3Normalize(XMLoadFloat3(&frames_[first].x_axis));
+	XMVECTOR y_first = XMVector3Normalize(XMLoadFloat3(&frames_[first].y_axis));
+
+	for (unsigned int i = first + 1; i <= last; i++)
+	{
+		XMVECTOR x = XMVector3Normalize(XMLoadFloat3(&frames_[i].x_axis));
+		XMVECTOR y = XMVector3Normalize(XMLoadFloat3(&frames_[i].y_axis));
+		if ((XMVectorGetX(XMVector3Dot(x_first, x)) < lod_min_cos[lod]) || (XMVectorGetX(XMVector3Dot(y_first, y)) < lod_min_cos[lod]))
+		{
+			return false;
+		}
+
+		if ((i < last) && (chord_length_sq > 0.0f))
+		{
+			XMVECTOR offset = XMLoadFloat3(&frames_[i].centre) - start;
+			XMVECTOR along = chord * (XMVectorGetX(XMVector3Dot(offset, chord)) / chord_length_sq);
+			if (XMVectorGetX(XMVector3LengthSq(offset - along)) > lod_flatness[lod] * lod_flatness[lod])
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+//	Empty the rails and cross ties, keeping the memory for the next bake.
+void TrackGeometry::Clear()
+{
+	frame_count_ = 0;
+	texture_v_ = 0.0f;
+	texture_v_step_ = rail_texture_step;
+
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		for (int i = 0; i < static_cast<int>(Part::PART_COUNT); i++)
+		{
+			parts_[lod][i].vertices.clear();
+		}
+
+		cross_ties_[lod].clear();
+	}
+
+	frames_.clear();
+	pieces_.clear();
+	chunks_.clear();
+}
+
+void TrackGeometry::ClearSupports()
+{
+	pillars_.clear();
+	joints_.clear();
+}
+
+TrackGeometry::~TrackGeometry()
+{
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "PipeMesh.h"
+#include "ProfileExtruder.h"
+#include <vector>
+
+class JobSystem;
+class ScratchArena;
+struct BakedPiece;
+
+namespace SL
+{
+	class CRSpline;
+}
+
+//	CPU side copy of the track's mesh: the rails, and the placement of each cross tie and of each pillar and joint of the supports.
+//	Nothing in here touches the GPU, so it can be baked on a worker thread and uploaded by the TrackMesh later.
+//		Once the frames are in, each chunk is built on its own, so a JobSystem can build them side by side. The working
+//		space for that comes from a ScratchArena, and is finished with once Finalise returns.
+//	Each piece is sampled with as many frames as its length and how sharply it turns and rolls call for, see
+//		GetFramesForPiece, and rings are only placed around the frames where the track turns or rolls,
+//		so straights need only a handful of rings. Each chunk of the track is also baked at lower levels of detail,
+//		for drawing it from further away.
+class TrackGeometry
+{
+public:
+	//	Level 0 is the full mesh. Each level after it has fewer slices, fewer rings and fewer cross ties.
+	static const int LOD_COUNT = 3;
+
+	enum class Part
+	{
+		LEFT_RAIL = 0,
+		RIGHT_RAIL,
+		SPINE,
+		PART_COUNT
+	};
+
+	//	The rings of one rail, one after another. They are always joined up the same way, see PipeMesh.
+	struct MeshData
+	{
+		std::vector<PipeMesh::VertexType> vertices;
+	};
+
+	//	One pillar or joint of the support structures, drawn by moving a mesh shared by every support.
+	//		Pillars move a unit cylinder running from the origin to (0, 1, 0), and joints a unit sphere.
+	//		Each is tagged with the chunk of track it holds up, so it can be drawn at that chunk's level of detail.
+	struct SupportInstance
+	{
+		XMFLOAT4X4 world;
+		unsigned int chunk;
+	};
+
+	//	Where one cross tie sits: its centre, and the rotation taking the tie's own space onto the track's frame there.
+	//		Every tie is the same mesh, see CrossTieMesh, so this is all that is kept for each one.
+	struct CrossTie
+	{
+		XMFLOAT3 position;
+		XMFLOAT4 rotation;
+	};
+
+	//	A run of a few pieces of track with a box around it, so it can be culled on its own.
+	//		Each rail of the chunk, at each level of detail, is a run of that level's rings. Its cross ties are a run
+	//		of that level's ties.
+	struct Chunk
+	{
+		unsigned int first_vertex[LOD_COUNT][static_cast<int>(Part::PART_COUNT)];
+		unsigned int vertex_count[LOD_COUNT][static_cast<int>(Part::PART_COUNT)];
+		unsigned int first_cross_tie[LOD_COUNT];
+		unsigned int cross_tie_count[LOD_COUNT];
+		XMFLOAT3 min;
+		XMFLOAT3 max;
+
+		//	Names the baked pieces the chunk was built from, see BakedPiece. A chunk with the same key at the same place
+		//		in a track holds the same meshes, so needn't be uploaded again. Zero if any piece was baked without keeping it.
+		unsigned long long key;
+	};
+
+	TrackGeometry();
+	void BeginPiece(unsigned int frame_count);
+	void AddFrame(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis);
+	void AddCrossTie(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis);
+	void Append(const TrackGeometry& geometry, const XMMATRIX& transform);
+	void AppendBakedPiece(const BakedPiece& baked);
+	void KeepLastPiece(BakedPiece& baked);
+	void AddSupportVertical(XMVECTOR from, XMVECTOR to);
+	void AddSupportSegmented(XMVECTOR vertical_from, XMVECTOR vertical_to,
+		XMVECTOR angled_from, XMVECTOR angled_to, XMVECTOR angled_x, XMVECTOR angled_z);
+	void Finalise(ScratchArena& scratch, JobSystem* jobs = nullptr);
+	void Clear();
+	void SetTextureFrame(unsigned int frame);
+	inline void SetAdaptive(bool adaptive) { adaptive_ = adaptive; }
+	void ClearSupports();
+	inline const MeshData& GetPart(Part part, int lod = 0) const { return parts_[lod][static_cast<int>(part)]; }
+	inline const std::vector<CrossTie>& GetCrossTies(int lod = 0) const { return cross_ties_[lod]; }
+	inline const std::vector<SupportInstance>& GetPillars() const { return pillars_; }
+	inline const std::vector<SupportInstance>& GetJoints() const { return joints_; }
+	inline const std::vector<Chunk>& GetChunks() const { return chunks_; }
+	inline unsigned int GetFrameCount() const { return frame_count_; }
+	inline static unsigned int GetCrossTieFrequency() { return 2; }
+	inline static unsigned int GetFramesPerPiece() { return 30; }
+	inline static unsigned int GetCrossTiesPerPiece() { return 15; }
+	inline static unsigned int GetPiecesPerChunk() { return 4; }
+	static unsigned int GetFramesForPiece(SL::CRSpline* segment, float length, float start_roll, float roll_target);
+	static unsigned int GetRailSlices(Part part, int lod = 0);
+	static unsigned int GetSupportSlices(int lod = 0);
+	~TrackGeometry();
+
+private:
+	//	Where the rails are built around, kept so the rings can be built again at lower detail.
+	typedef ProfileExtruder::Ring Frame;
+
+	//	Where each piece's frames and cross ties start. Chunks are cut between pieces.
+	//		Pieces kept as, or laid from, a BakedPiece have its serial number, and the rest zero.
+	struct Piece
+	{
+		unsigned int first_frame;
+		unsigned int first_cross_tie;
+		unsigned long long serial;
+	};
+
+	//	Working space for building one chunk. The arrays each have room for every frame of the chunk.
+	struct ChunkBuild
+	{
+		unsigned int first_frame;
+		unsigned int frame_count;
+		unsigned int first_cross_tie;
+		unsigned int cross_tie_count;
+
+		//	The frames given rings at each level of detail.
+		unsigned int* frames[LOD_COUNT];
+		unsigned int ring_count[LOD_COUNT];
+
+		//	Whether the first level 0 ring is the last ring of the chunk before, so is already there.
+		bool shares_first_ring;
+		Frame* rings;
+	};
+
+	void CalculateChunks(ScratchArena& scratch, JobSystem* jobs);
+	void SelectChunkFrames(unsigned int chunk);
+	void BuildChunk(unsigned int chunk);
+	void BoundChunk(unsigned int chunk);
+	unsigned int SelectFrames(unsigned int first_frame, unsigned int frame_count, int lod, unsigned int* frames) const;
+	bool SpanFlat(unsigned int first, unsigned int last, int lod) const;
+	void AddPillar(XMVECTOR from, XMVECTOR to, XMVECTOR x_axis, XMVECTOR z_axis, unsigned int chunk);
+	unsigned long long CalculateChunkKey(unsigned int first_piece, unsigned int end_piece) const;
+	unsigned int FindChunk(XMVECTOR point) const;
+	inline unsigned int GetPieceFrame(unsigned int piece) const { return pieces_.empty() ? 0 : pieces_[piece].first_frame; }
+	inline unsigned int GetPieceCrossTie(unsigned int piece) const { return pieces_.empty() ? 0 : pieces_[piece].first_cross_tie; }
+
+private:
+	MeshData parts_[LOD_COUNT][static_cast<int>(Part::PART_COUNT)];
+	std::vector<CrossTie> cross_ties_[LOD_COUNT];
+	std::vector<Frame> frames_;
+	std::vector<Piece> pieces_;
+	ChunkBuild* chunk_builds_;
+	ProfileExtruder rail_profiles_[LOD_COUNT][3];
+	std::vector<SupportInstance> pillars_;
+	std::vector<SupportInstance> joints_;
+	std::vector<Chunk> chunks_;
+	unsigned int frame_count_;
+
+	//	Texture coordinate along the rails of the next frame, and how far it moves on each frame of the current piece.
+	//		Every piece covers the same stretch of texture however many frames it has, so it doesn't stretch on curves.
+	float texture_v_;
+	float texture_v_step_;
+
+	//	Whether the full mesh places rings only where the track needs them, or around every frame.
+	bool adaptive_;
+};
+
+//	One piece of track as it was baked, kept with the snapshot of the piece it was baked from, see TrackPiece::State.
+//		When the same snapshot is baked again, and the track reaches it in the same frame, the piece is laid from here
+//		rather than simulated. See Track::StoreMeshData.
+struct BakedPiece
+{
+	//	The piece's frames, with the rail texture starting from zero, and its cross ties.
+	std::vector<ProfileExtruder::Ring> frames;
+	std::vector<TrackGeometry::CrossTie> cross_ties;
+
+	//	How far the piece carries the rail texture on, and at what rate.
+	float texture_v;
+	float texture_v_step;
+
+	//	The simulation the piece was baked from, and where it left the simulation. Rolls are in radians.
+	XMFLOAT3 start_forward;
+	XMFLOAT3 start_up;
+	float start_roll;
+	XMFLOAT3 end_forward;
+	XMFLOAT3 end_up;
+	XMFLOAT3 end_right;
+	float end_roll;
+
+	//	Different for every piece kept, so chunks can tell whether they were built from the same pieces.
+	unsigned long long serial;
+};
@@ -0,0 +1,172 @@
+#include "TrackGrid.h"
+
+#include <algorithm>
+
+namespace
+{
+	//	Grid steps for north, east, south and west. Turning right adds one to the heading.
+	const int heading_x[4] = { 0, 1, 0, -1 };
+	const int heading_z[4] = { 1, 0, -1, 0 };
+}
+
+const TrackPiece::Tag TrackGrid::stock_tags[TrackGrid::stock_count] =
+{
+	TrackPiece::Tag::STRAIGHT,
+	TrackPiece::Tag::RIGHT_TURN,
+	TrackPiece::Tag::LEFT_TURN,
+	TrackPiece::Tag::CLIMB_UP,
+	TrackPiece::Tag::CLIMB_DOWN
+};
+
+const int TrackGrid::stock_weights[TrackGrid::stock_count] = { 4, 2, 2, 1, 1 };
+
+TrackGrid::TrackGrid()
+{
+	footprint_ = 0;
+	max_height_ = 0;
+}
+
+//	Size the grid to a square footprint cells either side of the origin, and max_height levels above it. Clears it too.
+void TrackGrid::Resize(int footprint, int max_height)
+{
+	footprint_ = footprint;
+	max_height_ = max_height;
+
+	const int width = footprint_ * 2 + 1;
+	occupied_.assign(width * width * (max_height_ + 1), 0);
+}
+
+void TrackGrid::Clear()
+{
+	std::fill(occupied_.begin(), occupied_.end(), 0);
+}
+
+//	Where the end of the track ends up after adding a stock piece, or false if that leaves the grid.
+bool TrackGrid::Move(const Cell& from, TrackPiece::Tag tag, Cell& to) const
+{
+	to = from;
+	to.x += heading_x[from.heading];
+	to.z += heading_z[from.heading];
+
+	switch (tag)
+	{
+	case TrackPiece::Tag::RIGHT_TURN:
+		to.heading = (from.heading + 1) % 4;
+		to.x += heading_x[to.heading];
+		to.z += heading_z[to.heading];
+		break;
+
+	case TrackPiece::Tag::LEFT_TURN:
+		to.heading = (from.heading + 3) % 4;
+		to.x += heading_x[to.heading];
+		to.z += heading_z[to.heading];
+		break;
+
+	case TrackPiece::Tag::CLIMB_UP:
+		to.y++;
+		break;
+
+	case TrackPiece::Tag::CLIMB_DOWN:
+		to.y--;
+		break;
+
+	default:
+		break;
+	}
+
+	return IsInside(to);
+}
+
+//	A turn cuts across the corner of the square it turns in, and a climb across the square it climbs in, so
+//		both pass close to the cell straight ahead of where they start as well as the one they end in.
+//		Marking that cell too means two pieces can't cross over in the same square. Returns false for a straight.
+bool TrackGrid::GetCorner(const Cell& from, TrackPiece::Tag tag, Cell& corner) const
+{
+	if (tag == TrackPiece::Tag::STRAIGHT)
+	{
+		return false;
+	}
+
+	corner = from;
+	corner.x += heading_x[from.heading];
+	corner.z += heading_z[from.heading];
+
+	return true;
+}
+
+//	Like Move, but also false if the piece would run into the track already on the grid.
+bool TrackGrid::CanMove(const Cell& from, TrackPiece::Tag tag, Cell& to) const
+{
+	if (!Move(from, tag, to) || IsOccupied(to))
+	{
+		return false;
+	}
+
+	//	The corner is inside the grid whenever the end of the piece is.
+	Cell corner;
+	return !GetCorner(from, tag, corner) || !IsOccupied(corner);
+}
+
+//	Whether the track can carry on for 'depth' more pieces from the cell, optionally running through the track already laid.
+bool TrackGrid::HasMove(const Cell& from, int depth, bool ignore_track) const
+{
+	if (depth <= 0)
+	{
+		return true;
+	}
+
+	for (int i = 0; i < stock_count; i++)
+	{
+		Cell next;
+		bool valid = ignore_track ? Move(from, stock_tags[i], next) : CanMove(from, stock_tags[i], next);
+		if (valid && HasMove(next, depth - 1, ignore_track))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void TrackGrid::Occupy(const Cell& cell)
+{
+	occupied_[GetCellIndex(cell)]++;
+}
+
+//	Mark the cells a piece from 'from' to 'to' passes through, leaving out the one it starts in.
+void TrackGrid::Occupy(const Cell& from, TrackPiece::Tag tag, const Cell& to)
+{
+	Cell corner;
+	if (GetCorner(from, tag, corner))
+	{
+		Occupy(corner);
+	}
+	Occupy(to);
+}
+
+void TrackGrid::Vacate(const Cell& cell)
+{
+	occupied_[GetCellIndex(cell)]--;
+}
+
+bool TrackGrid::IsOccupied(const Cell& cell) const
+{
+	return occupied_[GetCellIndex(cell)] > 0;
+}
+
+bool TrackGrid::IsInside(const Cell& cell) const
+{
+	return (cell.x >= -footprint_) && (cell.x <= footprint_) &&
+		(cell.z >= -footprint_) && (cell.z <= footprint_) &&
+		(cell.y >= 0) && (cell.y <= max_height_);
+}
+
+int TrackGrid::GetCellIndex(const Cell& cell) const
+{
+	const int width = footprint_ * 2 + 1;
+	return ((cell.y * width) + (cell.z + footprint_)) * width + (cell.x + footprint_);
+}
+
+TrackGrid::~TrackGrid()
+{
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "TrackPiece.h"
+#include <vector>
+
+//	The grid that track layouts are planned on, shared by the TrackGenerator and the EndlessRide.
+//	Every stock piece moves the end of the track by whole 10 metre cells and leaves it facing along one of the
+//		four compass directions. The grid counts the pieces that pass through each cell, so a layout can be kept
+//		from running into itself before any spline is built.
+class TrackGrid
+{
+public:
+	struct Cell
+	{
+		int x;
+		int y;
+		int z;
+		int heading;
+	};
+
+	static const int stock_count = 5;
+
+	//	The stock pieces, in the order of their tags, and how often a random layout picks each of them.
+	static const TrackPiece::Tag stock_tags[stock_count];
+	static const int stock_weights[stock_count];
+
+	TrackGrid();
+	void Resize(int footprint, int max_height);
+	void Clear();
+	bool Move(const Cell& from, TrackPiece::Tag tag, Cell& to) const;
+	bool GetCorner(const Cell& from, TrackPiece::Tag tag, Cell& corner) const;
+	bool CanMove(const Cell& from, TrackPiece::Tag tag, Cell& to) const;
+	bool HasMove(const Cell& from, int depth, bool ignore_track) const;
+	void Occupy(const Cell& cell);
+	void Occupy(const Cell& from, TrackPiece::Tag tag, const Cell& to);
+	void Vacate(const Cell& cell);
+	bool IsOccupied(const Cell& cell) const;
+	bool IsInside(const Cell& cell) const;
+	int GetCellIndex(const Cell& cell) const;
+	inline int GetCellCount() const { return occupied_.size(); }
+	~TrackGrid();
+
+private:
+	int footprint_;
+	int max_height_;
+
+	//	Number of pieces passing through each cell.
+	std::vector<char> occupied_;
+};
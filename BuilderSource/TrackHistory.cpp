@@ -0,0 +1,188 @@
+#include "TrackHistory.h"
+
+#include "Track.h"
+
+TrackHistory::TrackHistory(unsigned int max_steps) : max_steps_(max_steps), current_group_(0), next_group_(1)
+{
+}
+
+void TrackHistory::Record(CommandType type, int index, TrackPiece::StatePtr before, TrackPiece::StatePtr after)
+{
+	Command command;
+	command.type = type;
+	command.index = index;
+	command.before = before;
+	command.after = after;
+	command.group = current_group_;
+
+	undo_stack_.push_back(command);
+
+	//	A new edit makes the redo history invalid.
+	redo_stack_.clear();
+
+	//	Forget the oldest steps once the limit has been reached.
+	//		A group is never left half in the history.
+	while (undo_stack_.size() > max_steps_)
+	{
+		unsigned int group = undo_stack_.front().group;
+		undo_stack_.pop_front();
+
+		while (group != 0 && !undo_stack_.empty() && undo_stack_.front().group == group)
+		{
+			undo_stack_.pop_front();
+		}
+	}
+}
+
+//	Every command recorded until EndGroup is treated as a single step.
+void TrackHistory::BeginGroup()
+{
+	current_group_ = next_group_++;
+
+	//	Zero is reserved for commands that are not in a group.
+	if (next_group_ == 0)
+	{
+		next_group_ = 1;
+	}
+}
+
+void TrackHistory::EndGroup()
+{
+	current_group_ = 0;
+}
+
+//	Record a change to an existing piece, working out which kind of edit it was.
+//		Nothing is recorded if the piece did not change.
+void TrackHistory::RecordEdit(int index, TrackPiece::StatePtr before, TrackPiece::StatePtr after)
+{
+	if (!before || !after)
+	{
+		return;
+	}
+
+	bool control_points_changed = false;
+	for (int i = 0; i < 4; i++)
+	{
+		SL::Vector difference = after->control_points[i].Subtract(before->control_points[i]);
+		if (difference.LengthSquared() > 0.0f)
+		{
+			control_points_changed = true;
+		}
+	}
+
+	if (control_points_changed)
+	{
+		Record(CommandType::EDIT_CONTROL_POINT, index, before, after);
+	}
+	else if (after->tension != before->tension)
+	{
+		Record(CommandType::EDIT_TENSION, index, before, after);
+	}
+	else if (after->roll_target != before->roll_target)
+	{
+		Record(CommandType::EDIT_ROLL, index, before, after);
+	}
+}
+
+bool TrackHistory::Undo(Track* track)
+{
+	if (undo_stack_.empty())
+	{
+		return false;
+	}
+
+	bool result = true;
+	unsigned int group = undo_stack_.back().group;
+
+	do
+	{
+		Command command = undo_stack_.back();
+		undo_stack_.pop_back();
+
+		result = Apply(track, command, false) && result;
+		redo_stack_.push_back(command);
+	} while (group != 0 && !undo_stack_.empty() && undo_stack_.back().group == group);
+
+	return result;
+}
+
+bool TrackHistory::Redo(Track* track)
+{
+	if (redo_stack_.empty())
+	{
+		return false;
+	}
+
+	bool result = true;
+	unsigned int group = redo_stack_.back().group;
+
+	do
+	{
+		Command command = redo_stack_.back();
+		redo_stack_.pop_back();
+
+		result = Apply(track, command, true) && result;
+		undo_stack_.push_back(command);
+	} while (group != 0 && !redo_stack_.empty() && redo_stack_.back().group == group);
+
+	return result;
+}
+
+//	Perform the command (forward) or its inverse.
+bool TrackHistory::Apply(Track* track, const Command& command, bool forward)
+{
+	switch (command.type)
+	{
+	case CommandType::ADD:
+	case CommandType::INSERT:
+		if (forward)
+		{
+			return track->RestoreTrackPiece(command.index, command.after, true);
+		}
+		return track->RemoveTrackPiece(command.index);
+
+	case CommandType::REMOVE:
+		if (forward)
+		{
+			return track->RemoveTrackPiece(command.index);
+		}
+		return track->RestoreTrackPiece(command.index, command.before, true);
+
+	default:
+		return track->RestoreTrackPiece(command.index, forward ? command.after : command.before, false);
+	}
+}
+
+void TrackHistory::Clear()
+{
+	undo_stack_.clear();
+	redo_stack_.clear();
+	current_group_ = 0;
+}
+
+const char* TrackHistory::GetCommandName(CommandType type)
+{
+	switch (type)
+	{
+	case CommandType::ADD:
+		return "Add Piece";
+	case CommandType::REMOVE:
+		return "Remove Piece";
+	case CommandType::INSERT:
+		return "Insert Piece";
+	case CommandType::REPLACE:
+		return "Replace Piece";
+	case CommandType::EDIT_CONTROL_POINT:
+		return "Edit Control Points";
+	case CommandType::EDIT_ROLL:
+		return "Edit Roll";
+	case CommandType::EDIT_TENSION:
+		return "Edit Tension";
+	default:
+		return "";
+	}
+}
+
+TrackHistory::~TrackHistory()
+{
+}
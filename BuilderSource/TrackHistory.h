@@ -0,0 +1,63 @@
+#pragma once
+
+#include "TrackPiece.h"
+#include <deque>
+
+class Track;
+
+//	Undo/redo history of edits made to the track.
+//	Each command only holds the index it applies to and snapshots of the piece before and after the edit.
+//		Snapshots are immutable and share their arc length tables with the track, so a step costs a fixed
+//		amount of memory no matter how long the track is, and undoing does not need to measure the spline again.
+//	Once baked, a snapshot also carries the geometry it was baked into, so undoing or redoing an edit puts the
+//		piece's old geometry back rather than simulating it again. Pieces that moved to follow the edit are baked anew.
+class TrackHistory
+{
+public:
+	enum class CommandType
+	{
+		ADD = 0,
+		REMOVE,
+		INSERT,
+		REPLACE,
+		EDIT_CONTROL_POINT,
+		EDIT_ROLL,
+		EDIT_TENSION
+	};
+
+	struct Command
+	{
+		CommandType type;
+		int index;
+		TrackPiece::StatePtr before;
+		TrackPiece::StatePtr after;
+
+		//	Commands in the same group are undone and redone together. Zero if the command is on its own.
+		unsigned int group;
+	};
+
+	TrackHistory(unsigned int max_steps = 8192);
+	void Record(CommandType type, int index, TrackPiece::StatePtr before, TrackPiece::StatePtr after);
+	void RecordEdit(int index, TrackPiece::StatePtr before, TrackPiece::StatePtr after);
+	bool Undo(Track* track);
+	bool Redo(Track* track);
+	void BeginGroup();
+	void EndGroup();
+	void Clear();
+	inline bool CanUndo() { return !undo_stack_.empty(); }
+	inline bool CanRedo() { return !redo_stack_.empty(); }
+	inline unsigned int GetUndoCount() { return undo_stack_.size(); }
+	inline unsigned int GetRedoCount() { return redo_stack_.size(); }
+	static const char* GetCommandName(CommandType type);
+	~TrackHistory();
+
+private:
+	bool Apply(Track* track, const Command& command, bool forward);
+
+private:
+	std::deque<Command> undo_stack_;
+	std::deque<Command> redo_stack_;
+	unsigned int max_steps_;
+	unsigned int current_group_;
+	unsigned int next_group_;
+};
@@ -51,8 +51,19 @@ bool TrackLoader::LoadTrack(char file_name[], Track* track)
             file >> roll_target;
             piece->SetRollTarget(roll_target);
 
+            //  The length is measured again once the piece is on the spline, so is only read to keep the file format.
             file >> length;
-            piece->SetLength(length);
+
+            //  Stop at the first malformed track piece, rather than loading a track made of garbage.
+            if (file.fail())
+            {
+                //  The spline segment is normally owned by the spline controller, but this one was never added.
+                delete piece->GetSpline();
+                delete piece;
+                file.close();
+                track->EraseTrack();
+                return false;
+            }
 
             piece->CalculateSpline();
 
@@ -91,7 +102,7 @@ bool TrackLoader::SaveTrack(char file_name[], Track* track)
             file << point.X() << " " << point.Y() << " " << point.Z() << std::endl;
             file << piece->GetTension() << std::endl;
             file << piece->GetRollTarget() << std::endl;
-            file << piece->GetLength() << std::endl;
+            file << track->GetPieceLength(i) << std::endl;
         }
 
         file.close();
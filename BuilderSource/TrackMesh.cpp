@@ -1,210 +1,462 @@
 #include "TrackMesh.h"
+#include "TrackGeometry.h"
 
-TrackMesh::TrackMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, BaseShader* shader, unsigned int max_segments) 
-	: device_(device), device_context_(deviceContext), shader_(shader), max_segments_(max_segments)
+TrackMesh::TrackMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, SceneShader* shader, InstancedShader* instanced_shader,
+	InstancedShader* cross_tie_shader, PackedShader* packed_shader) 
+	: device_(device), device_context_(deviceContext), shader_(shader), cross_tie_shader_(cross_tie_shader), packed_shader_(packed_shader)
 {
 	update_instances_ = false;
+	preview_active_ = true;
+	visible_ = true;
+	lod_distances_[0] = 60.0f;
+	lod_distances_[1] = 150.0f;
+	world_matrix_ = XMMatrixIdentity();
 	small_rail_texture_ = nullptr;
 	large_rail_texture_ = nullptr;
 	cross_tie_texture_ = nullptr;
 
-	//	Simulating Mesh:----------------------------------------------------------------------------
-	PipeMesh* rail_mesh = new PipeMesh(device, deviceContext, 0.06f, max_segments_);
-	//rail_mesh->AllowIndicesOverride();
-	rail_meshes_.push_back(rail_mesh);
-	rail_mesh = new PipeMesh(device, deviceContext, 0.06f, max_segments_);
-	//rail_mesh->AllowIndicesOverride();
-	rail_meshes_.push_back(rail_mesh);
-	rail_mesh = new PipeMesh(device, deviceContext, 0.26f, max_segments_, 6);
-	//rail_mesh->AllowIndicesOverride();
-	rail_meshes_.push_back(rail_mesh);
-
-	MeshInstance* rail = new MeshInstance(nullptr, shader, rail_meshes_[0]);
-	rail->SetColour(XMFLOAT4(0.46f, 0.62f, 0.8f, 0.0f));
-	simulating_instances_.push_back(rail);
-	rail = new MeshInstance(nullptr, shader, rail_meshes_[1]);
-	rail->SetColour(XMFLOAT4(0.46f, 0.62f, 0.8f, 0.0f));
-	simulating_instances_.push_back(rail);
-	rail = new MeshInstance(nullptr, shader, rail_meshes_[2]);	//Large
-	rail->SetColour(XMFLOAT4(0.3f, 0.3f, 0.3f, 0.0f));
-	simulating_instances_.push_back(rail);
-
-	CrossTieMesh* cross_ties_mesh = new CrossTieMesh(device, deviceContext, max_segments_);
-	cross_ties_meshes_.push_back(cross_ties_mesh);
-	MeshInstance* cross_ties = new MeshInstance(nullptr, shader, cross_ties_meshes_[0]);
-	cross_ties->SetColour(XMFLOAT4(0.2f, 0.2f, 0.2f, 0.0f));
-	simulating_instances_.push_back(cross_ties);
+	//	Simulating mesh chunks are created as the track grows, see AddChunk. Every cross tie is the same mesh.
+	cross_tie_mesh_ = new CrossTieMesh(device, deviceContext);
 
 	//	Preview mesh:-------------------------------------------------------------------------------
-	PipeMesh* preview_rail_mesh = new PipeMesh(device, deviceContext, 0.06f, max_segments_);
+	PipeMesh* preview_rail_mesh = new PipeMesh(device, deviceContext, 0.06f);
 	rail_meshes_.push_back(preview_rail_mesh);
-	preview_rail_mesh = new PipeMesh(device, deviceContext, 0.06f, max_segments_);
+	preview_rail_mesh = new PipeMesh(device, deviceContext, 0.06f);
 	rail_meshes_.push_back(preview_rail_mesh);
-	preview_rail_mesh = new PipeMesh(device, deviceContext, 0.26f, max_segments_, 6);
+	preview_rail_mesh = new PipeMesh(device, deviceContext, 0.26f, 6);
 	rail_meshes_.push_back(preview_rail_mesh);
 
-	CrossTieMesh* preview_cross_tie_mesh = new CrossTieMesh(device, deviceContext, max_segments_);
-	cross_ties_meshes_.push_back(preview_cross_tie_mesh);
-	
-	MeshInstance* preview_rail = new MeshInstance(nullptr, shader, rail_meshes_[3]);
+	MeshInstance* preview_rail = new MeshInstance(nullptr, shader, rail_meshes_[0]);
 	preview_rail->SetColour(XMFLOAT4(0.46f, 0.62f, 0.8f, 0.0f));
 	preview_instances_.push_back(preview_rail);
-	preview_rail = new MeshInstance(nullptr, shader, rail_meshes_[4]);
+	preview_rail = new MeshInstance(nullptr, shader, rail_meshes_[1]);
 	preview_rail->SetColour(XMFLOAT4(0.46f, 0.62f, 0.8f, 0.0f));
 	preview_instances_.push_back(preview_rail);
-	preview_rail = new MeshInstance(nullptr, shader, rail_meshes_[5]);
+	preview_rail = new MeshInstance(nullptr, shader, rail_meshes_[2]);
 	preview_rail->SetColour(XMFLOAT4(0.3f, 0.3f, 0.3f, 0.0f));
 	preview_instances_.push_back(preview_rail);
 
-	MeshInstance* preview_cross_ties = new MeshInstance(nullptr, shader, cross_ties_meshes_[1]);
-	preview_cross_ties->SetColour(XMFLOAT4(0.2f, 0.2f, 0.2f, 0.0f));
-	preview_instances_.push_back(preview_cross_ties);
+	preview_cross_ties_ = new InstancedMeshInstance(device, deviceContext, cross_tie_shader, cross_tie_mesh_, sizeof(TrackGeometry::CrossTie));
+	preview_cross_ties_->SetColour(XMFLOAT4(0.2f, 0.2f, 0.2f, 0.0f));
+	preview_instances_.push_back(preview_cross_ties_);
 
+	//	Supports:-----------------------------------------------------------------------------------
 	sphere_mesh_ = new SphereMesh(device, deviceContext, 10);
+	joint_instances_ = new InstancedMeshInstance(device, deviceContext, instanced_shader, sphere_mesh_);
+
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+	{
+		support_meshes_[lod] = new SupportMesh(device, deviceContext, TrackGeometry::GetSupportSlices(lod));
+		pillar_instances_[lod] = new InstancedMeshInstance(device, deviceContext, instanced_shader, support_meshes_[lod]);
+	}
 }
 
-void TrackMesh::StorePoints(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis)
+//	Copy the baked track geometry into the simulating mesh, one chunk and level of detail at a time.
+//		A chunk built from the same baked pieces as the one already uploaded to it is left alone.
+void TrackMesh::UploadTrack(const TrackGeometry& geometry)
 {
-	rail_meshes_[0]->AddCircleOrigin(centre - (x_axis * 0.35f), x_axis, y_axis);
-	rail_meshes_[1]->AddCircleOrigin(centre + (x_axis * 0.35f), x_axis, y_axis);
-	rail_meshes_[2]->AddCircleOrigin(centre - (y_axis * 0.30f), x_axis, y_axis);
+	const std::vector<TrackGeometry::Chunk>& chunks = geometry.GetChunks();
+
+	while (chunks_.size() < chunks.size())
+	{
+		AddChunk();
+	}
+
+	//	Give back any chunks the track no longer reaches, so they can be used again when it grows.
+	while (chunks_.size() > chunks.size())
+	{
+		ReleaseChunk();
+	}
+
+	for (int i = 0; i < chunks.size(); i++)
+	{
+		const TrackGeometry::Chunk& chunk = chunks[i];
+		Chunk* mesh_chunk = GetChunk(i);
+		if ((chunk.key != 0) && (chunk.key == mesh_chunk->key))
+		{
+			continue;
+		}
+
+		for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				const TrackGeometry::MeshData& rail = geometry.GetPart(static_cast<TrackGeometry::Part>(j), lod);
+				if (chunk.vertex_count[lod][j] > 0)
+				{
+					mesh_chunk->rail_meshes[lod][j]->Upload(&rail.vertices[chunk.first_vertex[lod][j]], chunk.vertex_count[lod][j]);
+				}
+				else
+				{
+					mesh_chunk->rail_meshes[lod][j]->Clear();
+				}
+			}
+
+			const std::vector<TrackGeometry::CrossTie>& cross_ties = geometry.GetCrossTies(lod);
+			if (chunk.cross_tie_count[lod] > 0)
+			{
+				mesh_chunk->cross_ties[lod]->SetInstances(&cross_ties[chunk.first_cross_tie[lod]], chunk.cross_tie_count[lod]);
+			}
+			else
+			{
+				mesh_chunk->cross_ties[lod]->Clear();
+			}
+
+			for (int j = 0; j < 4; j++)
+			{
+				mesh_chunk->instances[lod][j]->SetBounds(chunk.min, chunk.max);
+			}
+		}
+
+		mesh_chunk->min = chunk.min;
+		mesh_chunk->max = chunk.max;
+		mesh_chunk->key = chunk.key;
+	}
+
+	for (int i = 0; i < chunks_.size(); i++)
+	{
+		SetChunkRender(i);
+	}
 }
 
-void TrackMesh::AddCrossTie(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis)
+//	Pick each chunk's level of detail from how far its box is from the camera.
+void TrackMesh::UpdateLod(XMVECTOR camera_position)
 {
-	cross_ties_meshes_[0]->AddCrossTie(centre, x_axis * -0.35f, x_axis * 0.35f, y_axis * 0.25f, z_axis * 0.05f);
+	//	The chunks' boxes are in the track's own space.
+	XMVECTOR position = XMVector3Transform(camera_position, XMMatrixInverse(nullptr, world_matrix_));
+	bool changed = false;
+
+	for (int i = 0; i < chunks_.size(); i++)
+	{
+		Chunk& chunk = *GetChunk(i);
+		XMVECTOR closest = XMVectorClamp(position, XMLoadFloat3(&chunk.min), XMLoadFloat3(&chunk.max));
+		float distance = XMVectorGetX(XMVector3Length(position - closest));
+
+		int lod = 0;
+		while ((lod < TrackGeometry::LOD_COUNT - 1) && (distance > lod_distances_[lod]))
+		{
+			lod++;
+		}
+
+		if (lod != chunk.lod)
+		{
+			chunk.lod = lod;
+			SetChunkRender(i);
+			changed = true;
+		}
+	}
+
+	if (changed)
+	{
+		UpdateSupports();
+	}
 }
 
-void TrackMesh::AddPreviewCrossTie(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis)
+//	Keep a copy of where the supports go, and draw them.
+void TrackMesh::UploadSupports(const TrackGeometry& geometry)
 {
-	cross_ties_meshes_[1]->AddCrossTie(centre, x_axis * -0.35f, x_axis * 0.35f, y_axis * 0.25f, z_axis * 0.05f);
+	pillars_ = geometry.GetPillars();
+	joints_ = geometry.GetJoints();
+
+	UpdateSupports();
 }
 
-void TrackMesh::AddSupportVertical(XMVECTOR from, XMVECTOR to)
+//	Sort the pillars by the level of detail of the chunk they hold up, and upload each level's matrices in one go.
+void TrackMesh::UpdateSupports()
 {
-	SupportMesh* vertical_support_mesh = new SupportMesh(device_, device_context_, from, to);
-	MeshInstance* vertical_support = new MeshInstance(nullptr, shader_, vertical_support_mesh);
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+	{
+		support_matrices_.clear();
+		for (int i = 0; i < pillars_.size(); i++)
+		{
+			unsigned int chunk = pillars_[i].chunk;
+			int chunk_lod = (chunk < chunks_.size()) ? GetChunk(chunk)->lod : 0;
+			if (chunk_lod == lod)
+			{
+				support_matrices_.push_back(pillars_[i].world);
+			}
+		}
 
-	support_instances_.push_back(vertical_support);
-	support_meshes_.push_back(vertical_support_mesh);
-	update_instances_ = true;
+		pillar_instances_[lod]->SetInstances(support_matrices_);
+	}
+
+	support_matrices_.clear();
+	for (int i = 0; i < joints_.size(); i++)
+	{
+		support_matrices_.push_back(joints_[i].world);
+	}
+
+	joint_instances_->SetInstances(support_matrices_);
+}
+
+void TrackMesh::UploadPreview(const TrackGeometry& geometry)
+{
+	rail_meshes_[0]->Upload(geometry.GetPart(TrackGeometry::Part::LEFT_RAIL).vertices);
+	rail_meshes_[1]->Upload(geometry.GetPart(TrackGeometry::Part::RIGHT_RAIL).vertices);
+	rail_meshes_[2]->Upload(geometry.GetPart(TrackGeometry::Part::SPINE).vertices);
+
+	const std::vector<TrackGeometry::CrossTie>& cross_ties = geometry.GetCrossTies();
+	if (cross_ties.empty())
+	{
+		preview_cross_ties_->Clear();
+	}
+	else
+	{
+		preview_cross_ties_->SetInstances(&cross_ties[0], cross_ties.size());
+	}
 }
 
-void TrackMesh::AddSupportSegmented(XMVECTOR vertical_from, XMVECTOR vertical_to, 
-	XMVECTOR angled_from, XMVECTOR angled_to, XMVECTOR angled_x, XMVECTOR angled_z)
+//	Add one more chunk to the end of the simulating track, reusing one that was given back if there is one.
+//		Its meshes are empty until the track is uploaded into them.
+void TrackMesh::AddChunk()
 {
-	SupportMesh* segmented_support_mesh = new SupportMesh(device_, device_context_, vertical_from, vertical_to, 
-		angled_from, angled_to, angled_x, angled_z);
+	ResourcePool<Chunk>::Handle handle;
+	if (chunk_pool_.Reuse(handle))
+	{
+		//	The instances are already with the application, but may be out of date.
+		Chunk* chunk = chunk_pool_.Get(handle);
+		for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+		{
+			MeshInstance** instances = chunk->instances[lod];
+			instances[0]->SetTexture(small_rail_texture_);
+			instances[1]->SetTexture(small_rail_texture_);
+			instances[2]->SetTexture(large_rail_texture_);
+			instances[3]->SetTexture(cross_tie_texture_);
+
+			for (int i = 0; i < 4; i++)
+			{
+				instances[i]->SetWorldMatrix(world_matrix_);
+			}
+		}
+	}
+	else
+	{
+		handle = chunk_pool_.Add(CreateChunk());
+	}
 
-	support_meshes_.push_back(segmented_support_mesh);
+	Chunk* chunk = chunk_pool_.Get(handle);
+	chunk->min = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	chunk->max = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	chunk->lod = 0;
+	chunk->key = 0;
 
-	MeshInstance* segmented_support = new MeshInstance(nullptr, shader_, segmented_support_mesh);
-	support_instances_.push_back(segmented_support);
+	chunks_.push_back(handle);
+}
 
-	//	Create a new mesh instance of a sphere (reusing the sphere mesh object)
-	//		Place the mesh instance at the point where the support pillar is segmented
-	MeshInstance* sphere_joint = new MeshInstance(nullptr, shader_, sphere_mesh_);
-	XMMATRIX sphere_matrix = XMMatrixTranslation(XMVectorGetX(vertical_from), XMVectorGetY(vertical_from), XMVectorGetZ(vertical_from));
-	XMMATRIX scale_matrix = XMMatrixScaling(0.19f, 0.19f, 0.19f);
-	sphere_joint->SetWorldMatrix(scale_matrix * sphere_matrix);
-	support_instances_.push_back(sphere_joint);
+//	Empty the last chunk and give it back to the pool. Its instances stay with the application, but aren't drawn.
+void TrackMesh::ReleaseChunk()
+{
+	Chunk* chunk = GetChunk(chunks_.size() - 1);
+
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			chunk->rail_meshes[lod][j]->Clear();
+		}
+		chunk->cross_ties[lod]->Clear();
+
+		for (int j = 0; j < 4; j++)
+		{
+			chunk->instances[lod][j]->SetRender(false);
+		}
+	}
+
+	chunk_pool_.Release(chunks_.back());
+	chunks_.pop_back();
+}
+
+//	Create the meshes and instances for a new chunk.
+//		The instances are handed to the application through GetNewInstances.
+TrackMesh::Chunk* TrackMesh::CreateChunk()
+{
+	Chunk* chunk = new Chunk;
+
+	//	A page of ties holds a whole chunk's worth at the full level of detail.
+	const unsigned int cross_ties_per_chunk = TrackGeometry::GetPiecesPerChunk() * TrackGeometry::GetCrossTiesPerPiece();
+
+	//	With a packed shader the baked rails are kept as PackedVertex, at half the size.
+	const bool packed = (packed_shader_ != nullptr);
+
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+	{
+		chunk->rail_meshes[lod][0] = new PipeMesh(device_, device_context_, 0.06f, TrackGeometry::GetRailSlices(TrackGeometry::Part::LEFT_RAIL, lod), packed);
+		chunk->rail_meshes[lod][1] = new PipeMesh(device_, device_context_, 0.06f, TrackGeometry::GetRailSlices(TrackGeometry::Part::RIGHT_RAIL, lod), packed);
+		chunk->rail_meshes[lod][2] = new PipeMesh(device_, device_context_, 0.26f, TrackGeometry::GetRailSlices(TrackGeometry::Part::SPINE, lod), packed);
+
+		MeshInstance** instances = chunk->instances[lod];
+		instances[0] = CreateRailInstance(small_rail_texture_, chunk->rail_meshes[lod][0]);
+		instances[0]->SetColour(XMFLOAT4(0.46f, 0.62f, 0.8f, 0.0f));
+		instances[1] = CreateRailInstance(small_rail_texture_, chunk->rail_meshes[lod][1]);
+		instances[1]->SetColour(XMFLOAT4(0.46f, 0.62f, 0.8f, 0.0f));
+		instances[2] = CreateRailInstance(large_rail_texture_, chunk->rail_meshes[lod][2]);	//Large
+		instances[2]->SetColour(XMFLOAT4(0.3f, 0.3f, 0.3f, 0.0f));
+		chunk->cross_ties[lod] = new InstancedMeshInstance(device_, device_context_, cross_tie_shader_, cross_tie_mesh_,
+			sizeof(TrackGeometry::CrossTie), cross_ties_per_chunk);
+		chunk->cross_ties[lod]->SetTexture(cross_tie_texture_);
+		chunk->cross_ties[lod]->SetColour(XMFLOAT4(0.2f, 0.2f, 0.2f, 0.0f));
+		instances[3] = chunk->cross_ties[lod];
+
+		for (int i = 0; i < 4; i++)
+		{
+			instances[i]->SetWorldMatrix(world_matrix_);
+			new_instances_.push_back(instances[i]);
+		}
+	}
 
 	update_instances_ = true;
+	return chunk;
 }
 
-void TrackMesh::StorePreviewPoints(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis)
+MeshInstance* TrackMesh::CreateRailInstance(ID3D11ShaderResourceView* texture, PipeMesh* mesh)
 {
-	rail_meshes_[3]->AddCircleOrigin(centre - (x_axis * 0.35f), x_axis, y_axis);
-	rail_meshes_[4]->AddCircleOrigin(centre + (x_axis * 0.35f), x_axis, y_axis);
-	rail_meshes_[5]->AddCircleOrigin(centre - (y_axis * 0.3f), x_axis, y_axis);
+	if (mesh->IsPacked())
+	{
+		MeshInstance* instance = new MeshInstance(texture, packed_shader_, mesh);
+		instance->SetQuantisation(&mesh->GetQuantisation());
+		return instance;
+	}
+
+	return new MeshInstance(texture, shader_, mesh);
 }
 
-void TrackMesh::UpdateSimulatingMesh()
+TrackMesh::Chunk::~Chunk()
 {
-	for (int i = 0; i < rail_meshes_.size(); i++)
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			delete rail_meshes[lod][j];
+			rail_meshes[lod][j] = 0;
+		}
+
+		//	The cross ties are deleted as the last of the instances.
+		for (int j = 0; j < 4; j++)
+		{
+			delete instances[lod][j];
+			instances[lod][j] = 0;
+		}
+		cross_ties[lod] = 0;
+	}
+}
+
+unsigned int TrackMesh::Chunk::GetBufferBytes()
+{
+	unsigned int bytes = 0;
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
 	{
-		rail_meshes_[i]->Update();
+		for (int j = 0; j < 3; j++)
+		{
+			bytes += rail_meshes[lod][j]->GetBufferBytes();
+		}
+		bytes += cross_ties[lod]->GetBufferBytes();
 	}
+	return bytes;
+}
 
-	cross_ties_meshes_[0]->Update();
-	cross_ties_meshes_[1]->Update();
+//	Only the chunk's current level of detail is drawn, and nothing is drawn for parts that are empty at that level.
+void TrackMesh::SetChunkRender(int chunk)
+{
+	Chunk& c = *GetChunk(chunk);
+	bool render = visible_;
+
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			c.instances[lod][i]->SetRender(render && (lod == c.lod) && (c.rail_meshes[lod][i]->getIndexCount() > 0));
+		}
+		c.instances[lod][3]->SetRender(render && (lod == c.lod) && (c.cross_ties[lod]->GetInstanceCount() > 0));
+	}
 }
 
 void TrackMesh::SetPreviewActive(bool preview)
 {
+	preview_active_ = preview;
+
 	for (int i = 0; i < preview_instances_.size(); i++)
 	{
-		preview_instances_[i]->SetRender(preview);
+		preview_instances_[i]->SetRender(preview && visible_);
 	}
 }
 
-void TrackMesh::UpdatePreviewMesh()
+//	Show or hide the whole track, including the preview and supports, while another track is on screen.
+void TrackMesh::SetVisible(bool visible)
 {
-	rail_meshes_[3]->Update();
-	rail_meshes_[4]->Update();
-	rail_meshes_[5]->Update();
+	visible_ = visible;
+
+	for (int i = 0; i < chunks_.size(); i++)
+	{
+		SetChunkRender(i);
+	}
+
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+	{
+		pillar_instances_[lod]->SetRender(visible);
+	}
+	joint_instances_->SetRender(visible);
 
-	cross_ties_meshes_[1]->Update();
+	SetPreviewActive(preview_active_);
 }
 
 void TrackMesh::SetTranslation(float x, float y, float z)
 {
-	XMMATRIX world_matrix;
-	world_matrix = DirectX::XMMatrixTranslation(x, y, z);
+	world_matrix_ = DirectX::XMMatrixTranslation(x, y, z);
 
-	for (int i = 0; i < simulating_instances_.size(); i++)
+	for (int i = 0; i < chunks_.size(); i++)
 	{
-		simulating_instances_[i]->SetWorldMatrix(world_matrix);
+		for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				GetChunk(i)->instances[lod][j]->SetWorldMatrix(world_matrix_);
+			}
+		}
 	}
 
 	for (int i = 0; i < preview_instances_.size(); i++)
 	{
-		preview_instances_[i]->SetWorldMatrix(world_matrix);
+		preview_instances_[i]->SetWorldMatrix(world_matrix_);
 	}
 }
 
 XMMATRIX TrackMesh::GetWorldMatrix()
 {
-	return simulating_instances_[0]->GetWorldMatrix();
+	return world_matrix_;
 }
 
 void TrackMesh::Clear()
 {
-	//	Clear all of the components making up the track mesh.
-	for (int i = 0; i < rail_meshes_.size(); i++)
+	//	Clear all of the components making up the track mesh. The chunks go back to the pool.
+	while (!chunks_.empty())
 	{
-		rail_meshes_[i]->Clear();
+		ReleaseChunk();
 	}
 
-	cross_ties_meshes_[0]->Clear();
-	cross_ties_meshes_[1]->Clear();
+	ClearPreview();
 
 	ClearSupports();
 }
 
 void TrackMesh::ClearPreview()
 {
-	rail_meshes_[3]->Clear();
-	rail_meshes_[4]->Clear();
-	rail_meshes_[5]->Clear();
+	rail_meshes_[0]->Clear();
+	rail_meshes_[1]->Clear();
+	rail_meshes_[2]->Clear();
 
-	cross_ties_meshes_[1]->Clear();
+	preview_cross_ties_->Clear();
 }
 
 void TrackMesh::ClearSupports()
 {
-	for (int i = 0; i < support_instances_.size(); i++)
+	pillars_.clear();
+	joints_.clear();
+
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
 	{
-		instances_for_removal_.push_back(support_instances_[i]);
+		pillar_instances_[lod]->Clear();
 	}
-
-	/*support_meshes_.clear();
-	support_instances_.clear();*/
-}
-
-unsigned int TrackMesh::GetCrossTieFrequency()
-{
-	return 2;
+	joint_instances_->Clear();
 }
 
 void TrackMesh::SetSmallRailTexture(ID3D11ShaderResourceView* texture)
@@ -214,8 +466,14 @@ void TrackMesh::SetSmallRailTexture(ID3D11ShaderResourceView* texture)
 		small_rail_texture_ = texture;
 	}
 
-	simulating_instances_[0]->SetTexture(small_rail_texture_);
-	simulating_instances_[1]->SetTexture(small_rail_texture_);
+	for (int i = 0; i < chunks_.size(); i++)
+	{
+		for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+		{
+			GetChunk(i)->instances[lod][0]->SetTexture(small_rail_texture_);
+			GetChunk(i)->instances[lod][1]->SetTexture(small_rail_texture_);
+		}
+	}
 
 	preview_instances_[0]->SetTexture(small_rail_texture_);
 	preview_instances_[1]->SetTexture(small_rail_texture_);
@@ -228,7 +486,13 @@ void TrackMesh::SetLargeRailTexture(ID3D11ShaderResourceView* texture)
 		large_rail_texture_ = texture;
 	}
 
-	simulating_instances_[2]->SetTexture(large_rail_texture_);
+	for (int i = 0; i < chunks_.size(); i++)
+	{
+		for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+		{
+			GetChunk(i)->instances[lod][2]->SetTexture(large_rail_texture_);
+		}
+	}
 
 	preview_instances_[2]->SetTexture(large_rail_texture_);
 	
@@ -241,7 +505,13 @@ void TrackMesh::SetCrossTieTexture(ID3D11ShaderResourceView* texture)
 		cross_tie_texture_ = texture;
 	}
 
-	simulating_instances_[3]->SetTexture(cross_tie_texture_);
+	for (int i = 0; i < chunks_.size(); i++)
+	{
+		for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+		{
+			GetChunk(i)->instances[lod][3]->SetTexture(cross_tie_texture_);
+		}
+	}
 
 	preview_instances_[3]->SetTexture(cross_tie_texture_);
 }
@@ -258,15 +528,8 @@ TrackMesh::~TrackMesh()
 	}
 	rail_meshes_.clear();
 
-	for (int i = 0; i < simulating_instances_.size(); i++)
-	{
-		if (simulating_instances_.at(i));
-		{
-			delete simulating_instances_[i];
-			simulating_instances_[i] = 0;
-		}
-	}
-	simulating_instances_.clear();
+	//	The chunks are deleted by their pool.
+	chunks_.clear();
 
 	for (int i = 0; i < preview_instances_.size(); i++)
 	{
@@ -278,35 +541,28 @@ TrackMesh::~TrackMesh()
 	}
 	preview_instances_.clear();
 
-	for (int i = 0; i < cross_ties_meshes_.size(); i++)
+	//	The preview's cross ties were deleted with the rest of its instances.
+	preview_cross_ties_ = 0;
+
+	if (cross_tie_mesh_)
 	{
-		if (cross_ties_meshes_[i])
-		{
-			delete cross_ties_meshes_[i];
-			cross_ties_meshes_[i] = 0;
-		}
+		delete cross_tie_mesh_;
+		cross_tie_mesh_ = 0;
 	}
-	cross_ties_meshes_.clear();
 
-	for (int i = 0; i < support_instances_.size(); i++)
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
 	{
-		if (support_instances_[i])
-		{
-			delete support_instances_[i];
-			support_instances_[i] = 0;
-		}
+		delete pillar_instances_[lod];
+		pillar_instances_[lod] = 0;
+		delete support_meshes_[lod];
+		support_meshes_[lod] = 0;
 	}
-	support_instances_.clear();
 
-	for (int i = 0; i < support_meshes_.size(); i++)
+	if (joint_instances_)
 	{
-		if (support_meshes_[i])
-		{
-			delete support_meshes_[i];
-			support_meshes_[i] = 0;
-		}
+		delete joint_instances_;
+		joint_instances_ = 0;
 	}
-	support_meshes_.clear();
 
 	if (sphere_mesh_)
 	{
@@ -319,10 +575,21 @@ std::vector<MeshInstance*> TrackMesh::GetTrackMeshInstances()
 {
 	std::vector<MeshInstance*> instances;
 
-	for (int i = 0; i < simulating_instances_.size(); i++)
+	//	Pooled chunks too, as they are only handed to the application when they are created.
+	for (int i = 0; i < chunk_pool_.GetSlotCount(); i++)
+	{
+		for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				instances.push_back(chunk_pool_.GetSlot(i)->instances[lod][j]);
+			}
+		}
+	}
+
+	for (int i = 0; i < chunks_.size(); i++)
 	{
-		instances.push_back(simulating_instances_[i]);
-		simulating_instances_[i]->SetRender(true);
+		SetChunkRender(i);
 	}
 
 	for (int i = 0; i < preview_instances_.size(); i++)
@@ -331,35 +598,49 @@ std::vector<MeshInstance*> TrackMesh::GetTrackMeshInstances()
 		preview_instances_[i]->SetRender(true);
 	}
 
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+	{
+		instances.push_back(pillar_instances_[lod]);
+	}
+	instances.push_back(joint_instances_);
+
 	return instances;
 }
 
-//	Any instances that haven't been sent to the application renderer yet.
-//		TODO: Extend to allow the addition of all new instances - not just the support instances.
-std::vector<MeshInstance*> TrackMesh::GetNewInstances()
+//	Called once the instances from GetNewInstances have been sent to the application renderer, so each is only handed over once.
+//		The list keeps its memory for the next chunks.
+void TrackMesh::ClearNewInstances()
 {
+	new_instances_.clear();
 	update_instances_ = false;
-	return support_instances_;
 }
 
-//std::vector<MeshInstance*> TrackMesh::GetInstancesForRemoval()
-//{
-//	//return instances_for_removal_;
-//}
-
-//	Called from the application layer.
-void TrackMesh::RemoveUnusedInstances()
+TrackMesh::MemoryStats TrackMesh::GetMemoryStats()
 {
-	//support_meshes_.clear();
-	instances_for_removal_.clear();
-}
+	MemoryStats stats;
+	stats.chunk_count = chunk_pool_.GetLiveCount();
+	stats.pooled_chunk_count = chunk_pool_.GetFreeCount();
+	stats.chunks_created = chunk_pool_.GetCreatedCount();
+	stats.chunks_reused = chunk_pool_.GetReusedCount();
+
+	stats.chunk_bytes = 0;
+	for (int i = 0; i < chunk_pool_.GetSlotCount(); i++)
+	{
+		stats.chunk_bytes += chunk_pool_.GetSlot(i)->GetBufferBytes();
+	}
 
-bool TrackMesh::InstancesPendingRemoval()
-{
-	if (instances_for_removal_.size() != 0)
+	stats.preview_bytes = 0;
+	for (int i = 0; i < rail_meshes_.size(); i++)
 	{
-		return true;
+		stats.preview_bytes += rail_meshes_[i]->GetBufferBytes();
 	}
+	stats.preview_bytes += preview_cross_ties_->GetBufferBytes();
 
-	return false;
-}
\ No newline at end of file
+	stats.support_bytes = joint_instances_->GetBufferBytes();
+	for (int lod = 0; lod < TrackGeometry::LOD_COUNT; lod++)
+	{
+		stats.support_bytes += pillar_instances_[lod]->GetBufferBytes();
+	}
+
+	return stats;
+}
@@ -5,57 +5,122 @@
 #include "DefaultShader.h"
 #include "CrossTieMesh.h"
 #include "SupportMesh.h"
+#include "InstancedMeshInstance.h"
+#include "PackedShader.h"
 #include "../DXFramework/SphereMesh.h"
 #include "../Spline-Library/vector.h"
+#include "TrackGeometry.h"
+#include "ResourcePool.h"
+#include "TrackMeshSink.h"
 
 //	Contains all components of the track's mesh. Responsible for mesh instance logic.
-class TrackMesh
+//	The simulating track is split into chunks of a few pieces, each with its own meshes and bounding box,
+//		so the parts of a large track that are off screen can be culled.
+//	Every chunk holds each level of detail baked by the TrackGeometry, and only draws the one that suits its
+//		distance from the camera. The supports under a chunk are drawn at the same level.
+//	Given a PackedShader, the chunks keep their rails as PackedVertex. The preview is rebuilt too often to be worth packing.
+//	Cross ties are all drawn from one tie mesh, placed by a stream of positions and rotations.
+//	Chunks are kept in a pool. When the track gets shorter its last chunks are emptied and given back, and when it
+//		grows again they are reused, so editing for a long time doesn't keep making new buffers.
+class TrackMesh : public TrackMeshSink
 {
 public:
-	TrackMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, BaseShader* shader, unsigned int max_segments = 20);
+	TrackMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, SceneShader* shader, InstancedShader* instanced_shader,
+		InstancedShader* cross_tie_shader, PackedShader* packed_shader = nullptr);
 	std::vector<MeshInstance*> GetTrackMeshInstances();
 	inline bool HasNewInstances() { return update_instances_; }
-	inline unsigned int GetMaxSegments() { return max_segments_; }
-	inline std::vector<MeshInstance*> GetInstancesForRemoval() { return instances_for_removal_; }
-	void RemoveUnusedInstances();
-	bool InstancesPendingRemoval();
-	std::vector<MeshInstance*> GetNewInstances();
+	inline const std::vector<MeshInstance*>& GetNewInstances() { return new_instances_; }
+	void ClearNewInstances();
 	XMMATRIX GetWorldMatrix();
 	void SetTranslation(float x, float y, float z);
-	void StorePoints(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis);
-	void AddCrossTie(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis);
-	void AddSupportVertical(XMVECTOR from, XMVECTOR to);
-	void AddSupportSegmented(XMVECTOR vertical_from_, XMVECTOR vertical_to_,
-		XMVECTOR angled_from_, XMVECTOR angled_to_, XMVECTOR angled_x_, XMVECTOR angled_z_);
-	void StorePreviewPoints(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis);
-	void AddPreviewCrossTie(XMVECTOR centre, XMVECTOR x_axis, XMVECTOR y_axis, XMVECTOR z_axis);
-	void UpdateSimulatingMesh();
-	void UpdatePreviewMesh();
+	void UploadTrack(const TrackGeometry& geometry);
+	void UploadPreview(const TrackGeometry& geometry);
+	void UploadSupports(const TrackGeometry& geometry);
+	void UpdateLod(XMVECTOR camera_position);
 	void SetPreviewActive(bool preview);
+	void SetVisible(bool visible);
 	void Clear();
 	void ClearPreview();
 	void ClearSupports();
-	unsigned int GetCrossTieFrequency();
 	void SetSmallRailTexture(ID3D11ShaderResourceView* texture);
 	void SetLargeRailTexture(ID3D11ShaderResourceView* texture);
 	void SetCrossTieTexture(ID3D11ShaderResourceView* texture);
 	~TrackMesh();
+
+	//	How much the track mesh is holding on to. Bytes are of the GPU buffers, as sized by their pages.
+	struct MemoryStats
+	{
+		unsigned int chunk_count;
+		unsigned int pooled_chunk_count;
+		unsigned int chunks_created;
+		unsigned int chunks_reused;
+		unsigned int chunk_bytes;
+		unsigned int preview_bytes;
+		unsigned int support_bytes;
+	};
+	MemoryStats GetMemoryStats();
+
+private:
+	struct Chunk
+	{
+		PipeMesh* rail_meshes[TrackGeometry::LOD_COUNT][3];
+		InstancedMeshInstance* cross_ties[TrackGeometry::LOD_COUNT];
+
+		//	The rails, then the cross ties.
+		MeshInstance* instances[TrackGeometry::LOD_COUNT][4];
+		XMFLOAT3 min;
+		XMFLOAT3 max;
+		int lod;
+		//	The key of the baked chunk last uploaded, see TrackGeometry::Chunk.
+		unsigned long long key;
+
+		~Chunk();
+		unsigned int GetBufferBytes();
+	};
+
+	void AddChunk();
+	void ReleaseChunk();
+	Chunk* CreateChunk();
+	MeshInstance* CreateRailInstance(ID3D11ShaderResourceView* texture, PipeMesh* mesh);
+	void SetChunkRender(int chunk);
+	inline Chunk* GetChunk(int chunk) { return chunk_pool_.Get(chunks_[chunk]); }
+	void UpdateSupports();
+
 private:
+	//	Chunks holding the current track, in order.
+	ResourcePool<Chunk> chunk_pool_;
+	std::vector<ResourcePool<Chunk>::Handle> chunks_;
+
+	//	Distance from the camera, in metres, beyond which each level of detail gives way to the next.
+	float lod_distances_[TrackGeometry::LOD_COUNT - 1];
+
+	//	Meshes for the preview of the next piece, which is never culled.
 	std::vector<PipeMesh*> rail_meshes_;
-	std::vector<CrossTieMesh*> cross_ties_meshes_;
-	std::vector<MeshInstance*> simulating_instances_;
+	InstancedMeshInstance* preview_cross_ties_;
 	std::vector<MeshInstance*> preview_instances_;
 	ID3D11ShaderResourceView* small_rail_texture_;
 	ID3D11ShaderResourceView* large_rail_texture_;
 	ID3D11ShaderResourceView* cross_tie_texture_;
-	BaseShader* shader_;
+	SceneShader* shader_;
+	InstancedShader* cross_tie_shader_;
+	PackedShader* packed_shader_;
+	CrossTieMesh* cross_tie_mesh_;
 	ID3D11Device* device_;
 	ID3D11DeviceContext* device_context_;
-	std::vector<MeshInstance*> support_instances_;
-	std::vector<SupportMesh*> support_meshes_;
+
+	//	Every pillar is drawn by one instance of the pillar mesh for its chunk's level of detail, and every joint
+	//		by one instance of the sphere, so the supports take a handful of draw calls however many there are.
+	SupportMesh* support_meshes_[TrackGeometry::LOD_COUNT];
+	InstancedMeshInstance* pillar_instances_[TrackGeometry::LOD_COUNT];
+	InstancedMeshInstance* joint_instances_;
+	std::vector<TrackGeometry::SupportInstance> pillars_;
+	std::vector<TrackGeometry::SupportInstance> joints_;
+	std::vector<XMFLOAT4X4> support_matrices_;
 	SphereMesh* sphere_mesh_;
-	std::vector<MeshInstance*> instances_for_removal_;
+	std::vector<MeshInstance*> new_instances_;
+	XMMATRIX world_matrix_;
 	bool update_instances_;
-	unsigned int max_segments_;
+	bool preview_active_;
+	bool visible_;
 	
 };
\ No newline at end of file
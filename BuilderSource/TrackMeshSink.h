@@ -0,0 +1,21 @@
+#pragma once
+
+class TrackGeometry;
+
+//	Where a Track sends its baked geometry to be drawn, and tells to forget it again.
+//	The Track, the TrackBuilder and its baker and preview only know the mesh through this, so they don't depend on
+//		the renderer. The command line tools can load, bake and check tracks without a device, and the tests can
+//		run the builder's frames. The TrackMesh is the only one the application draws.
+class TrackMeshSink
+{
+public:
+	virtual ~TrackMeshSink() {}
+	virtual void UploadTrack(const TrackGeometry& geometry) = 0;
+	virtual void UploadPreview(const TrackGeometry& geometry) = 0;
+	virtual void UploadSupports(const TrackGeometry& geometry) = 0;
+	virtual void SetPreviewActive(bool preview) = 0;
+	virtual void SetTranslation(float x, float y, float z) = 0;
+	virtual void Clear() = 0;
+	virtual void ClearPreview() = 0;
+	virtual void ClearSupports() = 0;
+};
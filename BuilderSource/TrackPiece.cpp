@@ -1,10 +1,12 @@
 #include "TrackPiece.h"
+#include "Straight.h"
+#include "RightTurn.h"
+#include "LeftTurn.h"
+#include "ClimbUp.h"
+#include "ClimbDown.h"
 
 TrackPiece::TrackPiece()
 {
-	bounding_values_.t0 = 0.0f;
-	bounding_values_.t1 = 1.0f;
-	length_ = 0.0f;
 	roll_target_ = 0.0f;
 	roll_initial_ = 0.0f;
 	tension_ = 2.0f;
@@ -12,14 +14,49 @@ TrackPiece::TrackPiece()
 	spline_segment_ = nullptr;
 }
 
-void TrackPiece::SetSplineSegment(SL::CRSpline* spline)
+TrackPiece::State::State() : tag(Tag::NUMBER_OF_TYPES), tension(2.0f), roll_target(0.0f)
 {
-	spline_segment_ = spline;
 }
 
-void TrackPiece::SetLength(float length)
+//	Everything but the baked geometry, which belongs to the snapshot it was baked from.
+TrackPiece::State::State(const State& state) :
+	tag(state.tag), tension(state.tension), roll_target(state.roll_target), arc_table(state.arc_table)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		control_points[i] = state.control_points[i];
+	}
+}
+
+//	Create one of the stock track pieces, or nullptr for any other type.
+//		The closing piece depends on the rest of the track, and a piece from a file on the file, so both are created separately.
+TrackPiece* TrackPiece::CreateStockPiece(Tag tag)
 {
-	length_ = length;
+	switch (tag)
+	{
+	case Tag::STRAIGHT:
+		return new Straight();
+
+	case Tag::RIGHT_TURN:
+		return new RightTurn();
+
+	case Tag::LEFT_TURN:
+		return new LeftTurn();
+
+	case Tag::CLIMB_UP:
+		return new ClimbUp();
+
+	case Tag::CLIMB_DOWN:
+		return new ClimbDown();
+
+	default:
+		return nullptr;
+	}
+}
+
+void TrackPiece::SetSplineSegment(SL::CRSpline* spline)
+{
+	spline_segment_ = spline;
 }
 
 TrackPiece::Tag TrackPiece::GetTag()
@@ -40,11 +77,13 @@ float TrackPiece::GetTension()
 void TrackPiece::SetTension(float tension)
 {
 	tension_ = tension;
+	captured_state_.reset();
 }
 
 void TrackPiece::SetRollTarget(float roll_target)
 {
 	roll_target_ = roll_target;
+	captured_state_.reset();
 }
 
 float TrackPiece::GetRollTarget()
@@ -60,11 +99,13 @@ SL::Vector TrackPiece::GetControlPoint(int element)
 void TrackPiece::SetControlPoint(int control_point, SL::Vector point)
 {
 	spline_segment_->SetControlPoint(point, control_point);
+	captured_state_.reset();
 }
 
 void TrackPiece::SetControlPoints(SL::Vector p0, SL::Vector p1, SL::Vector p2, SL::Vector p3)
 {
 	spline_segment_->SetControlPoints(p0, p1, p2, p3);
+	captured_state_.reset();
 }
 
 SL::CRSpline* TrackPiece::GetSpline()
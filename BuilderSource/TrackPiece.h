@@ -1,6 +1,10 @@
 #pragma once
 
 #include "../Spline-Library/CRSpline.h"
+#include <memory>
+#include <vector>
+
+struct BakedPiece;
 
 class TrackPiece
 {
@@ -16,16 +20,32 @@ public:
 		NUMBER_OF_TYPES
 	};
 
-	struct Boundary
+	//	Immutable snapshot of a track piece, used by the edit history.
+	//		The arc length table is shared with the spline controller rather than copied.
+	struct State
 	{
-		float t0;
-		float t1;
+		//	Enough for the piece after an edited roll to find its old geometry again when the edit is undone.
+		static const int BAKE_COUNT = 2;
+
+		State();
+		State(const State& state);
+
+		Tag tag;
+		SL::Vector control_points[4];
+		float tension;
+		float roll_target;
+		std::shared_ptr<const std::vector<float>> arc_table;
+
+		//	The geometry the baker last made from this snapshot, most recent first, each from where the track reached it.
+		//		They are kept by whatever keeps the snapshot, such as the edit history, so the piece isn't simulated
+		//		again when the snapshot comes back. Only the baker's worker reads or writes them.
+		//		A copy is a new snapshot, so starts without any.
+		mutable std::shared_ptr<const BakedPiece> baked[BAKE_COUNT];
 	};
-	Boundary bounding_values_;
+	typedef std::shared_ptr<const State> StatePtr;
 
 	TrackPiece();
-	void SetLength(float length);
-	inline float GetLength() { return length_; }
+	static TrackPiece* CreateStockPiece(Tag tag);
 	virtual ~TrackPiece();
 	virtual Tag GetTag();
 	virtual bool ShouldSmooth();		
@@ -47,9 +67,13 @@ public:
 	void CalculateSpline();
 	inline bool OrientationStored() { return orientation_stored_; }
 
+	//	The last snapshot taken of this piece, shared by every capture until the piece is changed. See Track::CaptureTrackPiece.
+	inline const StatePtr& GetCapturedState() { return captured_state_; }
+	inline void SetCapturedState(const StatePtr& state) { captured_state_ = state; }
+
 protected:
 	SL::CRSpline* spline_segment_;
-	float length_;
+	StatePtr captured_state_;
 	float tension_;
 	float roll_target_;
 	float roll_initial_;
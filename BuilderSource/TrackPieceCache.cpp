@@ -0,0 +1,247 @@
+#include "TrackPieceCache.h"
+
+#include "../Spline-Library/CRSplineController.h"
+#include "../Spline-Library/matrix3x3.h"
+#include <cmath>
+
+namespace
+{
+	//	Every roll and tension the user picks adds an entry, so the cache is kept to this many.
+	const unsigned int max_entries = 256;
+}
+
+TrackPieceCache::TrackPieceCache(int resolution) : use_count_(0), bake_count_(0), resolution_(resolution)
+{
+}
+
+bool TrackPieceCache::Key::operator<(const Key& other) const
+{
+	if (tag != other.tag) return tag < other.tag;
+	if (tension != other.tension) return tension < other.tension;
+	if (start_roll != other.start_roll) return start_roll < other.start_roll;
+	return roll_target < other.roll_target;
+}
+
+bool TrackPieceCache::IsStockPiece(TrackPiece::Tag tag)
+{
+	switch (tag)
+	{
+	case TrackPiece::Tag::STRAIGHT:
+	case TrackPiece::Tag::RIGHT_TURN:
+	case TrackPiece::Tag::LEFT_TURN:
+	case TrackPiece::Tag::CLIMB_UP:
+	case TrackPiece::Tag::CLIMB_DOWN:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+//	Get the geometry for a stock piece with this tension and roll profile, baking it the first time it is asked for.
+const TrackPieceCache::Entry* TrackPieceCache::Find(TrackPiece::Tag tag, float tension, float start_roll, float roll_target)
+{
+	if (!IsStockPiece(tag))
+	{
+		return nullptr;
+	}
+
+	Key key;
+	key.tag = static_cast<int>(tag);
+	key.tension = (int)roundf(tension * 1000.0f);
+	key.start_roll = (int)roundf(start_roll * 100.0f);
+	key.roll_target = (int)roundf(roll_target * 100.0f);
+
+	use_count_++;
+
+	std::map<Key, Entry*>::iterator it = entries_.find(key);
+	if (it != entries_.end())
+	{
+		it->second->last_used = use_count_;
+		return it->second;
+	}
+
+	//	Only the one entry goes, so the pieces of a long track that are still in use stay cached.
+	if (entries_.size() >= max_entries)
+	{
+		EvictLeastRecentlyUsed();
+	}
+
+	Entry* entry = Bake(tag, tension, start_roll, roll_target);
+	if (entry)
+	{
+		entry->last_used = use_count_;
+		entries_[key] = entry;
+	}
+
+	return entry;
+}
+
+//	A search of every entry, but only made when a piece has to be baked anyway, which costs far more.
+void TrackPieceCache::EvictLeastRecentlyUsed()
+{
+	std::map<Key, Entry*>::iterator oldest = entries_.begin();
+	for (std::map<Key, Entry*>::iterator it = entries_.begin(); it != entries_.end(); ++it)
+	{
+		if (it->second->last_used < oldest->second->last_used)
+		{
+			oldest = it;
+		}
+	}
+
+	if (oldest != entries_.end())
+	{
+		delete oldest->second;
+		entries_.erase(oldest);
+	}
+}
+
+//	Simulate a single stock piece, starting from an upright frame that has been rolled to where the previous piece finished.
+//		Matches the sampling and roll of Track::StoreMeshData, so placed pieces line up with simulated ones.
+TrackPieceCache::Entry* TrackPieceCache::Bake(TrackPiece::Tag tag, float tension, float start_roll, float roll_target)
+{
+	TrackPiece* track_piece = TrackPiece::CreateStockPiece(tag);
+	if (!track_piece)
+	{
+		return nullptr;
+	}
+
+	bake_count_++;
+
+	Entry* entry = new Entry();
+	for (int i = 0; i < 4; i++)
+	{
+		entry->control_points[i] = track_piece->GetControlPoint(i);
+	}
+
+	//	The spline controller takes ownership of the spline segment.
+	SL::CRSplineController spline_controller(resolution_);
+	spline_controller.AddSegment(track_piece->GetSpline(), tension, false);
+	delete track_piece;
+
+	SL::Vector forward = spline_controller.GetTangent(0.0f);
+	SL::Vector up(0.0f, 1.0f, 0.0f);
+	SL::Vector right = up.Cross(forward).Normalised();
+	up = forward.Cross(right).Normalised();
+
+	float roll = start_roll * 0.0174533f;
+	if (roll != 0.0f)
+	{
+		SL::Matrix3x3 roll_matrix;
+		roll_matrix.RotationAxisAngle(forward, roll);
+		up = roll_matrix.TransformVector(up);
+		right = up.Cross(forward);
+	}
+
+	const int frame_count = TrackGeometry::GetFramesForPiece(spline_controller.GetSegment(0), spline_controller.GetArcLength(), start_roll, roll_target);
+	const int cross_tie_step = frame_count / TrackGeometry::GetCrossTiesPerPiece();
+
+	entry->geometry.BeginPiece(frame_count);
+	for (int k = 0; k <= frame_count; k++)
+	{
+		float d = (float)k / (float)frame_count;
+		float t = spline_controller.GetTimeAtDistance(d);
+
+		forward = spline_controller.GetTangent(t);
+		right = up.Cross(forward).Normalised();
+		up = forward.Cross(right).Normalised();
+
+		float target_roll = (1.0f - t) * start_roll * 0.0174533f + t * roll_target * 0.0174533f;
+		float angle_needed = target_roll - roll;
+		if (angle_needed != 0.0f)
+		{
+			SL::Matrix3x3 roll_matrix;
+			roll_matrix.RotationAxisAngle(forward, angle_needed);
+			up = roll_matrix.TransformVector(up);
+			right = up.Cross(forward);
+			roll = target_roll;
+		}
+
+		XMVECTOR x = XMVectorSet(right.X(), right.Y(), right.Z(), 0.0f);
+		XMVECTOR y = XMVectorSet(up.X(), up.Y(), up.Z(), 0.0f);
+		XMVECTOR z = XMVectorSet(forward.X(), forward.Y(), forward.Z(), 0.0f);
+
+		//	The frame at the end of the piece belongs to the next piece, it is only kept to carry on the simulation.
+		if (k == frame_count)
+		{
+			XMStoreFloat3(&entry->end_forward, z);
+			XMStoreFloat3(&entry->end_up, y);
+			break;
+		}
+
+		SL::Vector point = spline_controller.GetPointAtDistance(d);
+		XMVECTOR centre = XMVectorSet(point.X(), point.Y(), point.Z(), 0.0f);
+
+		if (k == 0)
+		{
+			XMStoreFloat3(&entry->start_position, centre);
+			XMStoreFloat3(&entry->start_forward, z);
+			XMStoreFloat3(&entry->start_up, y);
+		}
+
+		entry->geometry.AddFrame(centre, x, y, z);
+		if (k % cross_tie_step == 0)
+		{
+			entry->geometry.AddCrossTie(centre, x, y, z);
+		}
+	}
+
+	return entry;
+}
+
+//	Find the transform that moves the cached piece onto the frame at the start of the track piece.
+//		Fails if the control points don't end up in the same place, which means the piece has been edited
+//		or the frame has twisted relative to the piece, and it has to be simulated instead.
+bool TrackPieceCache::GetPlacement(const Entry& entry, TrackPiece* track_piece, XMVECTOR position, XMVECTOR forward, XMVECTOR up, XMMATRIX& transform)
+{
+	XMMATRIX local = GetFrameMatrix(XMLoadFloat3(&entry.start_position), XMLoadFloat3(&entry.start_forward), XMLoadFloat3(&entry.start_up));
+	XMMATRIX world = GetFrameMatrix(position, forward, up);
+
+	transform = XMMatrixInverse(nullptr, local) * world;
+
+	for (int i = 0; i < 4; i++)
+	{
+		SL::Vector cached = entry.control_points[i];
+		SL::Vector actual = track_piece->GetControlPoint(i);
+
+		XMVECTOR placed = XMVector3Transform(XMVectorSet(cached.X(), cached.Y(), cached.Z(), 1.0f), transform);
+		XMVECTOR difference = placed - XMVectorSet(actual.X(), actual.Y(), actual.Z(), 0.0f);
+
+		if (XMVectorGetX(XMVector3LengthSq(difference)) > 0.0001f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	Rows are the axes of the frame, followed by its origin.
+XMMATRIX TrackPieceCache::GetFrameMatrix(XMVECTOR position, XMVECTOR forward, XMVECTOR up)
+{
+	XMVECTOR z = XMVector3Normalize(forward);
+	XMVECTOR x = XMVector3Normalize(XMVector3Cross(up, z));
+	XMVECTOR y = XMVector3Cross(z, x);
+
+	XMMATRIX frame;
+	frame.r[0] = XMVectorSetW(x, 0.0f);
+	frame.r[1] = XMVectorSetW(y, 0.0f);
+	frame.r[2] = XMVectorSetW(z, 0.0f);
+	frame.r[3] = XMVectorSetW(position, 1.0f);
+
+	return frame;
+}
+
+void TrackPieceCache::Clear()
+{
+	for (std::map<Key, Entry*>::iterator it = entries_.begin(); it != entries_.end(); ++it)
+	{
+		delete it->second;
+	}
+	entries_.clear();
+}
+
+TrackPieceCache::~TrackPieceCache()
+{
+	Clear();
+}
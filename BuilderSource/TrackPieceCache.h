@@ -0,0 +1,55 @@
+#pragma once
+
+#include "TrackPiece.h"
+#include "TrackGeometry.h"
+#include <map>
+
+//	Geometry for the stock track pieces, baked once in the piece's own local space.
+//	A stock piece that hasn't been edited always has the same shape up to a rigid transform, so its
+//		frames and cross ties can be copied into place instead of simulating the piece again.
+class TrackPieceCache
+{
+public:
+	struct Entry
+	{
+		TrackGeometry geometry;
+		SL::Vector control_points[4];
+		XMFLOAT3 start_position;
+		XMFLOAT3 start_forward;
+		XMFLOAT3 start_up;
+		XMFLOAT3 end_forward;
+		XMFLOAT3 end_up;
+
+		//	When the entry was last found, so the least recently used can make way for a new one.
+		unsigned long long last_used;
+	};
+
+	TrackPieceCache(int resolution);
+	const Entry* Find(TrackPiece::Tag tag, float tension, float start_roll, float roll_target);
+	bool GetPlacement(const Entry& entry, TrackPiece* track_piece, XMVECTOR position, XMVECTOR forward, XMVECTOR up, XMMATRIX& transform);
+	void Clear();
+	static bool IsStockPiece(TrackPiece::Tag tag);
+	inline unsigned int GetEntryCount() { return entries_.size(); }
+	inline unsigned int GetBakeCount() { return bake_count_; }
+	~TrackPieceCache();
+
+private:
+	struct Key
+	{
+		int tag;
+		int tension;
+		int start_roll;
+		int roll_target;
+		bool operator<(const Key& other) const;
+	};
+
+	Entry* Bake(TrackPiece::Tag tag, float tension, float start_roll, float roll_target);
+	void EvictLeastRecentlyUsed();
+	static XMMATRIX GetFrameMatrix(XMVECTOR position, XMVECTOR forward, XMVECTOR up);
+
+private:
+	std::map<Key, Entry*> entries_;
+	unsigned long long use_count_;
+	unsigned int bake_count_;
+	int resolution_;
+};
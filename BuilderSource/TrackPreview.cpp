@@ -1,10 +1,11 @@
 #include "TrackPreview.h"
 #include "../Spline-Library/CRSplineController.h"
 #include "TrackPiece.h"
-#include "TrackMesh.h"
+#include "TrackMeshSink.h"
+#include "TrackGeometry.h"
 
 
-TrackPreview::TrackPreview(TrackMesh* track_mesh) : track_mesh_(track_mesh)
+TrackPreview::TrackPreview(TrackMeshSink* track_mesh) : track_mesh_(track_mesh), scratch_(1 << 14)
 {
     preview_active_ = false;
     t_ = 0.0f;
@@ -70,23 +71,48 @@ void TrackPreview::InitTrackPiece(TrackPiece* track_piece)
     spline_controller_->CalculateSplineLength();
     CalculateLength();
 
-    track_mesh_->SetPreviewActive(true);
+    if (track_mesh_)
+    {
+        track_mesh_->SetPreviewActive(true);
+    }
+}
+
+//  Copy a snapshot of a track piece. Used when the preview is simulated away from the track builder.
+void TrackPreview::InitTrackPiece(const TrackPiece::State& state)
+{
+    track_piece_->SetControlPoints(state.control_points[0], state.control_points[1], state.control_points[2], state.control_points[3]);
+    track_piece_->SetTension(state.tension);
+    track_piece_->SetRollTarget(state.roll_target);
+    track_piece_->CalculateSpline();
+
+    CalculateLength();
 }
 
 void TrackPreview::SetPreviewActive(bool active)
 {
     preview_active_ = active;
-    track_mesh_->SetPreviewActive(active);
+
+    if (track_mesh_)
+    {
+        track_mesh_->SetPreviewActive(active);
+    }
 }
 
-void TrackPreview::GenerateMesh()
+void TrackPreview::GenerateMesh(TrackGeometry* geometry)
 {
+    geometry->Clear();
+
     //  Simulate this track piece, given the initial conditions from the main track.
     //  Use the simulation to generate the points for the mesh.
-    //	Store data needed for the mesh to generate itself.
-    for (int i = 0; i < 25; i++)
+    //	Store data needed for the mesh to generate itself, sampled as the track would sample the piece.
+    const int frame_count = TrackGeometry::GetFramesForPiece(spline_controller_->GetSegment(0), spline_controller_->GetArcLength(),
+        track_piece_->GetInitRoll(), track_piece_->GetRollTarget());
+    const int cross_tie_step = frame_count / TrackGeometry::GetCrossTiesPerPiece();
+
+    geometry->BeginPiece(frame_count);
+    for (int i = 0; i <= frame_count; i++)
     {
-        float t = (float)i / 24.0f;
+        float t = (float)i / frame_count;
 
         UpdateSimulation(t);
 
@@ -97,15 +123,16 @@ void TrackPreview::GenerateMesh()
         XMVECTOR y = XMVectorSet(GetUp().x, GetUp().y, GetUp().z, 0.0f);
         XMVECTOR z = XMVectorSet(GetForward().x, GetForward().y, GetForward().z, 0.0f);
 
-        track_mesh_->StorePreviewPoints(centre, x, y, z);
+        geometry->AddFrame(centre, x, y, z);
 
-        if (i % track_mesh_->GetCrossTieFrequency() == 0)
+        if ((i < frame_count) && (i % cross_tie_step == 0))
         {
-            track_mesh_->AddPreviewCrossTie(centre, x, y, z);
+            geometry->AddCrossTie(centre, x, y, z);
         }
     }
 
-    track_mesh_->UpdatePreviewMesh();
+    scratch_.Reset();
+    geometry->Finalise(scratch_);
 
     Reset();
 }
@@ -174,13 +201,15 @@ void TrackPreview::Reset()
 
 void TrackPreview::Clear()
 {
-    track_mesh_->ClearPreview();
+    if (track_mesh_)
+    {
+        track_mesh_->ClearPreview();
+    }
 }
 
 void TrackPreview::CalculateLength()
 {
     spline_controller_->CalculateSplineLength();
-    track_piece_->SetLength(spline_controller_->GetArcLength());
 }
 
 TrackPiece* TrackPreview::GetPreviewPiece()
@@ -3,10 +3,11 @@
 #include <vector>
 #include "../Spline-Library/vector.h"
 #include <directxmath.h>
+#include "TrackPiece.h"
+#include "ScratchArena.h"
 
-
-class TrackPiece;
-class TrackMesh;
+class TrackMeshSink;
+class TrackGeometry;
 
 namespace SL
 {
@@ -16,16 +17,17 @@ namespace SL
 class TrackPreview
 {
 public:
-	TrackPreview(TrackMesh* track_mesh);
+	TrackPreview(TrackMeshSink* track_mesh);
 	void InitialiseSimulation(float initial_roll, SL::Vector forward, SL::Vector right, SL::Vector up, float previous_roll_target);
 	void EraseTrack();
 	inline float GetRoll() { return roll_; }
 	inline bool GetPreviewActive() { return preview_active_; }
 	void SetPreviewActive(bool active);
 	void InitTrackPiece(TrackPiece* track_piece);
+	void InitTrackPiece(const TrackPiece::State& state);
 	void UpdateSimulation(float t);
 	TrackPiece* GetPreviewPiece();
-	void GenerateMesh();
+	void GenerateMesh(TrackGeometry* geometry);
 	void CalculateLength();
 	~TrackPreview();
 
@@ -46,7 +48,7 @@ private:
 private:
 	TrackPiece* track_piece_;
 	SL::CRSplineController* spline_controller_;
-	TrackMesh* track_mesh_;
+	TrackMeshSink* track_mesh_;
 	float t_;
 	float initial_roll_;
 	float roll_;
@@ -57,4 +59,7 @@ private:
 	SL::Vector up_;
 	SL::Vector initial_up_;
 	bool preview_active_;
+
+	//	Working space for baking the preview, which is never more than a chunk.
+	ScratchArena scratch_;
 };
\ No newline at end of file
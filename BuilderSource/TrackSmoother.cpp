@@ -0,0 +1,223 @@
+#include "TrackSmoother.h"
+
+#include "Track.h"
+
+TrackSmoother::TrackSmoother()
+{
+}
+
+//	Replace the tangent at every joint so that curvature is continuous along the whole track.
+//	The joints stay where they are, as do the tangents at the two ends of an open track.
+//		Returns false if the track is too short to have a joint that can be smoothed.
+bool TrackSmoother::Smooth(Track* track)
+{
+	if (!track)
+	{
+		return false;
+	}
+
+	bool complete = track->IsComplete();
+	int piece_count = track->GetTrackPieceCount() - (complete ? 1 : 0);
+
+	//	An open track needs two pieces to have a joint between them. A loop needs two pieces as well as the closing piece,
+	//		which gives it the three joints the cyclic system needs for its corners not to overlap.
+	if (piece_count < 2)
+	{
+		return false;
+	}
+
+	joints_.resize(piece_count + 1);
+	tangents_.resize(piece_count + 1);
+
+	for (int i = 0; i < piece_count; i++)
+	{
+		TrackPiece* track_piece = track->GetTrackPiece(i);
+		joints_[i] = track_piece->GetControlPoint(1);
+	}
+
+	TrackPiece* first_piece = track->GetTrackPiece(0);
+	TrackPiece* last_piece = track->GetTrackPiece(piece_count - 1);
+	joints_[piece_count] = last_piece->GetControlPoint(2);
+	tangents_[0] = first_piece->GetControlPoint(2).Subtract(first_piece->GetControlPoint(0)).Scaled(first_piece->GetTension());
+	tangents_[piece_count] = last_piece->GetControlPoint(3).Subtract(last_piece->GetControlPoint(1)).Scaled(last_piece->GetTension());
+
+	if (complete)
+	{
+		SolveClosed(piece_count + 1);
+	}
+	else
+	{
+		SolveOpen(piece_count);
+	}
+
+	//	The closing piece takes its tangents from the first and last pieces, scaled by its own tension,
+	//		so those two pieces have to share its tension for the tangents to carry across.
+	float closing_tension = complete ? track->GetTrackPiece(piece_count)->GetTension() : 0.0f;
+
+	//	Every changed piece is put back in one go, so the track is only rebuilt once.
+	states_.assign(piece_count, TrackPiece::StatePtr());
+	bool any_changed = false;
+
+	for (int i = 0; i < piece_count; i++)
+	{
+		std::shared_ptr<TrackPiece::State> state = std::make_shared<TrackPiece::State>(*track->CaptureTrackPiece(i));
+		if (complete && (i == 0 || i == piece_count - 1))
+		{
+			state->tension = closing_tension;
+		}
+
+		float inverse_tension = 1.0f / state->tension;
+		SL::Vector control_points[4];
+		control_points[1] = joints_[i];
+		control_points[2] = joints_[i + 1];
+		control_points[0] = joints_[i + 1].Subtract(tangents_[i].Scaled(inverse_tension));
+		control_points[3] = joints_[i].Add(tangents_[i + 1].Scaled(inverse_tension));
+
+		//	Pieces that already fit are left alone, so they keep their arc length tables.
+		bool changed = (state->tension != track->GetTrackPiece(i)->GetTension());
+		for (int k = 0; k < 4; k++)
+		{
+			if (control_points[k].Subtract(state->control_points[k]).LengthSquared() > 0.000001f)
+			{
+				changed = true;
+			}
+			state->control_points[k] = control_points[k];
+		}
+
+		if (!changed)
+		{
+			continue;
+		}
+
+		state->arc_table.reset();
+		states_[i] = state;
+		any_changed = true;
+	}
+
+	bool restored = !any_changed || track->RestoreTrackPieceShapes(states_);
+
+	//	The states aren't needed once they are in the track.
+	states_.clear();
+
+	return restored;
+}
+
+//	With uniform parameters, matching curvature at joint i gives m[i - 1] + 4m[i] + m[i + 1] = 3(p[i + 1] - p[i - 1]).
+//		The end tangents are known, so they are moved to the right hand side.
+void TrackSmoother::SolveOpen(int piece_count)
+{
+	const int size = piece_count - 1;
+	if (size < 1)
+	{
+		return;
+	}
+
+	lower_.assign(size, 1.0f);
+	diagonal_.assign(size, 4.0f);
+	upper_.assign(size, 1.0f);
+	rhs_.assign(size * 3, 0.0f);
+
+	for (int row = 0; row < size; row++)
+	{
+		int joint = row + 1;
+		SL::Vector value = joints_[joint + 1].Subtract(joints_[joint - 1]).Scaled(3.0f);
+
+		if (row == 0)
+		{
+			value = value.Subtract(tangents_[0]);
+		}
+		if (row == size - 1)
+		{
+			value = value.Subtract(tangents_[piece_count]);
+		}
+
+		rhs_[row * 3 + 0] = value.X();
+		rhs_[row * 3 + 1] = value.Y();
+		rhs_[row * 3 + 2] = value.Z();
+	}
+
+	SolveTridiagonal(size, 3);
+
+	for (int row = 0; row < size; row++)
+	{
+		tangents_[row + 1].Set(rhs_[row * 3 + 0], rhs_[row * 3 + 1], rhs_[row * 3 + 2]);
+	}
+}
+
+//	Every joint of a loop is free, and the first and last rows wrap round to each other.
+//		The corners are removed with the Sherman-Morrison formula, which needs one more solve of the same
+//		tridiagonal system, done as a fourth column alongside x, y and z.
+void TrackSmoother::SolveClosed(int joint_count)
+{
+	const int size = joint_count;
+	const float gamma = -4.0f;
+
+	lower_.assign(size, 1.0f);
+	diagonal_.assign(size, 4.0f);
+	upper_.assign(size, 1.0f);
+	rhs_.assign(size * 4, 0.0f);
+
+	diagonal_[0] -= gamma;
+	diagonal_[size - 1] -= 1.0f / gamma;
+
+	for (int row = 0; row < size; row++)
+	{
+		SL::Vector next = joints_[(row + 1) % size];
+		SL::Vector value = next.Subtract(joints_[(row + size - 1) % size]).Scaled(3.0f);
+
+		rhs_[row * 4 + 0] = value.X();
+		rhs_[row * 4 + 1] = value.Y();
+		rhs_[row * 4 + 2] = value.Z();
+	}
+	rhs_[0 * 4 + 3] = gamma;
+	rhs_[(size - 1) * 4 + 3] = 1.0f;
+
+	SolveTridiagonal(size, 4);
+
+	float denominator = 1.0f + rhs_[3] + rhs_[(size - 1) * 4 + 3] / gamma;
+
+	float factors[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		factors[axis] = (rhs_[axis] + rhs_[(size - 1) * 4 + axis] / gamma) / denominator;
+	}
+
+	for (int row = 0; row < size; row++)
+	{
+		float z = rhs_[row * 4 + 3];
+		tangents_[row].Set(rhs_[row * 4 + 0] - factors[0] * z, rhs_[row * 4 + 1] - factors[1] * z, rhs_[row * 4 + 2] - factors[2] * z);
+	}
+}
+
+//	Thomas algorithm. Solves every column of rhs_ in place, overwriting upper_.
+void TrackSmoother::SolveTridiagonal(int size, int column_count)
+{
+	upper_[0] /= diagonal_[0];
+	for (int k = 0; k < column_count; k++)
+	{
+		rhs_[k] /= diagonal_[0];
+	}
+
+	for (int row = 1; row < size; row++)
+	{
+		float pivot = diagonal_[row] - lower_[row] * upper_[row - 1];
+		upper_[row] /= pivot;
+
+		for (int k = 0; k < column_count; k++)
+		{
+			rhs_[row * column_count + k] = (rhs_[row * column_count + k] - lower_[row] * rhs_[(row - 1) * column_count + k]) / pivot;
+		}
+	}
+
+	for (int row = size - 2; row >= 0; row--)
+	{
+		for (int k = 0; k < column_count; k++)
+		{
+			rhs_[row * column_count + k] -= upper_[row] * rhs_[(row + 1) * column_count + k];
+		}
+	}
+}
+
+TrackSmoother::~TrackSmoother()
+{
+}
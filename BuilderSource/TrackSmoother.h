@@ -0,0 +1,37 @@
+#pragma once
+
+#include "TrackPiece.h"
+#include <vector>
+
+class Track;
+
+//	Gives the track continuous curvature at every joint between pieces.
+//	Pieces are cubic Hermite curves, and keeping the joints where they are leaves only the tangents to solve for.
+//		Matching second derivatives at each joint ties every tangent to its two neighbours, so the
+//		system is tridiagonal and is solved in a single pass along the track. A complete track wraps round,
+//		which is handled as a cyclic system with one extra column.
+class TrackSmoother
+{
+public:
+	TrackSmoother();
+	bool Smooth(Track* track);
+	~TrackSmoother();
+
+private:
+	void SolveOpen(int piece_count);
+	void SolveClosed(int joint_count);
+	void SolveTridiagonal(int size, int column_count);
+
+private:
+	std::vector<SL::Vector> joints_;
+	std::vector<SL::Vector> tangents_;
+
+	//	The smoothed shape of each piece that has changed, or null for a piece that is left as it is.
+	std::vector<TrackPiece::StatePtr> states_;
+
+	//	Bands of the system and its right hand side, one row per unknown tangent.
+	std::vector<float> lower_;
+	std::vector<float> diagonal_;
+	std::vector<float> upper_;
+	std::vector<float> rhs_;
+};
@@ -0,0 +1,313 @@
+#include "TrackValidator.h"
+
+#include "Track.h"
+#include <algorithm>
+#include <cmath>
+
+TrackValidator::TrackValidator()
+{
+	limits_.sample_spacing = 0.5f;
+	limits_.intersection_distance = 1.0f;
+	limits_.rail_clearance = 1.5f;
+	limits_.ground_clearance = 0.5f;
+	limits_.max_curvature = 0.6f;
+	limits_.max_roll_rate = 30.0f;
+
+	for (int i = 0; i < static_cast<int>(Rule::RULE_COUNT); i++)
+	{
+		run_violation_[i] = -1;
+		run_end_[i] = -1;
+	}
+}
+
+//	Check the whole track against the limits. Returns true if there were no violations.
+//	The validator keeps its buffers between calls, so reusing one for many tracks avoids reallocating them.
+bool TrackValidator::Validate(Track* track)
+{
+	violations_.clear();
+
+	for (int i = 0; i < static_cast<int>(Rule::RULE_COUNT); i++)
+	{
+		run_violation_[i] = -1;
+		run_end_[i] = -1;
+	}
+
+	if (!track || track->GetTrackPieceCount() == 0)
+	{
+		return true;
+	}
+
+	SampleTrack(track);
+
+	CheckHeight(track->GetMinHeight());
+	CheckCurvature();
+	CheckRollRate();
+
+	//	Tracks loaded from a file don't know that they're complete, so also treat a track that ends where it starts as a loop.
+	bool closed = track->IsComplete() ||
+		(samples_.back().position.Subtract(samples_.front().position).GetLength() < limits_.intersection_distance);
+
+	CheckClearance(closed, track->GetTrackLength());
+
+	return violations_.empty();
+}
+
+//	Simulate along the track, storing the frame at evenly spaced distances.
+void TrackValidator::SampleTrack(Track* track)
+{
+	float track_length = track->GetTrackLength();
+
+	int sample_count = (int)ceilf(track_length / limits_.sample_spacing) + 1;
+	if (sample_count < 2)
+	{
+		sample_count = 2;
+	}
+	samples_.resize(sample_count);
+
+	int track_piece = 0;
+	float piece_end = track->GetPieceLength(0);
+
+	track->Reset();
+
+	for (int i = 0; i < sample_count; i++)
+	{
+		float d = (float)i / (float)(sample_count - 1);
+		float distance = d * track_length;
+
+		track->UpdateSimulation(d);
+
+		while ((distance > piece_end) && (track_piece < track->GetTrackPieceCount() - 1))
+		{
+			track_piece++;
+			piece_end += track->GetPieceLength(track_piece);
+		}
+
+		DirectX::XMFLOAT3 point = track->GetPointAtDistance(d);
+
+		Sample& sample = samples_[i];
+		sample.position.Set(point.x, point.y, point.z);
+		sample.forward = track->GetTangent();
+		sample.roll = track->GetRoll();
+		sample.distance = distance;
+		sample.track_piece = track_piece;
+	}
+
+	//	Return the track to a state where it is ready to start simulating.
+	track->Reset();
+}
+
+void TrackValidator::CheckHeight(float min_height)
+{
+	float lowest_allowed = min_height + limits_.ground_clearance;
+
+	for (int i = 0; i < samples_.size(); i++)
+	{
+		float height = samples_[i].position.Y();
+		if (height < lowest_allowed)
+		{
+			AddViolation(Rule::BELOW_GROUND, i, height, true);
+		}
+	}
+}
+
+//	Curvature is the change in direction over the distance between two samples.
+void TrackValidator::CheckCurvature()
+{
+	for (int i = 1; i < samples_.size(); i++)
+	{
+		float step = samples_[i].distance - samples_[i - 1].distance;
+		if (step <= 0.0f)
+		{
+			continue;
+		}
+
+		float dot = samples_[i].forward.Dot(samples_[i - 1].forward);
+		dot = std::max(-1.0f, std::min(1.0f, dot));
+
+		float curvature = acosf(dot) / step;
+		if (curvature > limits_.max_curvature)
+		{
+			AddViolation(Rule::CURVATURE, i, curvature, false);
+		}
+	}
+}
+
+void TrackValidator::CheckRollRate()
+{
+	for (int i = 1; i < samples_.size(); i++)
+	{
+		float step = samples_[i].distance - samples_[i - 1].distance;
+		if (step <= 0.0f)
+		{
+			continue;
+		}
+
+		float roll_rate = fabsf(samples_[i].roll - samples_[i - 1].roll) * 57.2958f / step;
+		if (roll_rate > limits_.max_roll_rate)
+		{
+			AddViolation(Rule::ROLL_RATE, i, roll_rate, false);
+		}
+	}
+}
+
+//	Find sections of track that pass close to each other.
+//	Samples are bucketed into a grid the size of the clearance, so each sample only has to be tested
+//		against the samples in the cells around it.
+void TrackValidator::CheckClearance(bool closed, float track_length)
+{
+	const float cell_size = limits_.rail_clearance;
+
+	//	Samples this close along the track are part of the same section, even on the tightest allowed curve.
+	const float min_separation = limits_.rail_clearance * 3.0f;
+
+	cells_.resize(samples_.size());
+	for (int i = 0; i < samples_.size(); i++)
+	{
+		SL::Vector& position = samples_[i].position;
+		cells_[i].key = GetCellKey((int)floorf(position.X() / cell_size), (int)floorf(position.Y() / cell_size), (int)floorf(position.Z() / cell_size));
+		cells_[i].sample = i;
+	}
+	std::sort(cells_.begin(), cells_.end());
+
+	for (int i = 0; i < samples_.size(); i++)
+	{
+		SL::Vector& position = samples_[i].position;
+		int cell_x = (int)floorf(position.X() / cell_size);
+		int cell_y = (int)floorf(position.Y() / cell_size);
+		int cell_z = (int)floorf(position.Z() / cell_size);
+
+		int closest = -1;
+		float closest_distance = limits_.rail_clearance;
+
+		for (int x = cell_x - 1; x <= cell_x + 1; x++)
+		{
+			for (int y = cell_y - 1; y <= cell_y + 1; y++)
+			{
+				for (int z = cell_z - 1; z <= cell_z + 1; z++)
+				{
+					CellEntry search;
+					search.key = GetCellKey(x, y, z);
+					search.sample = 0;
+
+					auto range = std::equal_range(cells_.begin(), cells_.end(), search);
+					for (auto it = range.first; it != range.second; ++it)
+					{
+						//	Each pair is only tested once, from the earlier sample.
+						int j = it->sample;
+						if (j <= i)
+						{
+							continue;
+						}
+
+						float separation = samples_[j].distance - samples_[i].distance;
+						if (closed)
+						{
+							separation = std::min(separation, track_length - separation);
+						}
+						if (separation < min_separation)
+						{
+							continue;
+						}
+
+						float distance = samples_[j].position.Subtract(position).GetLength();
+						if (distance < closest_distance)
+						{
+							closest_distance = distance;
+							closest = j;
+						}
+					}
+				}
+			}
+		}
+
+		if (closest >= 0)
+		{
+			Rule rule = (closest_distance < limits_.intersection_distance) ? Rule::SELF_INTERSECTION : Rule::RAIL_CLEARANCE;
+			AddViolation(rule, i, closest_distance, true, closest);
+		}
+	}
+}
+
+//	Start a new violation, or extend the current one if the previous sample broke the same rule.
+void TrackValidator::AddViolation(Rule rule, int sample, float value, bool smaller_is_worse, int other_sample)
+{
+	int rule_index = static_cast<int>(rule);
+
+	if ((run_violation_[rule_index] >= 0) && (run_end_[rule_index] == sample - 1))
+	{
+		Violation& violation = violations_[run_violation_[rule_index]];
+
+		bool worse = smaller_is_worse ? (value < violation.value) : (value > violation.value);
+		if (worse)
+		{
+			violation.value = value;
+
+			if (other_sample >= 0)
+			{
+				violation.other_track_piece = samples_[other_sample].track_piece;
+				violation.other_distance = samples_[other_sample].distance;
+			}
+		}
+
+		run_end_[rule_index] = sample;
+		return;
+	}
+
+	Violation violation;
+	violation.rule = rule;
+	violation.track_piece = samples_[sample].track_piece;
+	violation.distance = samples_[sample].distance;
+	violation.position = samples_[sample].position;
+	violation.value = value;
+	violation.other_track_piece = -1;
+	violation.other_distance = 0.0f;
+
+	if (other_sample >= 0)
+	{
+		violation.other_track_piece = samples_[other_sample].track_piece;
+		violation.other_distance = samples_[other_sample].distance;
+	}
+
+	violations_.push_back(violation);
+	run_violation_[rule_index] = violations_.size() - 1;
+	run_end_[rule_index] = sample;
+}
+
+//	Pack the three cell coordinates into one key, 21 bits each.
+unsigned long long TrackValidator::GetCellKey(int x, int y, int z)
+{
+	const unsigned long long mask = (1ull << 21) - 1;
+	const int offset = 1 << 20;
+
+	return ((unsigned long long)(x + offset) & mask) |
+		(((unsigned long long)(y + offset) & mask) << 21) |
+		(((unsigned long long)(z + offset) & mask) << 42);
+}
+
+const char* TrackValidator::GetRuleName(Rule rule)
+{
+	switch (rule)
+	{
+	case Rule::SELF_INTERSECTION:
+		return "self intersection";
+
+	case Rule::RAIL_CLEARANCE:
+		return "rail clearance";
+
+	case Rule::BELOW_GROUND:
+		return "below ground";
+
+	case Rule::CURVATURE:
+		return "curvature";
+
+	case Rule::ROLL_RATE:
+		return "roll rate";
+
+	default:
+		return "unknown";
+	}
+}
+
+TrackValidator::~TrackValidator()
+{
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../Spline-Library/vector.h"
+#include <vector>
+
+class Track;
+
+//	Checks a track for problems that would otherwise only be noticed by eye.
+//	The track is sampled at a fixed spacing along its length, and every violation is reported
+//		with where it starts along the track. Runs of neighbouring samples that break the same rule are
+//		reported as a single violation, keeping the worst value seen.
+class TrackValidator
+{
+public:
+	enum class Rule
+	{
+		SELF_INTERSECTION = 0,
+		RAIL_CLEARANCE,
+		BELOW_GROUND,
+		CURVATURE,
+		ROLL_RATE,
+		RULE_COUNT
+	};
+
+	struct Violation
+	{
+		Rule rule;
+		int track_piece;
+		float distance;
+		SL::Vector position;
+		float value;
+
+		//	The other section of track involved, for intersection and clearance violations.
+		int other_track_piece;
+		float other_distance;
+	};
+
+	struct Limits
+	{
+		//	Distance between samples, in metres.
+		float sample_spacing;
+
+		//	Centre lines closer than this overlap.
+		float intersection_distance;
+
+		//	Centre lines closer than this leave no room for the cars.
+		float rail_clearance;
+
+		//	How far the centre line must stay above the ground, which is taken from the track.
+		float ground_clearance;
+
+		//	In 1/metres, the inverse of the tightest allowed radius.
+		float max_curvature;
+
+		//	In degrees per metre.
+		float max_roll_rate;
+	};
+
+	TrackValidator();
+	bool Validate(Track* track);
+	inline const std::vector<Violation>& GetViolations() const { return violations_; }
+	inline Limits& GetLimits() { return limits_; }
+	static const char* GetRuleName(Rule rule);
+	~TrackValidator();
+
+private:
+	struct Sample
+	{
+		SL::Vector position;
+		SL::Vector forward;
+		float roll;
+		float distance;
+		int track_piece;
+	};
+
+	struct CellEntry
+	{
+		unsigned long long key;
+		int sample;
+		bool operator<(const CellEntry& other) const { return key < other.key; }
+	};
+
+	void SampleTrack(Track* track);
+	void CheckHeight(float min_height);
+	void CheckCurvature();
+	void CheckRollRate();
+	void CheckClearance(bool closed, float track_length);
+	void AddViolation(Rule rule, int sample, float value, bool smaller_is_worse, int other_sample = -1);
+	unsigned long long GetCellKey(int x, int y, int z);
+
+private:
+	Limits limits_;
+	std::vector<Sample> samples_;
+	std::vector<CellEntry> cells_;
+	std::vector<Violation> violations_;
+
+	//	Index into violations_ and the last sample of the most recent run of each rule.
+	int run_violation_[static_cast<int>(Rule::RULE_COUNT)];
+	int run_end_[static_cast<int>(Rule::RULE_COUNT)];
+};
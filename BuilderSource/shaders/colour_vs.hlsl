@@ -1,8 +1,13 @@
 
 
-cbuffer MatrixBuffer : register(b0)
+cbuffer ObjectBuffer : register(b0)
 {
 	matrix worldMatrix;
+};
+
+//	Shared by every draw in the frame, see SceneShader.
+cbuffer FrameBuffer : register(b1)
+{
 	matrix viewMatrix;
 	matrix projectionMatrix;
 };
@@ -0,0 +1,57 @@
+
+cbuffer ObjectBuffer : register(b0)
+{
+	matrix worldMatrix;
+};
+
+//	Shared by every draw in the frame, see SceneShader.
+cbuffer FrameBuffer : register(b1)
+{
+	matrix viewMatrix;
+	matrix projectionMatrix;
+};
+
+struct InputType
+{
+	float4 position : POSITION;
+	float2 tex : TEXCOORD0;
+	float3 normal : NORMAL;
+
+	//	Where this instance sits, and its rotation as a DirectXMath quaternion.
+	float3 instance_position : INSTANCEPOSITION;
+	float4 instance_rotation : INSTANCEROTATION;
+};
+
+struct OutputType
+{
+	float4 position : SV_POSITION;
+	float2 tex : TEXCOORD0;
+	float3 normal : NORMAL;
+};
+
+//	Same as XMVector3Rotate.
+float3 Rotate(float3 v, float4 q)
+{
+	return v + 2.0f * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+OutputType main(InputType input)
+{
+	OutputType output;
+
+	// Place the instance, then calculate the position of the vertex against the world, view, and projection matrices.
+	output.position = float4(Rotate(input.position.xyz, input.instance_rotation) + input.instance_position, 1.0f);
+	output.position = mul(output.position, worldMatrix);
+	output.position = mul(output.position, viewMatrix);
+	output.position = mul(output.position, projectionMatrix);
+
+	// Store the texture coordinates for the pixel shader.
+	output.tex = input.tex;
+
+	// The instance is only turned, so the normal is rotated the same way.
+	output.normal = Rotate(input.normal, input.instance_rotation);
+	output.normal = mul(output.normal, (float3x3)worldMatrix);
+	output.normal = normalize(output.normal);
+
+	return output;
+}
@@ -0,0 +1,57 @@
+
+cbuffer ObjectBuffer : register(b0)
+{
+	matrix worldMatrix;
+};
+
+//	Shared by every draw in the frame, see SceneShader.
+cbuffer FrameBuffer : register(b1)
+{
+	matrix viewMatrix;
+	matrix projectionMatrix;
+};
+
+struct InputType
+{
+	float4 position : POSITION;
+	float2 tex : TEXCOORD0;
+	float3 normal : NORMAL;
+
+	//	Rows of this instance's world matrix, as stored by DirectXMath.
+	float4 world0 : WORLD0;
+	float4 world1 : WORLD1;
+	float4 world2 : WORLD2;
+	float4 world3 : WORLD3;
+};
+
+struct OutputType
+{
+	float4 position : SV_POSITION;
+	float2 tex : TEXCOORD0;
+	float3 normal : NORMAL;
+};
+
+OutputType main(InputType input)
+{
+	OutputType output;
+	float4x4 instance_matrix = float4x4(input.world0, input.world1, input.world2, input.world3);
+
+	// Change the position vector to be 4 units for proper matrix calculations.
+	input.position.w = 1.0f;
+
+	// Place the instance, then calculate the position of the vertex against the world, view, and projection matrices.
+	output.position = mul(input.position, instance_matrix);
+	output.position = mul(output.position, worldMatrix);
+	output.position = mul(output.position, viewMatrix);
+	output.position = mul(output.position, projectionMatrix);
+
+	// Store the texture coordinates for the pixel shader.
+	output.tex = input.tex;
+
+	// Instances may be stretched, so the normal is normalised after both matrices.
+	output.normal = mul(input.normal, (float3x3)instance_matrix);
+	output.normal = mul(output.normal, (float3x3)worldMatrix);
+	output.normal = normalize(output.normal);
+
+	return output;
+}
@@ -0,0 +1,66 @@
+
+cbuffer ObjectBuffer : register(b0)
+{
+	matrix worldMatrix;
+};
+
+//	Shared by every draw in the frame, see SceneShader.
+cbuffer FrameBuffer : register(b1)
+{
+	matrix viewMatrix;
+	matrix projectionMatrix;
+};
+
+//	How to unpack the positions of the mesh being drawn, see PackedVertex::Quantisation.
+cbuffer QuantisationBuffer : register(b2)
+{
+	float4 position_offset;
+	float4 position_scale;
+};
+
+struct InputType
+{
+	//	Fractions of the mesh's box, the fourth is unused.
+	float4 position : POSITION;
+	float2 normal : NORMAL;
+	float2 tex : TEXCOORD0;
+};
+
+struct OutputType
+{
+	float4 position : SV_POSITION;
+	float2 tex : TEXCOORD0;
+	float3 normal : NORMAL;
+};
+
+//	Same as PackedVertex::DecodeNormal.
+float3 DecodeNormal(float2 encoded)
+{
+	float3 normal = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	if (normal.z < 0.0f)
+	{
+		float2 signs = float2(normal.x < 0.0f ? -1.0f : 1.0f, normal.y < 0.0f ? -1.0f : 1.0f);
+		normal.xy = (1.0f - abs(normal.yx)) * signs;
+	}
+	return normalize(normal);
+}
+
+OutputType main(InputType input)
+{
+	OutputType output;
+
+	// Unpack the position, then calculate it against the world, view, and projection matrices.
+	output.position = float4(position_offset.xyz + position_scale.xyz * input.position.xyz, 1.0f);
+	output.position = mul(output.position, worldMatrix);
+	output.position = mul(output.position, viewMatrix);
+	output.position = mul(output.position, projectionMatrix);
+
+	// Store the texture coordinates for the pixel shader.
+	output.tex = input.tex;
+
+	// Calculate the normal vector against the world matrix only and normalise.
+	output.normal = mul(DecodeNormal(input.normal), (float3x3)worldMatrix);
+	output.normal = normalize(output.normal);
+
+	return output;
+}
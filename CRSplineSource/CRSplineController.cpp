@@ -8,6 +8,7 @@ namespace SL
 
 
 	//	Spline will be created from seperate spline segments.
+	//		The resolution is the number of arc length samples taken along each segment.
 	CRSplineController::CRSplineController(int spline_resolution) : arc_length_(0.0f), spline_resolution_(spline_resolution)
 	{
 	}
@@ -39,13 +40,20 @@ namespace SL
 			segment_to_remove = 0;
 		}
 
-		//	The length of the curve has changed. So reparameterisation is needed again.
-		CalculateSplineLength();
+		//	The other segments are unchanged, so only the removed segment's length needs to be dropped.
+		segment_tensions_.pop_back();
+		segment_tables_.pop_back();
+		segment_lengths_.PopBack();
+		arc_length_ = segment_lengths_.GetTotal();
 	}
 
 	void CRSplineController::ClearSegments()
 	{
 		segments_.clear();
+		segment_tensions_.clear();
+		segment_tables_.clear();
+		segment_lengths_.Clear();
+		arc_length_ = 0.0f;
 	}
 
 	bool CRSplineController::AddSegment(CRSpline* segment, const float tension, bool match_tangent)
@@ -64,87 +72,311 @@ namespace SL
 		//	Attach the segment to the existing spline.
 		if (!segments_.empty())
 		{
-			Vector p0, p1, p2, p3;
-			p0 = segment->GetControlPoint(0);
-			p1 = segment->GetControlPoint(1);
-			p2 = segment->GetControlPoint(2);
-			p3 = segment->GetControlPoint(3);
+			if (!AttachSegment(segment, segments_.back(), match_tangent))
+			{
+				return false;
+			}
+		}
+
+		segments_.push_back(segment);
+		segment_tensions_.push_back(tension);
+		segment_tables_.push_back(ArcTable());
+
+		//	Used = true means that the spline controller is responsible for memory management of the segment that was added to it.
+		segment->SetUsed(true);
+
+		segment->CalculateCoefficients(tension);
+
+		//	Only the new segment needs to be measured.
+		CalculateSegmentTable(segments_.size() - 1);
+		segment_lengths_.PushBack(segment_tables_.back()->back());
+		arc_length_ = segment_lengths_.GetTotal();
+
+		return true;
+	}
+
+	//	Insert a segment before the segment currently at index. Segments after it are moved to stay attached.
+	//		A previously measured table can be passed in to avoid resampling the segment.
+	bool CRSplineController::InsertSegment(const int index, CRSpline* segment, const float tension, bool match_tangent, ArcTable table)
+	{
+		if (!segment || index < 0 || index > (int)segments_.size())
+		{
+			return false;
+		}
+
+		//	A segment on the end with a table of its own is added below, so it keeps the table.
+		if (index == segments_.size() && !table)
+		{
+			return AddSegment(segment, tension, match_tangent);
+		}
 
-			if (!segment->IsParent())
+		segment_rotation_store_.SetIdentity();
+		if (index > 0)
+		{
+			if (!AttachSegment(segment, segments_[index - 1], match_tangent))
 			{
-				//	Apply parent rotation to this segment.
-				p0 = segment_rotation_store_.TransformVector(p0);
-				p1 = segment_rotation_store_.TransformVector(p1);
-				p2 = segment_rotation_store_.TransformVector(p2);
-				p3 = segment_rotation_store_.TransformVector(p3);
+				return false;
 			}
+		}
+
+		segments_.insert(segments_.begin() + index, segment);
+		segment_tensions_.insert(segment_tensions_.begin() + index, tension);
+		segment_tables_.insert(segment_tables_.begin() + index, ArcTable());
+		segment->SetUsed(true);
+		segment->CalculateCoefficients(tension);
+		SetSegmentTable(index, table);
 
-			if (match_tangent)
+		//	Shifting the indices means the tree has to be rebuilt, but none of the other segments are resampled.
+		if (index == segments_.size() - 1)
+		{
+			segment_lengths_.PushBack(segment_tables_[index]->back());
+		}
+		else
+		{
+			std::vector<float> lengths(segments_.size());
+			for (int i = 0; i < segments_.size(); i++)
 			{
-				Matrix3x3 rotation_matrix;
+				lengths[i] = (i == index) ? segment_tables_[i]->back() : segment_lengths_.GetValue(i < index ? i : i - 1);
+			}
+			segment_lengths_.Build(lengths);
+		}
+		arc_length_ = segment_lengths_.GetTotal();
 
-				//	Tangents *must* be normalised for dot product comparison to work.
-				Vector target_tangent = segments_.back()->GetControlPoint(3).Subtract(segments_.back()->GetControlPoint(1)).Normalised();
-				Vector current_tangent = p2.Subtract(p0).Normalised();
+		ReattachFrom(index + 1);
 
-				float dot = current_tangent.Dot(target_tangent);
+		return true;
+	}
 
-				//	Dot = -1 implies tangents are opposites, so flip the direction of points.
-				//		treat -0.98 as -1.0 to account for floating point error.
-				if (dot <= -0.98f)
-				{
-					rotation_matrix.RotationY(180.0f);
-				}
-				//	Tangents face in different directions, so rotate the new spline segment such that the tangents will match.
-				//		Dot = 1 implies that tangents face in same direction.
-				else if(dot > -0.98f && dot < 1.0f)
-				{
-					Vector axis = current_tangent.Cross(target_tangent).Normalised();
+	//	Swap the segment at index for a new one. The old segment is deleted.
+	//		Passing the segment already at index re-attaches it after its control points have been restored.
+	//		Without reattach the following segments are left where they are, for when they are about to be replaced too.
+	bool CRSplineController::ReplaceSegment(const int index, CRSpline* segment, const float tension, bool match_tangent, ArcTable table, bool reattach)
+	{
+		if (!segment || index < 0 || index >= (int)segments_.size())
+		{
+			return false;
+		}
+
+		segment_rotation_store_.SetIdentity();
+		if (index > 0)
+		{
+			if (!AttachSegment(segment, segments_[index - 1], match_tangent))
+			{
+				return false;
+			}
+		}
 
-					//	Invalid axis of rotation, so do not add the segment.
-					if (std::isnan(axis.LengthSquared()))
-					{
-						return false;
-					}
-					
-					float angle = acosf(dot);
+		if (segments_[index] && segments_[index] != segment)
+		{
+			delete segments_[index];
+		}
+		segments_[index] = segment;
+		segment_tensions_[index] = tension;
+		segment->SetUsed(true);
 
-					rotation_matrix.RotationAxisAngle(axis, angle);
-				}
+		UpdateSegment(index, tension, table, reattach);
+
+		return true;
+	}
+
+	//	Remove and delete the segment at index. Segments after it are moved to close the gap.
+	void CRSplineController::RemoveSegment(const int index)
+	{
+		if (index < 0 || index >= (int)segments_.size())
+		{
+			return;
+		}
+
+		if (index == segments_.size() - 1)
+		{
+			RemoveBack();
+			return;
+		}
+
+		if (segments_[index])
+		{
+			delete segments_[index];
+		}
+		segments_.erase(segments_.begin() + index);
+		segment_tensions_.erase(segment_tensions_.begin() + index);
+		segment_tables_.erase(segment_tables_.begin() + index);
+
+		std::vector<float> lengths(segments_.size());
+		for (int i = 0; i < segments_.size(); i++)
+		{
+			lengths[i] = segment_tables_[i]->back();
+		}
+		segment_lengths_.Build(lengths);
+		arc_length_ = segment_lengths_.GetTotal();
+
+		ReattachFrom(index);
+	}
+
+	//	To be called after the control points of a single segment have been changed.
+	//		Only this segment is resampled, its length is updated in O(log n) and the following segments are moved to stay attached,
+	//		unless reattach is false.
+	void CRSplineController::UpdateSegment(const int index, const float tension, ArcTable table, bool reattach)
+	{
+		if (index < 0 || index >= (int)segments_.size())
+		{
+			return;
+		}
+
+		segment_tensions_[index] = tension;
+		segments_[index]->CalculateCoefficients(tension);
+
+		SetSegmentTable(index, table);
+		segment_lengths_.SetValue(index, segment_tables_[index]->back());
+		arc_length_ = segment_lengths_.GetTotal();
 
-				p0 = rotation_matrix.TransformVector(p0);
-				p1 = rotation_matrix.TransformVector(p1);
-				p2 = rotation_matrix.TransformVector(p2);
-				p3 = rotation_matrix.TransformVector(p3);
+		if (reattach)
+		{
+			ReattachFrom(index + 1);
+		}
+	}
 
-				if (segment->IsParent())
+	//	Move only the segment at index so that it joins onto the end of segment index - 1.
+	//		Used while a run of segments is being replaced one after another, so each is moved once.
+	void CRSplineController::ReattachSegment(const int index)
+	{
+		ReattachRange(index, index + 1);
+	}
+
+	//	Transform the control points of the segment so that it starts where 'previous' ends.
+	bool CRSplineController::AttachSegment(CRSpline* segment, CRSpline* previous, bool match_tangent)
+	{
+		Vector p0, p1, p2, p3;
+		p0 = segment->GetControlPoint(0);
+		p1 = segment->GetControlPoint(1);
+		p2 = segment->GetControlPoint(2);
+		p3 = segment->GetControlPoint(3);
+
+		if (!segment->IsParent())
+		{
+			//	Apply parent rotation to this segment.
+			p0 = segment_rotation_store_.TransformVector(p0);
+			p1 = segment_rotation_store_.TransformVector(p1);
+			p2 = segment_rotation_store_.TransformVector(p2);
+			p3 = segment_rotation_store_.TransformVector(p3);
+		}
+
+		if (match_tangent)
+		{
+			Matrix3x3 rotation_matrix;
+
+			//	Tangents *must* be normalised for dot product comparison to work.
+			Vector target_tangent = previous->GetControlPoint(3).Subtract(previous->GetControlPoint(1)).Normalised();
+			Vector current_tangent = p2.Subtract(p0).Normalised();
+
+			float dot = current_tangent.Dot(target_tangent);
+
+			//	Dot = -1 implies tangents are opposites, so flip the direction of points.
+			//		treat -0.98 as -1.0 to account for floating point error.
+			if (dot <= -0.98f)
+			{
+				rotation_matrix.RotationY(180.0f);
+			}
+			//	Tangents face in different directions, so rotate the new spline segment such that the tangents will match.
+			//		Dot = 1 implies that tangents face in same direction. Tangents that only differ by rounding error
+			//		have no usable axis of rotation, so are treated as matching.
+			else if(dot > -0.98f && dot < 0.99999f)
+			{
+				Vector axis = current_tangent.Cross(target_tangent).Normalised();
+
+				//	Invalid axis of rotation, so do not add the segment.
+				if (std::isnan(axis.LengthSquared()))
 				{
-					segment_rotation_store_ = rotation_matrix;
+					return false;
 				}
+				
+				float angle = acosf(dot);
+
+				rotation_matrix.RotationAxisAngle(axis, angle);
 			}
 
-			//	Calculate the offset needed to join the segment onto the end of the spline.
-			Vector direction_to_join_point = segments_.back()->GetSplineEnd().Subtract(p1);
+			p0 = rotation_matrix.TransformVector(p0);
+			p1 = rotation_matrix.TransformVector(p1);
+			p2 = rotation_matrix.TransformVector(p2);
+			p3 = rotation_matrix.TransformVector(p3);
+
+			if (segment->IsParent())
+			{
+				segment_rotation_store_ = rotation_matrix;
+			}
+		}
+
+		//	Calculate the offset needed to join the segment onto the end of the spline.
+		Vector direction_to_join_point = previous->GetSplineEnd().Subtract(p1);
+
+		p0 = p0.Add(direction_to_join_point);
+		p1 = p1.Add(direction_to_join_point);
+		p2 = p2.Add(direction_to_join_point);
+		p3 = p3.Add(direction_to_join_point);
+
+		segment->SetControlPoints(p0, p1, p2, p3);
+
+		return true;
+	}
 
-			p0 = p0.Add(direction_to_join_point);
-			p1 = p1.Add(direction_to_join_point);
-			p2 = p2.Add(direction_to_join_point);
-			p3 = p3.Add(direction_to_join_point);
+	//	Rigidly move the segments from index onwards so that they join onto the end of segment index - 1.
+	//		A rotation plus translation does not change any lengths, so no resampling is needed.
+	void CRSplineController::ReattachFrom(const int index)
+	{
+		ReattachRange(index, segments_.size());
+	}
 
-			segment->SetControlPoints(p0, p1, p2, p3);
+	//	Rigidly move the segments from index up to end so that the first joins onto the end of segment index - 1.
+	void CRSplineController::ReattachRange(const int index, const int end)
+	{
+		if (index <= 0 || index >= (int)segments_.size())
+		{
+			return;
 		}
 
-		segments_.push_back(segment);
+		CRSpline* previous = segments_[index - 1];
+		CRSpline* first = segments_[index];
 
-		//	Used = true means that the spline controller is responsible for memory management of the segment that was added to it.
-		segment->SetUsed(true);
+		Vector join_point = previous->GetSplineEnd();
+		Vector old_start = first->GetSplineStart();
 
-		//	To do: Make calculation of coefficients and distance reparameterisation occur after spline is finished, to improve run-time performance.
-		segment->CalculateCoefficients(tension);
+		Vector target_tangent = previous->GetControlPoint(3).Subtract(previous->GetControlPoint(1));
+		Vector current_tangent = first->GetControlPoint(2).Subtract(first->GetControlPoint(0));
+
+		Matrix3x3 rotation_matrix;
+		if (target_tangent.LengthSquared() > 0.0f && current_tangent.LengthSquared() > 0.0f)
+		{
+			target_tangent.Normalise();
+			current_tangent.Normalise();
 
-		CalculateSplineLength();
+			float dot = current_tangent.Dot(target_tangent);
+			if (dot < 0.99999f)
+			{
+				Vector axis = current_tangent.Cross(target_tangent);
 
-		return true;
+				//	Opposite tangents have no unique axis, so turn about the vertical.
+				if (axis.LengthSquared() < 0.000001f)
+				{
+					rotation_matrix.RotationY(180.0f);
+				}
+				else
+				{
+					axis.Normalise();
+					rotation_matrix.RotationAxisAngle(axis, acosf(dot < -1.0f ? -1.0f : dot));
+				}
+			}
+		}
+
+		for (int i = index; i < end; i++)
+		{
+			Vector points[4];
+			for (int j = 0; j < 4; j++)
+			{
+				points[j] = rotation_matrix.TransformVector(segments_[i]->GetControlPoint(j).Subtract(old_start)).Add(join_point);
+			}
+
+			segments_[i]->SetControlPoints(points[0], points[1], points[2], points[3]);
+			segments_[i]->CalculateCoefficients(segment_tensions_[i]);
+		}
 	}
 
 	//	Get a point from the splines, t normalised from 0:1
@@ -186,6 +418,8 @@ namespace SL
 		return point;
 	}
 
+	//	Find the segment containing the distance in O(log n) from the segment lengths,
+	//		then search that segment's own table for the local value of t.
 	float CRSplineController::GetTimeAtDistance(const float d)
 	{
 		if (segments_.size() == 0)
@@ -193,25 +427,27 @@ namespace SL
 			return 0.0f;
 		}
 
-		float desired_length = d * arc_length_;
+		if (arc_length_ <= 0.0f)
+		{
+			return d;
+		}
 
-		int index = FindLengthIndex(desired_length);
-		int left = index;
-		int right = index + 1;
-		if ((desired_length <= spline_lengths_[index]) && (index != 0))
+		float desired_length = d * arc_length_;
+		if (desired_length < 0.0f)
+		{
+			desired_length = 0.0f;
+		}
+		else if (desired_length > arc_length_)
 		{
-			right = index;
-			left = index - 1;
+			desired_length = arc_length_;
 		}
 
-		//	Calculate how far along the segment left->right the desired length is. [0,1]
-		float s = (desired_length - spline_lengths_[left]) / (spline_lengths_[right] - spline_lengths_[left]);
+		int segment = segment_lengths_.FindPrefix(desired_length);
+		float local_length = desired_length - segment_lengths_.GetPrefixSum(segment);
 
+		float local_t = FindLocalTime(segment, local_length);
 
-		//	Find the corresponding value of t for the desired length.
-		float t = spline_times_[left] + (s * (spline_times_[right] - spline_times_[left]));
-		
-		return t;
+		return (segment + local_t) / segments_.size();
 	}
 
 	Vector CRSplineController::GetTangent(const float t_)
@@ -237,82 +473,103 @@ namespace SL
 		return tangent;
 	}
 
-	//	To be called after every segment addition or removal.
-	//		Records distance along curve at each t.
-	//			To Do: Make spline resolution specific to each spline segment.
-	//				Would allow alteration of resolution based on spline length, whilst keeping short-lengthed splines low resoultion.
+	//	Resample every segment and rebuild the segment lengths.
+	//		Only needed when segments have been changed outside of the controller.
 	void CRSplineController::CalculateSplineLength()
 	{
 		if (segments_.empty())
 		{
 			arc_length_ = 0.0f;
+			segment_lengths_.Clear();
 			return;
 		}
-		//	Remove the existing times and lengths from the spline.
-		spline_times_.clear();
-		spline_lengths_.clear();
 
-		std::vector<Vector> spline_points;
+		std::vector<float> lengths(segments_.size());
+		for (int i = 0; i < segments_.size(); i++)
+		{
+			CalculateSegmentTable(i);
+			lengths[i] = segment_tables_[i]->back();
+		}
+
+		segment_lengths_.Build(lengths);
+		arc_length_ = segment_lengths_.GetTotal();
+	}
+
+	//	Records distance along a single segment at each sample of local t.
+	void CRSplineController::CalculateSegmentTable(const int index)
+	{
+		//	Tables may be shared with saved track states, so a new table is always created rather than overwriting the old one.
+		std::shared_ptr<std::vector<float>> new_table = std::make_shared<std::vector<float>>(spline_resolution_ + 1);
+		std::vector<float>& table = *new_table;
 
 		const float increment = 1.0f / spline_resolution_;
-		float t = 0.0f;
 		float length = 0.0f;
+		Vector previous_point = segments_[index]->GetPoint(0.0f);
+		table[0] = 0.0f;
 
-		for (int i = 0; i < spline_resolution_; i++)
+		for (int i = 1; i <= spline_resolution_; i++)
 		{
-			Vector point = GetPoint(t);
-			spline_points.push_back(point);
+			//	Calculate length by approximating space between points as a straight line.
+			Vector point = segments_[index]->GetPoint(i * increment);
+			length += point.Subtract(previous_point).GetLength();
+			table[i] = length;
+			previous_point = point;
+		}
 
-			spline_times_.push_back(t);
-			t += increment;
+		segment_tables_[index] = new_table;
+	}
 
-			//	Calculate length by approximating space between points as a straight line.
-			if (i == 0)
-			{
-				spline_lengths_.push_back(length);
-			}
-			else
-			{
-				Vector p0 = spline_points[i - 1];
-				Vector p1 = spline_points[i];
-				Vector direction = p1.Subtract(p0);
-				float magnitude = direction.GetLength();
-				length += magnitude;
-				spline_lengths_.push_back(length);
-			}
+	//	Use a table that was measured earlier, as long as it was measured at the same resolution.
+	//		Only valid if the segment has not changed shape since, moving or rotating it does not change its lengths.
+	void CRSplineController::SetSegmentTable(const int index, ArcTable table)
+	{
+		if (table && table->size() == spline_resolution_ + 1)
+		{
+			segment_tables_[index] = table;
+		}
+		else
+		{
+			CalculateSegmentTable(index);
 		}
-		arc_length_ = length;
 	}
 
-	//	Return the index number whose value matches or is closest to the desired length.
+	//	Return the local value of t [0,1] at which the segment has covered 'length'.
 	//		Binary search.
-	int CRSplineController::FindLengthIndex(float length)
+	float CRSplineController::FindLocalTime(const int index, float length)
 	{
-		int mid = spline_resolution_ / 2;
+		const std::vector<float>& table = *segment_tables_[index];
+
 		int left = 0;
 		int right = spline_resolution_;
 
-		while (left <= right)
+		//	Find the last sample whose length does not exceed the desired length.
+		while (right - left > 1)
 		{
-			mid = (left + right) / 2;
+			int mid = (left + right) / 2;
 
-			if (spline_lengths_[mid] == length)
+			if (table[mid] <= length)
 			{
-				return mid;
-			}
-
-			if (spline_lengths_[mid] < length)
-			{
-				//	length is right of mid.
-				left = mid + 1;
+				left = mid;
 			}
 			else
 			{
-				//	length is left of mid.
-				right = mid - 1;
+				right = mid;
 			}
 		}
-		return mid;
+
+		//	Calculate how far between the two samples the desired length is. [0,1]
+		float span = table[right] - table[left];
+		float s = 0.0f;
+		if (span > 0.0f)
+		{
+			s = (length - table[left]) / span;
+		}
+		if (s > 1.0f)
+		{
+			s = 1.0f;
+		}
+
+		return (left + s) / spline_resolution_;
 	}
 
 	//	Attach the end of this spline to the start of this spline.
@@ -6,12 +6,17 @@
 #include "crspline.h"
 #include <vector>
 #include "matrix3x3.h"
+#include "fenwicktree.h"
+#include <memory>
 
 namespace SL
 {
 	class CRSplineController
 	{
 	public:
+		//	Arc length samples for a single segment. Immutable once measured, so can be shared with saved track states.
+		typedef std::shared_ptr<const std::vector<float>> ArcTable;
+
 		CRSplineController(int spline_resolution);
 		~CRSplineController();
 		
@@ -22,24 +27,44 @@ namespace SL
 		inline float GetArcLength() { return arc_length_; }
 
 		bool AddSegment(CRSpline* segment, const float tension, bool match_tangent = false);
+		bool InsertSegment(const int index, CRSpline* segment, const float tension, bool match_tangent = false, ArcTable table = ArcTable());
+		bool ReplaceSegment(const int index, CRSpline* segment, const float tension, bool match_tangent = false, ArcTable table = ArcTable(), bool reattach = true);
+		void RemoveSegment(const int index);
+		void UpdateSegment(const int index, const float tension, ArcTable table = ArcTable(), bool reattach = true);
+		void ReattachSegment(const int index);
 		void RemoveBack();
 		void ClearSegments();
 		void CalculateSplineLength();
 		inline int GetSegmentCount() { return segments_.size(); }
+		inline float GetSegmentLength(const int index) { return segment_lengths_.GetValue(index); }
+		inline CRSpline* GetSegment(const int index) { return segments_.at(index); }
+		inline ArcTable GetSegmentTable(const int index) { return segment_tables_.at(index); }
 		CRSpline* JoinSelf();
 
 	private:
-		std::vector<float> spline_times_;
-		std::vector<float> spline_lengths_;
 		std::vector<Vector> control_points_;
 		std::vector<CRSpline*> segments_;
+		std::vector<float> segment_tensions_;
 		Matrix3x3 segment_rotation_store_;
 
+		//	Cumulative length at each sample along each segment, local to that segment.
+		std::vector<ArcTable> segment_tables_;
+
+		//	Length of each segment. Gives the distance to the start of any segment in O(log n).
+		FenwickTree segment_lengths_;
+
 		float arc_length_;
+
+		//	Number of arc length samples taken along each segment.
 		int spline_resolution_;
 	private:
 		int GetCurrentSegment(float t);
-		int FindLengthIndex(float length);
+		bool AttachSegment(CRSpline* segment, CRSpline* previous, bool match_tangent);
+		void ReattachFrom(const int index);
+		void ReattachRange(const int index, const int end);
+		void CalculateSegmentTable(const int index);
+		void SetSegmentTable(const int index, ArcTable table);
+		float FindLocalTime(const int index, float length);
 
 	};
 }
@@ -0,0 +1,139 @@
+#include "fenwicktree.h"
+
+namespace SL
+{
+	FenwickTree::FenwickTree() : highest_bit_(0)
+	{
+		tree_.push_back(0.0f);
+	}
+
+	//	Construct the tree from a full list of values in O(n).
+	void FenwickTree::Build(const std::vector<float>& values)
+	{
+		values_ = values;
+		tree_.assign(values_.size() + 1, 0.0f);
+
+		for (int i = 1; i <= (int)values_.size(); i++)
+		{
+			tree_[i] += values_[i - 1];
+
+			//	Push this node's sum up to its parent.
+			int parent = i + (i & -i);
+			if (parent <= (int)values_.size())
+			{
+				tree_[parent] += tree_[i];
+			}
+		}
+
+		CalculateHighestBit();
+	}
+
+	//	Appending only creates a new node, the existing nodes never cover later indices.
+	void FenwickTree::PushBack(const float value)
+	{
+		values_.push_back(value);
+
+		const int i = (int)values_.size();
+		float node = value + GetPrefixSum(i - 1) - GetPrefixSum(i - (i & -i));
+		tree_.push_back(node);
+
+		CalculateHighestBit();
+	}
+
+	void FenwickTree::PopBack()
+	{
+		if (values_.empty())
+		{
+			return;
+		}
+
+		values_.pop_back();
+		tree_.pop_back();
+
+		CalculateHighestBit();
+	}
+
+	void FenwickTree::Clear()
+	{
+		values_.clear();
+		tree_.assign(1, 0.0f);
+		highest_bit_ = 0;
+	}
+
+	void FenwickTree::SetValue(const int index, const float value)
+	{
+		const float delta = value - values_[index];
+		values_[index] = value;
+
+		for (int i = index + 1; i <= (int)values_.size(); i += (i & -i))
+		{
+			tree_[i] += delta;
+		}
+	}
+
+	float FenwickTree::GetValue(const int index) const
+	{
+		return values_[index];
+	}
+
+	//	Sum of the first 'count' values.
+	float FenwickTree::GetPrefixSum(const int count) const
+	{
+		float sum = 0.0f;
+
+		for (int i = count; i > 0; i -= (i & -i))
+		{
+			sum += tree_[i];
+		}
+
+		return sum;
+	}
+
+	float FenwickTree::GetTotal() const
+	{
+		return GetPrefixSum((int)values_.size());
+	}
+
+	//	Return the index of the value that contains the running total 'sum'.
+	//		i.e. the number of values whose prefix sum is no greater than 'sum', clamped to a valid index.
+	int FenwickTree::FindPrefix(const float sum) const
+	{
+		if (values_.empty())
+		{
+			return 0;
+		}
+
+		int position = 0;
+		float remaining = sum;
+
+		for (int step = highest_bit_; step > 0; step >>= 1)
+		{
+			if ((position + step <= (int)values_.size()) && (tree_[position + step] <= remaining))
+			{
+				position += step;
+				remaining -= tree_[position];
+			}
+		}
+
+		if (position > (int)values_.size() - 1)
+		{
+			position = (int)values_.size() - 1;
+		}
+
+		return position;
+	}
+
+	void FenwickTree::CalculateHighestBit()
+	{
+		highest_bit_ = 1;
+		while ((highest_bit_ << 1) <= (int)values_.size())
+		{
+			highest_bit_ <<= 1;
+		}
+
+		if (values_.empty())
+		{
+			highest_bit_ = 0;
+		}
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+namespace SL
+{
+	//	Binary indexed tree over a list of values.
+	//		Prefix sums, single value updates and prefix searches are all O(log n).
+	class FenwickTree
+	{
+	public:
+		FenwickTree();
+		void Build(const std::vector<float>& values);
+		void PushBack(const float value);
+		void PopBack();
+		void Clear();
+		void SetValue(const int index, const float value);
+		float GetValue(const int index) const;
+		float GetPrefixSum(const int count) const;
+		float GetTotal() const;
+		int FindPrefix(const float sum) const;
+		inline int GetSize() const { return (int)values_.size(); }
+
+	private:
+		void CalculateHighestBit();
+
+	private:
+		//	One-based tree, each node stores the sum of the range ending at its index.
+		std::vector<float> tree_;
+		std::vector<float> values_;
+		int highest_bit_;
+	};
+}
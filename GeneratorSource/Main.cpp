@@ -0,0 +1,174 @@
+// Main.cpp
+//	Command line driver for the procedural track generator.
+//	Usage: GenerateTracks <candidate count> <output directory> [keep count] [thread count] [seed]
+//	Every candidate is generated, checked with the track validator and scored with the ride analytics,
+//		spread across worker threads. The best candidates are saved as track files that can be loaded into the builder.
+//	Returns 0 if at least one candidate was kept, 1 if none were, and 2 for bad arguments.
+#include "../BuilderSource/Track.h"
+#include "../BuilderSource/TrackGenerator.h"
+#include "../BuilderSource/TrackLoader.h"
+#include "../BuilderSource/TrackValidator.h"
+#include "../BuilderSource/RideAnalytics.h"
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Candidate
+{
+	unsigned int seed;
+	bool generated;
+	int piece_count;
+	int violation_count;
+	float excitement;
+	float intensity;
+	float score;
+	RideAnalytics::Stats stats;
+};
+
+//	Each worker has its own track, generator, validator and analytics, and takes the next seed until there are none left.
+void ScoreCandidates(std::vector<Candidate>* candidates, std::atomic<int>* next_candidate)
+{
+	Track track(100, nullptr);
+	TrackGenerator generator;
+	TrackValidator validator;
+	RideAnalytics analytics;
+
+	while (true)
+	{
+		int index = (*next_candidate)++;
+		if (index >= (int)candidates->size())
+		{
+			break;
+		}
+
+		Candidate& candidate = (*candidates)[index];
+
+		candidate.generated = generator.Generate(candidate.seed, &track);
+		if (!candidate.generated)
+		{
+			continue;
+		}
+
+		validator.Validate(&track);
+		analytics.Analyse(&track);
+
+		candidate.piece_count = track.GetTrackPieceCount();
+		candidate.violation_count = validator.GetViolations().size();
+		candidate.excitement = analytics.GetExcitement();
+		candidate.intensity = analytics.GetIntensity();
+		candidate.stats = analytics.GetStats();
+
+		//	Rides that break the rules or are too intense are kept in the ranking, but well below the rest.
+		candidate.score = candidate.excitement - candidate.intensity - candidate.violation_count;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		printf("Usage: GenerateTracks <candidate count> <output directory> [keep count] [thread count] [seed]\n");
+		return 2;
+	}
+
+	int candidate_count = atoi(argv[1]);
+	if (candidate_count < 1)
+	{
+		printf("Candidate count must be at least 1\n");
+		return 2;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(argv[2], error);
+	if (error)
+	{
+		printf("Unable to create directory %s\n", argv[2]);
+		return 2;
+	}
+
+	int keep_count = (argc > 3) ? atoi(argv[3]) : 10;
+
+	int thread_count = std::thread::hardware_concurrency();
+	if (argc > 4)
+	{
+		thread_count = atoi(argv[4]);
+	}
+	thread_count = std::max(1, std::min(thread_count, candidate_count));
+
+	unsigned int first_seed = (argc > 5) ? (unsigned int)strtoul(argv[5], nullptr, 10) : 1;
+
+	std::vector<Candidate> candidates(candidate_count);
+	for (int i = 0; i < candidate_count; i++)
+	{
+		candidates[i] = Candidate();
+		candidates[i].seed = first_seed + i;
+	}
+
+	auto start_time = std::chrono::steady_clock::now();
+
+	std::atomic<int> next_candidate(0);
+	std::vector<std::thread> workers;
+	for (int i = 0; i < thread_count; i++)
+	{
+		workers.push_back(std::thread(ScoreCandidates, &candidates, &next_candidate));
+	}
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start_time).count();
+
+	//	Best first, with the seed breaking ties so the output does not depend on the thread count.
+	std::vector<Candidate> generated;
+	for (int i = 0; i < candidates.size(); i++)
+	{
+		if (candidates[i].generated)
+		{
+			generated.push_back(candidates[i]);
+		}
+	}
+	std::sort(generated.begin(), generated.end(), [](const Candidate& a, const Candidate& b)
+	{
+		return (a.score != b.score) ? (a.score > b.score) : (a.seed < b.seed);
+	});
+
+	printf("%d candidates, %d generated in %.2fs (%.0f per minute)\n", candidate_count, (int)generated.size(), seconds,
+		(seconds > 0.0f) ? candidate_count * 60.0f / seconds : 0.0f);
+
+	//	The kept tracks are rebuilt from their seeds, which is quicker than holding every candidate's track.
+	Track track(100, nullptr);
+	TrackGenerator generator;
+	TrackLoader track_loader;
+	std::vector<char> file_name;
+
+	keep_count = std::min(keep_count, (int)generated.size());
+	for (int i = 0; i < keep_count; i++)
+	{
+		Candidate& candidate = generated[i];
+		generator.Generate(candidate.seed, &track);
+
+		std::string path = (std::filesystem::path(argv[2]) / ("generated_" + std::to_string(i + 1) + ".txt")).string();
+		file_name.assign(path.begin(), path.end());
+		file_name.push_back('\0');
+
+		if (!track_loader.SaveTrack(file_name.data(), &track))
+		{
+			printf("Unable to save %s\n", path.c_str());
+			continue;
+		}
+
+		printf("%s: seed %u, %d pieces, score %.2f, excitement %.2f, intensity %.2f, %d violations, %.0fm, %.1fm/s, %.2fg to %.2fg, %.2fg lateral, %.1fs airtime\n",
+			path.c_str(), candidate.seed, candidate.piece_count, candidate.score, candidate.excitement, candidate.intensity,
+			candidate.violation_count, candidate.stats.length, candidate.stats.max_speed, candidate.stats.min_vertical_g,
+			candidate.stats.max_vertical_g, candidate.stats.max_lateral_g, candidate.stats.airtime);
+	}
+
+	return (keep_count > 0) ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+// ArcLengthTests.cpp
+//	The track measures each piece with 100 arc length samples, where it used to take 1000 across the whole track.
+//	These tests measure a track at that resolution against one measured far more finely, and bound the difference.
+#include "Tests.h"
+#include "../BuilderSource/TrackPiece.h"
+#include "../Spline-Library/CRSplineController.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	//	Add piece_count stock pieces, turning and climbing as well as running straight.
+	void BuildSpline(SL::CRSplineController& spline_controller, int piece_count)
+	{
+		const TrackPiece::Tag layout[] = { TrackPiece::Tag::STRAIGHT, TrackPiece::Tag::RIGHT_TURN, TrackPiece::Tag::CLIMB_UP,
+			TrackPiece::Tag::LEFT_TURN, TrackPiece::Tag::CLIMB_DOWN, TrackPiece::Tag::RIGHT_TURN, TrackPiece::Tag::RIGHT_TURN };
+
+		for (int i = 0; i < piece_count; i++)
+		{
+			//	The spline controller takes ownership of the spline segment.
+			TrackPiece* track_piece = TrackPiece::CreateStockPiece(layout[i % 7]);
+			spline_controller.AddSegment(track_piece->GetSpline(), track_piece->GetTension(), track_piece->ShouldSmooth());
+			delete track_piece;
+		}
+	}
+}
+
+//	At 100 samples a piece the length of the track is within a centimetre every hundred metres of the reference,
+//		and every point found by distance along it is within a few millimetres of where the reference puts it.
+void TestArcLengthIsAccurateAtDefaultResolution()
+{
+	const int piece_count = 20;
+	const int sample_count = 10000;
+
+	SL::CRSplineController spline(100);
+	SL::CRSplineController reference(20000);
+	BuildSpline(spline, piece_count);
+	BuildSpline(reference, piece_count);
+
+	CHECK(spline.GetSegmentCount() == piece_count);
+	CHECK(reference.GetArcLength() > 0.0f);
+
+	float length_error = fabsf(spline.GetArcLength() - reference.GetArcLength()) / reference.GetArcLength();
+	CHECK(length_error < 1.0e-4f);
+
+	//	Each piece on its own as well as the whole track.
+	for (int i = 0; i < piece_count; i++)
+	{
+		float piece_error = fabsf(spline.GetSegmentLength(i) - reference.GetSegmentLength(i)) / reference.GetSegmentLength(i);
+		CHECK(piece_error < 1.0e-4f);
+	}
+
+	float worst_position = 0.0f;
+	for (int i = 0; i <= sample_count; i++)
+	{
+		float d = (float)i / sample_count;
+		SL::Vector point = spline.GetPointAtDistance(d);
+		SL::Vector reference_point = reference.GetPointAtDistance(d);
+		worst_position = std::max(worst_position, point.Subtract(reference_point).GetLength());
+	}
+	CHECK(worst_position < 0.005f);
+}
@@ -0,0 +1,310 @@
+// FrameAllocationTests.cpp
+//	Once the application has warmed up, a frame with nothing being edited should not touch the heap.
+//	Each test runs one kind of frame for a while, against backends standing in for the GPU, then counts the allocations of many more.
+#include "Tests.h"
+#include "../BuilderSource/AllocationTracker.h"
+#include "../BuilderSource/Track.h"
+#include "../BuilderSource/TrackBuilder.h"
+#include "../BuilderSource/TrackMeshSink.h"
+#include "../BuilderSource/SimulatingState.h"
+#include "../BuilderSource/LineController.h"
+#include "../BuilderSource/Scene.h"
+#include "../BuilderSource/EndlessRide.h"
+#include "../BuilderSource/TrackGeometry.h"
+#include "../BuilderSource/MemoryBufferBackend.h"
+#include "../BuilderSource/RecordingRenderBackend.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace
+{
+	const int warm_up_frames = 60;
+	const int counted_frames = 600;
+	const float delta_time = 1.0f / 60.0f;
+
+	const TrackPiece::Tag layout[] = { TrackPiece::Tag::STRAIGHT, TrackPiece::Tag::RIGHT_TURN, TrackPiece::Tag::STRAIGHT,
+		TrackPiece::Tag::CLIMB_UP, TrackPiece::Tag::CLIMB_DOWN, TrackPiece::Tag::LEFT_TURN, TrackPiece::Tag::LEFT_TURN,
+		TrackPiece::Tag::STRAIGHT, TrackPiece::Tag::RIGHT_TURN };
+
+	//	Stand-ins for the scene's shaders and textures. The render queue only compares them, it never looks inside.
+	char scene_resources[64];
+
+	template<class T> T* SceneResource(int index)
+	{
+		return reinterpret_cast<T*>(&scene_resources[index]);
+	}
+
+	//	A mesh with no buffers behind it, which the recording backend never binds.
+	class StandInMesh : public BaseMesh
+	{
+	public:
+		StandInMesh()
+		{
+			vertexBuffer = nullptr;
+			indexBuffer = nullptr;
+			vertexCount = 24;
+			indexCount = 36;
+		}
+
+	protected:
+		void initBuffers(ID3D11Device* device) {}
+	};
+
+	//	A scene shaped like the builder's: a ground plane, and track chunks drawn with two shaders and three textures,
+	//		each with a box to be culled by, strung out either side of the origin so some are off screen.
+	class StandInScene
+	{
+	public:
+		StandInScene()
+		{
+			instances_[0] = new MeshInstance(SceneResource<ID3D11ShaderResourceView>(2), SceneResource<SceneShader>(0), &meshes_[0]);
+			instances_[0]->SetWorldMatrix(XMMatrixScaling(50.0f, 1.0f, 50.0f) * XMMatrixTranslation(-150.0f, -3.0f, -70.0f));
+			scene.Add(instances_[0]);
+
+			for (int i = 1; i < instance_count; i++)
+			{
+				instances_[i] = new MeshInstance(SceneResource<ID3D11ShaderResourceView>(2 + i % 3), SceneResource<SceneShader>(i % 2), &meshes_[i]);
+				instances_[i]->SetBounds(XMFLOAT3(-5.0f, -5.0f, -5.0f), XMFLOAT3(5.0f, 5.0f, 5.0f));
+				instances_[i]->SetWorldMatrix(XMMatrixTranslation((i - instance_count / 2) * 20.0f, 0.0f, 0.0f));
+				scene.Add(instances_[i]);
+			}
+		}
+
+		~StandInScene()
+		{
+			for (int i = 0; i < instance_count; i++)
+			{
+				delete instances_[i];
+			}
+		}
+
+		Scene scene;
+
+	private:
+		static const int instance_count = 41;
+		StandInMesh meshes_[instance_count];
+		MeshInstance* instances_[instance_count];
+	};
+
+	//	Counts what the builder sends to be drawn, standing in for the TrackMesh.
+	class CountingMeshSink : public TrackMeshSink
+	{
+	public:
+		CountingMeshSink() : track_uploads(0), preview_uploads(0), support_uploads(0) {}
+		void UploadTrack(const TrackGeometry& geometry) { track_uploads++; }
+		void UploadPreview(const TrackGeometry& geometry) { preview_uploads++; }
+		void UploadSupports(const TrackGeometry& geometry) { support_uploads++; }
+		void SetPreviewActive(bool preview) {}
+		void SetTranslation(float x, float y, float z) {}
+		void Clear() {}
+		void ClearPreview() {}
+		void ClearSupports() {}
+
+		unsigned int track_uploads;
+		unsigned int preview_uploads;
+		unsigned int support_uploads;
+	};
+
+	bool WasDrawn(const RecordingRenderBackend& render_backend, const BaseMesh* mesh)
+	{
+		const std::vector<const BaseMesh*>& drawn_meshes = render_backend.GetDrawnMeshes();
+		return std::find(drawn_meshes.begin(), drawn_meshes.end(), mesh) != drawn_meshes.end();
+	}
+}
+
+//	Without this, a frame that allocated through a form the tracker missed would look like it hadn't allocated.
+void TestAllocationTrackerCountsEveryForm()
+{
+	struct alignas(64) Aligned
+	{
+		float values[16];
+	};
+
+	unsigned long long count_before = AllocationTracker::GetThreadAllocationCount();
+
+	int* single = new int;
+	int* array = new int[4];
+	int* nothrow_single = new (std::nothrow) int;
+	int* nothrow_array = new (std::nothrow) int[4];
+	Aligned* aligned_single = new Aligned;
+	Aligned* aligned_array = new Aligned[2];
+	Aligned* nothrow_aligned_single = new (std::nothrow) Aligned;
+	Aligned* nothrow_aligned_array = new (std::nothrow) Aligned[2];
+
+	CHECK(AllocationTracker::GetThreadAllocationCount() - count_before == 8);
+	CHECK(reinterpret_cast<uintptr_t>(aligned_single) % alignof(Aligned) == 0);
+	CHECK(reinterpret_cast<uintptr_t>(aligned_array) % alignof(Aligned) == 0);
+	CHECK(reinterpret_cast<uintptr_t>(nothrow_aligned_single) % alignof(Aligned) == 0);
+	CHECK(reinterpret_cast<uintptr_t>(nothrow_aligned_array) % alignof(Aligned) == 0);
+
+	delete single;
+	delete[] array;
+	delete nothrow_single;
+	delete[] nothrow_array;
+	delete aligned_single;
+	delete[] aligned_array;
+	delete nothrow_aligned_single;
+	delete[] nothrow_aligned_array;
+}
+
+//	Riding a baked track, as App1::frame does in the simulating state: the simulation and the lines of its reference
+//		frame, the camera rig, and the scene with the lines drawn through the render queue.
+void TestRideFrameDoesNotAllocate()
+{
+	Track track(100, nullptr);
+	for (int i = 0; i < 37; i++)
+	{
+		track.AddTrackPiece(layout[i % 9]);
+	}
+
+	MemoryBufferBackend buffer_backend;
+	LineController line_controller(&buffer_backend, SceneResource<SceneShader>(6), 6);
+	line_controller.SetRenderFlag(true);
+	const unsigned int buffers_created = buffer_backend.GetCreateCount();
+
+	SimulatingState simulating_state;
+	simulating_state.Init(&track);
+	simulating_state.SetLineController(&line_controller);
+	simulating_state.SetTrackWorldMatrix(XMMatrixTranslation(0.0f, 2.0f, 0.0f));
+	simulating_state.OnEnter();
+
+	StandInScene stand_in;
+	stand_in.scene.SetLineController(&line_controller);
+	RecordingRenderBackend render_backend;
+	const XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PI / 4.0f, 16.0f / 9.0f, 0.1f, 200.0f);
+
+	AllocationTracker allocation_tracker;
+	unsigned int allocations = 0;
+	bool lines_drawn = true;
+
+	for (int frame = 0; frame < warm_up_frames + counted_frames; frame++)
+	{
+		allocation_tracker.BeginFrame();
+
+		simulating_state.Update(delta_time);
+
+		//	The coaster camera looks along the track from the rig, moved to where the track is placed.
+		XMVECTOR eye, look_at, up;
+		simulating_state.GetCamera(eye, look_at, up);
+		XMVECTOR offset = XMVectorSet(0.0f, 2.0f, 0.0f, 0.0f);
+		XMMATRIX view = XMMatrixLookAtLH(eye + offset, look_at + offset, up);
+
+		render_backend.Reset();
+		stand_in.scene.Render(view, projection, &render_backend);
+
+		allocation_tracker.EndFrame();
+		if (frame >= warm_up_frames)
+		{
+			allocations += allocation_tracker.GetFrameAllocations();
+			lines_drawn = lines_drawn && WasDrawn(render_backend, line_controller.GetMesh());
+		}
+	}
+
+	//	The three axes of the reference frame, written to the buffers the line mesh was made with.
+	CHECK(line_controller.GetMesh()->GetLineCount() == 3);
+	CHECK(line_controller.GetMesh()->getIndexCount() == 6);
+	CHECK(buffer_backend.GetCreateCount() == buffers_created);
+	CHECK(buffer_backend.GetLiveBuffers() == 2);
+	CHECK(lines_drawn);
+	CHECK(allocations == 0);
+}
+
+//	Building with nothing being edited, as App1::frame does in the building state: the track builder's update,
+//		which picks up anything baked, and the scene. The track is laid the way the builder's buttons lay it,
+//		a piece a frame, and left with the last piece still being previewed.
+void TestBuildingFrameDoesNotAllocate()
+{
+	CountingMeshSink mesh_sink;
+	Track track(100, &mesh_sink);
+	TrackBuilder track_builder(&track, &mesh_sink);
+
+	for (int i = 0; i < 12; i++)
+	{
+		*track_builder.SetTrackPieceType(layout[i % 9]) = true;
+		track_builder.UpdateTrack();
+	}
+
+	//	Pick up the last bake, so the frames counted have nothing left to upload.
+	track_builder.FinishBaking();
+	CHECK(track.GetTrackPieceCount() == 12);
+	CHECK(track_builder.GetPreviewActive());
+	CHECK(mesh_sink.track_uploads > 0);
+	CHECK(mesh_sink.preview_uploads > 0);
+
+	StandInScene stand_in;
+	RecordingRenderBackend render_backend;
+	const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 1.0f, -10.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	const XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PI / 4.0f, 16.0f / 9.0f, 0.1f, 200.0f);
+
+	const unsigned int track_uploads = mesh_sink.track_uploads;
+	const unsigned int preview_uploads = mesh_sink.preview_uploads;
+	AllocationTracker allocation_tracker;
+	unsigned int allocations = 0;
+
+	for (int frame = 0; frame < warm_up_frames + counted_frames; frame++)
+	{
+		allocation_tracker.BeginFrame();
+
+		track_builder.UpdateTrack();
+
+		render_backend.Reset();
+		stand_in.scene.Render(view, projection, &render_backend);
+
+		allocation_tracker.EndFrame();
+		if (frame >= warm_up_frames)
+		{
+			allocations += allocation_tracker.GetFrameAllocations();
+		}
+	}
+
+	//	Nothing was edited, so nothing was baked again.
+	CHECK(mesh_sink.track_uploads == track_uploads);
+	CHECK(mesh_sink.preview_uploads == preview_uploads);
+	CHECK(!track_builder.IsBaking());
+	CHECK(render_backend.GetDrawCalls() > 0);
+	CHECK(allocations == 0);
+}
+
+//	Riding the endless track: pieces are laid in front of the train and baked into the slots behind it, as in EndlessState.
+void TestEndlessFrameDoesNotAllocate()
+{
+	EndlessRide ride(24);
+	ride.Reset(1);
+
+	//	Baked the way the EndlessMesh bakes it, with the same rings for every slot.
+	TrackGeometry geometry;
+	geometry.SetAdaptive(false);
+	AllocationTracker allocation_tracker;
+	unsigned int allocations = 0;
+	unsigned int slots_baked = 0;
+
+	for (int frame = 0; frame < warm_up_frames + counted_frames; frame++)
+	{
+		allocation_tracker.BeginFrame();
+
+		ride.Update(delta_time);
+
+		XMVECTOR position, forward, up;
+		ride.GetFrame(position, forward, up);
+
+		const std::vector<int>& changed_slots = ride.GetChangedSlots();
+		for (int i = 0; i < changed_slots.size(); i++)
+		{
+			ride.BakeSlot(changed_slots[i], &geometry);
+		}
+
+		allocation_tracker.EndFrame();
+		if (frame >= warm_up_frames)
+		{
+			allocations += allocation_tracker.GetFrameAllocations();
+			slots_baked += changed_slots.size();
+		}
+
+		ride.ClearChangedSlots();
+	}
+
+	//	Otherwise the frames counted wouldn't have laid any track.
+	CHECK(slots_baked > 0);
+	CHECK(allocations == 0);
+}
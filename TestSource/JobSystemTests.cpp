@@ -0,0 +1,124 @@
+// JobSystemTests.cpp
+//	The bakes split their stages over the job system, and rely on every index being run exactly once before ParallelFor returns.
+//	These tests count the calls for each index, over more work than the queues start with room for,
+//		and check a thread held up by one task doesn't hold up the rest.
+#include "Tests.h"
+#include "../BuilderSource/JobSystem.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace
+{
+	//	Every index was called once, and none of them more than once.
+	bool EachRanOnce(const std::vector<std::atomic<int>>& calls)
+	{
+		for (int i = 0; i < calls.size(); i++)
+		{
+			if (calls[i] != 1)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+//	Each index from 0 to count is run once, whether there are no workers, a few, or no job system at all,
+//		and however the range divides between the tasks. A range of nothing runs nothing.
+void TestJobSystemRunsEachIndexOnce()
+{
+	const unsigned int counts[] = { 0, 1, 2, 7, 100, 100003 };
+	const unsigned int worker_counts[] = { 0, 1, 3 };
+
+	for (int w = 0; w < 3; w++)
+	{
+		JobSystem jobs(worker_counts[w]);
+		CHECK(jobs.GetWorkerCount() == worker_counts[w]);
+
+		for (int c = 0; c < 6; c++)
+		{
+			std::vector<std::atomic<int>> calls(counts[c]);
+			std::atomic<int> total(0);
+			auto count_call = [&calls, &total](unsigned int index)
+			{
+				calls[index]++;
+				total++;
+			};
+
+			jobs.ParallelFor(counts[c], count_call);
+			CHECK(EachRanOnce(calls));
+			CHECK(total == counts[c]);
+
+			std::vector<std::atomic<int>> serial_calls(counts[c]);
+			auto count_serial_call = [&serial_calls](unsigned int index) { serial_calls[index]++; };
+			JobSystem::ParallelFor(nullptr, counts[c], count_serial_call);
+			CHECK(EachRanOnce(serial_calls));
+		}
+	}
+}
+
+//	Jobs that start a ParallelFor of their own queue far more tasks than the queues start with room for,
+//		and the threads waiting on them run the new tasks rather than stalling.
+void TestJobSystemRunsNestedWork()
+{
+	const unsigned int outer_count = 24;
+	const unsigned int inner_count = 1000;
+
+	JobSystem jobs(2);
+	std::vector<std::atomic<int>> calls(outer_count * inner_count);
+
+	auto outer = [&jobs, &calls, inner_count](unsigned int i)
+	{
+		auto inner = [&calls, i, inner_count](unsigned int j) { calls[i * inner_count + j]++; };
+		jobs.ParallelFor(inner_count, inner);
+	};
+
+	jobs.ParallelFor(outer_count, outer);
+	CHECK(EachRanOnce(calls));
+
+	//	And the job system still works afterwards.
+	std::vector<std::atomic<int>> more_calls(5000);
+	auto count_call = [&more_calls](unsigned int index) { more_calls[index]++; };
+	jobs.ParallelFor(more_calls.size(), count_call);
+	CHECK(EachRanOnce(more_calls));
+}
+
+//	Whichever thread takes the first task is held there until the second half of the range has run, so whatever
+//		else is queued behind it has to be taken by the other threads. Gives up after a few seconds rather than hanging.
+void TestJobSystemStealsWork()
+{
+	const unsigned int count = 4000;
+
+	JobSystem jobs(2);
+	std::vector<std::atomic<int>> calls(count);
+	std::atomic<unsigned int> second_half(0);
+	std::atomic<bool> timed_out(false);
+
+	auto job = [&calls, &second_half, &timed_out, count](unsigned int index)
+	{
+		if (index == 0)
+		{
+			std::chrono::steady_clock::time_point give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+			while (second_half < count - count / 2)
+			{
+				if (std::chrono::steady_clock::now() > give_up)
+				{
+					timed_out = true;
+					break;
+				}
+				std::this_thread::yield();
+			}
+		}
+		else if (index >= count / 2)
+		{
+			second_half++;
+		}
+
+		calls[index]++;
+	};
+
+	jobs.ParallelFor(count, job);
+	CHECK(!timed_out);
+	CHECK(EachRanOnce(calls));
+}
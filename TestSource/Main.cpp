@@ -0,0 +1,72 @@
+// Main.cpp
+//	Runs the tests for the parts of the builder that don't need a device.
+//	Usage: RunTests
+//	Returns 0 if every check passed and 1 if any failed.
+#include "Tests.h"
+
+int failed_checks = 0;
+
+struct Test
+{
+	const char* name;
+	void (*run)();
+};
+
+const Test tests[] =
+{
+	{ "ArcLengthIsAccurateAtDefaultResolution", TestArcLengthIsAccurateAtDefaultResolution },
+	{ "AllocationTrackerCountsEveryForm", TestAllocationTrackerCountsEveryForm },
+	{ "RideFrameDoesNotAllocate", TestRideFrameDoesNotAllocate },
+	{ "BuildingFrameDoesNotAllocate", TestBuildingFrameDoesNotAllocate },
+	{ "EndlessFrameDoesNotAllocate", TestEndlessFrameDoesNotAllocate },
+	{ "JobSystemRunsEachIndexOnce", TestJobSystemRunsEachIndexOnce },
+	{ "JobSystemRunsNestedWork", TestJobSystemRunsNestedWork },
+	{ "JobSystemStealsWork", TestJobSystemStealsWork },
+	{ "PackedVertexRoundTripsPositions", TestPackedVertexRoundTripsPositions },
+	{ "PackedVertexRoundTripsNormals", TestPackedVertexRoundTripsNormals },
+	{ "PagedBufferGrowsByPages", TestPagedBufferGrowsByPages },
+	{ "PagedBufferShrinksWithHysteresis", TestPagedBufferShrinksWithHysteresis },
+	{ "PagedBufferWritesRegions", TestPagedBufferWritesRegions },
+	{ "RenderQueueBatchesStateChanges", TestRenderQueueBatchesStateChanges },
+	{ "RenderQueueDrawsUntexturedFirst", TestRenderQueueDrawsUntexturedFirst },
+	{ "RenderQueueNumbersResourcesEachFrame", TestRenderQueueNumbersResourcesEachFrame },
+	{ "RenderQueueOutlastsTheIdRange", TestRenderQueueOutlastsTheIdRange },
+	{ "ResourcePoolHandlesGoStale", TestResourcePoolHandlesGoStale },
+	{ "ScratchArenaAlignsAllocations", TestScratchArenaAlignsAllocations },
+	{ "ScratchArenaGrowsByBlocks", TestScratchArenaGrowsByBlocks },
+	{ "ScratchArenaReusesBlocksAfterReset", TestScratchArenaReusesBlocksAfterReset },
+	{ "TrackGridMarksCorners", TestTrackGridMarksCorners },
+	{ "GeneratedTracksDoNotCrossThemselves", TestGeneratedTracksDoNotCrossThemselves },
+	{ "TrackGeometrySamplesByShape", TestTrackGeometrySamplesByShape },
+	{ "TrackGeometryPlacesInstances", TestTrackGeometryPlacesInstances },
+	{ "TrackBakesInstances", TestTrackBakesInstances },
+	{ "RebakeDoesNotAllocate", TestRebakeDoesNotAllocate },
+	{ "TrackPieceCacheEvictsLeastRecentlyUsed", TestTrackPieceCacheEvictsLeastRecentlyUsed },
+	{ "TrackPieceCacheReusesEntries", TestTrackPieceCacheReusesEntries },
+	{ "CapturedStatesAreSharedUntilEdited", TestCapturedStatesAreSharedUntilEdited },
+	{ "PieceLengthsFollowEdits", TestPieceLengthsFollowEdits },
+	{ "UndoReusesBakedPieces", TestUndoReusesBakedPieces },
+};
+
+int main(int argc, char* argv[])
+{
+	int test_count = sizeof(tests) / sizeof(tests[0]);
+	int failed_count = 0;
+
+	for (int i = 0; i < test_count; i++)
+	{
+		int failed_before = failed_checks;
+		tests[i].run();
+
+		bool passed = (failed_checks == failed_before);
+		printf("%s %s\n", passed ? "passed" : "FAILED", tests[i].name);
+		if (!passed)
+		{
+			failed_count++;
+		}
+	}
+
+	printf("%d tests run, %d failed\n", test_count, failed_count);
+
+	return (failed_count == 0) ? 0 : 1;
+}
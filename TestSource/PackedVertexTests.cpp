@@ -0,0 +1,116 @@
+// PackedVertexTests.cpp
+//	The packed rails keep their vertices at half the size, and these tests check what that costs.
+//	Vertices are packed and unpacked again, and compared against what went in.
+#include "Tests.h"
+#include "../BuilderSource/PackedVertex.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	//	About the size of a chunk of track, which is what each rail mesh is fitted to.
+	const XMFLOAT3 box_min(-35.0f, 2.0f, 10.0f);
+	const XMFLOAT3 box_max(25.0f, 32.0f, 70.0f);
+
+	float RandomIn(std::mt19937& random, float min, float max)
+	{
+		return std::uniform_real_distribution<float>(min, max)(random);
+	}
+}
+
+//	Positions come back to within half a step of the box, which across a chunk of track is well under a millimetre.
+//		Texture coordinates come back to within a half float's precision, however far along the track v has got.
+void TestPackedVertexRoundTripsPositions()
+{
+	const float v_min = 1000.0f;
+	PackedVertex::Quantisation quantisation = PackedVertex::CalculateQuantisation(box_min, box_max, v_min);
+	std::mt19937 random(7);
+
+	float worst_position = 0.0f;
+	float worst_u = 0.0f;
+	float worst_v = 0.0f;
+	for (int i = 0; i < 10000; i++)
+	{
+		XMFLOAT3 position(RandomIn(random, box_min.x, box_max.x), RandomIn(random, box_min.y, box_max.y), RandomIn(random, box_min.z, box_max.z));
+		XMFLOAT2 texture(RandomIn(random, 0.0f, 1.0f), RandomIn(random, v_min, v_min + 4.0f));
+
+		XMFLOAT3 decoded_position, decoded_normal;
+		XMFLOAT2 decoded_texture;
+		PackedVertex vertex = PackedVertex::Encode(position, texture, XMFLOAT3(0.0f, 1.0f, 0.0f), quantisation);
+		PackedVertex::Decode(vertex, quantisation, decoded_position, decoded_texture, decoded_normal);
+
+		worst_position = std::max(worst_position, fabsf(decoded_position.x - position.x));
+		worst_position = std::max(worst_position, fabsf(decoded_position.y - position.y));
+		worst_position = std::max(worst_position, fabsf(decoded_position.z - position.z));
+		worst_u = std::max(worst_u, fabsf(decoded_texture.x - texture.x));
+		worst_v = std::max(worst_v, fabsf(decoded_texture.y - texture.y));
+	}
+
+	const float largest_side = std::max(box_max.x - box_min.x, std::max(box_max.y - box_min.y, box_max.z - box_min.z));
+	CHECK(worst_position <= largest_side / 65535.0f * 0.5f + 1.0e-5f);
+	CHECK(worst_position < 0.001f);
+
+	//	Half floats keep 11 significant bits, so u below one is within 2^-12 and v, less its repeats, below four within 2^-10.
+	CHECK(worst_u <= 1.0f / 4096.0f);
+	CHECK(worst_v <= 1.0f / 1024.0f + 1.0e-4f);
+
+	//	Positions outside the box are clamped to it rather than wrapping round.
+	XMFLOAT3 decoded_position, decoded_normal;
+	XMFLOAT2 decoded_texture;
+	PackedVertex vertex = PackedVertex::Encode(XMFLOAT3(box_max.x + 5.0f, box_min.y - 5.0f, box_max.z), XMFLOAT2(0.0f, v_min), XMFLOAT3(0.0f, 1.0f, 0.0f), quantisation);
+	PackedVertex::Decode(vertex, quantisation, decoded_position, decoded_texture, decoded_normal);
+	CHECK(fabsf(decoded_position.x - box_max.x) < 0.001f);
+	CHECK(fabsf(decoded_position.y - box_min.y) < 0.001f);
+}
+
+//	Normals come back as unit vectors within a hundredth of a degree, in every direction including straight down
+//		and along the folds of the octahedron.
+void TestPackedVertexRoundTripsNormals()
+{
+	PackedVertex::Quantisation quantisation = PackedVertex::CalculateQuantisation(box_min, box_max, 0.0f);
+	std::mt19937 random(11);
+
+	const XMFLOAT3 awkward_normals[] =
+	{
+		XMFLOAT3(0.0f, 0.0f, 1.0f),
+		XMFLOAT3(0.0f, 0.0f, -1.0f),
+		XMFLOAT3(1.0f, 0.0f, 0.0f),
+		XMFLOAT3(0.0f, -1.0f, 0.0f),
+		XMFLOAT3(0.70710678f, 0.70710678f, 0.0f),
+		XMFLOAT3(-0.70710678f, 0.0f, -0.70710678f),
+	};
+	const int awkward_count = sizeof(awkward_normals) / sizeof(awkward_normals[0]);
+
+	float worst_angle = 0.0f;
+	float worst_length = 0.0f;
+	for (int i = 0; i < 10000 + awkward_count; i++)
+	{
+		XMFLOAT3 normal;
+		if (i < awkward_count)
+		{
+			normal = awkward_normals[i];
+		}
+		else
+		{
+			XMStoreFloat3(&normal, XMVector3Normalize(XMVectorSet(RandomIn(random, -1.0f, 1.0f), RandomIn(random, -1.0f, 1.0f), RandomIn(random, -1.0f, 1.0f), 0.0f)));
+		}
+
+		XMFLOAT3 decoded_position, decoded_normal;
+		XMFLOAT2 decoded_texture;
+		PackedVertex vertex = PackedVertex::Encode(box_min, XMFLOAT2(0.0f, 0.0f), normal, quantisation);
+		PackedVertex::Decode(vertex, quantisation, decoded_position, decoded_texture, decoded_normal);
+
+		//	The angle between two close unit vectors, from the length of their difference, which keeps its precision near zero.
+		float dx = decoded_normal.x - normal.x;
+		float dy = decoded_normal.y - normal.y;
+		float dz = decoded_normal.z - normal.z;
+		float angle = 2.0f * asinf(std::min(1.0f, sqrtf(dx * dx + dy * dy + dz * dz) * 0.5f)) * 57.29578f;
+		float length = sqrtf(decoded_normal.x * decoded_normal.x + decoded_normal.y * decoded_normal.y + decoded_normal.z * decoded_normal.z);
+		worst_angle = std::max(worst_angle, angle);
+		worst_length = std::max(worst_length, fabsf(length - 1.0f));
+	}
+
+	CHECK(worst_angle < 0.01f);
+	CHECK(worst_length < 1.0e-5f);
+}
@@ -0,0 +1,120 @@
+// PagedBufferTests.cpp
+//	The track's vertex and index buffers are paged, so that editing the end of a track doesn't reallocate them every time.
+//	These tests page a buffer in system memory and count the buffers it creates along the way.
+#include "Tests.h"
+#include "../BuilderSource/PagedBuffer.h"
+#include "../BuilderSource/MemoryBufferBackend.h"
+
+namespace
+{
+	const unsigned int page_size = 4;
+
+	//	Element i holds i, so what ended up in a buffer can be checked.
+	const unsigned int elements[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+	unsigned int GetElement(const MemoryBufferBackend& backend, const PagedBuffer& buffer, unsigned int index)
+	{
+		const std::vector<unsigned char>& contents = backend.GetContents(buffer.GetBuffer());
+		return *reinterpret_cast<const unsigned int*>(&contents[index * sizeof(unsigned int)]);
+	}
+}
+
+//	A buffer grows a whole page at a time, and only when what is written no longer fits.
+void TestPagedBufferGrowsByPages()
+{
+	MemoryBufferBackend backend;
+
+	{
+		PagedBuffer buffer(&backend, sizeof(unsigned int), page_size, false);
+
+		//	Even an empty buffer has a page, so it can be bound.
+		CHECK(buffer.Reserve(0));
+		CHECK(buffer.GetPageCount() == 1);
+		CHECK(backend.GetCreateCount() == 1);
+
+		CHECK(buffer.Write(elements, 4));
+		CHECK(buffer.GetPageCount() == 1);
+		CHECK(backend.GetCreateCount() == 1);
+
+		CHECK(buffer.Write(elements, 5));
+		CHECK(buffer.GetPageCount() == 2);
+		CHECK(buffer.GetCapacity() == 2 * page_size);
+		CHECK(backend.GetCreateCount() == 2);
+
+		//	The old buffer is let go as soon as the new one is made.
+		CHECK(backend.GetLiveBuffers() == 1);
+		CHECK(backend.GetLiveBytes() == buffer.GetByteSize());
+		CHECK(GetElement(backend, buffer, 4) == 4);
+
+		CHECK(buffer.Write(elements, 8));
+		CHECK(backend.GetCreateCount() == 2);
+
+		CHECK(buffer.Write(elements, 16));
+		CHECK(buffer.GetPageCount() == 4);
+		CHECK(backend.GetCreateCount() == 3);
+		CHECK(GetElement(backend, buffer, 15) == 15);
+	}
+
+	CHECK(backend.GetLiveBuffers() == 0);
+	CHECK(backend.GetLiveBytes() == 0);
+}
+
+//	A buffer keeps up to one page more than it needs, so data that keeps crossing a page boundary
+//		doesn't reallocate every time, but gives the rest back once it has shrunk by more than that.
+void TestPagedBufferShrinksWithHysteresis()
+{
+	MemoryBufferBackend backend;
+	PagedBuffer buffer(&backend, sizeof(unsigned int), page_size, false);
+
+	CHECK(buffer.Write(elements, 12));
+	CHECK(buffer.GetPageCount() == 3);
+	unsigned int create_count = backend.GetCreateCount();
+
+	CHECK(buffer.Write(elements, 8));
+	CHECK(buffer.GetPageCount() == 3);
+	CHECK(backend.GetCreateCount() == create_count);
+
+	CHECK(buffer.Write(elements, 4));
+	CHECK(buffer.GetPageCount() == 1);
+	CHECK(backend.GetCreateCount() == create_count + 1);
+	CHECK(backend.GetLiveBytes() == page_size * sizeof(unsigned int));
+
+	//	Adding and removing an element at the boundary grows the buffer once, then leaves it alone.
+	create_count = backend.GetCreateCount();
+	for (int i = 0; i < 10; i++)
+	{
+		CHECK(buffer.Write(elements, 5));
+		CHECK(buffer.Write(elements, 4));
+	}
+	CHECK(buffer.GetPageCount() == 2);
+	CHECK(backend.GetCreateCount() == create_count + 1);
+
+	//	Clearing keeps a buffer of one or two pages, as PipeMesh::Clear relies on.
+	CHECK(buffer.Reserve(0));
+	CHECK(buffer.GetPageCount() == 2);
+	CHECK(backend.GetCreateCount() == create_count + 1);
+}
+
+//	Writing a region keeps the rest of the buffer, and never resizes it.
+void TestPagedBufferWritesRegions()
+{
+	MemoryBufferBackend backend;
+	PagedBuffer buffer(&backend, sizeof(unsigned int), page_size, false);
+
+	//	Nothing to write into yet.
+	CHECK(!buffer.WriteRegion(0, elements, 1));
+
+	CHECK(buffer.Write(elements, 8));
+	unsigned int create_count = backend.GetCreateCount();
+
+	CHECK(buffer.WriteRegion(2, &elements[12], 3));
+	CHECK(GetElement(backend, buffer, 1) == 1);
+	CHECK(GetElement(backend, buffer, 2) == 12);
+	CHECK(GetElement(backend, buffer, 4) == 14);
+	CHECK(GetElement(backend, buffer, 5) == 5);
+
+	CHECK(buffer.WriteRegion(6, elements, 2));
+	CHECK(!buffer.WriteRegion(6, elements, 3));
+	CHECK(buffer.GetPageCount() == 2);
+	CHECK(backend.GetCreateCount() == create_count);
+}
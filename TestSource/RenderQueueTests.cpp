@@ -0,0 +1,143 @@
+// RenderQueueTests.cpp
+//	The render queue sorts a frame's draws so that shaders, textures and meshes are bound as few times as they can be.
+//	These tests queue frames into the recording backend and count what it is asked to bind.
+#include "Tests.h"
+#include "../BuilderSource/RenderQueue.h"
+#include "../BuilderSource/RecordingRenderBackend.h"
+
+namespace
+{
+	const int shader_count = 2;
+	const int texture_count = 3;
+	const int mesh_count = 4;
+
+	//	Stand-ins for the scene's shaders, textures and meshes. The render queue only compares them, it never looks inside.
+	char scene_resources[64];
+
+	template<class T> T* SceneResource(int index)
+	{
+		return reinterpret_cast<T*>(&scene_resources[index]);
+	}
+
+	DrawItem MakeItem(int shader, int texture, int mesh)
+	{
+		DrawItem item = {};
+		XMStoreFloat4x4(&item.world, XMMatrixIdentity());
+		item.index_count = 36;
+		item.shader = SceneResource<SceneShader>(shader);
+		item.texture = (texture >= 0) ? SceneResource<ID3D11ShaderResourceView>(8 + texture) : nullptr;
+		item.mesh = SceneResource<BaseMesh>(16 + mesh);
+		return item;
+	}
+}
+
+//	Every pairing of shader, texture and mesh is drawn twice, submitted in an order that changes all three every time.
+void TestRenderQueueBatchesStateChanges()
+{
+	RenderQueue render_queue;
+	RecordingRenderBackend render_backend;
+
+	const int pairing_count = shader_count * texture_count * mesh_count;
+	render_queue.Begin(XMMatrixIdentity(), XMMatrixIdentity());
+	for (int i = 0; i < pairing_count * 2; i++)
+	{
+		int pairing = (i * 7) % pairing_count;
+		render_queue.Submit(MakeItem(pairing % shader_count, (pairing / shader_count) % texture_count, pairing / (shader_count * texture_count)));
+	}
+	CHECK(render_queue.GetDrawCount() == pairing_count * 2);
+
+	render_queue.Flush(&render_backend);
+
+	CHECK(render_backend.GetFrameCount() == 1);
+	CHECK(render_backend.GetDrawCalls() == pairing_count * 2);
+	CHECK(render_backend.GetShaderChanges() == shader_count);
+	CHECK(render_backend.GetTextureChanges() == shader_count * texture_count);
+	CHECK(render_backend.GetMeshChanges() == pairing_count);
+
+	//	Both draws of each pairing are made one after the other.
+	const std::vector<const BaseMesh*>& drawn_meshes = render_backend.GetDrawnMeshes();
+	for (int i = 0; i + 1 < drawn_meshes.size(); i += 2)
+	{
+		CHECK(drawn_meshes[i] == drawn_meshes[i + 1]);
+	}
+
+	CHECK(render_queue.GetDrawCount() == 0);
+}
+
+//	Untextured draws come before the shader's textured draws, and don't bind a texture of their own.
+void TestRenderQueueDrawsUntexturedFirst()
+{
+	RenderQueue render_queue;
+	RecordingRenderBackend render_backend;
+
+	render_queue.Begin(XMMatrixIdentity(), XMMatrixIdentity());
+	render_queue.Submit(MakeItem(0, 0, 0));
+	render_queue.Submit(MakeItem(0, -1, 1));
+	render_queue.Submit(MakeItem(0, 0, 2));
+	render_queue.Flush(&render_backend);
+
+	const std::vector<const BaseMesh*>& drawn_meshes = render_backend.GetDrawnMeshes();
+	CHECK(drawn_meshes.size() == 3);
+	CHECK(drawn_meshes[0] == SceneResource<BaseMesh>(17));
+	CHECK(drawn_meshes[1] == SceneResource<BaseMesh>(16));
+	CHECK(drawn_meshes[2] == SceneResource<BaseMesh>(18));
+	CHECK(render_backend.GetTextureChanges() == 1);
+}
+
+//	Draws that tie on shader and texture are ordered by when their mesh was first seen in the same frame,
+//		so a mesh from an earlier frame, or one rebuilt at a freed mesh's address, gets no say in the order.
+void TestRenderQueueNumbersResourcesEachFrame()
+{
+	RenderQueue render_queue;
+	RecordingRenderBackend render_backend;
+
+	render_queue.Begin(XMMatrixIdentity(), XMMatrixIdentity());
+	render_queue.Submit(MakeItem(0, 0, 0));
+	render_queue.Submit(MakeItem(0, 0, 1));
+	render_queue.Flush(&render_backend);
+
+	render_backend.Reset();
+	render_queue.Begin(XMMatrixIdentity(), XMMatrixIdentity());
+	render_queue.Submit(MakeItem(0, 0, 1));
+	render_queue.Submit(MakeItem(0, 0, 2));
+	render_queue.Submit(MakeItem(0, 0, 0));
+	render_queue.Submit(MakeItem(0, 0, 1));
+	render_queue.Flush(&render_backend);
+
+	const std::vector<const BaseMesh*>& drawn_meshes = render_backend.GetDrawnMeshes();
+	CHECK(drawn_meshes.size() == 4);
+	CHECK(drawn_meshes[0] == SceneResource<BaseMesh>(17));
+	CHECK(drawn_meshes[1] == SceneResource<BaseMesh>(17));
+	CHECK(drawn_meshes[2] == SceneResource<BaseMesh>(18));
+	CHECK(drawn_meshes[3] == SceneResource<BaseMesh>(16));
+	CHECK(render_backend.GetMeshChanges() == 3);
+}
+
+//	More textures than a key has room for, spread over many frames, are still told apart within each frame.
+void TestRenderQueueOutlastsTheIdRange()
+{
+	const int frame_count = 300;
+	const int textures_per_frame = 250;
+	static char textures[frame_count * textures_per_frame];
+
+	RenderQueue render_queue;
+	RecordingRenderBackend render_backend;
+
+	for (int frame = 0; frame < frame_count; frame++)
+	{
+		render_backend.Reset();
+		render_queue.Begin(XMMatrixIdentity(), XMMatrixIdentity());
+
+		//	Each texture is drawn twice, apart, so the draws only come together if the textures are told apart.
+		for (int i = 0; i < textures_per_frame * 2; i++)
+		{
+			DrawItem item = MakeItem(0, 0, 0);
+			item.texture = reinterpret_cast<ID3D11ShaderResourceView*>(&textures[frame * textures_per_frame + i % textures_per_frame]);
+			render_queue.Submit(item);
+		}
+
+		render_queue.Flush(&render_backend);
+	}
+
+	CHECK(render_backend.GetTextureChanges() == textures_per_frame);
+}
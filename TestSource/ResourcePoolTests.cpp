@@ -0,0 +1,80 @@
+// ResourcePoolTests.cpp
+//	The track mesh keeps its chunk meshes in a pool, and drops handles to them as the track changes.
+//	These tests check a handle only ever reaches the object it was handed out for.
+#include "Tests.h"
+#include "../BuilderSource/ResourcePool.h"
+
+namespace
+{
+	//	Counts how many are alive, so the tests can see the pool delete them.
+	struct Counted
+	{
+		Counted(int value) : value(value) { alive++; }
+		~Counted() { alive--; }
+
+		int value;
+		static int alive;
+	};
+
+	int Counted::alive = 0;
+}
+
+//	Releasing an object makes every handle to it stale. Reusing its slot hands out a new generation, which the stale
+//		handles don't match, so they still don't resolve, and releasing one again doesn't free the slot twice.
+void TestResourcePoolHandlesGoStale()
+{
+	{
+		ResourcePool<Counted> pool;
+		ResourcePool<Counted>::Handle handle;
+		CHECK(!pool.Reuse(handle));
+
+		ResourcePool<Counted>::Handle first = pool.Add(new Counted(1));
+		ResourcePool<Counted>::Handle second = pool.Add(new Counted(2));
+		CHECK(pool.IsValid(first) && pool.IsValid(second));
+		CHECK(pool.Get(first)->value == 1);
+		CHECK(pool.Get(second)->value == 2);
+		CHECK(pool.GetLiveCount() == 2);
+
+		pool.Release(first);
+		CHECK(!pool.IsValid(first));
+		CHECK(pool.Get(first) == nullptr);
+		CHECK(pool.Get(second)->value == 2);
+		CHECK(pool.GetLiveCount() == 1);
+		CHECK(pool.GetFreeCount() == 1);
+
+		//	Releasing a stale handle does nothing.
+		pool.Release(first);
+		CHECK(pool.GetFreeCount() == 1);
+
+		ResourcePool<Counted>::Handle reused;
+		CHECK(pool.Reuse(reused));
+		CHECK(reused.index == first.index);
+		CHECK(reused.generation != first.generation);
+		CHECK(pool.IsValid(reused));
+		CHECK(!pool.IsValid(first));
+		CHECK(pool.Get(first) == nullptr);
+		CHECK(pool.Get(reused)->value == 1);
+		CHECK(!pool.Reuse(handle));
+
+		//	Each time round the slot moves on again.
+		pool.Release(reused);
+		ResourcePool<Counted>::Handle again;
+		CHECK(pool.Reuse(again));
+		CHECK(again.index == first.index);
+		CHECK(again.generation != reused.generation);
+		CHECK(again.generation != first.generation);
+		CHECK(!pool.IsValid(reused));
+
+		//	A handle from somewhere else doesn't reach past the end.
+		ResourcePool<Counted>::Handle outside = { pool.GetSlotCount(), 0 };
+		CHECK(!pool.IsValid(outside));
+		CHECK(pool.Get(outside) == nullptr);
+
+		CHECK(pool.GetCreatedCount() == 2);
+		CHECK(pool.GetReusedCount() == 2);
+		CHECK(Counted::alive == 2);
+	}
+
+	//	The pool deletes everything it holds, in use or not.
+	CHECK(Counted::alive == 0);
+}
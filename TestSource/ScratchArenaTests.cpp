@@ -0,0 +1,105 @@
+// ScratchArenaTests.cpp
+//	A bake's working space comes from a ScratchArena, which only touches the heap while it is still growing.
+//	These tests check where it hands memory out from, and when it has to add to it.
+#include "Tests.h"
+#include "../BuilderSource/AllocationTracker.h"
+#include "../BuilderSource/ScratchArena.h"
+#include <cstdint>
+
+namespace
+{
+	struct alignas(64) CacheLine
+	{
+		float values[16];
+	};
+
+	bool IsAligned(const void* memory, size_t alignment)
+	{
+		return (reinterpret_cast<uintptr_t>(memory) % alignment) == 0;
+	}
+}
+
+//	Each allocation starts on its type's alignment, however the allocations before it left the block,
+//		and doesn't overlap the one before.
+void TestScratchArenaAlignsAllocations()
+{
+	ScratchArena scratch(1024);
+
+	char* first = scratch.Allocate<char>(3);
+	double* second = scratch.Allocate<double>(2);
+	char* third = scratch.Allocate<char>(1);
+	CacheLine* fourth = scratch.Allocate<CacheLine>(1);
+	int* fifth = scratch.Allocate<int>(5);
+
+	CHECK(IsAligned(second, alignof(double)));
+	CHECK(IsAligned(fourth, alignof(CacheLine)));
+	CHECK(IsAligned(fifth, alignof(int)));
+	CHECK(reinterpret_cast<char*>(second) >= first + 3);
+	CHECK(third >= reinterpret_cast<char*>(second + 2));
+	CHECK(reinterpret_cast<char*>(fourth) >= third + 1);
+	CHECK(reinterpret_cast<char*>(fifth) >= reinterpret_cast<char*>(fourth + 1));
+
+	//	Used counts the padding too, so it is at least what was asked for.
+	CHECK(scratch.GetUsed() >= 3 + 2 * sizeof(double) + 1 + sizeof(CacheLine) + 5 * sizeof(int));
+	CHECK(scratch.GetCapacity() == 1024);
+}
+
+//	An allocation that doesn't fit in what is left of a block moves on to a new one, and one bigger than a whole
+//		block gets a block of its own, big enough however it has to be aligned.
+void TestScratchArenaGrowsByBlocks()
+{
+	ScratchArena scratch(256);
+	CHECK(scratch.GetCapacity() == 0);
+
+	scratch.Allocate<char>(200);
+	CHECK(scratch.GetCapacity() == 256);
+
+	char* next = scratch.Allocate<char>(100);
+	CHECK(next != nullptr);
+	CHECK(scratch.GetCapacity() == 512);
+
+	CacheLine* large = scratch.Allocate<CacheLine>(10);
+	CHECK(IsAligned(large, alignof(CacheLine)));
+	CHECK(scratch.GetCapacity() >= 512 + 10 * sizeof(CacheLine));
+
+	//	The whole of the large allocation can be written.
+	for (int i = 0; i < 10; i++)
+	{
+		large[i].values[15] = (float)i;
+	}
+	CHECK(large[9].values[15] == 9.0f);
+}
+
+//	After a reset the same allocations come from the blocks already there, at the same addresses, without
+//		touching the heap. Only asking for more than before adds a block.
+void TestScratchArenaReusesBlocksAfterReset()
+{
+	ScratchArena scratch(256);
+	AllocationTracker allocation_tracker;
+
+	float* first = scratch.Allocate<float>(40);
+	double* second = scratch.Allocate<double>(40);
+	size_t capacity = scratch.GetCapacity();
+	size_t used = scratch.GetUsed();
+
+	scratch.Reset();
+	CHECK(scratch.GetUsed() == 0);
+
+	allocation_tracker.BeginFrame();
+	float* first_again = scratch.Allocate<float>(40);
+	double* second_again = scratch.Allocate<double>(40);
+	allocation_tracker.EndFrame();
+
+	CHECK(first_again == first);
+	CHECK(second_again == second);
+	CHECK(scratch.GetUsed() == used);
+	CHECK(scratch.GetCapacity() == capacity);
+	CHECK(allocation_tracker.GetFrameAllocations() == 0);
+
+	scratch.Reset();
+	allocation_tracker.BeginFrame();
+	scratch.Allocate<double>(100);
+	allocation_tracker.EndFrame();
+	CHECK(scratch.GetCapacity() > capacity);
+	CHECK(allocation_tracker.GetFrameAllocations() > 0);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdio>
+
+//	Checks that have failed so far in this run.
+extern int failed_checks;
+
+//	Report a failed check with where it was made, and carry on, so one run shows every failure.
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+			failed_checks++; \
+		} \
+	} while (0)
+
+//	ArcLengthTests.cpp
+void TestArcLengthIsAccurateAtDefaultResolution();
+
+//	FrameAllocationTests.cpp
+void TestAllocationTrackerCountsEveryForm();
+void TestRideFrameDoesNotAllocate();
+void TestBuildingFrameDoesNotAllocate();
+void TestEndlessFrameDoesNotAllocate();
+
+//	JobSystemTests.cpp
+void TestJobSystemRunsEachIndexOnce();
+void TestJobSystemRunsNestedWork();
+void TestJobSystemStealsWork();
+
+//	PackedVertexTests.cpp
+void TestPackedVertexRoundTripsPositions();
+void TestPackedVertexRoundTripsNormals();
+
+//	PagedBufferTests.cpp
+void TestPagedBufferGrowsByPages();
+void TestPagedBufferShrinksWithHysteresis();
+void TestPagedBufferWritesRegions();
+
+//	RenderQueueTests.cpp
+void TestRenderQueueBatchesStateChanges();
+void TestRenderQueueDrawsUntexturedFirst();
+void TestRenderQueueNumbersResourcesEachFrame();
+void TestRenderQueueOutlastsTheIdRange();
+
+//	ResourcePoolTests.cpp
+void TestResourcePoolHandlesGoStale();
+
+//	ScratchArenaTests.cpp
+void TestScratchArenaAlignsAllocations();
+void TestScratchArenaGrowsByBlocks();
+void TestScratchArenaReusesBlocksAfterReset();
+
+//	TrackGeneratorTests.cpp
+void TestTrackGridMarksCorners();
+void TestGeneratedTracksDoNotCrossThemselves();
+
+//	TrackGeometryTests.cpp
+void TestTrackGeometrySamplesByShape();
+void TestTrackGeometryPlacesInstances();
+void TestTrackBakesInstances();
+void TestRebakeDoesNotAllocate();
+
+//	TrackPieceCacheTests.cpp
+void TestTrackPieceCacheEvictsLeastRecentlyUsed();
+void TestTrackPieceCacheReusesEntries();
+
+//	TrackTests.cpp
+void TestCapturedStatesAreSharedUntilEdited();
+void TestPieceLengthsFollowEdits();
+void TestUndoReusesBakedPieces();
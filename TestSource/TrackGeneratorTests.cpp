@@ -0,0 +1,83 @@
+// TrackGeneratorTests.cpp
+//	Generated tracks are planned on a grid, and the grid is what keeps them from running into themselves.
+//	These tests check the grid's bookkeeping, then run generated tracks through the track validator.
+#include "Tests.h"
+#include "../BuilderSource/Track.h"
+#include "../BuilderSource/TrackGenerator.h"
+#include "../BuilderSource/TrackGrid.h"
+#include "../BuilderSource/TrackValidator.h"
+
+//	Turns and climbs pass by the cell straight ahead of them, so another piece can't cross them there.
+void TestTrackGridMarksCorners()
+{
+	TrackGrid grid;
+	grid.Resize(2, 2);
+
+	const TrackGrid::Cell start = { 0, 0, 0, 0 };
+	const TrackGrid::Cell ahead = { 0, 0, 1, 0 };
+
+	TrackGrid::Cell end;
+	CHECK(grid.CanMove(start, TrackPiece::Tag::RIGHT_TURN, end));
+	CHECK(end.x == 1 && end.z == 1 && end.heading == 1);
+	grid.Occupy(start, TrackPiece::Tag::RIGHT_TURN, end);
+	CHECK(grid.IsOccupied(end));
+	CHECK(grid.IsOccupied(ahead));
+	CHECK(!grid.IsOccupied(start));
+
+	//	A left turn into the same square would cut across the right turn.
+	const TrackGrid::Cell across = { 1, 0, 0, 0 };
+	TrackGrid::Cell left_end;
+	CHECK(grid.Move(across, TrackPiece::Tag::LEFT_TURN, left_end));
+	CHECK(!grid.CanMove(across, TrackPiece::Tag::LEFT_TURN, left_end));
+
+	//	Climbing up one level above where another piece climbs down the same square crosses it too.
+	grid.Clear();
+	const TrackGrid::Cell low = { 0, 0, -1, 0 };
+	const TrackGrid::Cell high = { 0, 1, -1, 0 };
+	TrackGrid::Cell down_end;
+	CHECK(grid.CanMove(high, TrackPiece::Tag::CLIMB_DOWN, down_end));
+	grid.Occupy(high, TrackPiece::Tag::CLIMB_DOWN, down_end);
+
+	TrackGrid::Cell up_end;
+	CHECK(!grid.CanMove(low, TrackPiece::Tag::CLIMB_UP, up_end));
+
+	//	A straight only passes through the cell it ends in.
+	grid.Clear();
+	TrackGrid::Cell straight_end;
+	CHECK(grid.CanMove(start, TrackPiece::Tag::STRAIGHT, straight_end));
+	grid.Occupy(start, TrackPiece::Tag::STRAIGHT, straight_end);
+	CHECK(grid.IsOccupied(ahead));
+	CHECK(grid.GetCellCount() == 5 * 5 * 3);
+}
+
+//	No generated track overlaps itself anywhere along its length, the closing piece included.
+void TestGeneratedTracksDoNotCrossThemselves()
+{
+	const unsigned int seed_count = 60;
+
+	Track track(100, nullptr);
+	TrackGenerator generator;
+	TrackValidator validator;
+
+	unsigned int generated_count = 0;
+	for (unsigned int seed = 1; seed <= seed_count; seed++)
+	{
+		if (!generator.Generate(seed, &track))
+		{
+			continue;
+		}
+		generated_count++;
+
+		validator.Validate(&track);
+
+		const std::vector<TrackValidator::Violation>& violations = validator.GetViolations();
+		for (int i = 0; i < violations.size(); i++)
+		{
+			CHECK(violations[i].rule != TrackValidator::Rule::SELF_INTERSECTION);
+			CHECK(violations[i].rule != TrackValidator::Rule::RAIL_CLEARANCE);
+		}
+	}
+
+	//	Most seeds find a layout. The rest are turned down rather than crossing themselves.
+	CHECK(generated_count > seed_count * 3 / 4);
+}
@@ -0,0 +1,224 @@
+// TrackGeometryTests.cpp
+//	The track is baked into a TrackGeometry on the baker's worker every time it is edited.
+//	These tests bake tracks without a device and check what comes out, and what it costs.
+#include "Tests.h"
+#include "../BuilderSource/AllocationTracker.h"
+#include "../BuilderSource/Track.h"
+#include "../BuilderSource/TrackGeometry.h"
+#include "../BuilderSource/ScratchArena.h"
+#include "../Spline-Library/CRSplineController.h"
+#include <cmath>
+
+namespace
+{
+	void BuildTrack(Track& track, int piece_count)
+	{
+		const TrackPiece::Tag layout[] = { TrackPiece::Tag::STRAIGHT, TrackPiece::Tag::RIGHT_TURN, TrackPiece::Tag::STRAIGHT,
+			TrackPiece::Tag::CLIMB_UP, TrackPiece::Tag::CLIMB_DOWN, TrackPiece::Tag::LEFT_TURN, TrackPiece::Tag::LEFT_TURN,
+			TrackPiece::Tag::STRAIGHT, TrackPiece::Tag::RIGHT_TURN };
+
+		for (int i = 0; i < piece_count; i++)
+		{
+			track.AddTrackPiece(layout[i % 9]);
+		}
+	}
+
+	bool IsNear(XMVECTOR a, XMVECTOR b)
+	{
+		return XMVectorGetX(XMVector3Length(a - b)) < 1.0e-4f;
+	}
+
+	//	Frames for a stock piece on its own, rolling from start_roll to roll_target.
+	unsigned int GetStockFrames(TrackPiece::Tag tag, float start_roll, float roll_target)
+	{
+		TrackPiece* track_piece = TrackPiece::CreateStockPiece(tag);
+
+		//	The spline controller takes ownership of the spline segment.
+		SL::CRSplineController spline_controller(100);
+		spline_controller.AddSegment(track_piece->GetSpline(), track_piece->GetTension(), false);
+		unsigned int frame_count = TrackGeometry::GetFramesForPiece(spline_controller.GetSegment(0), spline_controller.GetArcLength(), start_roll, roll_target);
+
+		delete track_piece;
+		return frame_count;
+	}
+}
+
+//	Pieces that turn, climb or roll are sampled with more frames than a straight, in whole steps between the cross ties,
+//		and a baked track has just the frames its pieces asked for, and one more to close it.
+void TestTrackGeometrySamplesByShape()
+{
+	const unsigned int straight = GetStockFrames(TrackPiece::Tag::STRAIGHT, 0.0f, 0.0f);
+	const unsigned int rolling_straight = GetStockFrames(TrackPiece::Tag::STRAIGHT, 0.0f, 90.0f);
+	const unsigned int turn = GetStockFrames(TrackPiece::Tag::RIGHT_TURN, 0.0f, 0.0f);
+	const unsigned int banked_turn = GetStockFrames(TrackPiece::Tag::RIGHT_TURN, 0.0f, -45.0f);
+	const unsigned int climb = GetStockFrames(TrackPiece::Tag::CLIMB_UP, 0.0f, 0.0f);
+
+	CHECK(straight < TrackGeometry::GetFramesPerPiece());
+	CHECK(rolling_straight > straight);
+	CHECK(turn > straight);
+	CHECK(banked_turn > turn);
+	CHECK(climb > straight);
+	CHECK(GetStockFrames(TrackPiece::Tag::LEFT_TURN, 0.0f, 45.0f) == banked_turn);
+
+	const unsigned int counts[] = { straight, rolling_straight, turn, banked_turn, climb };
+	for (int i = 0; i < 5; i++)
+	{
+		CHECK(counts[i] > 0);
+		CHECK(counts[i] % TrackGeometry::GetCrossTiesPerPiece() == 0);
+	}
+
+	Track track(100, nullptr);
+	track.AddTrackPiece(TrackPiece::Tag::STRAIGHT);
+	track.AddTrackPiece(TrackPiece::Tag::RIGHT_TURN);
+	track.GetBack()->SetRollTarget(-45.0f);
+
+	TrackGeometry geometry;
+	track.StoreMeshData(&geometry);
+	CHECK(geometry.GetFrameCount() == straight + banked_turn + 1);
+	CHECK(geometry.GetCrossTies().size() == 2 * TrackGeometry::GetCrossTiesPerPiece());
+}
+
+//	Each cross tie keeps the frame of the track where it sits, as a position and a rotation of the tie's own space.
+//		Each pillar stretches the unit cylinder from one end to the other, and each joint scales the unit sphere
+//		where a segmented support bends, both tagged with the chunk of track they hold up.
+void TestTrackGeometryPlacesInstances()
+{
+	const int frame_count = 2 * TrackGeometry::GetFramesPerPiece() * TrackGeometry::GetPiecesPerChunk() + 1;
+	const XMVECTOR x_axis = XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f);
+	const XMVECTOR y_axis = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+	const XMVECTOR z_axis = XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+
+	//	A straight track heading along x, 2 metres up, a tie every other frame.
+	TrackGeometry geometry;
+	for (int k = 0; k < frame_count; k++)
+	{
+		if ((k + 1 < frame_count) && (k % TrackGeometry::GetFramesPerPiece() == 0))
+		{
+			geometry.BeginPiece(TrackGeometry::GetFramesPerPiece());
+		}
+
+		XMVECTOR centre = XMVectorSet(k * 0.5f, 2.0f, 0.0f, 0.0f);
+		geometry.AddFrame(centre, x_axis, y_axis, z_axis);
+		if ((k + 1 < frame_count) && (k % TrackGeometry::GetCrossTieFrequency() == 0))
+		{
+			geometry.AddCrossTie(centre, x_axis * 3.0f, y_axis, z_axis);
+		}
+	}
+
+	ScratchArena scratch;
+	geometry.Finalise(scratch);
+	CHECK(geometry.GetChunks().size() == 2);
+
+	const std::vector<TrackGeometry::CrossTie>& cross_ties = geometry.GetCrossTies();
+	CHECK(cross_ties.size() == (frame_count - 1) / TrackGeometry::GetCrossTieFrequency());
+	for (int i = 0; i < cross_ties.size(); i++)
+	{
+		XMVECTOR rotation = XMLoadFloat4(&cross_ties[i].rotation);
+		CHECK(IsNear(XMLoadFloat3(&cross_ties[i].position), XMVectorSet(i * TrackGeometry::GetCrossTieFrequency() * 0.5f, 2.0f, 0.0f, 0.0f)));
+		CHECK(IsNear(XMVector3Rotate(XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), rotation), x_axis));
+		CHECK(IsNear(XMVector3Rotate(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), rotation), y_axis));
+		CHECK(IsNear(XMVector3Rotate(XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), rotation), z_axis));
+	}
+
+	//	One support straight down under the first chunk, and one bent support under the second.
+	geometry.AddSupportVertical(XMVectorSet(10.0f, 1.8f, 0.0f, 0.0f), XMVectorSet(10.0f, 0.0f, 0.0f, 0.0f));
+	XMVECTOR bend = XMVectorSet(100.0f, 1.0f, 1.0f, 0.0f);
+	XMVECTOR angled_x = XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+	XMVECTOR angled_z = XMVector3Normalize(XMVectorSet(0.0f, 1.0f, 1.0f, 0.0f));
+	geometry.AddSupportSegmented(bend, XMVectorSet(100.0f, 0.0f, 1.0f, 0.0f), XMVectorSet(100.0f, 1.8f, 0.2f, 0.0f), bend, angled_x, angled_z);
+
+	const std::vector<TrackGeometry::SupportInstance>& pillars = geometry.GetPillars();
+	const std::vector<TrackGeometry::SupportInstance>& joints = geometry.GetJoints();
+	CHECK(pillars.size() == 3);
+	CHECK(joints.size() == 1);
+	if ((pillars.size() != 3) || (joints.size() != 1))
+	{
+		return;
+	}
+
+	XMMATRIX vertical = XMLoadFloat4x4(&pillars[0].world);
+	CHECK(IsNear(XMVector3TransformCoord(XMVectorZero(), vertical), XMVectorSet(10.0f, 1.8f, 0.0f, 0.0f)));
+	CHECK(IsNear(XMVector3TransformCoord(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), vertical), XMVectorSet(10.0f, 0.0f, 0.0f, 0.0f)));
+	CHECK(fabsf(XMVectorGetX(XMVector3Length(vertical.r[0])) - 0.2f) < 1.0e-5f);
+	CHECK(fabsf(XMVectorGetX(XMVector3Length(vertical.r[2])) - 0.2f) < 1.0e-5f);
+	CHECK(pillars[0].chunk == 0);
+
+	XMMATRIX angled = XMLoadFloat4x4(&pillars[1].world);
+	CHECK(IsNear(XMVector3TransformCoord(XMVectorZero(), angled), XMVectorSet(100.0f, 1.8f, 0.2f, 0.0f)));
+	CHECK(IsNear(XMVector3TransformCoord(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), angled), bend));
+	CHECK(IsNear(XMVector3Normalize(angled.r[2]), angled_z));
+	CHECK(pillars[1].chunk == 1);
+	CHECK(pillars[2].chunk == 1);
+
+	XMMATRIX joint = XMLoadFloat4x4(&joints[0].world);
+	CHECK(IsNear(XMVector3TransformCoord(XMVectorZero(), joint), bend));
+	CHECK(fabsf(XMVectorGetX(XMVector3Length(joint.r[1])) - 0.19f) < 1.0e-5f);
+	CHECK(joints[0].chunk == 1);
+
+	geometry.ClearSupports();
+	CHECK(geometry.GetPillars().empty() && geometry.GetJoints().empty());
+	CHECK(geometry.GetCrossTies().size() == cross_ties.size());
+}
+
+//	A baked track has a cross tie every other frame of every piece, and supports under it down to the ground.
+void TestTrackBakesInstances()
+{
+	const int piece_count = 12;
+	Track track(100, nullptr);
+	BuildTrack(track, piece_count);
+
+	TrackGeometry geometry;
+	track.StoreMeshData(&geometry);
+	track.StoreSupportData(&geometry);
+
+	CHECK(geometry.GetCrossTies().size() == piece_count * TrackGeometry::GetCrossTiesPerPiece());
+	CHECK(!geometry.GetPillars().empty());
+
+	const unsigned int chunk_count = geometry.GetChunks().size();
+	float lowest = 1.0e9f;
+	for (int i = 0; i < geometry.GetPillars().size(); i++)
+	{
+		const TrackGeometry::SupportInstance& pillar = geometry.GetPillars()[i];
+		XMMATRIX world = XMLoadFloat4x4(&pillar.world);
+		lowest = std::min(lowest, XMVectorGetY(XMVector3TransformCoord(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), world)));
+		CHECK(pillar.chunk < chunk_count);
+	}
+	for (int i = 0; i < geometry.GetJoints().size(); i++)
+	{
+		CHECK(geometry.GetJoints()[i].chunk < chunk_count);
+	}
+
+	//	Supports that aren't cut short by the track below them stand on the ground.
+	CHECK(fabsf(lowest - track.GetMinHeight()) < 1.0e-4f);
+}
+
+//	Once a track has been baked, baking it again reuses the geometry's buffers and the track's scratch space,
+//		so the worker doesn't touch the heap however often an edit asks for the same track.
+//	Without a job system every part of the bake runs on this thread, where the allocations are counted.
+void TestRebakeDoesNotAllocate()
+{
+	Track track(100, nullptr);
+	BuildTrack(track, 37);
+
+	TrackGeometry geometry;
+	AllocationTracker allocation_tracker;
+
+	for (int bake = 0; bake < 3; bake++)
+	{
+		allocation_tracker.BeginFrame();
+		track.StoreMeshData(&geometry);
+		geometry.ClearSupports();
+		track.StoreSupportData(&geometry);
+		allocation_tracker.EndFrame();
+
+		CHECK(geometry.GetFrameCount() > 0);
+		if (bake == 0)
+		{
+			CHECK(allocation_tracker.GetFrameAllocations() > 0);
+		}
+		else
+		{
+			CHECK(allocation_tracker.GetFrameAllocations() == 0);
+		}
+	}
+}
@@ -0,0 +1,47 @@
+// TrackPieceCacheTests.cpp
+//	The stock piece cache bakes each type, tension and roll profile once, and is kept to a fixed number of entries.
+#include "Tests.h"
+#include "../BuilderSource/TrackPieceCache.h"
+
+//	A full cache makes room by dropping the entry used longest ago, keeping the rest.
+void TestTrackPieceCacheEvictsLeastRecentlyUsed()
+{
+	TrackPieceCache cache(100);
+
+	//	Keep using the first roll target while adding new ones, until the cache is full and has to drop one.
+	cache.Find(TrackPiece::Tag::STRAIGHT, 2.0f, 0.0f, 0.0f);
+	int roll = 1;
+	while (cache.GetBakeCount() == cache.GetEntryCount())
+	{
+		cache.Find(TrackPiece::Tag::STRAIGHT, 2.0f, 0.0f, 0.0f);
+		cache.Find(TrackPiece::Tag::STRAIGHT, 2.0f, 0.0f, (float)roll);
+		roll++;
+	}
+	unsigned int capacity = cache.GetEntryCount();
+	CHECK(capacity > 2);
+
+	//	The first roll target was used most recently, so it is still there. The second was used longest ago, so it went.
+	unsigned int bake_count = cache.GetBakeCount();
+	cache.Find(TrackPiece::Tag::STRAIGHT, 2.0f, 0.0f, 0.0f);
+	CHECK(cache.GetBakeCount() == bake_count);
+
+	cache.Find(TrackPiece::Tag::STRAIGHT, 2.0f, 0.0f, 1.0f);
+	CHECK(cache.GetBakeCount() == bake_count + 1);
+	CHECK(cache.GetEntryCount() == capacity);
+}
+
+//	A stock piece with the same tension and roll is only baked once, and anything else isn't cached at all.
+void TestTrackPieceCacheReusesEntries()
+{
+	TrackPieceCache cache(100);
+
+	const TrackPieceCache::Entry* entry = cache.Find(TrackPiece::Tag::RIGHT_TURN, 2.0f, 0.0f, 15.0f);
+	CHECK(entry);
+	CHECK(entry && entry->geometry.GetFrameCount() % TrackGeometry::GetCrossTiesPerPiece() == 0);
+	CHECK(entry && entry->geometry.GetCrossTies().size() == TrackGeometry::GetCrossTiesPerPiece());
+	CHECK(cache.Find(TrackPiece::Tag::RIGHT_TURN, 2.0f, 0.0f, 15.0f) == entry);
+	CHECK(cache.GetBakeCount() == 1);
+
+	CHECK(!cache.Find(TrackPiece::Tag::COMPLETE_TRACK, 2.0f, 0.0f, 0.0f));
+	CHECK(cache.GetEntryCount() == 1);
+}
@@ -0,0 +1,213 @@
+// TrackTests.cpp
+//	The track builder snapshots the whole track for every bake, and the track works out piece lengths after every edit.
+//	These tests check both only cost as much as the pieces that changed, and so does baking a track again after an undo.
+#include "Tests.h"
+#include "../BuilderSource/AllocationTracker.h"
+#include "../BuilderSource/Track.h"
+#include "../BuilderSource/TrackBaker.h"
+#include "../BuilderSource/TrackHistory.h"
+#include "../BuilderSource/TrackMeshSink.h"
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	void BuildTrack(Track& track, int piece_count)
+	{
+		const TrackPiece::Tag layout[] = { TrackPiece::Tag::STRAIGHT, TrackPiece::Tag::RIGHT_TURN, TrackPiece::Tag::CLIMB_UP,
+			TrackPiece::Tag::CLIMB_DOWN, TrackPiece::Tag::LEFT_TURN };
+
+		for (int i = 0; i < piece_count; i++)
+		{
+			track.AddTrackPiece(layout[i % 5]);
+		}
+	}
+
+	void CaptureTrack(Track& track, std::vector<TrackPiece::StatePtr>& states)
+	{
+		for (int i = 0; i < states.size(); i++)
+		{
+			states[i] = track.CaptureTrackPiece(i);
+		}
+	}
+
+	//	Keeps what the last track upload was given, as the track mesh would see it.
+	class KeySink : public TrackMeshSink
+	{
+	public:
+		KeySink() : frame_count(0) {}
+		void UploadTrack(const TrackGeometry& geometry)
+		{
+			keys.clear();
+			for (int i = 0; i < geometry.GetChunks().size(); i++)
+			{
+				keys.push_back(geometry.GetChunks()[i].key);
+			}
+			frame_count = geometry.GetFrameCount();
+			cross_ties = geometry.GetCrossTies();
+		}
+		void UploadPreview(const TrackGeometry& geometry) {}
+		void UploadSupports(const TrackGeometry& geometry) {}
+		void SetPreviewActive(bool preview) {}
+		void SetTranslation(float x, float y, float z) {}
+		void Clear() {}
+		void ClearPreview() {}
+		void ClearSupports() {}
+
+		std::vector<unsigned long long> keys;
+		unsigned int frame_count;
+		std::vector<TrackGeometry::CrossTie> cross_ties;
+	};
+
+	void Bake(TrackBaker& baker, Track& track, KeySink& sink)
+	{
+		baker.RequestTrack(&track);
+		baker.Wait();
+		CHECK(baker.Collect(&sink, &track));
+	}
+
+	bool SameCrossTies(const std::vector<TrackGeometry::CrossTie>& a, const std::vector<TrackGeometry::CrossTie>& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+
+		for (int i = 0; i < a.size(); i++)
+		{
+			if (a[i].position.x != b[i].position.x || a[i].position.y != b[i].position.y || a[i].position.z != b[i].position.z)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+//	Capturing a piece that hasn't changed hands back the snapshot it was last captured with, without allocating.
+//		Editing a piece gives it a new snapshot, and so does moving it to stay joined to a piece edited before it.
+void TestCapturedStatesAreSharedUntilEdited()
+{
+	const int piece_count = 12;
+	Track track(100, nullptr);
+	BuildTrack(track, piece_count);
+
+	std::vector<TrackPiece::StatePtr> first(piece_count);
+	std::vector<TrackPiece::StatePtr> second(piece_count);
+	CaptureTrack(track, first);
+
+	AllocationTracker allocation_tracker;
+	allocation_tracker.BeginFrame();
+	CaptureTrack(track, second);
+	allocation_tracker.EndFrame();
+
+	CHECK(allocation_tracker.GetFrameAllocations() == 0);
+	CHECK(first == second);
+
+	//	Only the edited piece changes.
+	track.GetTrackPiece(5)->SetRollTarget(30.0f);
+	CaptureTrack(track, second);
+	for (int i = 0; i < piece_count; i++)
+	{
+		CHECK((second[i] == first[i]) == (i != 5));
+	}
+	CHECK(second[5]->roll_target == 30.0f);
+
+	//	Swapping a piece for another type moves every piece after it, but leaves the ones before it alone.
+	CHECK(track.ReplaceTrackPiece(8, TrackPiece::Tag::LEFT_TURN));
+	CaptureTrack(track, first);
+	for (int i = 0; i < piece_count; i++)
+	{
+		CHECK((first[i] == second[i]) == (i < 8));
+	}
+
+	//	Putting a snapshot back means capturing the piece again gives the same snapshot.
+	CHECK(track.RestoreTrackPiece(8, second[8], false));
+	CHECK(track.CaptureTrackPiece(8) == second[8]);
+}
+
+//	Each piece's length is the length of its spline segment, and they add up to the track.
+//		Changing the last piece only changes its own length, as it does when the preview is committed.
+void TestPieceLengthsFollowEdits()
+{
+	const int piece_count = 9;
+	Track track(100, nullptr);
+	BuildTrack(track, piece_count);
+
+	std::vector<float> lengths(piece_count);
+	float total = 0.0f;
+	for (int i = 0; i < piece_count; i++)
+	{
+		lengths[i] = track.GetPieceLength(i);
+		total += lengths[i];
+		CHECK(lengths[i] > 0.0f);
+	}
+	CHECK(fabsf(total - track.GetTrackLength()) < 1.0e-3f * total);
+
+	TrackPiece* longer = TrackPiece::CreateStockPiece(TrackPiece::Tag::STRAIGHT);
+	for (int i = 0; i < 4; i++)
+	{
+		SL::Vector point = track.GetBack()->GetControlPoint(0);
+		SL::Vector end = track.GetBack()->GetControlPoint(i);
+		longer->SetControlPoint(i, SL::Vector(point.X() + (end.X() - point.X()) * 2.0f, point.Y() + (end.Y() - point.Y()) * 2.0f, point.Z() + (end.Z() - point.Z()) * 2.0f));
+	}
+	longer->SetTension(track.GetBack()->GetTension());
+	track.UpdateBack(longer);
+	delete longer->GetSpline();
+	delete longer;
+
+	for (int i = 0; i < piece_count - 1; i++)
+	{
+		CHECK(track.GetPieceLength(i) == lengths[i]);
+	}
+	CHECK(track.GetPieceLength(piece_count - 1) > lengths[piece_count - 1] * 1.5f);
+}
+
+//	Every piece the baker bakes keeps its geometry with its snapshot, and each chunk is keyed by the pieces it was built from.
+//		Editing a piece's roll only changes the chunk it's in, and undoing the edit gives back the first bake's chunks
+//		as they were, so the mesh has nothing to upload again.
+void TestUndoReusesBakedPieces()
+{
+	const int piece_count = 16;
+	const int edited = 13;
+	Track track(100, nullptr);
+	BuildTrack(track, piece_count);
+
+	TrackBaker baker(100);
+	TrackHistory history;
+	KeySink sink;
+
+	Bake(baker, track, sink);
+	const std::vector<unsigned long long> first_keys = sink.keys;
+	const unsigned int first_frame_count = sink.frame_count;
+	const std::vector<TrackGeometry::CrossTie> first_cross_ties = sink.cross_ties;
+	CHECK(first_keys.size() == piece_count / TrackGeometry::GetPiecesPerChunk());
+	for (int i = 0; i < first_keys.size(); i++)
+	{
+		CHECK(first_keys[i] != 0);
+	}
+
+	//	Baking the same track again lays every piece from its snapshot.
+	Bake(baker, track, sink);
+	CHECK(sink.keys == first_keys);
+	CHECK(sink.frame_count == first_frame_count);
+	CHECK(SameCrossTies(sink.cross_ties, first_cross_ties));
+
+	TrackPiece::StatePtr before = track.CaptureTrackPiece(edited);
+	track.GetTrackPiece(edited)->SetRollTarget(20.0f);
+	history.RecordEdit(edited, before, track.CaptureTrackPiece(edited));
+
+	Bake(baker, track, sink);
+	CHECK(sink.keys.size() == first_keys.size());
+	const int edited_chunk = edited / TrackGeometry::GetPiecesPerChunk();
+	for (int i = 0; i < sink.keys.size(); i++)
+	{
+		CHECK((sink.keys[i] == first_keys[i]) == (i < edited_chunk));
+	}
+
+	CHECK(history.Undo(&track));
+	Bake(baker, track, sink);
+	CHECK(sink.keys == first_keys);
+	CHECK(sink.frame_count == first_frame_count);
+	CHECK(SameCrossTies(sink.cross_ties, first_cross_ties));
+}
@@ -0,0 +1,139 @@
+// Main.cpp
+//	Command line driver for the track validator.
+//	Usage: ValidateTracks <directory> [thread count]
+//	Every .txt track file in the directory is loaded and validated, spread across worker threads.
+//	Returns 0 if every track passed, 1 if any track had violations or could not be loaded, and 2 for bad arguments.
+#include "../BuilderSource/Track.h"
+#include "../BuilderSource/TrackLoader.h"
+#include "../BuilderSource/TrackValidator.h"
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Result
+{
+	std::string file_name;
+	bool loaded;
+	std::vector<TrackValidator::Violation> violations;
+};
+
+//	Each worker has its own track, loader and validator, and takes the next file until there are none left.
+void ValidateFiles(std::vector<Result>* results, std::atomic<int>* next_file)
+{
+	Track track(100, nullptr);
+	TrackLoader track_loader;
+	TrackValidator validator;
+	std::vector<char> file_name;
+
+	while (true)
+	{
+		int index = (*next_file)++;
+		if (index >= (int)results->size())
+		{
+			break;
+		}
+
+		Result& result = (*results)[index];
+
+		file_name.assign(result.file_name.begin(), result.file_name.end());
+		file_name.push_back('\0');
+
+		result.loaded = track_loader.LoadTrack(file_name.data(), &track);
+		if (result.loaded)
+		{
+			validator.Validate(&track);
+			result.violations = validator.GetViolations();
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		printf("Usage: ValidateTracks <directory> [thread count]\n");
+		return 2;
+	}
+
+	std::error_code error;
+	std::vector<Result> results;
+	for (const auto& entry : std::filesystem::directory_iterator(argv[1], error))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".txt")
+		{
+			Result result;
+			result.file_name = entry.path().string();
+			result.loaded = false;
+			results.push_back(result);
+		}
+	}
+
+	if (error)
+	{
+		printf("Unable to read directory %s\n", argv[1]);
+		return 2;
+	}
+
+	//	Report in a stable order, regardless of which thread finished first.
+	std::sort(results.begin(), results.end(), [](const Result& a, const Result& b) { return a.file_name < b.file_name; });
+
+	int thread_count = std::thread::hardware_concurrency();
+	if (argc > 2)
+	{
+		thread_count = atoi(argv[2]);
+	}
+	thread_count = std::max(1, std::min(thread_count, (int)results.size()));
+
+	std::atomic<int> next_file(0);
+	std::vector<std::thread> workers;
+	for (int i = 0; i < thread_count; i++)
+	{
+		workers.push_back(std::thread(ValidateFiles, &results, &next_file));
+	}
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	int failed_count = 0;
+	for (int i = 0; i < results.size(); i++)
+	{
+		Result& result = results[i];
+
+		if (!result.loaded)
+		{
+			printf("%s: unable to load track\n", result.file_name.c_str());
+			failed_count++;
+			continue;
+		}
+
+		if (!result.violations.empty())
+		{
+			failed_count++;
+		}
+
+		for (int j = 0; j < result.violations.size(); j++)
+		{
+			TrackValidator::Violation& violation = result.violations[j];
+
+			printf("%s: piece %d at %.1fm (%.2f, %.2f, %.2f): %s %.3f", result.file_name.c_str(),
+				violation.track_piece, violation.distance, violation.position.X(), violation.position.Y(), violation.position.Z(),
+				TrackValidator::GetRuleName(violation.rule), violation.value);
+
+			if (violation.other_track_piece >= 0)
+			{
+				printf(" with piece %d at %.1fm", violation.other_track_piece, violation.other_distance);
+			}
+			printf("\n");
+		}
+	}
+
+	printf("%d tracks validated, %d failed\n", (int)results.size(), failed_count);
+
+	return (failed_count == 0) ? 0 : 1;
+}